@@ -0,0 +1,141 @@
+/* Test-only stand-in for the flex scanner (flex isn't installed here). */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../includes/lexer.h"
+#include "../../includes/types.h"
+#include "../parser/bison.h"
+void set_lval(int);
+int yyline = 1;
+FILE* yyin;
+char* yytext;
+static char textbuf[1<<16];
+
+struct yy_buffer_state { FILE* f; char* data; size_t len, pos; int state; };
+static YY_BUFFER_STATE bstack[64]; static int bdepth = 0;
+
+enum { S_INIT=1, S_DIR=2, S_COM=4 };
+enum { A_RET, A_SET, A_DIR, A_NL, A_SKIP, A_COMSTART, A_COMEND, A_COMNL };
+YY_BUFFER_STATE yy_create_buffer(FILE* file, int size)
+{
+  YY_BUFFER_STATE b = calloc(1, sizeof(*b));
+  b->f = file; b->state = S_INIT;
+  size_t cap = 1<<16; b->data = malloc(cap);
+  size_t n;
+  while ((n = fread(b->data + b->len, 1, cap - b->len, file)) > 0) {
+    b->len += n;
+    if (b->len == cap) { cap *= 2; b->data = realloc(b->data, cap); }
+  }
+  return b;
+}
+void yy_delete_buffer(YY_BUFFER_STATE b) { if (b) { free(b->data); free(b); } }
+void yy_flush_buffer(YY_BUFFER_STATE b) { (void)b; }
+void yy_switch_to_buffer(YY_BUFFER_STATE b) { if (bdepth==0) bdepth=1; bstack[bdepth-1] = b; }
+void yypush_buffer_state(YY_BUFFER_STATE b) { bstack[bdepth++] = b; }
+void yypop_buffer_state(void) { if (bdepth) { yy_delete_buffer(bstack[bdepth-1]); bdepth--; } }
+void yyrestart(FILE* f)
+{
+  if (bdepth) yy_delete_buffer(bstack[bdepth-1]); else bdepth = 1;
+  bstack[bdepth-1] = yy_create_buffer(f, 0);
+}
+
+static int isid(int c) { return c=='_' || (c>='a'&&c<='z') || (c>='A'&&c<='Z') || (c>='0'&&c<='9'); }
+static int isdig(int c) { return c>='0' && c<='9'; }
+static int ishex(int c) { return isdig(c) || (c>='a'&&c<='f') || (c>='A'&&c<='F'); }
+struct kw { const char* w; int act; int tok; };
+static const struct kw kws[] = {
+  {"void",A_SET,TYPE},{"char",A_SET,TYPE},{"int",A_SET,TYPE},{"float",A_SET,TYPE},
+  {"extern",A_SET,SCOPE},{"static",A_SET,SCOPE},{"for",A_RET,FOR},{"while",A_RET,WHILE},
+  {"do",A_RET,DO},{"if",A_RET,IF},{"else",A_RET,ELSE},{"break",A_RET,BREAK},
+  {"continue",A_RET,CONTINUE},{"return",A_RET,RETURN},{0,0,0}};
+static const struct kw dirs[] = {
+  {"#include",0,INCLUDE},{"#undef",0,UNDEF},{"#ifdef",0,IFDEF},{"#ifndef",0,IFNDEF},
+  {"#endif",0,ENDIF},{"#elif",0,ELIF},{"#else",0,ELSE_DIREC},{0,0,0}};
+static const struct kw ops2[] = {
+  {"==",0,EQUAL},{"!=",0,NEQUAL},{">=",0,GE},{"<=",0,LE},{"&&",0,DAMP},{"||",0,DPIPE},
+  {"+=",0,PLUSASSIGN},{"-=",0,MINUSASSIGN},{"*=",0,STARASSIGN},{"/=",0,SLASHASSIGN},
+  {"++",0,INCR},{"--",0,DECR},{0,0,0}};
+
+int yylex(void)
+{
+  if (!bdepth || !bstack[bdepth-1]) { if (!yyin) return 0; yyrestart(yyin); }
+  YY_BUFFER_STATE b = bstack[bdepth-1];
+  for (;;) {
+    const char* d = b->data; size_t n = b->len, p = b->pos;
+    if (p >= n) { yytext = textbuf; textbuf[0] = 0; return 0; }
+#define AT(i) ((p+(i)) < n ? d[p+(i)] : 0)
+    char c = d[p];
+    size_t len = 1; int act = A_SET, tok = UNKNOWN;
+    if (b->state == S_COM) {
+      if (c=='*' && AT(1)=='/') { b->state = S_INIT; b->pos += 2; }
+      else { if (c=='\n') yyline++; b->pos++; }
+      continue;
+    }
+    if (c==' '||c=='\t'||c=='\r') { b->pos++; continue; }
+    if (c=='\n') {
+      b->pos++; yyline++;
+      if (b->state == S_DIR) { b->state = S_INIT; textbuf[0]='\n'; textbuf[1]=0; yytext=textbuf; return NEWLINE; }
+      continue;
+    }
+    if (c=='/' && AT(1)=='/') { while (p<n && d[p]!='\n') p++; b->pos = p; continue; }
+    if (c=='/' && AT(1)=='*') { b->state = S_COM; b->pos += 2; continue; }
+    if (c=='#') {
+      int i;
+      if (n-p >= 7 && !memcmp(d+p, "#define", 7) && (AT(7)==' '||AT(7)=='\t'||AT(7)=='\r')) {
+        len = 7; while (AT(len)==' '||AT(len)=='\t'||AT(len)=='\r') len++;
+        act = A_DIR; tok = DEFINE;
+      } else for (i=0; dirs[i].w; i++) {
+        size_t l = strlen(dirs[i].w);
+        if (n-p >= l && !memcmp(d+p, dirs[i].w, l)) { len = l; act = A_DIR; tok = dirs[i].tok; break; }
+      }
+    } else if (isid(c) && !isdig(c)) {
+      int i;
+      while (isid(AT(len))) len++;
+      act = A_SET; tok = IDENT;
+      for (i=0; kws[i].w; i++) if (strlen(kws[i].w)==len && !memcmp(d+p, kws[i].w, len)) { act = kws[i].act; tok = kws[i].tok; break; }
+    } else if (isdig(c) || (c=='.' && isdig(AT(1)))) {
+      size_t a = 0, best = 0, r; int bt = UNKNOWN;
+      while (isdig(AT(a))) a++;
+      if (a) { best = a; bt = INTCONST; }
+      if (c=='0' && AT(1)=='x' && ishex(AT(2))) { size_t h = 2; while (ishex(AT(h))) h++; if (h > best) { best = h; bt = HEXCONST; } }
+      r = 0;
+      if (AT(a)=='.' && isdig(AT(a+1))) { r = a+1; while (isdig(AT(r))) r++; }
+      else if (a) r = a;
+      if (r && AT(r)=='e') { r++; if (AT(r)=='-') r++; while (isdig(AT(r))) r++; }
+      if (r > best) { best = r; bt = REALCONST; }
+      len = best; tok = bt; act = A_SET;
+    } else if (c=='"') {
+      /* longest match of \"([^\n"]|\\\"|\\\n)*\" */
+      size_t q = p+1, end = 0; int r0 = 1, r1 = 0, r2 = 0;
+      while (q < n && (r0||r1||r2)) {
+        if (r0) {
+          char e = d[q];
+          if (e=='"') end = q+1;
+          if (e!='\n' && e!='"') r1 = 1;
+          if (e=='\\' && q+1<n && (d[q+1]=='"' || d[q+1]=='\n')) r2 = 1;
+        }
+        r0 = r1; r1 = r2; r2 = 0; q++;
+      }
+      if (end) { len = end - p; tok = STRCONST; }
+    } else if (c=='\'') {
+      if (AT(1)=='\\' && AT(2) && AT(2)!='\n' && AT(3)=='\'') { len = 4; tok = CHARCONST; }
+      else if (AT(1) && AT(1)!='\\' && AT(1)!='\n' && AT(2)=='\'') { len = 3; tok = CHARCONST; }
+    } else {
+      int i, found = 0;
+      if (c=='<' && b->state==S_DIR) {
+        size_t q = 1; while (AT(q) && AT(q)!='>') q++;
+        if (AT(q)=='>' && q > 1 && q+1 > 2) { len = q+1; act = A_SET; tok = INCLUDE_FILE; found = 1; }
+      }
+      if (!found) for (i=0; ops2[i].w; i++) if (c==ops2[i].w[0] && AT(1)==ops2[i].w[1]) { len = 2; act = A_RET; tok = ops2[i].tok; found = 1; break; }
+      if (!found && strchr("()[]{},;?:><+-*/%~|!&=", c)) { len = 1; act = A_RET; tok = c; }
+    }
+#undef AT
+    memcpy(textbuf, d+p, len); textbuf[len] = 0; yytext = textbuf;
+    b->pos += len;
+    if (act == A_DIR) { b->state = S_DIR; return tok; }
+    if (act == A_SET) set_lval(tok);
+    return tok;
+  }
+}
+int yywrap(void) { return 1; }
@@ -0,0 +1,160 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison interface for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_YY_BIN_PARSER_BISON_H_INCLUDED
+# define YY_YY_BIN_PARSER_BISON_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+/* "%code requires" blocks.  */
+#line 2 "src/parser/c_parser.y"
+
+
+#include "../../includes/parser.h"
+
+
+#line 55 "./bin/parser/bison.h"
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    INCLUDE = 258,                 /* INCLUDE  */
+    DEFINE = 259,                  /* DEFINE  */
+    TYPE = 260,                    /* TYPE  */
+    FOR = 261,                     /* FOR  */
+    WHILE = 262,                   /* WHILE  */
+    DO = 263,                      /* DO  */
+    IF = 264,                      /* IF  */
+    ELSE = 265,                    /* ELSE  */
+    BREAK = 266,                   /* BREAK  */
+    CONTINUE = 267,                /* CONTINUE  */
+    RETURN = 268,                  /* RETURN  */
+    VARIABLE = 269,                /* VARIABLE  */
+    NODE_LIST = 270,               /* NODE_LIST  */
+    IDENT = 271,                   /* IDENT  */
+    INTCONST = 272,                /* INTCONST  */
+    STRCONST = 273,                /* STRCONST  */
+    CHARCONST = 274,               /* CHARCONST  */
+    INCLUDE_FILE = 275,            /* INCLUDE_FILE  */
+    FUNCTION_CALL = 276,           /* FUNCTION_CALL  */
+    STATEMENT_BLOCK = 277,         /* STATEMENT_BLOCK  */
+    EQUAL = 278,                   /* EQUAL  */
+    NEQUAL = 279,                  /* NEQUAL  */
+    GE = 280,                      /* GE  */
+    LE = 281,                      /* LE  */
+    FUNCTION = 282,                /* FUNCTION  */
+    EXPRESSION_LIST = 283,         /* EXPRESSION_LIST  */
+    BINARY_OP = 284,               /* BINARY_OP  */
+    UNARY_OP = 285,                /* UNARY_OP  */
+    FUNCTION_DEF = 286,            /* FUNCTION_DEF  */
+    DAMP = 287,                    /* DAMP  */
+    DPIPE = 288,                   /* DPIPE  */
+    PLUSASSIGN = 289,              /* PLUSASSIGN  */
+    MINUSASSIGN = 290,             /* MINUSASSIGN  */
+    CAST = 291,                    /* CAST  */
+    PROGRAM = 292,                 /* PROGRAM  */
+    END_NODE_LIST = 293,           /* END_NODE_LIST  */
+    FUNCTION_PROTO = 294,          /* FUNCTION_PROTO  */
+    STARASSIGN = 295,              /* STARASSIGN  */
+    SLASHASSIGN = 296,             /* SLASHASSIGN  */
+    INCR = 297,                    /* INCR  */
+    DECR = 298,                    /* DECR  */
+    UNKNOWN = 299,                 /* UNKNOWN  */
+    REALCONST = 300,               /* REALCONST  */
+    IFNDEF = 301,                  /* IFNDEF  */
+    IFDEF = 302,                   /* IFDEF  */
+    TYPE_NAME = 303,               /* TYPE_NAME  */
+    VARIABLE_LIST = 304,           /* VARIABLE_LIST  */
+    ENDIF = 305,                   /* ENDIF  */
+    ELIF = 306,                    /* ELIF  */
+    ELSE_DIREC = 307,              /* ELSE_DIREC  */
+    HEXCONST = 308,                /* HEXCONST  */
+    UNDEF = 309,                   /* UNDEF  */
+    SCOPE = 310,                   /* SCOPE  */
+    LVALUE = 311,                  /* LVALUE  */
+    EMPTY = 312,                   /* EMPTY  */
+    PARAM_LIST = 313,              /* PARAM_LIST  */
+    STATEMENT = 314,               /* STATEMENT  */
+    ZEQUAL = 315,                  /* ZEQUAL  */
+    ZNEQUAL = 316,                 /* ZNEQUAL  */
+    NOELSE = 317,                  /* NOELSE  */
+    COMMA_FAKE = 318,              /* COMMA_FAKE  */
+    TURNARY = 319,                 /* TURNARY  */
+    EQUALITY = 320,                /* EQUALITY  */
+    INEQUALITY = 321,              /* INEQUALITY  */
+    UNARY = 322,                   /* UNARY  */
+    PAREN = 323,                   /* PAREN  */
+    BRACK = 324                    /* BRACK  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+union YYSTYPE
+{
+#line 21 "src/parser/c_parser.y"
+
+    ast_value_t v;
+    ast_node_t *a;
+
+#line 146 "./bin/parser/bison.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_BIN_PARSER_BISON_H_INCLUDED  */
@@ -0,0 +1,2561 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 8 "src/parser/c_parser.y"
+
+
+#include "../../includes/lexer.h"
+#include "../../includes/parser.h"
+#include "../../includes/types.h"
+
+ast_value_t yyempty_value;
+extern char* parse_file_string;
+
+#line 81 "bin/parser/c_parser.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "bison.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_INCLUDE = 3,                    /* INCLUDE  */
+  YYSYMBOL_DEFINE = 4,                     /* DEFINE  */
+  YYSYMBOL_TYPE = 5,                       /* TYPE  */
+  YYSYMBOL_FOR = 6,                        /* FOR  */
+  YYSYMBOL_WHILE = 7,                      /* WHILE  */
+  YYSYMBOL_DO = 8,                         /* DO  */
+  YYSYMBOL_IF = 9,                         /* IF  */
+  YYSYMBOL_ELSE = 10,                      /* ELSE  */
+  YYSYMBOL_BREAK = 11,                     /* BREAK  */
+  YYSYMBOL_CONTINUE = 12,                  /* CONTINUE  */
+  YYSYMBOL_RETURN = 13,                    /* RETURN  */
+  YYSYMBOL_VARIABLE = 14,                  /* VARIABLE  */
+  YYSYMBOL_NODE_LIST = 15,                 /* NODE_LIST  */
+  YYSYMBOL_IDENT = 16,                     /* IDENT  */
+  YYSYMBOL_INTCONST = 17,                  /* INTCONST  */
+  YYSYMBOL_STRCONST = 18,                  /* STRCONST  */
+  YYSYMBOL_CHARCONST = 19,                 /* CHARCONST  */
+  YYSYMBOL_INCLUDE_FILE = 20,              /* INCLUDE_FILE  */
+  YYSYMBOL_FUNCTION_CALL = 21,             /* FUNCTION_CALL  */
+  YYSYMBOL_STATEMENT_BLOCK = 22,           /* STATEMENT_BLOCK  */
+  YYSYMBOL_EQUAL = 23,                     /* EQUAL  */
+  YYSYMBOL_NEQUAL = 24,                    /* NEQUAL  */
+  YYSYMBOL_GE = 25,                        /* GE  */
+  YYSYMBOL_LE = 26,                        /* LE  */
+  YYSYMBOL_FUNCTION = 27,                  /* FUNCTION  */
+  YYSYMBOL_EXPRESSION_LIST = 28,           /* EXPRESSION_LIST  */
+  YYSYMBOL_BINARY_OP = 29,                 /* BINARY_OP  */
+  YYSYMBOL_UNARY_OP = 30,                  /* UNARY_OP  */
+  YYSYMBOL_FUNCTION_DEF = 31,              /* FUNCTION_DEF  */
+  YYSYMBOL_DAMP = 32,                      /* DAMP  */
+  YYSYMBOL_DPIPE = 33,                     /* DPIPE  */
+  YYSYMBOL_PLUSASSIGN = 34,                /* PLUSASSIGN  */
+  YYSYMBOL_MINUSASSIGN = 35,               /* MINUSASSIGN  */
+  YYSYMBOL_CAST = 36,                      /* CAST  */
+  YYSYMBOL_PROGRAM = 37,                   /* PROGRAM  */
+  YYSYMBOL_END_NODE_LIST = 38,             /* END_NODE_LIST  */
+  YYSYMBOL_FUNCTION_PROTO = 39,            /* FUNCTION_PROTO  */
+  YYSYMBOL_STARASSIGN = 40,                /* STARASSIGN  */
+  YYSYMBOL_SLASHASSIGN = 41,               /* SLASHASSIGN  */
+  YYSYMBOL_INCR = 42,                      /* INCR  */
+  YYSYMBOL_DECR = 43,                      /* DECR  */
+  YYSYMBOL_UNKNOWN = 44,                   /* UNKNOWN  */
+  YYSYMBOL_REALCONST = 45,                 /* REALCONST  */
+  YYSYMBOL_IFNDEF = 46,                    /* IFNDEF  */
+  YYSYMBOL_IFDEF = 47,                     /* IFDEF  */
+  YYSYMBOL_TYPE_NAME = 48,                 /* TYPE_NAME  */
+  YYSYMBOL_VARIABLE_LIST = 49,             /* VARIABLE_LIST  */
+  YYSYMBOL_ENDIF = 50,                     /* ENDIF  */
+  YYSYMBOL_ELIF = 51,                      /* ELIF  */
+  YYSYMBOL_ELSE_DIREC = 52,                /* ELSE_DIREC  */
+  YYSYMBOL_HEXCONST = 53,                  /* HEXCONST  */
+  YYSYMBOL_UNDEF = 54,                     /* UNDEF  */
+  YYSYMBOL_SCOPE = 55,                     /* SCOPE  */
+  YYSYMBOL_LVALUE = 56,                    /* LVALUE  */
+  YYSYMBOL_EMPTY = 57,                     /* EMPTY  */
+  YYSYMBOL_PARAM_LIST = 58,                /* PARAM_LIST  */
+  YYSYMBOL_STATEMENT = 59,                 /* STATEMENT  */
+  YYSYMBOL_ZEQUAL = 60,                    /* ZEQUAL  */
+  YYSYMBOL_ZNEQUAL = 61,                   /* ZNEQUAL  */
+  YYSYMBOL_NOELSE = 62,                    /* NOELSE  */
+  YYSYMBOL_COMMA_FAKE = 63,                /* COMMA_FAKE  */
+  YYSYMBOL_64_ = 64,                       /* '='  */
+  YYSYMBOL_TURNARY = 65,                   /* TURNARY  */
+  YYSYMBOL_66_ = 66,                       /* '?'  */
+  YYSYMBOL_67_ = 67,                       /* ':'  */
+  YYSYMBOL_68_ = 68,                       /* '|'  */
+  YYSYMBOL_69_ = 69,                       /* '&'  */
+  YYSYMBOL_EQUALITY = 70,                  /* EQUALITY  */
+  YYSYMBOL_INEQUALITY = 71,                /* INEQUALITY  */
+  YYSYMBOL_72_ = 72,                       /* '<'  */
+  YYSYMBOL_73_ = 73,                       /* '>'  */
+  YYSYMBOL_74_ = 74,                       /* '+'  */
+  YYSYMBOL_75_ = 75,                       /* '-'  */
+  YYSYMBOL_76_ = 76,                       /* '*'  */
+  YYSYMBOL_77_ = 77,                       /* '/'  */
+  YYSYMBOL_78_ = 78,                       /* '%'  */
+  YYSYMBOL_UNARY = 79,                     /* UNARY  */
+  YYSYMBOL_80_ = 80,                       /* '!'  */
+  YYSYMBOL_81_ = 81,                       /* '~'  */
+  YYSYMBOL_PAREN = 82,                     /* PAREN  */
+  YYSYMBOL_BRACK = 83,                     /* BRACK  */
+  YYSYMBOL_84_ = 84,                       /* ';'  */
+  YYSYMBOL_85_ = 85,                       /* '('  */
+  YYSYMBOL_86_ = 86,                       /* ')'  */
+  YYSYMBOL_87_ = 87,                       /* '{'  */
+  YYSYMBOL_88_ = 88,                       /* '}'  */
+  YYSYMBOL_89_ = 89,                       /* ','  */
+  YYSYMBOL_90_ = 90,                       /* '['  */
+  YYSYMBOL_91_ = 91,                       /* ']'  */
+  YYSYMBOL_YYACCEPT = 92,                  /* $accept  */
+  YYSYMBOL_program = 93,                   /* program  */
+  YYSYMBOL_program_statement = 94,         /* program_statement  */
+  YYSYMBOL_variables = 95,                 /* variables  */
+  YYSYMBOL_variable_list = 96,             /* variable_list  */
+  YYSYMBOL_variable = 97,                  /* variable  */
+  YYSYMBOL_function_proto = 98,            /* function_proto  */
+  YYSYMBOL_function_def = 99,              /* function_def  */
+  YYSYMBOL_function_sig = 100,             /* function_sig  */
+  YYSYMBOL_params = 101,                   /* params  */
+  YYSYMBOL_param_list = 102,               /* param_list  */
+  YYSYMBOL_type_name = 103,                /* type_name  */
+  YYSYMBOL_func_type_name = 104,           /* func_type_name  */
+  YYSYMBOL_statement_block = 105,          /* statement_block  */
+  YYSYMBOL_statements = 106,               /* statements  */
+  YYSYMBOL_statement_list = 107,           /* statement_list  */
+  YYSYMBOL_statement = 108,                /* statement  */
+  YYSYMBOL_expressions = 109,              /* expressions  */
+  YYSYMBOL_optional_expression = 110,      /* optional_expression  */
+  YYSYMBOL_expression = 111,               /* expression  */
+  YYSYMBOL_l_value = 112,                  /* l_value  */
+  YYSYMBOL_unary = 113,                    /* unary  */
+  YYSYMBOL_assignment = 114,               /* assignment  */
+  YYSYMBOL_constant = 115,                 /* constant  */
+  YYSYMBOL_identifiers = 116,              /* identifiers  */
+  YYSYMBOL_identifier = 117,               /* identifier  */
+  YYSYMBOL_do = 118,                       /* do  */
+  YYSYMBOL_while = 119,                    /* while  */
+  YYSYMBOL_if = 120,                       /* if  */
+  YYSYMBOL_else = 121,                     /* else  */
+  YYSYMBOL_for = 122                       /* for  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if 1
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* 1 */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  15
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   583
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  92
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  31
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  97
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  180
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   324
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    80,     2,     2,     2,    78,    69,     2,
+      85,    86,    76,    74,    89,    75,     2,    77,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,    67,    84,
+      72,    64,    73,    66,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,    90,     2,    91,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    87,    68,    88,    81,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
+      45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    59,    60,    61,    62,    63,    65,
+      70,    71,    79,    82,    83
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,    58,    58,    60,    64,    66,    68,    73,    74,    77,
+      79,    84,    86,    90,    94,   102,   107,   108,   111,   113,
+     119,   123,   129,   131,   135,   140,   141,   145,   147,   153,
+     155,   157,   159,   161,   163,   165,   167,   171,   173,   175,
+     179,   181,   188,   189,   193,   195,   197,   201,   205,   209,
+     211,   213,   215,   220,   225,   230,   235,   240,   245,   250,
+     255,   260,   265,   270,   275,   280,   285,   290,   295,   297,
+     301,   303,   307,   309,   311,   315,   317,   319,   321,   323,
+     327,   329,   331,   333,   337,   339,   345,   347,   351,   355,
+     361,   365,   371,   375,   381,   383,   387,   393
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "INCLUDE", "DEFINE",
+  "TYPE", "FOR", "WHILE", "DO", "IF", "ELSE", "BREAK", "CONTINUE",
+  "RETURN", "VARIABLE", "NODE_LIST", "IDENT", "INTCONST", "STRCONST",
+  "CHARCONST", "INCLUDE_FILE", "FUNCTION_CALL", "STATEMENT_BLOCK", "EQUAL",
+  "NEQUAL", "GE", "LE", "FUNCTION", "EXPRESSION_LIST", "BINARY_OP",
+  "UNARY_OP", "FUNCTION_DEF", "DAMP", "DPIPE", "PLUSASSIGN", "MINUSASSIGN",
+  "CAST", "PROGRAM", "END_NODE_LIST", "FUNCTION_PROTO", "STARASSIGN",
+  "SLASHASSIGN", "INCR", "DECR", "UNKNOWN", "REALCONST", "IFNDEF", "IFDEF",
+  "TYPE_NAME", "VARIABLE_LIST", "ENDIF", "ELIF", "ELSE_DIREC", "HEXCONST",
+  "UNDEF", "SCOPE", "LVALUE", "EMPTY", "PARAM_LIST", "STATEMENT", "ZEQUAL",
+  "ZNEQUAL", "NOELSE", "COMMA_FAKE", "'='", "TURNARY", "'?'", "':'", "'|'",
+  "'&'", "EQUALITY", "INEQUALITY", "'<'", "'>'", "'+'", "'-'", "'*'",
+  "'/'", "'%'", "UNARY", "'!'", "'~'", "PAREN", "BRACK", "';'", "'('",
+  "')'", "'{'", "'}'", "','", "'['", "']'", "$accept", "program",
+  "program_statement", "variables", "variable_list", "variable",
+  "function_proto", "function_def", "function_sig", "params", "param_list",
+  "type_name", "func_type_name", "statement_block", "statements",
+  "statement_list", "statement", "expressions", "optional_expression",
+  "expression", "l_value", "unary", "assignment", "constant",
+  "identifiers", "identifier", "do", "while", "if", "else", "for", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-149)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-23)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int16 yypact[] =
+{
+      13,   -12,    21,    12,  -149,  -149,  -149,  -149,   -60,   -57,
+     -80,    17,   -75,  -149,    18,  -149,  -149,    16,    27,    26,
+    -149,  -149,    18,   -46,   -69,    18,   117,    16,  -149,    47,
+     -17,   -10,  -149,   -19,  -149,  -149,    -1,     9,    74,    11,
+      14,    15,   148,   -61,  -149,  -149,  -149,  -149,  -149,  -149,
+    -149,  -149,    20,    19,   117,  -149,   356,   184,   155,  -149,
+    -149,  -149,    87,  -149,  -149,    22,    24,    27,  -149,   155,
+     155,   117,    95,    96,   155,  -149,  -149,  -149,   386,   124,
+     155,    23,   218,  -149,  -149,   155,   155,   155,   155,   155,
+     155,   155,   155,   155,   155,   155,   155,   155,   155,   155,
+     155,  -149,  -149,  -149,  -149,  -149,  -149,  -149,  -149,   155,
+    -149,    74,  -149,    89,  -149,  -149,    32,   442,   244,    34,
+      25,    35,   274,  -149,  -149,   -44,   442,   188,   155,  -149,
+     112,   112,     0,     0,   480,   424,   412,   498,   505,     0,
+       0,   -70,   -70,  -149,  -149,  -149,   442,  -149,  -149,    36,
+     155,    74,  -149,   155,   155,    74,  -149,   155,  -149,  -149,
+     155,  -149,    60,  -149,  -149,   300,   330,  -149,  -149,   442,
+     442,   155,    61,    62,    45,  -149,  -149,    74,  -149,  -149
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       0,     0,     0,     0,     2,     4,     5,     6,     0,     0,
+      86,     0,     0,    84,     0,     1,     3,     7,    16,     0,
+      23,    12,     0,    86,     0,     0,    25,     8,     9,     0,
+       0,    17,    18,     0,    85,    11,     0,     0,     0,     0,
+       0,     0,     0,    71,    80,    81,    82,    83,    72,    73,
+      74,    29,     0,     0,    26,    27,     0,    45,     0,    44,
+      39,    38,    35,    37,    10,    20,    15,     0,    87,    42,
+       0,    25,     0,     0,     0,    30,    31,    32,     0,     0,
+       0,     0,     0,    14,    28,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    34,    76,    77,    78,    79,    49,    50,    75,     0,
+      51,     0,    36,     0,    13,    19,     0,    43,     0,     0,
+       0,     0,     0,    33,    47,     0,    40,     0,     0,    69,
+      52,    53,    55,    57,    66,    65,     0,    63,    64,    56,
+      54,    58,    59,    60,    61,    62,    48,    95,    94,     0,
+      42,     0,    24,     0,     0,     0,    46,     0,    70,    68,
+       0,    21,     0,    91,    90,     0,     0,    93,    92,    41,
+      67,    42,     0,     0,     0,    89,    88,     0,    97,    96
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int16 yypgoto[] =
+{
+    -149,  -149,   101,  -149,  -149,   -16,  -149,  -149,  -149,  -149,
+    -149,    80,  -149,   -89,    77,  -149,   -38,  -149,  -148,   -39,
+    -149,  -149,  -149,  -149,   136,   129,  -149,  -149,  -149,  -149,
+    -149
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     3,     4,    26,    27,     5,     6,     7,     8,    30,
+      31,    32,     9,    72,    53,    54,    55,   125,   116,    56,
+      57,    58,   109,    59,    12,    13,    60,    61,    62,   112,
+      63
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int16 yytable[] =
+{
+      73,    28,   162,    78,    10,   -22,    98,    99,   100,    21,
+      19,    64,    15,    82,    22,    35,    84,     1,     1,   110,
+      22,    25,   147,   174,    79,    81,    14,    17,    18,    80,
+     117,   118,    29,    20,    23,   122,    43,    44,    45,    46,
+     126,   127,   156,    33,    19,   157,   130,   131,   132,   133,
+     134,   135,   136,   137,   138,   139,   140,   141,   142,   143,
+     144,   145,   163,    65,    11,    47,   167,     2,     2,    66,
+     146,     2,    68,   148,    96,    97,    98,    99,   100,    67,
+      36,    37,    38,    39,    69,    40,    41,    42,   178,   159,
+      43,    44,    45,    46,    70,    48,    74,   111,    75,    76,
+      49,    50,   120,   121,    16,    52,   149,    83,   114,   128,
+     153,   117,   113,   164,   165,   166,   150,   168,   169,    47,
+     154,   170,   152,    36,    37,    38,    39,   161,    40,    41,
+      42,   177,   117,    43,    44,    45,    46,    87,    88,   179,
+      43,    44,    45,    46,   171,   175,   176,   115,   119,    48,
+      24,    34,     0,     0,    49,    50,     0,     0,    51,    52,
+       0,    71,    47,     0,    43,    44,    45,    46,     0,    47,
+       0,    43,    44,    45,    46,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    94,    95,    96,    97,    98,    99,
+     100,     0,    48,    47,     0,     0,     0,    49,    50,    48,
+      47,    51,    52,     0,    49,    50,     0,     0,     0,    52,
+     124,    85,    86,    87,    88,     0,     0,     0,   102,   103,
+      89,    90,     0,    48,   104,   105,   106,   107,    49,    50,
+      48,     0,    77,    52,     0,    49,    50,     0,     0,     0,
+      52,    85,    86,    87,    88,     0,     0,     0,   108,     0,
+      89,    90,     0,     0,    91,     0,    92,    93,     0,     0,
+      94,    95,    96,    97,    98,    99,   100,    85,    86,    87,
+      88,     0,     0,     0,     0,     0,    89,    90,     0,   158,
+       0,     0,     0,     0,    91,     0,    92,    93,     0,     0,
+      94,    95,    96,    97,    98,    99,   100,    85,    86,    87,
+      88,     0,     0,     0,   129,     0,    89,    90,     0,     0,
+      91,     0,    92,    93,     0,     0,    94,    95,    96,    97,
+      98,    99,   100,    85,    86,    87,    88,     0,     0,     0,
+     151,     0,    89,    90,     0,     0,     0,     0,     0,     0,
+      91,     0,    92,    93,     0,     0,    94,    95,    96,    97,
+      98,    99,   100,    85,    86,    87,    88,     0,     0,     0,
+     155,     0,    89,    90,     0,     0,    91,     0,    92,    93,
+       0,     0,    94,    95,    96,    97,    98,    99,   100,    85,
+      86,    87,    88,     0,     0,     0,   172,     0,    89,    90,
+       0,     0,     0,     0,     0,     0,    91,     0,    92,    93,
+       0,     0,    94,    95,    96,    97,    98,    99,   100,    85,
+      86,    87,    88,     0,     0,     0,   173,     0,    89,    90,
+       0,     0,    91,     0,    92,    93,     0,     0,    94,    95,
+      96,    97,    98,    99,   100,    85,    86,    87,    88,     0,
+     101,     0,     0,     0,    89,    90,     0,    85,    86,    87,
+      88,     0,    91,     0,    92,    93,    89,     0,    94,    95,
+      96,    97,    98,    99,   100,    85,    86,    87,    88,     0,
+     123,     0,     0,     0,    89,    90,     0,     0,    91,   160,
+      92,    93,     0,     0,    94,    95,    96,    97,    98,    99,
+     100,     0,    92,    93,     0,     0,    94,    95,    96,    97,
+      98,    99,   100,    85,    86,    87,    88,     0,    91,     0,
+      92,    93,     0,     0,    94,    95,    96,    97,    98,    99,
+     100,    85,    86,    87,    88,     0,     0,     0,    85,    86,
+      87,    88,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    92,    93,
+       0,     0,    94,    95,    96,    97,    98,    99,   100,     0,
+       0,     0,     0,     0,     0,     0,     0,    93,     0,     0,
+      94,    95,    96,    97,    98,    99,   100,    94,    95,    96,
+      97,    98,    99,   100
+};
+
+static const yytype_int16 yycheck[] =
+{
+      38,    17,   150,    42,    16,    85,    76,    77,    78,    84,
+      90,    27,     0,    52,    89,    84,    54,     5,     5,    58,
+      89,     5,   111,   171,    85,     5,     5,    87,    85,    90,
+      69,    70,     5,    16,    16,    74,    16,    17,    18,    19,
+      79,    80,    86,    17,    90,    89,    85,    86,    87,    88,
+      89,    90,    91,    92,    93,    94,    95,    96,    97,    98,
+      99,   100,   151,    16,    76,    45,   155,    55,    55,    86,
+     109,    55,    91,   111,    74,    75,    76,    77,    78,    89,
+       6,     7,     8,     9,    85,    11,    12,    13,   177,   128,
+      16,    17,    18,    19,    85,    75,    85,    10,    84,    84,
+      80,    81,     7,     7,     3,    85,    17,    88,    84,    86,
+      85,   150,    90,   151,   153,   154,    84,   155,   157,    45,
+      85,   160,    88,     6,     7,     8,     9,    91,    11,    12,
+      13,    86,   171,    16,    17,    18,    19,    25,    26,   177,
+      16,    17,    18,    19,    84,    84,    84,    67,    71,    75,
+      14,    22,    -1,    -1,    80,    81,    -1,    -1,    84,    85,
+      -1,    87,    45,    -1,    16,    17,    18,    19,    -1,    45,
+      -1,    16,    17,    18,    19,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    72,    73,    74,    75,    76,    77,
+      78,    -1,    75,    45,    -1,    -1,    -1,    80,    81,    75,
+      45,    84,    85,    -1,    80,    81,    -1,    -1,    -1,    85,
+      86,    23,    24,    25,    26,    -1,    -1,    -1,    34,    35,
+      32,    33,    -1,    75,    40,    41,    42,    43,    80,    81,
+      75,    -1,    84,    85,    -1,    80,    81,    -1,    -1,    -1,
+      85,    23,    24,    25,    26,    -1,    -1,    -1,    64,    -1,
+      32,    33,    -1,    -1,    66,    -1,    68,    69,    -1,    -1,
+      72,    73,    74,    75,    76,    77,    78,    23,    24,    25,
+      26,    -1,    -1,    -1,    -1,    -1,    32,    33,    -1,    91,
+      -1,    -1,    -1,    -1,    66,    -1,    68,    69,    -1,    -1,
+      72,    73,    74,    75,    76,    77,    78,    23,    24,    25,
+      26,    -1,    -1,    -1,    86,    -1,    32,    33,    -1,    -1,
+      66,    -1,    68,    69,    -1,    -1,    72,    73,    74,    75,
+      76,    77,    78,    23,    24,    25,    26,    -1,    -1,    -1,
+      86,    -1,    32,    33,    -1,    -1,    -1,    -1,    -1,    -1,
+      66,    -1,    68,    69,    -1,    -1,    72,    73,    74,    75,
+      76,    77,    78,    23,    24,    25,    26,    -1,    -1,    -1,
+      86,    -1,    32,    33,    -1,    -1,    66,    -1,    68,    69,
+      -1,    -1,    72,    73,    74,    75,    76,    77,    78,    23,
+      24,    25,    26,    -1,    -1,    -1,    86,    -1,    32,    33,
+      -1,    -1,    -1,    -1,    -1,    -1,    66,    -1,    68,    69,
+      -1,    -1,    72,    73,    74,    75,    76,    77,    78,    23,
+      24,    25,    26,    -1,    -1,    -1,    86,    -1,    32,    33,
+      -1,    -1,    66,    -1,    68,    69,    -1,    -1,    72,    73,
+      74,    75,    76,    77,    78,    23,    24,    25,    26,    -1,
+      84,    -1,    -1,    -1,    32,    33,    -1,    23,    24,    25,
+      26,    -1,    66,    -1,    68,    69,    32,    -1,    72,    73,
+      74,    75,    76,    77,    78,    23,    24,    25,    26,    -1,
+      84,    -1,    -1,    -1,    32,    33,    -1,    -1,    66,    67,
+      68,    69,    -1,    -1,    72,    73,    74,    75,    76,    77,
+      78,    -1,    68,    69,    -1,    -1,    72,    73,    74,    75,
+      76,    77,    78,    23,    24,    25,    26,    -1,    66,    -1,
+      68,    69,    -1,    -1,    72,    73,    74,    75,    76,    77,
+      78,    23,    24,    25,    26,    -1,    -1,    -1,    23,    24,
+      25,    26,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    68,    69,
+      -1,    -1,    72,    73,    74,    75,    76,    77,    78,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    -1,    69,    -1,    -1,
+      72,    73,    74,    75,    76,    77,    78,    72,    73,    74,
+      75,    76,    77,    78
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,     5,    55,    93,    94,    97,    98,    99,   100,   104,
+      16,    76,   116,   117,     5,     0,    94,    87,    85,    90,
+      16,    84,    89,    16,   116,     5,    95,    96,    97,     5,
+     101,   102,   103,    17,   117,    84,     6,     7,     8,     9,
+      11,    12,    13,    16,    17,    18,    19,    45,    75,    80,
+      81,    84,    85,   106,   107,   108,   111,   112,   113,   115,
+     118,   119,   120,   122,    97,    16,    86,    89,    91,    85,
+      85,    87,   105,   108,    85,    84,    84,    84,   111,    85,
+      90,     5,   111,    88,   108,    23,    24,    25,    26,    32,
+      33,    66,    68,    69,    72,    73,    74,    75,    76,    77,
+      78,    84,    34,    35,    40,    41,    42,    43,    64,   114,
+     111,    10,   121,    90,    84,   103,   110,   111,   111,   106,
+       7,     7,   111,    84,    86,   109,   111,   111,    86,    86,
+     111,   111,   111,   111,   111,   111,   111,   111,   111,   111,
+     111,   111,   111,   111,   111,   111,   111,   105,   108,    17,
+      84,    86,    88,    85,    85,    86,    86,    89,    91,   111,
+      67,    91,   110,   105,   108,   111,   111,   105,   108,   111,
+     111,    84,    86,    86,   110,    84,    84,    86,   105,   108
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    92,    93,    93,    94,    94,    94,    95,    95,    96,
+      96,    97,    97,    98,    99,   100,   101,   101,   102,   102,
+     103,   103,   104,   104,   105,   106,   106,   107,   107,   108,
+     108,   108,   108,   108,   108,   108,   108,   108,   108,   108,
+     109,   109,   110,   110,   111,   111,   111,   111,   111,   111,
+     111,   111,   111,   111,   111,   111,   111,   111,   111,   111,
+     111,   111,   111,   111,   111,   111,   111,   111,   111,   111,
+     112,   112,   113,   113,   113,   114,   114,   114,   114,   114,
+     115,   115,   115,   115,   116,   116,   117,   117,   118,   118,
+     119,   119,   120,   120,   121,   121,   122,   122
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     2,     1,     1,     1,     0,     1,     1,
+       2,     4,     3,     5,     5,     4,     0,     1,     1,     3,
+       2,     5,     2,     3,     3,     0,     1,     1,     2,     1,
+       2,     2,     2,     3,     2,     1,     2,     1,     1,     1,
+       1,     3,     0,     1,     1,     1,     4,     3,     3,     2,
+       2,     2,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     5,     4,     3,
+       4,     1,     1,     1,     1,     1,     1,     1,     1,     1,
+       1,     1,     1,     1,     1,     3,     1,     4,     7,     7,
+       5,     5,     5,     5,     2,     2,     9,     9
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
+
+
+
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
+/* Return the length of YYSTR.  */
+static YYPTRDIFF_T
+yystrlen (const char *yystr)
+{
+  YYPTRDIFF_T yylen;
+  for (yylen = 0; yystr[yylen]; yylen++)
+    continue;
+  return yylen;
+}
+# endif
+#endif
+
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
+/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
+   YYDEST.  */
+static char *
+yystpcpy (char *yydest, const char *yysrc)
+{
+  char *yyd = yydest;
+  const char *yys = yysrc;
+
+  while ((*yyd++ = *yys++) != '\0')
+    continue;
+
+  return yyd - 1;
+}
+# endif
+#endif
+
+#ifndef yytnamerr
+/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
+   quotes and backslashes, so that it's suitable for yyerror.  The
+   heuristic is that double-quoting is unnecessary unless the string
+   contains an apostrophe, a comma, or backslash (other than
+   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
+   null, do not copy; instead, return the length of what the result
+   would have been.  */
+static YYPTRDIFF_T
+yytnamerr (char *yyres, const char *yystr)
+{
+  if (*yystr == '"')
+    {
+      YYPTRDIFF_T yyn = 0;
+      char const *yyp = yystr;
+      for (;;)
+        switch (*++yyp)
+          {
+          case '\'':
+          case ',':
+            goto do_not_strip_quotes;
+
+          case '\\':
+            if (*++yyp != '\\')
+              goto do_not_strip_quotes;
+            else
+              goto append;
+
+          append:
+          default:
+            if (yyres)
+              yyres[yyn] = *yyp;
+            yyn++;
+            break;
+
+          case '"':
+            if (yyres)
+              yyres[yyn] = '\0';
+            return yyn;
+          }
+    do_not_strip_quotes: ;
+    }
+
+  if (yyres)
+    return yystpcpy (yyres, yystr) - yyres;
+  else
+    return yystrlen (yystr);
+}
+#endif
+
+
+static int
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  /* There are many possibilities here to consider:
+     - If this state is a consistent state with a default action, then
+       the only way this function was invoked is if the default action
+       is an error action.  In that case, don't check for expected
+       tokens because there are none.
+     - The only way there can be no lookahead present (in yychar) is if
+       this state is a consistent state with a default action.  Thus,
+       detecting the absence of a lookahead is sufficient to determine
+       that there is no unexpected or expected token to report.  In that
+       case, just report a simple "syntax error".
+     - Don't assume there isn't a lookahead just because this state is a
+       consistent state with a default action.  There might have been a
+       previous inconsistent state, consistent state with a non-default
+       action, or user semantic action that manipulated yychar.
+     - Of course, the expected token list depends on states to have
+       correct lookahead information, and it depends on the parser not
+       to perform extra reductions after fetching a lookahead from the
+       scanner and before detecting a syntax error.  Thus, state merging
+       (from LALR or IELR) and default reductions corrupt the expected
+       token list.  However, the list is correct for canonical LR with
+       one exception: it will still contain any token that will not be
+       accepted due to an error action in a later state.
+  */
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
+    {
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
+    }
+  return yycount;
+}
+
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
+
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
+
+  switch (yycount)
+    {
+#define YYCASE_(N, S)                       \
+      case N:                               \
+        yyformat = S;                       \
+        break
+    default: /* Avoid compiler warnings. */
+      YYCASE_(0, YY_("syntax error"));
+      YYCASE_(1, YY_("syntax error, unexpected %s"));
+      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
+      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
+      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
+      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
+#undef YYCASE_
+    }
+
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
+  {
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
+  }
+
+  if (*yymsg_alloc < yysize)
+    {
+      *yymsg_alloc = 2 * yysize;
+      if (! (yysize <= *yymsg_alloc
+             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
+        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
+      return -1;
+    }
+
+  /* Avoid sprintf, as that infringes on the user's name space.
+     Don't have undefined behavior even if the translation
+     produced a string with the wrong number of "%s"s.  */
+  {
+    char *yyp = *yymsg;
+    int yyi = 0;
+    while ((*yyp = *yyformat) != '\0')
+      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
+        {
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
+          yyformat += 2;
+        }
+      else
+        {
+          ++yyp;
+          ++yyformat;
+        }
+  }
+  return 0;
+}
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+  /* Buffer for error messages, and its allocated size.  */
+  char yymsgbuf[128];
+  char *yymsg = yymsgbuf;
+  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* program: program_statement  */
+#line 59 "src/parser/c_parser.y"
+        { add_flat_declaration((yyvsp[0].a)); }
+#line 1671 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 3: /* program: program program_statement  */
+#line 61 "src/parser/c_parser.y"
+        { add_flat_declaration((yyvsp[0].a)); }
+#line 1677 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 4: /* program_statement: variable  */
+#line 65 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); process_declaration((yyvsp[0].a), 0); }
+#line 1683 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 5: /* program_statement: function_proto  */
+#line 67 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); }
+#line 1689 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 6: /* program_statement: function_def  */
+#line 69 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); }
+#line 1695 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 7: /* variables: %empty  */
+#line 73 "src/parser/c_parser.y"
+    { (yyval.a) = new_ast_node(VARIABLE_LIST, 0, 0, NULL, yyempty_value, 0); }
+#line 1701 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 8: /* variables: variable_list  */
+#line 75 "src/parser/c_parser.y"
+    { (yyval.a) = (yyvsp[0].a); process_declaration((yyvsp[0].a), 1); }
+#line 1707 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 9: /* variable_list: variable  */
+#line 78 "src/parser/c_parser.y"
+            { (yyval.a) = new_ast_node(VARIABLE_LIST, 0, 1, (yyvsp[0].a), yyempty_value, 0); }
+#line 1713 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 10: /* variable_list: variable_list variable  */
+#line 80 "src/parser/c_parser.y"
+            { (yyval.a) = (yyvsp[-1].a);
+              add_ast_children((yyval.a), (yyvsp[0].a), 1);
+            }
+#line 1721 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 11: /* variable: SCOPE TYPE identifiers ';'  */
+#line 85 "src/parser/c_parser.y"
+        { (yyval.a) = new_variable_node((yyvsp[-3].v).i, (yyvsp[-2].v).i, (yyvsp[-1].a)); }
+#line 1727 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 12: /* variable: TYPE identifiers ';'  */
+#line 87 "src/parser/c_parser.y"
+        { (yyval.a) = new_variable_node(0, (yyvsp[-2].v).i, (yyvsp[-1].a)); }
+#line 1733 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 13: /* function_proto: func_type_name '(' params ')' ';'  */
+#line 91 "src/parser/c_parser.y"
+        { (yyval.a) = make_function_sig((yyvsp[-4].a), (yyvsp[-2].a), FUNCTION_PROTO); }
+#line 1739 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 14: /* function_def: function_sig '{' variables statements '}'  */
+#line 95 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[-4].a);
+          add_ast_children((yyval.a), (yyvsp[-2].a), 1);
+          add_ast_children((yyval.a), (yyvsp[-1].a), 1);
+          (yyval.a)->value.t = close_scope();
+        }
+#line 1749 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 15: /* function_sig: func_type_name '(' params ')'  */
+#line 103 "src/parser/c_parser.y"
+    { (yyval.a) = make_function_sig((yyvsp[-3].a), (yyvsp[-1].a), FUNCTION_DEF); }
+#line 1755 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 16: /* params: %empty  */
+#line 107 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(PARAM_LIST, 0, 0, NULL, yyempty_value, 0); }
+#line 1761 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 17: /* params: param_list  */
+#line 109 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); }
+#line 1767 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 18: /* param_list: type_name  */
+#line 112 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(PARAM_LIST, 0, 1, (yyvsp[0].a), yyempty_value, 0); }
+#line 1773 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 19: /* param_list: param_list ',' type_name  */
+#line 114 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[-2].a);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 1781 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 20: /* type_name: TYPE IDENT  */
+#line 120 "src/parser/c_parser.y"
+    {
+        (yyval.a) = new_ast_node(TYPE_NAME, (yyvsp[-1].v).i, 0, NULL, (yyvsp[0].v), 0);
+    }
+#line 1789 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 21: /* type_name: TYPE IDENT '[' INTCONST ']'  */
+#line 124 "src/parser/c_parser.y"
+    {
+        (yyval.a) = new_ast_node(TYPE_NAME, (yyvsp[-4].v).i | ARRAY, 0, NULL, (yyvsp[-3].v), (yyvsp[-1].v).i);
+    }
+#line 1797 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 22: /* func_type_name: TYPE IDENT  */
+#line 130 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(TYPE_NAME, (yyvsp[-1].v).i, 0, NULL, (yyvsp[0].v), 0); }
+#line 1803 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 23: /* func_type_name: TYPE '*' IDENT  */
+#line 132 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(TYPE_NAME, (yyvsp[-2].v).i | ARRAY, 0, NULL, (yyvsp[0].v), 0); }
+#line 1809 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 24: /* statement_block: '{' statements '}'  */
+#line 136 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[-1].a); }
+#line 1815 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 25: /* statements: %empty  */
+#line 140 "src/parser/c_parser.y"
+    { (yyval.a) = new_ast_node(STATEMENT_BLOCK, 0, 0, NULL, yyempty_value, 0); }
+#line 1821 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 26: /* statements: statement_list  */
+#line 142 "src/parser/c_parser.y"
+    { (yyval.a) = (yyvsp[0].a); }
+#line 1827 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 27: /* statement_list: statement  */
+#line 146 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(STATEMENT_BLOCK, 0, 1, (yyvsp[0].a), yyempty_value, 0); }
+#line 1833 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 28: /* statement_list: statement_list statement  */
+#line 148 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[-1].a);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 1841 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 29: /* statement: ';'  */
+#line 154 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(EMPTY, 0, 0, NULL, yyempty_value, 0); }
+#line 1847 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 30: /* statement: BREAK ';'  */
+#line 156 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(BREAK, 0, 0, NULL, yyempty_value, 0); }
+#line 1853 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 31: /* statement: CONTINUE ';'  */
+#line 158 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(CONTINUE, 0, 0, NULL, yyempty_value, 0); }
+#line 1859 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 32: /* statement: RETURN ';'  */
+#line 160 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(RETURN, VOID, 0, NULL, yyempty_value, 0); check_return_type(VOID);}
+#line 1865 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 33: /* statement: RETURN expression ';'  */
+#line 162 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(RETURN, (yyvsp[-1].a)->type, 1, (yyvsp[-1].a), yyempty_value, 0); check_return_type((yyvsp[-1].a)->type);}
+#line 1871 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 34: /* statement: expression ';'  */
+#line 164 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[-1].a); print_expression_type((yyvsp[-1].a)->type);}
+#line 1877 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 35: /* statement: if  */
+#line 166 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(IF, 0, 1, (yyvsp[0].a), yyempty_value, 0); }
+#line 1883 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 36: /* statement: if else  */
+#line 168 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(IF, 0, 1, (yyvsp[-1].a), yyempty_value, 0); 
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 1891 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 37: /* statement: for  */
+#line 172 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); }
+#line 1897 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 38: /* statement: while  */
+#line 174 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); }
+#line 1903 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 39: /* statement: do  */
+#line 176 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); }
+#line 1909 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 40: /* expressions: expression  */
+#line 180 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(EXPRESSION_LIST, 0, 1, (yyvsp[0].a), yyempty_value, 0); }
+#line 1915 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 41: /* expressions: expressions ',' expression  */
+#line 182 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[-2].a);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 1923 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 42: /* optional_expression: %empty  */
+#line 188 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(EMPTY, 0, 0, NULL, yyempty_value, 0); }
+#line 1929 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 43: /* optional_expression: expression  */
+#line 190 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); }
+#line 1935 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 44: /* expression: constant  */
+#line 194 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); }
+#line 1941 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 45: /* expression: l_value  */
+#line 196 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[0].a); }
+#line 1947 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 46: /* expression: IDENT '(' expressions ')'  */
+#line 198 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(FUNCTION_CALL, find_type((yyvsp[-3].v).s), 1, (yyvsp[-1].a), (yyvsp[-3].v), 0); 
+            check_function_params((yyval.a));  
+        }
+#line 1955 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 47: /* expression: IDENT '(' ')'  */
+#line 202 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(FUNCTION_CALL, find_type((yyvsp[-2].v).s), 0, NULL, (yyvsp[-2].v), 0); 
+            check_function_params((yyval.a)); 
+        }
+#line 1963 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 48: /* expression: l_value assignment expression  */
+#line 206 "src/parser/c_parser.y"
+        {(yyval.a) = new_ast_node((yyvsp[-1].v).i, resolve_bop_type((yyvsp[-1].v).i, (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), yyempty_value, 0);
+         add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 1971 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 49: /* expression: l_value INCR  */
+#line 210 "src/parser/c_parser.y"
+        {(yyval.a) = new_ast_node(INCR, (yyvsp[-1].a)->type, 1, (yyvsp[-1].a), yyempty_value, 0);}
+#line 1977 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 50: /* expression: l_value DECR  */
+#line 212 "src/parser/c_parser.y"
+        {(yyval.a) = new_ast_node(DECR, (yyvsp[-1].a)->type, 1, (yyvsp[-1].a), yyempty_value, 0);}
+#line 1983 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 51: /* expression: unary expression  */
+#line 214 "src/parser/c_parser.y"
+        {(yyval.a) = new_ast_node((yyvsp[-1].v).i, resolve_uop_type((yyvsp[-1].v).i, (yyvsp[0].a)->type), 1, (yyvsp[0].a), yyempty_value, 0);}
+#line 1989 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 52: /* expression: expression EQUAL expression  */
+#line 216 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type(EQUAL, (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)EQUAL, 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 1998 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 53: /* expression: expression NEQUAL expression  */
+#line 221 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type(NEQUAL, (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)NEQUAL, 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2007 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 54: /* expression: expression '>' expression  */
+#line 226 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type('>', (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)'>', 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2016 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 55: /* expression: expression GE expression  */
+#line 231 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type(GE, (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)GE, 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2025 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 56: /* expression: expression '<' expression  */
+#line 236 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type('<', (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)'<', 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2034 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 57: /* expression: expression LE expression  */
+#line 241 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type(LE, (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)LE, 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2043 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 58: /* expression: expression '+' expression  */
+#line 246 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type('+', (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)'+', 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2052 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 59: /* expression: expression '-' expression  */
+#line 251 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type('-', (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)'-', 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2061 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 60: /* expression: expression '*' expression  */
+#line 256 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type('*', (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)'*', 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2070 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 61: /* expression: expression '/' expression  */
+#line 261 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type('/', (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)'/', 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2079 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 62: /* expression: expression '%' expression  */
+#line 266 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type('%', (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)'%', 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2088 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 63: /* expression: expression '|' expression  */
+#line 271 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type('|', (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)'|', 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2097 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 64: /* expression: expression '&' expression  */
+#line 276 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type('&', (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)'&', 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2106 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 65: /* expression: expression DPIPE expression  */
+#line 281 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type(DPIPE, (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)DPIPE, 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2115 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 66: /* expression: expression DAMP expression  */
+#line 286 "src/parser/c_parser.y"
+        {
+            (yyval.a) = new_ast_node(BINARY_OP, resolve_bop_type(DAMP, (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-2].a), (ast_value_t)DAMP, 0);
+            add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2124 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 67: /* expression: expression '?' expression ':' expression  */
+#line 291 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(TURNARY, resolve_turnary_type((yyvsp[-4].a)->type, (yyvsp[-2].a)->type, (yyvsp[0].a)->type), 1, (yyvsp[-4].a), yyempty_value, 0);
+          add_ast_children((yyval.a), (yyvsp[-2].a), 1);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2133 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 68: /* expression: '(' TYPE ')' expression  */
+#line 296 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(CAST, (yyvsp[-2].v).i, 1, (yyvsp[0].a), (yyvsp[-2].v), 0); }
+#line 2139 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 69: /* expression: '(' expression ')'  */
+#line 298 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[-1].a); }
+#line 2145 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 70: /* l_value: IDENT '[' expression ']'  */
+#line 302 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(LVALUE, resolve_bop_type('[', find_type((yyvsp[-3].v).s), (yyvsp[-1].a)->type), 1, (yyvsp[-1].a), (yyvsp[-3].v), 0); }
+#line 2151 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 71: /* l_value: IDENT  */
+#line 304 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(LVALUE, find_type((yyvsp[0].v).s), 0, NULL, (yyvsp[0].v), 0); }
+#line 2157 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 72: /* unary: '-'  */
+#line 308 "src/parser/c_parser.y"
+        { (yyval.v).i =  '-' ; }
+#line 2163 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 73: /* unary: '!'  */
+#line 310 "src/parser/c_parser.y"
+        { (yyval.v).i = '!' ; }
+#line 2169 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 74: /* unary: '~'  */
+#line 312 "src/parser/c_parser.y"
+        { (yyval.v).i = '~'; }
+#line 2175 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 75: /* assignment: '='  */
+#line 316 "src/parser/c_parser.y"
+    { (yyval.v).i = '='; }
+#line 2181 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 76: /* assignment: PLUSASSIGN  */
+#line 318 "src/parser/c_parser.y"
+        { (yyval.v).i = PLUSASSIGN; }
+#line 2187 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 77: /* assignment: MINUSASSIGN  */
+#line 320 "src/parser/c_parser.y"
+        { (yyval.v).i = MINUSASSIGN; }
+#line 2193 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 78: /* assignment: STARASSIGN  */
+#line 322 "src/parser/c_parser.y"
+        { (yyval.v).i = STARASSIGN; }
+#line 2199 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 79: /* assignment: SLASHASSIGN  */
+#line 324 "src/parser/c_parser.y"
+        { (yyval.v).i = SLASHASSIGN; }
+#line 2205 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 80: /* constant: INTCONST  */
+#line 328 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(INTCONST, INT, 0, NULL, (yyvsp[0].v), 0); }
+#line 2211 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 81: /* constant: STRCONST  */
+#line 330 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(STRCONST, CHAR | ARRAY, 0, NULL, (yyvsp[0].v), 0); }
+#line 2217 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 82: /* constant: CHARCONST  */
+#line 332 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(CHARCONST, CHAR, 0, NULL, (yyvsp[0].v), 0); }
+#line 2223 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 83: /* constant: REALCONST  */
+#line 334 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(REALCONST, FLOAT, 0, NULL, (yyvsp[0].v), 0); }
+#line 2229 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 84: /* identifiers: identifier  */
+#line 338 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(VARIABLE, 0, 1, (yyvsp[0].a), yyempty_value, 0); }
+#line 2235 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 85: /* identifiers: identifiers ',' identifier  */
+#line 340 "src/parser/c_parser.y"
+        { (yyval.a) = (yyvsp[-2].a);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2243 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 86: /* identifier: IDENT  */
+#line 346 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(IDENT, 0, 0, NULL, (yyvsp[0].v), 0); }
+#line 2249 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 87: /* identifier: IDENT '[' INTCONST ']'  */
+#line 348 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(IDENT, 0, 0, NULL, (yyvsp[-3].v), (yyvsp[-1].v).i); }
+#line 2255 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 88: /* do: DO statement WHILE '(' expression ')' ';'  */
+#line 352 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(DO, 0, 1, (yyvsp[-2].a), yyempty_value, 0);
+          add_ast_children((yyval.a), (yyvsp[-5].a), 1);
+        }
+#line 2263 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 89: /* do: DO statement_block WHILE '(' expression ')' ';'  */
+#line 356 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(DO, 0, 1, (yyvsp[-2].a), yyempty_value, 0);
+          add_ast_children((yyval.a), (yyvsp[-5].a), 1);
+        }
+#line 2271 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 90: /* while: WHILE '(' expression ')' statement  */
+#line 362 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(WHILE, 0, 1, (yyvsp[-2].a), yyempty_value, 0);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2279 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 91: /* while: WHILE '(' expression ')' statement_block  */
+#line 366 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(WHILE, 0, 1, (yyvsp[-2].a), yyempty_value, 0);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2287 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 92: /* if: IF '(' expression ')' statement  */
+#line 372 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(IF, 0, 1, (yyvsp[-2].a), yyempty_value, 0);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2295 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 93: /* if: IF '(' expression ')' statement_block  */
+#line 376 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(IF, 0, 1, (yyvsp[-2].a), yyempty_value, 0);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2303 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 94: /* else: ELSE statement  */
+#line 382 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(ELSE, 0, 1, (yyvsp[0].a), yyempty_value, 0); }
+#line 2309 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 95: /* else: ELSE statement_block  */
+#line 384 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(ELSE, 0, 1, (yyvsp[0].a), yyempty_value, 0); }
+#line 2315 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 96: /* for: FOR '(' optional_expression ';' optional_expression ';' optional_expression ')' statement  */
+#line 388 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(FOR, 0, 1, (yyvsp[-6].a), yyempty_value, 0);
+          add_ast_children((yyval.a), (yyvsp[-4].a), 1);
+          add_ast_children((yyval.a), (yyvsp[-2].a), 1);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2325 "bin/parser/c_parser.tab.c"
+    break;
+
+  case 97: /* for: FOR '(' optional_expression ';' optional_expression ';' optional_expression ')' statement_block  */
+#line 394 "src/parser/c_parser.y"
+        { (yyval.a) = new_ast_node(FOR, 0, 1, (yyvsp[-6].a), yyempty_value, 0);
+          add_ast_children((yyval.a), (yyvsp[-4].a), 1);
+          add_ast_children((yyval.a), (yyvsp[-2].a), 1);
+          add_ast_children((yyval.a), (yyvsp[0].a), 1);
+        }
+#line 2335 "bin/parser/c_parser.tab.c"
+    break;
+
+
+#line 2339 "bin/parser/c_parser.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      {
+        yypcontext_t yyctx
+          = {yyssp, yytoken};
+        char const *yymsgp = YY_("syntax error");
+        int yysyntax_error_status;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+        if (yysyntax_error_status == 0)
+          yymsgp = yymsg;
+        else if (yysyntax_error_status == -1)
+          {
+            if (yymsg != yymsgbuf)
+              YYSTACK_FREE (yymsg);
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
+              {
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
+              }
+            else
+              {
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
+              }
+          }
+        yyerror (yymsgp);
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
+      }
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+  if (yymsg != yymsgbuf)
+    YYSTACK_FREE (yymsg);
+  return yyresult;
+}
+
@@ -0,0 +1,42 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+    #include <stddef.h>
+
+    /**
+     * a block of memory that an arena hands out from the front,
+     * chunks are kept in a list so they can all be freed together
+     */
+    typedef struct arena_chunk
+    {
+        struct arena_chunk *next;
+        size_t size;
+        size_t used;
+    } arena_chunk_t;
+
+    /**
+     * a bump allocator for things that all die at the same time,
+     * like the nodes and strings of one parse tree. an arena that
+     * is all zeros is empty and ready to use
+     */
+    typedef struct arena
+    {
+        arena_chunk_t *chunks;
+        size_t chunk_size;
+        size_t allocations;
+        size_t bytes;
+    } arena_t;
+
+    /**
+     *  returns size bytes from the arena, aligned for any of the ast types.
+     *  exits the program if no memory is left
+     */
+    void *arena_alloc(arena_t *arena, size_t size);
+
+    /**
+     *  frees every chunk at once, everything allocated from the arena
+     *  is gone and the arena is empty again
+     */
+    void arena_reset(arena_t *arena);
+
+#endif
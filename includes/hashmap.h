@@ -38,6 +38,12 @@ typedef any_t map_t;
 */
 extern map_t hashmap_new();
 
+/*
+ * Return an empty hashmap for keys that all come from intern.  Keys
+ * are compared by pointer and hashed with the hash intern saved.
+ */
+extern map_t hashmap_new_interned();
+
 /*
  * Iteratively call f with argument (item, data) for
  * each element data in the hashmap. The function must
@@ -48,19 +54,20 @@ extern map_t hashmap_new();
 extern int hashmap_iterate(map_t in, PFany f, any_t item);
 
 /*
- * Add an element to the hashmap. Return MAP_OK or MAP_OMEM.
+ * Add an element to the hashmap, or replace the element the key
+ * already has. Return MAP_OK or MAP_OMEM.
  */
-extern int hashmap_put(map_t in, char* key, any_t value);
+extern int hashmap_put(map_t in, const char* key, any_t value);
 
 /*
  * Get an element from the hashmap. Return MAP_OK or MAP_MISSING.
  */
-extern int hashmap_get(map_t in, char* key, any_t *arg);
+extern int hashmap_get(map_t in, const char* key, any_t *arg);
 
 /*
  * Remove an element from the hashmap. Return MAP_OK or MAP_MISSING.
  */
-extern int hashmap_remove(map_t in, char* key);
+extern int hashmap_remove(map_t in, const char* key);
 
 /*
  * Get any element. Return MAP_OK or MAP_MISSING.
@@ -3,6 +3,6 @@
 
 #include "./parser.h"
 
-int generate_intermediate_code(ast_node_t *parse_trees, int num_trees);
+int generate_intermediate_code(flat_tree_t *parse_trees, int num_trees);
 
 #endif
@@ -0,0 +1,29 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+    #include <stddef.h>
+
+    /**
+     *  returns the one copy of the first length characters of text, null terminated.
+     *  the same characters always give back the same pointer, so two interned names
+     *  are equal exactly when their pointers are. the copies live until intern_free
+     */
+    const char *intern_n(const char *text, size_t length);
+
+    /**
+     *  same as intern_n for a null terminated string
+     */
+    const char *intern(const char *text);
+
+    /**
+     *  returns the hash of an interned name, which was worked out once when
+     *  the name was first interned. only pass pointers that came from intern
+     */
+    unsigned intern_hash(const char *name);
+
+    /**
+     *  frees every interned name, all pointers intern handed out are gone
+     */
+    void intern_free(void);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef IRB_H
+#define IRB_H
+
+#include <stdio.h>
+
+/*
+  Converts a text IR program read from in to the binary .irb format
+  (see stackvm.h), written to out.  Exits with a message on bad input.
+  Declared on its own so the compiler can use it without the VM's
+  definitions.
+*/
+void irToIrb(FILE* in, FILE* out);
+
+#endif
@@ -39,7 +39,8 @@ typedef struct def_map
 {
     int size;
     lexeme_t *list;
-    char *key;
+    //interned
+    const char *key;
 } def_map_t;
 
 typedef struct lexer_state
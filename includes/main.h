@@ -18,6 +18,7 @@
 #define PARSER_OUTPUT_OPTION     0x200
 #define TYPE_OUTPUT_OPTION       0x400
 #define INTERMEDIATE_OUTPUT       0x800
+#define BINARY_OUTPUT            0x1000
 
 //runtime options for the program
 extern uint64_t program_options;
@@ -2,6 +2,7 @@
 #define PARSER_H
 
     #include "./symbol_table.h"
+    #include "./arena.h"
     
     /**
      * this union contains
@@ -39,6 +40,46 @@
         int array_size;
     } ast_node_t;
 
+    /**
+     * a node of the compact tree the parser hands on once a file is parsed.
+     * nodes are stored in preorder so a node's first child comes right after
+     * it, and size (the node plus everything under it) links each child to
+     * its next sibling. a node is referred to by its index in the tree
+     */
+    typedef struct flat_node
+    {
+        ast_value_t value;
+        int type;
+        unsigned size;
+        unsigned num_children;
+        short token;
+    } flat_node_t;
+
+    /**
+     * one parsed file. line numbers and array sizes are rarely looked at so they
+     * are kept in side tables indexed like nodes. identifier and string constant
+     * values are interned, so they outlive the tree
+     */
+    typedef struct flat_tree
+    {
+        flat_node_t *nodes;
+        int *line_numbers;
+        int *array_sizes;
+        unsigned length;
+    } flat_tree_t;
+
+    /**
+     * the function called on each node by the traversals
+     */
+    typedef void (*flat_visitor_t)(const flat_tree_t *tree, unsigned node, int depth, void *arg);
+
+    /**
+     * the arena for the translation unit being parsed. every node and
+     * child array the grammar builds comes from here, and is reused
+     * once its declaration is flattened
+     */
+    extern arena_t *ast_arena;
+
     /**
      * function that is called by bison to print parsing errors
      */
@@ -47,22 +88,25 @@
     /**
      *  this function is called from main. it gets the file list from the 
      *  and then runs the parser on each file generating an ast for each file
-     *  it then returns the ast array
+     *  it then returns the array of flattened trees
      */
-    ast_node_t *parse_input(int num_files, char **files);
+    flat_tree_t *parse_input(int num_files, char **files);
 
     /**
      *  this function takes the different values of a ast_node, allocates a new node,
      *  and assigns the values to the new node. 
      *  if you call with a non 0 number of children and a null pointer for children
-     *  then an empty children array will be allocated
+     *  then an empty children array will be allocated. nodes and children arrays
+     *  come from ast_arena, and children arrays always have room for a power of 2
+     *  nodes so add_ast_children can usually grow them in place
      */
     ast_node_t *new_ast_node(int token, int type, int num_children, ast_node_t *children, ast_value_t value, int array_size);
     
     /**
-     *  at the start I couldn't think of a better way of creating my variable nodes so i made this
+     *  at the start I couldn't think of a better way of creating my variable nodes so i made this.
+     *  it takes the VARIABLE node the identifiers rule collected and gives it and its identifiers their type
      */
-    ast_node_t *new_variable_node(int scope, int type, ast_node_t *indedifiers);
+    ast_node_t *new_variable_node(int scope, int type, ast_node_t *identifiers);
 
     ast_node_t *make_function_sig(ast_node_t *type_name, ast_node_t *params, int type);
 
@@ -75,35 +119,49 @@
     void add_ast_children(ast_node_t *parent, ast_node_t *children, int num_children);
 
     /**
-     *   This function does a preorder traversal of the ast so i can print it. it takes a starting node,
-     *   an arbitrary depth starting point, a function pointer and a optional argument to supply to the 
-     *   function. It then traverses the tree incrementing depth for each recursive call.
+     *  This function appends a finished external declaration to the flat tree of the
+     *  file being parsed, as the next child of its PROGRAM node, and gives the
+     *  declaration's nodes back to be reused by the rest of the file.
      */
-    void preorder_traversal(ast_node_t node, int depth, void (*func)(ast_node_t, int, void*), void *arg);
+    void add_flat_declaration(ast_node_t *decl);
 
     /**
-     *
+     *   This function does a preorder traversal of a flat tree so i can print it. it takes a tree, 
+     *   the index of a starting node, an arbitrary depth starting point, a function pointer and a 
+     *   optional argument to supply to the function. Depth goes up by one for each level down.
+     *   It keeps its own stack so deep trees don't use up the c stack.
      */
-    void postorder_traversal(ast_node_t node, int depth, void (*func)(ast_node_t, int, void*), void *arg);
+    void preorder_traversal(const flat_tree_t *tree, unsigned node, int depth, flat_visitor_t func, void *arg);
+
+    /**
+     *   Same as preorder_traversal but each node is visited after everything under it
+     */
+    void postorder_traversal(const flat_tree_t *tree, unsigned node, int depth, flat_visitor_t func, void *arg);
+
+    /**
+     *   returns the index of child number n of a node in a flat tree
+     */
+    unsigned flat_child(const flat_tree_t *tree, unsigned node, int n);
+
+    /**
+     *   returns the index of the node after a node and everything under it, 
+     *   which is its next sibling if it has one
+     */
+    unsigned flat_next(const flat_tree_t *tree, unsigned node);
     
     /**
      *   This is the function that i use as an argument to the traversal
      *   it just prints the basic information about each node adding
      *   2 * depth spaces before printing so its easier to visualize
      */
-    void print_node(ast_node_t node, int depth, void *arg);
-
-    ast_node_t *invert_list(ast_node_t *node);
+    void print_node(const flat_tree_t *tree, unsigned node, int depth, void *arg);
 
     void check_function_params(ast_node_t *node);
 
     /**
-     *   This function is used to free the children of an ast_node_t 
-     *   created by the parser. You can free whole tree by passing
-     *   in the root node then calling free on the root node itself, 
-     *   or some subtree by passing the parent of the children you
-     *   want to free
+     *   This function frees a tree returned by parse_input, its node array
+     *   and side tables. the interned names it points to stay
      */
-    void free_tree_memory(ast_node_t node);
+    void free_flat_tree(flat_tree_t *tree);
 
 #endif
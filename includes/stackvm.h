@@ -0,0 +1,707 @@
+#ifndef STACKVM_H
+#define STACKVM_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <setjmp.h>
+#include <ucontext.h>
+
+/*
+  Shared definitions for the stack VM.  Memory, the reference (switch)
+  interpreter and the library entry points (vmContextInit, vmLoad and
+  vmRun) live in src/code_gen/stackvm.c, the loaders and alternative
+  execution engines in their own files, and the command line in
+  stackvm_main.c, stackvm_batch.c and stackvm_serve.c.  All of it but
+  the command line is built into libstackvm.a, which the translator
+  to C (stackvm_aot.c, bin/ir2c) also links.
+*/
+
+/*
+  Conversion.  Done through memcpy so they stay correct when the VM
+  is built with optimization (strict aliasing).
+*/
+static inline int u2i(unsigned x)
+{
+  int y;
+  memcpy(&y, &x, sizeof(y));
+  return y;
+}
+
+static inline float u2f(unsigned x)
+{
+  float y;
+  memcpy(&y, &x, sizeof(y));
+  return y;
+}
+
+static inline unsigned i2u(int x)
+{
+  unsigned y;
+  memcpy(&y, &x, sizeof(y));
+  return y;
+}
+
+static inline unsigned f2u(float x)
+{
+  unsigned y;
+  memcpy(&y, &x, sizeof(y));
+  return y;
+}
+
+/*
+  Memory segments
+*/
+typedef struct {
+  unsigned* mem_base;
+  unsigned* data;
+  size_t size;
+} segment;
+
+/*
+  initSegment reserves a segment followed by a guard region; running
+  into the guard is reported as the runtime error overflow.  Set
+  hugePages first to ask for transparent huge pages.  shrinkSegment
+  cuts a segment down to its first slots, turning the rest of it into
+  guard from the next page on.  clearSegment zeroes a segment by
+  giving its pages back, and freeSegment unmaps one that was never
+  shrunk.  guardRegion reports faults in any other region the same
+  way.
+*/
+extern int hugePages;
+void initSegment(segment* S, size_t slots, const char* overflow);
+void shrinkSegment(segment* S, size_t slots, const char* overflow);
+void clearSegment(const segment* S);
+void freeSegment(segment* S);
+void guardRegion(void* at, size_t bytes, const char* what);
+void makeSubSegment(const segment* mainSeg, size_t off, size_t cap, segment* piece);
+unsigned addr2ptr(const segment* S, unsigned addr);
+
+/*
+  Stacks
+*/
+typedef struct {
+  size_t size;
+  unsigned* data;
+  size_t top;
+} stack;
+
+void initStack(const segment* seg, size_t off, stack* S);
+void makeSubStack(stack* ss, const stack* S);
+unsigned top(stack* S);
+unsigned pop(stack* S);
+void push(stack* S, unsigned d);
+
+/*
+  Instruction types
+*/
+typedef enum {
+  PUSH, PTRTO, PUSHv, PUSHc, PUSHi, PUSHf,
+  COPY, MOVE,
+  POPX, POP, POPc, POPi, POPf,
+
+  CALL, RET,
+
+  INCc, INCi, INCf,
+  DECc, DECi, DECf,
+  NEGc, NEGi, NEGf,
+  FLIP, CONVif, CONVfi,
+
+  PLUSc, PLUSi, PLUSf,
+  MINUSc, MINUSi, MINUSf,
+  STARc, STARi, STARf,
+  SLASHc, SLASHi, SLASHf,
+  MODc, MODi,
+  AND, OR,
+
+  GOTO,
+  IFZc, IFZi, IFZf,
+  IFNZc, IFNZi, IFNZf,
+  IFEQc, IFEQi, IFEQf,
+  IFNEc, IFNEi, IFNEf,
+  IFLTc, IFLTi, IFLTf,
+  IFLEc, IFLEi, IFLEf,
+  IFGTc, IFGTi, IFGTf,
+  IFGEc, IFGEi, IFGEf,
+
+  /*
+    Fused opcodes, only produced by fuseFunction.  The LL forms take
+    two local slots, the LV forms a local slot and an immediate value.
+    The c flavors of + - and the compares fuse into the i forms.
+  */
+  PLUSiLL, PLUSiLV, MINUSiLL, MINUSiLV,
+  IFEQiLL, IFNEiLL, IFLTiLL, IFLEiLL, IFGTiLL, IFGEiLL,
+  IFEQiLV, IFNEiLV, IFLTiLV, IFLEiLV, IFGTiLV, IFGEiLV,
+
+  NONE,
+  ERROR
+} opcode;
+
+/*
+  Address types
+*/
+typedef enum {
+  CONST='C', GLOBAL='G', LOCAL='L', LABEL=':', FNUM='f', VALUE='v', UNUSED=' ', MOVEDIST='m'
+} address_type;
+
+/*
+  Complete instructions.  addr2 and addr3 are only used by the fused
+  opcodes: arithmetic keeps its two operands in addr and addr2, the
+  compare-and-branch forms keep the target in addr and the operands
+  in addr2 and addr3.
+*/
+typedef struct {
+  opcode op;
+  address_type atype;
+  unsigned addr;
+  unsigned addr2;
+  unsigned addr3;
+} instruction;
+
+void showInstruction(FILE* out, instruction I);
+void showSegment(segment* S);
+
+/*
+  Function data
+*/
+struct threaded_instr;
+struct register_code;
+
+typedef struct {
+  char* name;
+  unsigned parameter_slots;
+  unsigned return_slots;
+  unsigned local_slots;
+  instruction* code;
+  unsigned code_length;
+  /* Fusion pattern + 1 per instruction, only kept for --fusion-stats */
+  unsigned char* fused;
+  /* Instruction number before fusion of each instruction and of the end;
+     0 when fusion left the code alone */
+  unsigned* source_pc;
+  /* Packed code for callFunction, built by packFunction */
+  unsigned char* packed;
+  unsigned packed_length;
+  /* Pre-decoded handler stream, built by threadFunction */
+  struct threaded_instr* threaded;
+  /* Three-address code, built by registerFunction */
+  struct register_code* registered;
+  /* Set by verifyFunction when the operand stack depth is bounded */
+  int verified;
+  unsigned max_depth;
+  /* verifyFunction's diagnostic, if it rejected the function */
+  char* rejected;
+  /* Native code from jitCompile, once the function got hot */
+  unsigned* (*jit)(unsigned* locals, unsigned* sp);
+  unsigned calls;
+  int jit_failed;
+  /* Executions per instruction, only kept for --profile */
+  unsigned long* profile;
+  /* Start of the code in the source, until loadFunction reads it */
+  const char* source;
+  int source_line;
+} function;
+
+typedef unsigned* (*jit_code)(unsigned* locals, unsigned* sp);
+
+/*
+  Instruction numbers in messages and reports are the ones in the
+  source, whether or not the code was fused.
+*/
+static inline unsigned sourceInstruction(const function* F, unsigned pc)
+{
+  return F->source_pc ? F->source_pc[pc] : pc;
+}
+
+void showFunction(FILE* out, unsigned fnum, function* F);
+
+extern const unsigned BUILTIN_FUNCTIONS;
+
+typedef struct {
+  segment constants;
+  segment globals;
+  function* F;
+  unsigned nf;
+  int verify;           /* loadFunction verifies what it reads */
+} program;
+
+/*
+  Loading.  readProgram (stackvm_load.c) parses a text program.
+  loadIrb (stackvm_irb.c) maps a binary one instead; it returns 0,
+  leaving P alone, if the file isn't in that format.  Both put the
+  constants at the start of memory and set the sizes of P's constant
+  and global segments; exit with a message on bad input.  writeIrb
+  saves a program as loaded, before fusion.  The compiler links these
+  for its -b option.
+
+  readProgramLazy only reads the header of each function and skips
+  its code, leaving source set; loadFunction reads the code the first
+  time the function is called, then fuses, verifies and packs it.
+  The engines call it for a function with source set, so a run only
+  reads the code it uses.  The input stays mapped for as long as the
+  program is used, and only one thread may run a lazy program.
+*/
+void zeroFunc(function* F);
+void initBuiltins(function* F);
+void readProgram(FILE* in, program* P, segment* memory);
+void readProgramLazy(FILE* in, program* P, segment* memory, int verify);
+void loadFunction(program* P, function* F);
+int loadIrb(const char* path, program* P, segment* memory);
+void writeIrb(FILE* out, const program* P);
+
+/*
+  Binary program file (.irb).  All fields are native byte order; a
+  file is only accepted by a build with the same byte order and
+  instruction layout.  After the header come the constants, the
+  function table, the function names, and the code of every function
+  as an instruction array, labels already resolved.
+*/
+#define IRB_MAGIC       "IRB\x1a"
+#define IRB_VERSION     1
+#define IRB_BYTE_ORDER  0x01020304u
+
+typedef struct {
+  char magic[4];
+  unsigned version;
+  unsigned byte_order;
+  unsigned instruction_size;
+  unsigned constants;
+  unsigned globals;
+  unsigned functions;       /* not counting builtins */
+  unsigned reserved;
+} irb_header;
+
+typedef struct {
+  unsigned fnum;
+  unsigned parameter_slots;
+  unsigned return_slots;
+  unsigned local_slots;
+  unsigned code_length;
+  unsigned name;            /* file offset of the 0-terminated name */
+  unsigned long code;       /* file offset of the instructions */
+} irb_function;
+
+/*
+  Superinstruction fusion (stackvm_fusion.c), run on every function
+  once the program is loaded.
+*/
+typedef enum {
+  FUSE_STORE,       /* copy; pop X; popx            -> pop X      */
+  FUSE_INCDEC,      /* pushv 0x1; +i                -> ++i        */
+  FUSE_ARITH_LL,    /* push Lx; push Ly; +i         -> +iLL x y   */
+  FUSE_ARITH_LV,    /* push Lx; pushv k; +i         -> +iLV x k   */
+  FUSE_BRANCH_LL,   /* push Lx; push Ly; <i label   -> <iLL x y   */
+  FUSE_BRANCH_LV,   /* push Lx; pushv k; <i label   -> <iLV x k   */
+  FUSE_PATTERNS
+} fusion_pattern;
+
+extern int fusionEnabled;
+extern int fusionStats;
+extern unsigned long fusionSites[FUSE_PATTERNS];
+extern unsigned long fusionHits[FUSE_PATTERNS];
+
+void fuseFunction(function* F);
+void showFusionStats(FILE* out);
+
+/*
+  Packed code (stackvm_pack.c), what callFunction runs.  Each
+  instruction is an opcode byte followed by packedOperands[op]
+  operands, as unaligned native 32-bit words; most instructions have
+  none and take one byte.  The address type of push, ptrto and pop is
+  folded into the opcode: PUSH and PTRTO are of constants and POP is
+  to a global in packed code, the rest have opcodes of their own.
+  Labels are byte offsets into the packed code, which ends in
+  PACKED_END so a jump to the end of the function lands on it.  A
+  fused instruction tagged for --fusion-stats is preceded by
+  PACKED_HIT and a byte holding its pattern; the pair is not an
+  instruction.
+
+  packedIndex turns an offset back into an instruction number, for
+  messages; packedOffsets gives the offset of every instruction, and
+  of the end, in a malloc'd array.  showPacked shows the instruction
+  at an offset with showInstruction.
+*/
+typedef enum {
+  PUSHG = ERROR+1, PUSHL,
+  PTRTOG, PTRTOL,
+  POPL,
+  PACKED_HIT, PACKED_END,
+  PACKED_OPCODES
+} packed_opcode;
+
+extern const unsigned char packedOperands[PACKED_OPCODES];
+extern const unsigned char packedOpcode[PACKED_OPCODES];
+
+static inline unsigned packedOperand(const unsigned char* p, unsigned i)
+{
+  unsigned u;
+  memcpy(&u, p + 4*i, sizeof(u));
+  return u;
+}
+
+void packFunction(function* F);
+unsigned packedIndex(const function* F, unsigned offset);
+unsigned* packedOffsets(const function* F);
+void showPacked(FILE* out, const function* F, unsigned offset);
+
+/*
+  Static verifier (stackvm_verify.c), run on every function once the
+  program is read.  A bad function keeps a diagnostic in rejected, and
+  is never packed, threaded or translated: packFunction and
+  threadFunction call rejectedCall for it instead, which prints the
+  diagnostic and exits with 1.  Since the engines build a function's
+  code when it is first called at the latest, that is when a rejected
+  function stops the run, however the program was loaded.
+  stackEffect gives how many slots an instruction reads and how it
+  changes the depth; it returns 0 for a call to an unknown function.
+*/
+int stackEffect(const program* P, instruction I, unsigned* need, int* delta);
+void verifyFunction(const program* P, function* F);
+void rejectedCall(const function* F) __attribute__((noreturn));
+
+/*
+  Builtin I/O state for a run, see stackvm_io.c
+*/
+typedef struct {
+  const unsigned char* in;        /* unread input */
+  const unsigned char* in_end;
+  unsigned char* out;             /* next free output byte */
+  unsigned char* out_end;         /* fast path limit; 0 room on a terminal */
+  unsigned char* in_buffer;
+  unsigned char* out_buffer;
+  unsigned char* mapped;          /* input file mapping, if any */
+  size_t mapped_length;
+  int in_fd, out_fd;
+  int in_terminal, out_terminal;
+  int in_done;
+} vm_io;
+
+/*
+  VM contexts (stackvm_context.c).  Everything a run changes lives in
+  a vm_context, and each thread runs one context at a time, found in
+  vmCurrent.  Until a thread sets its own, vmCurrent is a process-wide
+  context that reports errors on stderr and exits, as the command line
+  wants.
+
+  Errors are printed to vmErrors() and end with vmExit(status): 1 for
+  a bad program, 2 for a failure while running.  If the context has
+  recover set, vmExit frees the buffers engines registered with vmHold
+  and jumps there with the status instead of exiting.
+
+  A fault in a guard region, or an integer division that traps, is
+  reported from the SIGSEGV or SIGFPE handler, where none of that is
+  safe: without recover it writes the message with write(2) and ends
+  the process with _exit, and with recover it leaves the message in
+  fault and the held buffers in orphans, and jumps.  Whoever set
+  recover calls vmRecovered when sigsetjmp returns nonzero, which
+  reports and frees them.
+*/
+#define VM_HELD 8
+#define VM_FAULT 160
+
+struct vm_green;
+
+typedef struct {
+  const function* executing;      /* for error messages */
+  unsigned instruction;
+  int packed_pc;                  /* instruction is an offset into packed */
+  FILE* errors;                   /* 0 for stderr */
+  sigjmp_buf* recover;
+  void** held[VM_HELD];
+  unsigned nheld;
+  char fault[VM_FAULT];           /* from the SIGSEGV handler */
+  void* orphans[VM_HELD];
+  unsigned norphans;
+  vm_io io;
+  /* memory for vmRun, reserved by vmContextInit */
+  segment memory;
+  segment stack_memory;
+  size_t local_slots;
+  /* the green thread running in this context, if any, and its fuel */
+  struct vm_green* green;
+  unsigned long fuel;
+} vm_context;
+
+extern __thread vm_context* vmCurrent;
+
+static inline FILE* vmErrors()
+{
+  return vmCurrent->errors ? vmCurrent->errors : stderr;
+}
+
+void vmExit(int status) __attribute__((noreturn));
+void vmRecovered(vm_context* C);
+
+/*
+  p is a local holding an engine's heap buffer, for the rest of the
+  call; calls to vmHold and vmRelease pair up like the calls they are
+  in.  Without recover they do nothing, since vmExit exits anyway.
+*/
+static inline void vmHold(void** p)
+{
+  vm_context* C = vmCurrent;
+  if (0==C->recover) return;
+  assert(C->nheld < VM_HELD);
+  C->held[C->nheld++] = p;
+}
+
+static inline void vmRelease()
+{
+  vm_context* C = vmCurrent;
+  if (C->recover) C->nheld--;
+}
+
+/*
+  Execution
+*/
+
+void runtimeError(const char* e);
+void runtimeError3(const char* e, unsigned e2, const char* e3);
+
+void callBuiltin(unsigned fnum, segment* mylocals, stack* mystack);
+
+/*
+  Builtin I/O (stackvm_io.c), on vmCurrent's vm_io.  ioOpen sets it up
+  on two file descriptors; noInput says the program itself was read
+  from in, so nothing is left.  ioClose flushes and lets go of it.
+  ioGetchar and ioPutchar are the fast paths; engines pass them
+  vmCurrent's io, which they keep at hand.  putchar(-1) writes nothing
+  and flushes.  Flush before writing to the same descriptor with
+  stdio.
+*/
+void ioOpen(vm_io* io, int in, int out, int noInput);
+void ioClose(vm_io* io);
+int ioRefill();
+void ioOverflow(int c);
+void ioFlush();
+
+static inline int ioGetchar(vm_io* io)
+{
+  return (io->in < io->in_end) ? *io->in++ : ioRefill();
+}
+
+static inline void ioPutchar(vm_io* io, int c)
+{
+  if (io->out < io->out_end && c != -1) {
+    *io->out++ = c;
+  } else {
+    ioOverflow(c);
+  }
+}
+
+/*
+  A builtin run straight on an operand stack, without a frame: sp is
+  just past the arguments, and the new sp is returned.  getchar pushes
+  its result; putchar returns its argument, so leaves it in place.
+*/
+static inline unsigned* callBuiltinFast(vm_io* io, unsigned fnum, unsigned* sp)
+{
+  if (0==fnum) {
+    *sp++ = i2u(ioGetchar(io));
+  } else {
+    ioPutchar(io, u2i(sp[-1]));
+  }
+  return sp;
+}
+
+/* Reference interpreter: one switch per instruction */
+void callFunction(program* P, unsigned fnum, segment* locals, stack* compstack);
+
+/*
+  A caller suspended by callFunction.  The callee's frame begins at
+  the arguments on the caller's stack, so the bases are all that is
+  needed to rebuild the caller's segment and stack.
+*/
+typedef struct {
+  function* F;
+  unsigned pc;          /* return address */
+  unsigned* locals;
+  unsigned* stack;
+} call_frame;
+
+/*
+  Profiler (stackvm_profile.c) for --profile.  callProfiled is a
+  second build of callFunction's loop with the counting compiled in,
+  so callFunction itself pays nothing.  profileStart must run before
+  it, profileReport after.
+*/
+extern unsigned long profileOps[ERROR+1];
+extern unsigned long profileTotal;
+void profileStart(program* P);
+void profileEnter(const function* caller, unsigned fnum);
+void profileLeave();
+void profileReport(const program* P, FILE* text, const char* jsonpath);
+void callProfiled(program* P, unsigned fnum, segment* locals, stack* compstack);
+
+/*
+  Sampling profiler (stackvm_sample.c) for --sample.  callSampled is
+  a third build of callFunction's loop that publishes its frames in
+  sampleFrames and sampleDepth on every call and ret, and the builtin
+  it is in (plus 1) in sampleBuiltin.  A SIGPROF handler reads them
+  with the function and instruction in vmCurrent.  Updates go between sampleBegin
+  and sampleEnd; a sample that arrives in between is only noted, and
+  sampleEnd takes it.  sampleStop turns the timer off and
+  sampleReport writes the stacks in folded form.
+*/
+extern call_frame* volatile sampleFrames;
+extern volatile unsigned sampleDepth;
+extern volatile unsigned sampleBuiltin;
+extern volatile int sampleBusy;
+extern volatile unsigned samplePending;
+void sampleStart(const program* P, unsigned hz);
+void sampleCatchUp();
+void sampleStop();
+void sampleReport(const program* P, FILE* text, const char* foldedpath);
+void callSampled(program* P, unsigned fnum, segment* locals, stack* compstack);
+
+/* Keeps the compiler from moving stores across it, for the handler */
+#ifdef __GNUC__
+#define SAMPLE_FENCE()  __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#else
+#define SAMPLE_FENCE()
+#endif
+
+static inline void sampleBegin()
+{
+  sampleBusy = 1;
+  SAMPLE_FENCE();
+}
+
+static inline void sampleEnd()
+{
+  SAMPLE_FENCE();
+  sampleBusy = 0;
+  if (samplePending) sampleCatchUp();
+}
+
+/*
+  Direct-threaded engine (stackvm_threaded.c).  threadedAvailable is 0
+  when the compiler has no labels-as-values, in which case the engine
+  is never selected and callers stay on callFunction.  Verified
+  functions run without per-instruction stack checks.
+*/
+extern const int threadedAvailable;
+void threadFunction(program* P, function* F);
+void callThreaded(program* P, unsigned fnum, segment* locals, stack* compstack);
+
+/*
+  Register tier (stackvm_register.c).  registerFunction returns 0 and
+  leaves the function alone when its stack depths aren't static; such
+  functions run on callFunction.  Needs every function loaded, since
+  a call's stack effect depends on the callee.
+*/
+int registerFunction(program* P, function* F);
+void callRegister(program* P, unsigned fnum, segment* locals, stack* compstack);
+
+/*
+  Template JIT (stackvm_jit.c), layered on the threaded engine.
+  jitReady counts a call and compiles the function once it reaches
+  jitThreshold calls; it returns 1 if the function has native code.
+  jitCall runs function fnum with its arguments on top of sp and its
+  locals starting at locals, and returns the new stack pointer.
+*/
+extern const int jitAvailable;
+extern int jitEnabled;
+extern unsigned jitThreshold;
+void jitInit(program* P, segment* locals, stack* compstack);
+void jitCompile(program* P, function* F);
+int jitReady(program* P, function* F);
+unsigned* jitCall(unsigned fnum, unsigned* locals, unsigned* sp, unsigned pc);
+
+/*
+  Execution engines selectable with --engine
+*/
+typedef enum {
+  ENGINE_SWITCH, ENGINE_THREADED, ENGINE_REGISTER, ENGINE_JIT
+} vm_engine;
+
+/*
+  Library interface (stackvm.c).  Each returns 0 on success, or the
+  status vmExit was given, with the message written to C's errors.
+
+  vmContextInit reserves a context's memory; C must start out zeroed,
+  with errors set if wanted.  vmLoad reads the program in path with
+  C's memory and prepares it for an engine; the vm_program it fills
+  in is not changed again, so any number of contexts may run it at
+  once, and it is kept until exit.  vmRun runs main with getchar and
+  putchar on the file descriptors in (-1 for no input) and out, leaves
+  what main returned in *result, and clears C's memory for the next
+  run.  The
+  JIT, the profilers and --fusion-stats keep process-wide state and
+  are only for the command line.
+*/
+typedef struct {
+  program P;            /* constants and globals point into image */
+  unsigned* image;      /* constants, then globals, as loaded */
+  unsigned entry;       /* function main */
+  vm_engine engine;
+} vm_program;
+
+int vmContextInit(vm_context* C, size_t globalSlots, size_t localSlots, size_t stackSlots);
+void vmContextFree(vm_context* C);
+int vmLoad(vm_context* C, const char* path, vm_engine engine, int verify, vm_program* V);
+int vmRun(vm_context* C, const vm_program* V, int in, int out, int* result);
+
+/*
+  Green threads (stackvm_green.c).  A vm_green runs vmRun on a stack
+  of its own, in a context of its own, with callFueled: a fourth build
+  of callFunction's loop that spends one unit of the context's fuel
+  per instruction and calls vmYield when there is none left.  ioRefill
+  also yields, with waiting set, when its input has nothing to read
+  yet.  vmGreenInit reserves what a green thread needs, vmGreenStart
+  sets it up to run a program, and vmGreenResume runs it until it
+  yields, returning 0 once vmRun has returned.  vmSchedule runs n
+  started green threads round robin, quantum instructions at a time,
+  polling the inputs of those waiting when nothing else can run, and
+  fills in their statistics.  Times are in seconds.
+*/
+typedef struct vm_green {
+  vm_context C;
+  ucontext_t context;
+  ucontext_t resumer;       /* where vmYield goes back to */
+  char* stack;
+  size_t stack_bytes;
+  const vm_program* V;
+  int in, out;
+  int waiting;              /* the input is empty, not at its end */
+  int done;
+  int status;
+  int result;
+  /* statistics */
+  unsigned long instructions;
+  unsigned long slices;
+  unsigned long waits;
+  double cpu;               /* thread CPU time while resumed */
+  double started;           /* from the start of vmSchedule to ... */
+  double finished;
+  double max_wait;          /* longest time ready but not running */
+  double ready_since;
+} vm_green;
+
+void callFueled(program* P, unsigned fnum, segment* locals, stack* compstack);
+void vmYield();
+int vmGreenInit(vm_green* G, size_t globalSlots, size_t localSlots, size_t stackSlots);
+void vmGreenStart(vm_green* G, const vm_program* V, int in, int out);
+int vmGreenResume(vm_green* G, unsigned long fuel);
+void vmGreenFree(vm_green* G);
+void vmSchedule(vm_green** G, unsigned n, unsigned long quantum);
+
+/*
+  Batch runner for --batch (stackvm_batch.c): runs the jobs listed in
+  jobfile on threads contexts of the given sizes, and returns the exit
+  status for main.  With a quantum, each thread runs all of its jobs
+  at once as green threads instead of one after another.
+*/
+int runBatch(const char* jobfile, unsigned threads, vm_engine engine, int verify,
+  size_t globalSlots, size_t localSlots, size_t stackSlots, unsigned long quantum);
+
+/*
+  Server for --serve (stackvm_serve.c): loads irfile once, then runs it
+  in a forked child for each connection to socketPath.  Only returns
+  if the program can't be loaded or the socket can't be used.
+*/
+int runServer(const char* socketPath, const char* irfile, vm_engine engine, int verify,
+  size_t globalSlots, size_t localSlots, size_t stackSlots);
+
+#endif
@@ -2,11 +2,13 @@
 #include <stdio.h>
 #include <string.h>
 #include "../../includes/hashmap.h"
+#include "../../includes/intern.h"
 #include "../../bin/parser/bison.h"
 #include "../../includes/intermediate_generator.h"
 #include "../../includes/types.h"
 #include "../../includes/main.h"
 #include "../../includes/utils.h"
+#include "../../includes/irb.h"
 #define FUNC_OFFSET 2
 
 /**
@@ -14,49 +16,49 @@
  *  needed to store all string constants. Then a second
  *  pass through to generate the constant values.
  */
-static int generate_constants(ast_node_t *parse_trees, int num_trees);
+static int generate_constants(flat_tree_t *parse_trees, int num_trees);
 
 /**
  *  scans the whole ast and prints the constant information 
  *  for all string constants
  */
-void print_constant_traversal(ast_node_t node, int a, void *v);
+void print_constant_traversal(const flat_tree_t *t, unsigned node, int a, void *v);
 
 /**
  *  scans whole ast and counts the number of slots
  *  for string constants we will need
  */
-void count_constant_traversal(ast_node_t node, int a, void *v);
+void count_constant_traversal(const flat_tree_t *t, unsigned node, int a, void *v);
 
 /**
  *  counts the number of global slots needed and then writes the 
  *  instruction to reserve those slots.
  */
-static int generate_globals(ast_node_t *parse_trees, int num_trees, map_t map);
+static int generate_globals(flat_tree_t *parse_trees, int num_trees, map_t map);
 
 /**
  *  counts the number of functions, writes the instruction to declair number
  *  of functions. then generates the function code for each function definition
  */
-static int generate_functions(ast_node_t *parse_tree, int num_trees, map_t map);
+static int generate_functions(flat_tree_t *parse_trees, int num_trees, map_t map);
 
 /**
  *  is used by generate_functions to actually generate the code for each function
  */
-static int generate_function_code(ast_node_t func, map_t map);
+static int generate_function_code(unsigned func, map_t map);
 
 /**
  *  is used by generate_function_code to generate code for specific statements 
  *  in the function body
  */
-static int generate_statement_code(ast_node_t func, map_t global, map_t local, char *into, char *around, int test);
+static int generate_statement_code(unsigned func, map_t global, map_t local, char *into, char *around, int test);
 
 /**
  *  this function is used to generate instructions for code that requires
  *  branching. Mainly used split code into logical chunks and splitting 
  *  functionality for different run options.
  */
-static int generate_branching_code(ast_node_t func, map_t global, map_t local, char *into, char *around, int test);
+static int generate_branching_code(unsigned func, map_t global, map_t local, char *into, char *around, int test);
 
 /**
  *  generates the code for binary operations
@@ -72,7 +74,7 @@ static void generate_binary_op_code(int op, int op_type, char *into, char *aroun
  *  the integer argument is the starting point for the slot counter.
  *  returns the number of slots counted
  */
-static int count_slots(ast_node_t base, char prepend, int vars, map_t map);
+static int count_slots(unsigned base, char prepend, int vars, map_t map);
 
 /**
  *  this function takes a character buffer and stores the comparision
@@ -87,7 +89,7 @@ static void invert_operation(char *type, int op);
  *  branching code can then compare the value placed on the stack
  *  by the expression to 0 to get its jump.
  */
-static int need_comparison(ast_node_t token);
+static int need_comparison(unsigned token);
 
 /**
  *  continually makes new labels to be used by other functions
@@ -110,19 +112,38 @@ static char get_type_char(int type);
 //function used to free all map memory
 static int clear_map(void *nothing, void *str);
 
+//the tree of the translation unit being generated, node indices are into it
+static const flat_tree_t *tree;
+#define NODE(i)         (tree->nodes[i])
+#define CHILD(i, n)     flat_child(tree, i, n)
+
 //variable used to store constant map because it needs to be global 
 static map_t const_map;
 
 //variable to store constant slots because recursive function
 static int constant_counter = 0;
 
+//where the text code goes, a temporary file when binary output is wanted
+static FILE *ir_out;
+
 /**
  *  generates the code based on the asts passed in
  */
-int generate_intermediate_code(ast_node_t *parse_trees, int num_trees)
+int generate_intermediate_code(flat_tree_t *parse_trees, int num_trees)
 {
-    map_t global_map = hashmap_new();
-    const_map = hashmap_new();
+    map_t global_map;
+
+    //the binary form is assembled from the text form by the vm's loader
+    ir_out = (program_options & BINARY_OUTPUT) ? tmpfile() : stdout;
+    if(ir_out == NULL)
+    {
+        fprintf(stderr, "unable to create temporary file for binary output\n");
+        return -1;
+    }
+
+    //every key is an interned identifier or string constant
+    global_map = hashmap_new_interned();
+    const_map = hashmap_new_interned();
 
     generate_constants(parse_trees, num_trees);
     generate_globals(parse_trees, num_trees, global_map);
@@ -132,37 +153,44 @@ int generate_intermediate_code(ast_node_t *parse_trees, int num_trees)
     hashmap_free(global_map);
     hashmap_iterate(const_map, &clear_map, NULL);
     hashmap_free(const_map);
+
+    if(program_options & BINARY_OUTPUT)
+    {
+        rewind(ir_out);
+        irToIrb(ir_out, stdout);
+        fclose(ir_out);
+    }
     return 0;
 }
 
-static int generate_constants(ast_node_t *parse_trees, int num_trees)
+static int generate_constants(flat_tree_t *parse_trees, int num_trees)
 {
     int i;
     
     for(i = 0; i < num_trees; i++)
     {
-        preorder_traversal(parse_trees[i], 0, &count_constant_traversal, NULL);
+        preorder_traversal(parse_trees + i, 0, 0, &count_constant_traversal, NULL);
     }
 
-    printf("\n.CONSTANTS %d", constant_counter);
+    fprintf(ir_out, "\n.CONSTANTS %d", constant_counter);
 
     for(i = 0; i < num_trees; i++)
     {
-        preorder_traversal(parse_trees[i], 0, &print_constant_traversal, NULL);
+        preorder_traversal(parse_trees + i, 0, 0, &print_constant_traversal, NULL);
     }
 
-    printf("\n");
+    fprintf(ir_out, "\n");
 
     return 0;
 }
 
-void print_constant_traversal(ast_node_t node, int a, void *v)
+void print_constant_traversal(const flat_tree_t *t, unsigned node, int a, void *v)
 {
     int i, length, adjusted;
 
-    if(node.token == STRCONST)
+    if(t->nodes[node].token == STRCONST)
     {
-        length = strlen(node.value.s);
+        length = strlen(t->nodes[node].value.s);
         adjusted = length/4;
         if(length%4)
             adjusted++;
@@ -170,27 +198,27 @@ void print_constant_traversal(ast_node_t node, int a, void *v)
         for(i = adjusted*4-1; i >= 0; i--)
         {  
             if(i%4 == 3)
-                printf("\n  0x");
+                fprintf(ir_out, "\n  0x");
             if(i >= length)
-                printf("00");
+                fprintf(ir_out, "00");
             else
-                printf("%x", node.value.s[i]);
+                fprintf(ir_out, "%x", t->nodes[node].value.s[i]);
         }
         constant_counter+=adjusted;
     }
 }
 
-void count_constant_traversal(ast_node_t node, int a, void *v)
+void count_constant_traversal(const flat_tree_t *t, unsigned node, int a, void *v)
 {
     int adjusted, length;
     char *address;
 
-    if(node.token == STRCONST)
+    if(t->nodes[node].token == STRCONST)
     {   
         address = malloc(10);
         snprintf(address, 10, "C%d", constant_counter);
-        hashmap_put(const_map, node.value.s, address);
-        length = strlen(node.value.s);
+        hashmap_put(const_map, t->nodes[node].value.s, address);
+        length = strlen(t->nodes[node].value.s);
         adjusted = length/4;
         if(length%4)
             adjusted++;
@@ -198,73 +226,74 @@ void count_constant_traversal(ast_node_t node, int a, void *v)
     }
 }
 
-static int generate_globals(ast_node_t *parse_trees, int num_trees, map_t map)
+static int generate_globals(flat_tree_t *parse_trees, int num_trees, map_t map)
 {
     int i, vars=0;
     
     //for each file
     for(i = 0; i < num_trees; i++)
     {
-        vars = count_slots(parse_trees[i], 'G', vars, map); 
+        tree = parse_trees + i;
+        vars = count_slots(0, 'G', vars, map); 
     }
 
     if(program_options & INTERMEDIATE_OUTPUT)
     {
-        printf("\n.GLOBALS %d\n", vars);
+        fprintf(ir_out, "\n.GLOBALS %d\n", vars);
     }
 
     return 0;
 }
 
-static int generate_functions(ast_node_t *parse_trees, int num_trees, map_t map)
+static int generate_functions(flat_tree_t *parse_trees, int num_trees, map_t map)
 {
     int i, j, funcs = 0;
     char *func_num;
-    ast_node_t cur;
+    unsigned cur;
     
     func_num = malloc(2);
     func_num[0] = '0';
     func_num[1] = '\0';
-    hashmap_put(map, "getchar", func_num);
+    hashmap_put(map, intern("getchar"), func_num);
     func_num = malloc(2);
     func_num[0] = '1';
     func_num[1] = '\0';
-    hashmap_put(map, "putchar", func_num);
+    hashmap_put(map, intern("putchar"), func_num);
     
     //for each file
     for(i = 0; i < num_trees; i++)
     {
+        tree = parse_trees + i;
         //for each root node
-        for(j = 0; j < parse_trees[i].num_children; j++)
+        for(j = 0, cur = CHILD(0, 0); j < NODE(0).num_children; j++, cur = flat_next(tree, cur))
         {
-            cur = parse_trees[i].children[j];
             //count number of functions and assign stack identifier
-            if(cur.token == FUNCTION_DEF)
+            if(NODE(cur).token == FUNCTION_DEF)
             {
                 func_num = malloc(10);
                 snprintf(func_num, 10, "%d", funcs + FUNC_OFFSET);
-                hashmap_put(map, cur.children[0].value.s, func_num);
+                hashmap_put(map, NODE(CHILD(cur, 0)).value.s, func_num);
                 funcs++;
             }
         }
     }
-    printf("\n.FUNCTIONS %d\n", funcs);
+    fprintf(ir_out, "\n.FUNCTIONS %d\n", funcs);
 
     funcs = FUNC_OFFSET;
     
     //for each file
     for(i = 0; i < num_trees; i++)
     {
+        tree = parse_trees + i;
         //for each root node
-        for(j = 0; j < parse_trees[i].num_children; j++)
+        for(j = 0, cur = CHILD(0, 0); j < NODE(0).num_children; j++, cur = flat_next(tree, cur))
         {
-            cur = parse_trees[i].children[j];
             //generate function code
-            if(cur.token == FUNCTION_DEF)
+            if(NODE(cur).token == FUNCTION_DEF)
             {
-                printf("\n.FUNC %d %s\n", funcs, cur.children[0].value.s);
+                fprintf(ir_out, "\n.FUNC %d %s\n", funcs, NODE(CHILD(cur, 0)).value.s);
                 generate_function_code(cur, map);
-                printf(".end FUNC\n");
+                fprintf(ir_out, ".end FUNC\n");
                 funcs++;
             }
         }
@@ -273,25 +302,25 @@ static int generate_functions(ast_node_t *parse_trees, int num_trees, map_t map)
     return 0;
 }
 
-static int generate_function_code(ast_node_t func, map_t map)
+static int generate_function_code(unsigned func, map_t map)
 {
     int locals = 0, i;
-    //ast_node_t cur;
-    map_t local_map = hashmap_new();
+    unsigned child;
+    map_t local_map = hashmap_new_interned();
 
     //set params
-    locals = count_slots(func.children[1], 'L', locals, local_map);
-    printf("  .params %d\n", locals);
-    printf("  .return %d\n", func.type != VOID);
+    locals = count_slots(CHILD(func, 1), 'L', locals, local_map);
+    fprintf(ir_out, "  .params %d\n", locals);
+    fprintf(ir_out, "  .return %d\n", NODE(func).type != VOID);
 
     //get local vars
-    locals = count_slots(func.children[2], 'L', locals, local_map);
-    printf("  .locals %d\n", locals);
+    locals = count_slots(CHILD(func, 2), 'L', locals, local_map);
+    fprintf(ir_out, "  .locals %d\n", locals);
 
-    for(i = 0; i < func.children[3].num_children; i++)
+    for(i = 0, child = CHILD(CHILD(func, 3), 0); i < NODE(CHILD(func, 3)).num_children; i++, child = flat_next(tree, child))
     {
-        if(generate_statement_code(func.children[3].children[i], map, local_map, NULL, NULL, 0))
-            printf("    popx\n");
+        if(generate_statement_code(child, map, local_map, NULL, NULL, 0))
+            fprintf(ir_out, "    popx\n");
     }
 
     hashmap_iterate(local_map, &clear_map, NULL);
@@ -299,126 +328,127 @@ static int generate_function_code(ast_node_t func, map_t map)
     return 0;
 }
 
-static int generate_statement_code(ast_node_t cur, map_t global, map_t local, char *into, char *around, int test)
+static int generate_statement_code(unsigned cur, map_t global, map_t local, char *into, char *around, int test)
 {
     char token[20], *address=NULL, t;
-    tok_to_str(token, cur.token);
+    tok_to_str(token, NODE(cur).token);
     int i;
+    unsigned child;
 
-    printf("    ;%s on line %d\n", token, cur.line_number);
+    fprintf(ir_out, "    ;%s on line %d\n", token, tree->line_numbers[cur]);
 
-    switch(cur.token)
+    switch(NODE(cur).token)
     {
         case '=':
-            address = get_address(local, global, cur.children[0].value.s);
-            if(cur.children[0].num_children)
+            address = get_address(local, global, NODE(CHILD(cur, 0)).value.s);
+            if(NODE(CHILD(cur, 0)).num_children)
             {
-                t = get_type_char(cur.children[0].type);
-                generate_statement_code(cur.children[0].children[0], global, local, into, around, 0);
-                printf("    ptrto %s\n", address);
-                generate_statement_code(cur.children[1], global, local, into, around, test);
-                printf("    copy\n    pop%c[]\n", t);
+                t = get_type_char(NODE(CHILD(cur, 0)).type);
+                generate_statement_code(CHILD(CHILD(cur, 0), 0), global, local, into, around, 0);
+                fprintf(ir_out, "    ptrto %s\n", address);
+                generate_statement_code(CHILD(cur, 1), global, local, into, around, test);
+                fprintf(ir_out, "    copy\n    pop%c[]\n", t);
             }
             else
             {
-                generate_statement_code(cur.children[1], global, local, into, around, 0);
-                printf("    copy\n    pop %s\n", address);
+                generate_statement_code(CHILD(cur, 1), global, local, into, around, 0);
+                fprintf(ir_out, "    copy\n    pop %s\n", address);
             }
             break;
         case RETURN:
-            if(cur.num_children)
+            if(NODE(cur).num_children)
             {
-                generate_statement_code(cur.children[0], global, local, into, around, 0);
+                generate_statement_code(CHILD(cur, 0), global, local, into, around, 0);
             }
-                printf("    ret\n");
+                fprintf(ir_out, "    ret\n");
             break;
         case BINARY_OP:
-            if(cur.value.i == DAMP || cur.value.i == DPIPE)
+            if(NODE(cur).value.i == DAMP || NODE(cur).value.i == DPIPE)
             {
                 generate_branching_code(cur, global, local, into, around, test);
             }
             else
             {
-                generate_statement_code(cur.children[0], global, local, into, around, test);
-                generate_statement_code(cur.children[1], global, local, into, around, test);
-                generate_binary_op_code(cur.value.i, cur.type, into, around, test);
+                generate_statement_code(CHILD(cur, 0), global, local, into, around, test);
+                generate_statement_code(CHILD(cur, 1), global, local, into, around, test);
+                generate_binary_op_code(NODE(cur).value.i, NODE(cur).type, into, around, test);
             }
             break;
         case FUNCTION_CALL:
-            address = get_address(global, NULL, cur.value.s);
-            for(i=0; cur.num_children && i<cur.children[0].num_children; i++)
+            address = get_address(global, NULL, NODE(cur).value.s);
+            for(i = 0, child = CHILD(CHILD(cur, 0), 0); NODE(cur).num_children && i < NODE(CHILD(cur, 0)).num_children; i++, child = flat_next(tree, child))
             {
-                generate_statement_code(cur.children[0].children[i], global,local, into, around, 0);
+                generate_statement_code(child, global,local, into, around, 0);
             }
-            printf("    call %s\n", address);
+            fprintf(ir_out, "    call %s\n", address);
             break;
         case CAST:
-            generate_statement_code(cur.children[0], global, local, into, around, test);
-            switch(cur.type)
+            generate_statement_code(CHILD(cur, 0), global, local, into, around, test);
+            switch(NODE(cur).type)
             {
                 case INT:
-                    if(cur.children[0].type == FLOAT)
-                        printf("    convif\n");
+                    if(NODE(CHILD(cur, 0)).type == FLOAT)
+                        fprintf(ir_out, "    convif\n");
                     break;
                 case CHAR:
-                    if(cur.children[0].type == FLOAT)
-                        printf("    convif\n");
-                    printf("    pushv 0xFF\n    &\n");
+                    if(NODE(CHILD(cur, 0)).type == FLOAT)
+                        fprintf(ir_out, "    convif\n");
+                    fprintf(ir_out, "    pushv 0xFF\n    &\n");
                     break;
                 case FLOAT:
-                    if(cur.children[0].type != FLOAT)
-                        printf("    convfi\n");
+                    if(NODE(CHILD(cur, 0)).type != FLOAT)
+                        fprintf(ir_out, "    convfi\n");
             }
             break;
         case '-':
-            t = get_type_char(cur.children[0].type);
-            generate_statement_code(cur.children[0], global, local, into, around, 0);
-            printf("    neg%c\n", t);
+            t = get_type_char(NODE(CHILD(cur, 0)).type);
+            generate_statement_code(CHILD(cur, 0), global, local, into, around, 0);
+            fprintf(ir_out, "    neg%c\n", t);
             break;
         case INCR:
-            t = get_type_char(cur.type);
+            t = get_type_char(NODE(cur).type);
             //array
-            if(cur.children[0].token == LVALUE && cur.children[0].num_children)
+            if(NODE(CHILD(cur, 0)).token == LVALUE && NODE(CHILD(cur, 0)).num_children)
             {
-                address = get_address(local, global, cur.children[0].value.s);
-                generate_statement_code(cur.children[0].children[0], global, local, into, around, 0);
-                printf("    ptrto %s\n", address);
-                generate_statement_code(cur.children[0], global, local, into, around, 0);
-                printf("    ++%c\n    copy\n    pop%c[]\n", t, t);
+                address = get_address(local, global, NODE(CHILD(cur, 0)).value.s);
+                generate_statement_code(CHILD(CHILD(cur, 0), 0), global, local, into, around, 0);
+                fprintf(ir_out, "    ptrto %s\n", address);
+                generate_statement_code(CHILD(cur, 0), global, local, into, around, 0);
+                fprintf(ir_out, "    ++%c\n    copy\n    pop%c[]\n", t, t);
             }
-            else if( cur.children[0].token == LVALUE)
+            else if( NODE(CHILD(cur, 0)).token == LVALUE)
             {
-                address = get_address(local, global, cur.children[0].value.s);
-                generate_statement_code(cur.children[0], global, local, into, around, 0);
-                printf("    ++%c\n    copy\n    pop %s\n", t, address);
+                address = get_address(local, global, NODE(CHILD(cur, 0)).value.s);
+                generate_statement_code(CHILD(cur, 0), global, local, into, around, 0);
+                fprintf(ir_out, "    ++%c\n    copy\n    pop %s\n", t, address);
             }
             else
             {
-                generate_statement_code(cur.children[0], global, local, into, around, 0);
-                printf("    ++%c\n", t);
+                generate_statement_code(CHILD(cur, 0), global, local, into, around, 0);
+                fprintf(ir_out, "    ++%c\n", t);
             }
             break;
         case DECR:
-            t = get_type_char(cur.type);
+            t = get_type_char(NODE(cur).type);
             //array
-            if(cur.children[0].token == LVALUE && cur.children[0].num_children)
+            if(NODE(CHILD(cur, 0)).token == LVALUE && NODE(CHILD(cur, 0)).num_children)
             {
-                address = get_address(local, global, cur.children[0].value.s);
-                generate_statement_code(cur.children[0].children[0], global, local, into, around, 0);
-                printf("    ptrto %s\n", address);
-                generate_statement_code(cur.children[0], global, local, into, around, 0);
-                printf("    --%c\n    copy\n    pop%c[]\n", t, t);
+                address = get_address(local, global, NODE(CHILD(cur, 0)).value.s);
+                generate_statement_code(CHILD(CHILD(cur, 0), 0), global, local, into, around, 0);
+                fprintf(ir_out, "    ptrto %s\n", address);
+                generate_statement_code(CHILD(cur, 0), global, local, into, around, 0);
+                fprintf(ir_out, "    --%c\n    copy\n    pop%c[]\n", t, t);
             }
-            else if (cur.children[0].token == LVALUE) 
+            else if (NODE(CHILD(cur, 0)).token == LVALUE) 
             {
-                address = get_address(local, global, cur.children[0].value.s);
-                generate_statement_code(cur.children[0], global, local, into, around, 0);
-                printf("    --%c\n    copy\n    pop %s\n", t, address);
+                address = get_address(local, global, NODE(CHILD(cur, 0)).value.s);
+                generate_statement_code(CHILD(cur, 0), global, local, into, around, 0);
+                fprintf(ir_out, "    --%c\n    copy\n    pop %s\n", t, address);
             }
             else
             {
-                generate_statement_code(cur.children[0], global, local, into, around, 0);
-                printf("    --%c\n", t);
+                generate_statement_code(CHILD(cur, 0), global, local, into, around, 0);
+                fprintf(ir_out, "    --%c\n", t);
             }
             break;
         case IF:
@@ -436,25 +466,25 @@ static int generate_statement_code(ast_node_t cur, map_t global, map_t local, ch
             }
             else
             {
-                fprintf(stderr, "branching statement on line %d not yet supported\n", cur.line_number);
+                fprintf(stderr, "branching statement on line %d not yet supported\n", tree->line_numbers[cur]);
             }
             break;
         case LVALUE:
-            address = get_address(local, global, cur.value.s);
-            printf("    push %s\n", address);
+            address = get_address(local, global, NODE(cur).value.s);
+            fprintf(ir_out, "    push %s\n", address);
             break;
         case INTCONST:
-            printf("    pushv 0x%x\n", cur.value.i);
+            fprintf(ir_out, "    pushv 0x%x\n", NODE(cur).value.i);
             break;
         case CHARCONST:
-            printf("    pushv 0x%x\n", cur.value.c);
+            fprintf(ir_out, "    pushv 0x%x\n", NODE(cur).value.c);
             break;
         case REALCONST:
-            printf("    pushv 0x%x\n", *(unsigned int*)&cur.value.f);
+            fprintf(ir_out, "    pushv 0x%x\n", *(unsigned int*)&NODE(cur).value.f);
             break;
         case STRCONST:
-            address = get_address(const_map, NULL, cur.value.s);
-            printf("    push %s\n", address);
+            address = get_address(const_map, NULL, NODE(cur).value.s);
+            fprintf(ir_out, "    push %s\n", address);
             break;
         default:
             fprintf(stderr, "collin you forgot to write a case for %s you idiot\n", token);
@@ -464,129 +494,129 @@ static int generate_statement_code(ast_node_t cur, map_t global, map_t local, ch
     return 0;
 }
 
-static int generate_branching_code(ast_node_t cur, map_t global, map_t local, char *into, char *around, int test)
+static int generate_branching_code(unsigned cur, map_t global, map_t local, char *into, char *around, int test)
 {
     char label[20], label1[20], label2[20], token[20];
-    ast_node_t cur2;
-    tok_to_str(token, cur.token);
+    unsigned cur2, child;
+    tok_to_str(token, NODE(cur).token);
     int i;
     
-    switch(cur.token)
+    switch(NODE(cur).token)
     {
         case IF:
             generate_label(label);
             generate_label(label1);
-            cur2 = cur.children[0];
-            generate_statement_code(cur2.children[0], global, local, label, label1, 1);
-            if(need_comparison(cur2.children[0]))
-                generate_binary_op_code(ZEQUAL, cur2.children[0].type, label1, label, 1);
-            printf("  %s:\n", label);
-            if(cur2.children[1].token == STATEMENT_BLOCK)
-            {
-                for(i = 0; i < cur2.children[1].num_children; i++)
+            cur2 = CHILD(cur, 0);
+            generate_statement_code(CHILD(cur2, 0), global, local, label, label1, 1);
+            if(need_comparison(CHILD(cur2, 0)))
+                generate_binary_op_code(ZEQUAL, NODE(CHILD(cur2, 0)).type, label1, label, 1);
+            fprintf(ir_out, "  %s:\n", label);
+            if(NODE(CHILD(cur2, 1)).token == STATEMENT_BLOCK)
+            {
+                for(i = 0, child = CHILD(CHILD(cur2, 1), 0); i < NODE(CHILD(cur2, 1)).num_children; i++, child = flat_next(tree, child))
                 {
-                    generate_statement_code(cur2.children[1].children[i], global, local, into, around, 0);
+                    generate_statement_code(child, global, local, into, around, 0);
                 }
             }
             else
             {
-                generate_statement_code(cur2.children[1], global, local, into, around, 0);
+                generate_statement_code(CHILD(cur2, 1), global, local, into, around, 0);
             }
 
-            if(cur.num_children == 2)
+            if(NODE(cur).num_children == 2)
             {
                 generate_label(label);
-                printf("    goto %s\n  %s:\n", label, label1);
-                cur2 = cur.children[1];
-                if(cur2.children[0].token == STATEMENT_BLOCK)
+                fprintf(ir_out, "    goto %s\n  %s:\n", label, label1);
+                cur2 = CHILD(cur, 1);
+                if(NODE(CHILD(cur2, 0)).token == STATEMENT_BLOCK)
                 {
-                    for(i = 0; i < cur2.children[0].num_children; i++)
+                    for(i = 0, child = CHILD(CHILD(cur2, 0), 0); i < NODE(CHILD(cur2, 0)).num_children; i++, child = flat_next(tree, child))
                     {
-                        generate_statement_code(cur2.children[0].children[i], global, local, into, around, 0);
+                        generate_statement_code(child, global, local, into, around, 0);
                     }
                 }
                 else
                 {
-                    generate_statement_code(cur2.children[0], global, local, into, around, 0);
+                    generate_statement_code(CHILD(cur2, 0), global, local, into, around, 0);
                 }
-                printf("  %s:\n", label);
+                fprintf(ir_out, "  %s:\n", label);
             }
             else
             {
-                printf("  %s:\n", label);
+                fprintf(ir_out, "  %s:\n", label);
             }
             break;
         case FOR:
             generate_label(label);
             generate_label(label1);
-            generate_statement_code(cur.children[0], global, local, NULL, NULL, 0);
-            printf("  %s:\n", label);
-            generate_statement_code(cur.children[1], global, local, NULL, label1, 1);
-            if(need_comparison(cur.children[1]))
-                generate_binary_op_code(ZEQUAL, cur.children[1].type, label1, NULL, 1);
-            if(cur.children[3].token == STATEMENT_BLOCK)
-            {
-                for(i = 0; i < cur.children[3].num_children; i++)
+            generate_statement_code(CHILD(cur, 0), global, local, NULL, NULL, 0);
+            fprintf(ir_out, "  %s:\n", label);
+            generate_statement_code(CHILD(cur, 1), global, local, NULL, label1, 1);
+            if(need_comparison(CHILD(cur, 1)))
+                generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 1)).type, label1, NULL, 1);
+            if(NODE(CHILD(cur, 3)).token == STATEMENT_BLOCK)
+            {
+                for(i = 0, child = CHILD(CHILD(cur, 3), 0); i < NODE(CHILD(cur, 3)).num_children; i++, child = flat_next(tree, child))
                 {
-                    generate_statement_code(cur.children[3].children[i], global, local, label, label1, 0);
+                    generate_statement_code(child, global, local, label, label1, 0);
                 }
             }
             else
             {
-                generate_statement_code(cur.children[3], global, local, label, label1, 0);
+                generate_statement_code(CHILD(cur, 3), global, local, label, label1, 0);
             }
-            generate_statement_code(cur.children[2], global, local, label, label1, 0);
-            printf("    goto %s\n  %s:", label, label1);
+            generate_statement_code(CHILD(cur, 2), global, local, label, label1, 0);
+            fprintf(ir_out, "    goto %s\n  %s:", label, label1);
             break;
         case WHILE:
             generate_label(label);
             generate_label(label1);
-            printf("  %s:\n", label);
-            generate_statement_code(cur.children[0], global, local, NULL, label1, 1);
-            if(need_comparison(cur.children[0]))
-                generate_binary_op_code(ZEQUAL, cur.children[0].type, label1, NULL, 1);
-            if(cur.children[1].token == STATEMENT_BLOCK)
+            fprintf(ir_out, "  %s:\n", label);
+            generate_statement_code(CHILD(cur, 0), global, local, NULL, label1, 1);
+            if(need_comparison(CHILD(cur, 0)))
+                generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 0)).type, label1, NULL, 1);
+            if(NODE(CHILD(cur, 1)).token == STATEMENT_BLOCK)
             {
-                for(i = 0; i < cur.children[1].num_children; i++)
+                for(i = 0, child = CHILD(CHILD(cur, 1), 0); i < NODE(CHILD(cur, 1)).num_children; i++, child = flat_next(tree, child))
                 {
-                    generate_statement_code(cur.children[1].children[i], global, local, label,  label1, 0);
+                    generate_statement_code(child, global, local, label,  label1, 0);
                 }
             }
             else
             {
-                generate_statement_code(cur.children[1], global, local, label, label1, 0);
+                generate_statement_code(CHILD(cur, 1), global, local, label, label1, 0);
             }
-            printf("    goto %s\n  %s:\n", label, label1);
+            fprintf(ir_out, "    goto %s\n  %s:\n", label, label1);
             break;
         case DO:
             generate_label(label);
             generate_label(label1);
             generate_label(label2);
-            printf("  %s:\n", label);
-            if(cur.children[1].token == STATEMENT_BLOCK)
+            fprintf(ir_out, "  %s:\n", label);
+            if(NODE(CHILD(cur, 1)).token == STATEMENT_BLOCK)
             {
-                for(i = 0; i < cur.children[1].num_children; i++)
+                for(i = 0, child = CHILD(CHILD(cur, 1), 0); i < NODE(CHILD(cur, 1)).num_children; i++, child = flat_next(tree, child))
                 {
-                    generate_statement_code(cur.children[1].children[i], global, local, label2, label1, 0);
+                    generate_statement_code(child, global, local, label2, label1, 0);
                 }
             }
             else
             {
-                generate_statement_code(cur.children[1], global, local, label2, label1, 0);
+                generate_statement_code(CHILD(cur, 1), global, local, label2, label1, 0);
             }
-            printf("  %s:\n", label2);
-            generate_statement_code(cur.children[0], global, local, label, label1, 1);
-            if(need_comparison(cur.children[0]))
-                generate_binary_op_code(ZNEQUAL, cur.children[0].type, label, NULL, 1);
-            printf("  %s:\n", label1);
+            fprintf(ir_out, "  %s:\n", label2);
+            generate_statement_code(CHILD(cur, 0), global, local, label, label1, 1);
+            if(need_comparison(CHILD(cur, 0)))
+                generate_binary_op_code(ZNEQUAL, NODE(CHILD(cur, 0)).type, label, NULL, 1);
+            fprintf(ir_out, "  %s:\n", label1);
             break;
         case CONTINUE:
             if(into)
-                printf("    goto %s\n", into);
+                fprintf(ir_out, "    goto %s\n", into);
             break;
         case BREAK:
             if(around)
-                printf("    goto %s\n", around);
+                fprintf(ir_out, "    goto %s\n", around);
             break;
         case ELSE:
             fprintf(stderr, "somehow i needed to process an ELSE by itself");
@@ -594,48 +624,48 @@ static int generate_branching_code(ast_node_t cur, map_t global, map_t local, ch
         case TURNARY:
             generate_label(label);
             generate_label(label1);
-            generate_statement_code(cur.children[0], global, local, NULL, label, 1);
-            if(need_comparison(cur.children[0]))
-                generate_binary_op_code(ZEQUAL, cur.children[0].type, label, NULL, 1);
-            generate_statement_code(cur.children[1], global, local, into, around, 0);
-            printf("    goto %s\n  %s:\n", label1, label);
-            generate_statement_code(cur.children[2], global, local, into, around, 0);
-            printf("  %s:\n", label1);
+            generate_statement_code(CHILD(cur, 0), global, local, NULL, label, 1);
+            if(need_comparison(CHILD(cur, 0)))
+                generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 0)).type, label, NULL, 1);
+            generate_statement_code(CHILD(cur, 1), global, local, into, around, 0);
+            fprintf(ir_out, "    goto %s\n  %s:\n", label1, label);
+            generate_statement_code(CHILD(cur, 2), global, local, into, around, 0);
+            fprintf(ir_out, "  %s:\n", label1);
             break;
         case BINARY_OP:
-            if(cur.value.i == DAMP)
+            if(NODE(cur).value.i == DAMP)
             {
                 if(test && around)
                 {
-                    generate_statement_code(cur.children[0], global, local, NULL, around, 1);
-                    if(need_comparison(cur.children[0]))
-                        generate_binary_op_code(ZEQUAL, cur.children[0].type, around, NULL, 1);
-                    generate_statement_code(cur.children[1], global, local, into, around, 1);
-                    if(need_comparison(cur.children[1]))
-                        generate_binary_op_code(ZEQUAL, cur.children[1].type, around, into, 1);
+                    generate_statement_code(CHILD(cur, 0), global, local, NULL, around, 1);
+                    if(need_comparison(CHILD(cur, 0)))
+                        generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 0)).type, around, NULL, 1);
+                    generate_statement_code(CHILD(cur, 1), global, local, into, around, 1);
+                    if(need_comparison(CHILD(cur, 1)))
+                        generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 1)).type, around, into, 1);
                 }
                 else if(test && into)
                 {
                     generate_label(label);
-                    generate_statement_code(cur.children[0], global, local, NULL, label, 1);
-                    if(need_comparison(cur.children[0]))
-                        generate_binary_op_code(ZEQUAL, cur.children[0].type, label, NULL, 1);
-                    generate_statement_code(cur.children[1], global, local, into, NULL, 1);
-                    if(need_comparison(cur.children[1]))
-                        generate_binary_op_code(ZEQUAL, cur.children[1].type, around, into, 1);
-                    printf("  %s:\n", label);
+                    generate_statement_code(CHILD(cur, 0), global, local, NULL, label, 1);
+                    if(need_comparison(CHILD(cur, 0)))
+                        generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 0)).type, label, NULL, 1);
+                    generate_statement_code(CHILD(cur, 1), global, local, into, NULL, 1);
+                    if(need_comparison(CHILD(cur, 1)))
+                        generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 1)).type, around, into, 1);
+                    fprintf(ir_out, "  %s:\n", label);
                 }
                 else
                 {
                     generate_label(label);
                     generate_label(label1);
-                    generate_statement_code(cur.children[0], global, local, NULL, label1, 1);
-                    if(need_comparison(cur.children[0]))
-                        generate_binary_op_code(ZEQUAL, cur.children[0].type,label1, NULL, 1);
-                    generate_statement_code(cur.children[1], global, local, NULL, label1, 1);
-                    if(need_comparison(cur.children[1]))
-                        generate_binary_op_code(ZEQUAL, cur.children[1].type, label1, NULL, 1);
-                    printf("    pushv 0x1\n    goto %s\n  %s:\n    pushv 0x0\n  %s:\n", label, label1, label);
+                    generate_statement_code(CHILD(cur, 0), global, local, NULL, label1, 1);
+                    if(need_comparison(CHILD(cur, 0)))
+                        generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 0)).type,label1, NULL, 1);
+                    generate_statement_code(CHILD(cur, 1), global, local, NULL, label1, 1);
+                    if(need_comparison(CHILD(cur, 1)))
+                        generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 1)).type, label1, NULL, 1);
+                    fprintf(ir_out, "    pushv 0x1\n    goto %s\n  %s:\n    pushv 0x0\n  %s:\n", label, label1, label);
                 }
                 break;
             }
@@ -643,35 +673,35 @@ static int generate_branching_code(ast_node_t cur, map_t global, map_t local, ch
             {
                 if(test && into)
                 {
-                    generate_statement_code(cur.children[0], global, local, into, NULL, 1);
-                    if(need_comparison(cur.children[0]))
-                        generate_binary_op_code(ZNEQUAL, cur.children[0].type, into, NULL, 1);
-                    generate_statement_code(cur.children[1], global, local, into, around, 1);
-                    if(need_comparison(cur.children[1]))
-                        generate_binary_op_code(ZNEQUAL, cur.children[1].type, into, around, 1);
+                    generate_statement_code(CHILD(cur, 0), global, local, into, NULL, 1);
+                    if(need_comparison(CHILD(cur, 0)))
+                        generate_binary_op_code(ZNEQUAL, NODE(CHILD(cur, 0)).type, into, NULL, 1);
+                    generate_statement_code(CHILD(cur, 1), global, local, into, around, 1);
+                    if(need_comparison(CHILD(cur, 1)))
+                        generate_binary_op_code(ZNEQUAL, NODE(CHILD(cur, 1)).type, into, around, 1);
                 }
                 else if(test && around)
                 {
                     generate_label(label);
-                    generate_statement_code(cur.children[0], global, local, label, NULL, 1);
-                    if(need_comparison(cur.children[0]))
-                        generate_binary_op_code(ZNEQUAL, cur.children[0].type, label, NULL, 1);
-                    generate_statement_code(cur.children[1], global, local, NULL, around, 1);
-                    if(need_comparison(cur.children[1]))
-                        generate_binary_op_code(ZEQUAL, cur.children[1].type, around, NULL, 1);
-                    printf("  %s:\n", label);
+                    generate_statement_code(CHILD(cur, 0), global, local, label, NULL, 1);
+                    if(need_comparison(CHILD(cur, 0)))
+                        generate_binary_op_code(ZNEQUAL, NODE(CHILD(cur, 0)).type, label, NULL, 1);
+                    generate_statement_code(CHILD(cur, 1), global, local, NULL, around, 1);
+                    if(need_comparison(CHILD(cur, 1)))
+                        generate_binary_op_code(ZEQUAL, NODE(CHILD(cur, 1)).type, around, NULL, 1);
+                    fprintf(ir_out, "  %s:\n", label);
                 }
                 else
                 {
                     generate_label(label);
                     generate_label(label1);
-                    generate_statement_code(cur.children[0], global, local, label, NULL, test);
-                    if(need_comparison(cur.children[0]))
-                        generate_binary_op_code(ZNEQUAL, cur.children[0].type, label, NULL, 1);
-                    generate_statement_code(cur.children[1], global, local, label, NULL, test);
-                    if(need_comparison(cur.children[1]))
-                        generate_binary_op_code(ZNEQUAL, cur.children[1].type, label, NULL, 1);
-                    printf("    pushv 0x0\n    goto %s\n  %s:\n    pushv 0x1\n  %s:\n", label1, label, label1);
+                    generate_statement_code(CHILD(cur, 0), global, local, label, NULL, test);
+                    if(need_comparison(CHILD(cur, 0)))
+                        generate_binary_op_code(ZNEQUAL, NODE(CHILD(cur, 0)).type, label, NULL, 1);
+                    generate_statement_code(CHILD(cur, 1), global, local, label, NULL, test);
+                    if(need_comparison(CHILD(cur, 1)))
+                        generate_binary_op_code(ZNEQUAL, NODE(CHILD(cur, 1)).type, label, NULL, 1);
+                    fprintf(ir_out, "    pushv 0x0\n    goto %s\n  %s:\n    pushv 0x1\n  %s:\n", label1, label, label1);
                 }
                 break;
             }
@@ -703,11 +733,11 @@ static void generate_binary_op_code(int op, int op_type, char *into, char *aroun
         case '%':
         case '/':
         case '*':
-            printf("    %c%c\n", op, code);
+            fprintf(ir_out, "    %c%c\n", op, code);
             break;
         case '&':
         case '|':
-            printf("    %c\n", op);
+            fprintf(ir_out, "    %c\n", op);
             break;
         case ZEQUAL:
         case ZNEQUAL:
@@ -720,25 +750,25 @@ static void generate_binary_op_code(int op, int op_type, char *into, char *aroun
             tok_to_str(type, op);
             if(test && into && around)
             {
-                printf("    %s%c %s\n", type, code, into);
-                printf("    goto %s\n", around);
+                fprintf(ir_out, "    %s%c %s\n", type, code, into);
+                fprintf(ir_out, "    goto %s\n", around);
             }
             else if(test && into)
             {
 
-                printf("    %s%c %s\n", type, code, into);
+                fprintf(ir_out, "    %s%c %s\n", type, code, into);
             }
             else if(test && around)
             {
                 invert_operation(type, op);
-                printf("    %s%c %s\n", type, code, around);
+                fprintf(ir_out, "    %s%c %s\n", type, code, around);
             }
             else
             {
                 generate_label(label1);
                 generate_label(label2);
-                printf("    %s%c %s\n    pushv 0x0\n    goto %s\n", type, code, label1, label2);
-                printf("  %s:\n    pushv 0x1\n  %s:\n", label1, label2);
+                fprintf(ir_out, "    %s%c %s\n    pushv 0x0\n    goto %s\n", type, code, label1, label2);
+                fprintf(ir_out, "  %s:\n    pushv 0x1\n  %s:\n", label1, label2);
             }
             break;
     }
@@ -784,49 +814,48 @@ static void generate_label(char *ans)
     label_number++;
 }
 
-static int count_slots(ast_node_t base, char prepend, int vars, map_t map)
+static int count_slots(unsigned base, char prepend, int vars, map_t map)
 {
     int i, j;
     char *var_name;
-    ast_node_t cur;
+    unsigned cur, name;
 
     //for each variable node
-    for(i = 0; i < base.num_children; i++)
+    for(i = 0, cur = CHILD(base, 0); i < NODE(base).num_children; i++, cur = flat_next(tree, cur))
     {
-        cur = base.children[i];
-        if(cur.token == VARIABLE)
+        if(NODE(cur).token == VARIABLE)
         {
             //for each identifier add up slots and add to global total
-            for(j = 0; j < cur.num_children; j++)
+            for(j = 0, name = CHILD(cur, 0); j < NODE(cur).num_children; j++, name = flat_next(tree, name))
             {
                 var_name = malloc(sizeof(char) * 10);
                 snprintf(var_name, 10, "%c%d", prepend, vars);
-                hashmap_put(map, cur.children[j].value.s, var_name);
+                hashmap_put(map, NODE(name).value.s, var_name);
                 vars++;
-                if(cur.children[j].type & ARRAY)
-                    vars += cur.children[j].array_size -1;
+                if(NODE(name).type & ARRAY)
+                    vars += tree->array_sizes[name] -1;
             }
         }
-        else if(cur.token == TYPE_NAME)
+        else if(NODE(cur).token == TYPE_NAME)
         {
             var_name = malloc(sizeof(char) * 10);
             snprintf(var_name, 10, "%c%d", prepend, vars);
-            hashmap_put(map, cur.value.s, var_name);
+            hashmap_put(map, NODE(cur).value.s, var_name);
             vars++;
-            if(cur.type & ARRAY)
-                vars += cur.array_size - 1;
+            if(NODE(cur).type & ARRAY)
+                vars += tree->array_sizes[cur] - 1;
         }
     }
 
     return vars;
 }
 
-static int need_comparison(ast_node_t token)
+static int need_comparison(unsigned token)
 {
 
-    if(token.token == BINARY_OP)
+    if(NODE(token).token == BINARY_OP)
     {
-        switch(token.value.i)
+        switch(NODE(token).value.i)
         {
             case EQUAL:
             case NEQUAL:
@@ -3,59 +3,222 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "../../includes/stackvm.h"
 
 //#define DEBUG_PARSER
 //#define DEBUG_LABELS
-//#define SHOW_PROGRAM
 //#define SHOW_EXECUTION
 //#define SHOW_STACK
 
-void runtimeError(const char* e);
+/*
+  Memory segments.  Each is its own anonymous mapping, reserved up
+  front with MAP_NORESERVE so pages only cost anything once touched,
+  and placed to end exactly at a guard region.  Anything that runs off
+  the end of a segment faults there, and the SIGSEGV handler turns
+  that into the runtime error the segment was set up with; so stacks
+  need no overflow test on every push.  Integer division by zero, or
+  of INT_MIN by -1, is caught the same way from SIGFPE, so divisions
+  need no test either.
+*/
+
+int hugePages = 0;
+
+#define GUARD_BYTES   (64u << 10)
+/* each context takes three, and a green thread is a context */
+#define MAX_GUARDS    (1u << 15)
 
 /*
-  Conversion
+  Guards are added under guardLock and published by bumping nguards,
+  so the handler can read them without it.  A region that is let go
+  of keeps its entry, with no what, until another takes it over.
 */
-int u2i(unsigned x)
+typedef struct {
+  const char* lo;
+  const char* hi;
+  const char* volatile what;
+} guard_region;
+
+static guard_region guards[MAX_GUARDS];
+static unsigned nguards;
+static pthread_mutex_t guardLock = PTHREAD_MUTEX_INITIALIZER;
+
+static void faultError(const char* what) __attribute__((noreturn));
+
+static void guardFault(int sig, siginfo_t* info, void* context)
 {
-  return *((int*)(&x));
+  const char* at = info->si_addr;
+  unsigned n = __atomic_load_n(&nguards, __ATOMIC_ACQUIRE);
+  unsigned i;
+  for (i=0; i<n; i++) {
+    const char* what = guards[i].what;
+    if (what && at >= guards[i].lo && at < guards[i].hi) faultError(what);
+  }
+  /* a real crash; fault again without us */
+  signal(SIGSEGV, SIG_DFL);
 }
 
-float u2f(unsigned x)
+/* Only engine code divides integers, so any SIGFPE is the program's */
+static void divideFault(int sig, siginfo_t* info, void* context)
 {
-  return *((float*)(&x));
+  faultError("division by zero or overflow");
 }
 
-unsigned i2u(int x)
+/*
+  Each thread that sets up guards gets an alternate signal stack of
+  its own, so a guard on its native stack can be reported, unless it
+  has one already.  It goes away with the thread.
+*/
+#define ALTSTACK_BYTES  (64u << 10)
+
+static pthread_key_t altstackKey;
+static pthread_once_t altstackOnce = PTHREAD_ONCE_INIT;
+
+static void freeAltstack(void* altstack)
 {
-  return *((unsigned*)(&x));
+  stack_t ss;
+  memset(&ss, 0, sizeof(ss));
+  ss.ss_flags = SS_DISABLE;
+  sigaltstack(&ss, 0);
+  munmap(altstack, ALTSTACK_BYTES);
 }
 
-unsigned f2u(float x)
+static void makeAltstackKey()
 {
-  return *((unsigned*)(&x));
+  pthread_key_create(&altstackKey, freeAltstack);
 }
 
-/*
-  Memory segments
-*/
+static void threadAltstack()
+{
+  pthread_once(&altstackOnce, makeAltstackKey);
+  if (pthread_getspecific(altstackKey)) return;
+  stack_t ss;
+  if (0==sigaltstack(0, &ss) && !(ss.ss_flags & SS_DISABLE)) return;
+  void* altstack = mmap(0, ALTSTACK_BYTES, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (MAP_FAILED == altstack) return;
+  ss.ss_sp = altstack;
+  ss.ss_size = ALTSTACK_BYTES;
+  ss.ss_flags = 0;
+  if (sigaltstack(&ss, 0)) {
+    munmap(altstack, ALTSTACK_BYTES);
+    return;
+  }
+  pthread_setspecific(altstackKey, altstack);
+}
 
-typedef struct {
-  unsigned* mem_base;
-  unsigned* data;
-  size_t size;
-} segment;
+void guardRegion(void* at, size_t bytes, const char* what)
+{
+  threadAltstack();
+  pthread_mutex_lock(&guardLock);
+  if (0==nguards) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = guardFault;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigaction(SIGSEGV, &sa, 0);
+    sa.sa_sigaction = divideFault;
+    sigaction(SIGFPE, &sa, 0);
+  }
+  unsigned i;
+  for (i=0; i<nguards && guards[i].what; i++);
+  if (i < MAX_GUARDS) {
+    guards[i].lo = at;
+    guards[i].hi = (char*) at + bytes;
+    guards[i].what = what;
+    if (i == nguards) __atomic_store_n(&nguards, i+1, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&guardLock);
+}
 
-void initSegment(segment* S, size_t slots)
+static void unguardRegion(void* at)
 {
-  S->size = slots;
-  S->mem_base = (unsigned*) malloc (slots * sizeof(unsigned));
-  if ( (slots>0) && (0==S->mem_base) ) {
-    fprintf(stderr, "Error - couldn't allocate memory segment\n");
-    exit(2);
+  pthread_mutex_lock(&guardLock);
+  unsigned i;
+  for (i=0; i<nguards; i++) {
+    if (guards[i].lo == at) guards[i].what = 0;
   }
+  pthread_mutex_unlock(&guardLock);
+}
+
+void initSegment(segment* S, size_t slots, const char* overflow)
+{
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t bytes = (slots * sizeof(unsigned) + page - 1) / page * page;
+  char* base = mmap(0, bytes + GUARD_BYTES, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (MAP_FAILED == base) {
+    fprintf(vmErrors(), "Error - couldn't reserve a memory segment of %zu slots\n", slots);
+    vmExit(2);
+  }
+#ifdef MADV_HUGEPAGE
+  if (hugePages) madvise(base, bytes, MADV_HUGEPAGE);
+#endif
+  mprotect(base + bytes, GUARD_BYTES, PROT_NONE);
+  guardRegion(base + bytes, GUARD_BYTES, overflow);
+
+  S->size = slots;
+  S->mem_base = (unsigned*) (base + bytes) - slots;
   S->data = S->mem_base;
 }
 
+/*
+  Give back the end of a segment that won't be used: from the first
+  page boundary past slots, it becomes part of the guard.
+*/
+void shrinkSegment(segment* S, size_t slots, const char* overflow)
+{
+  assert(slots <= S->size);
+  size_t page = sysconf(_SC_PAGESIZE);
+  unsigned long lo = (unsigned long) (S->data + slots);
+  unsigned long hi = (unsigned long) (S->data + S->size);
+  lo = (lo + page - 1) / page * page;
+  if (lo < hi) {
+    mprotect((void*) lo, hi - lo, PROT_NONE);
+    guardRegion((void*) lo, hi - lo, overflow);
+  }
+  S->size = slots;
+}
+
+/*
+  Start of the mapping initSegment made for S, and its length up to
+  the guard
+*/
+static char* segmentMapping(const segment* S, size_t* bytes)
+{
+  size_t page = sysconf(_SC_PAGESIZE);
+  unsigned long lo = (unsigned long) S->mem_base / page * page;
+  unsigned long hi = (unsigned long) (S->mem_base + S->size);
+  *bytes = (hi + page - 1) / page * page - lo;
+  return (char*) lo;
+}
+
+/*
+  Throw away everything written to a segment from initSegment; it
+  reads as zeroes again, and its pages go back to the system.
+*/
+void clearSegment(const segment* S)
+{
+  size_t bytes;
+  char* base = segmentMapping(S, &bytes);
+  madvise(base, bytes, MADV_DONTNEED);
+}
+
+/* Unmap a segment from initSegment that was never shrunk */
+void freeSegment(segment* S)
+{
+  size_t bytes;
+  char* base = segmentMapping(S, &bytes);
+  unguardRegion(base + bytes);
+  munmap(base, bytes + GUARD_BYTES);
+  S->mem_base = S->data = 0;
+  S->size = 0;
+}
+
 void makeSubSegment(const segment* mainSeg, size_t off, size_t cap, segment* piece)
 {
   assert(off <= cap);
@@ -85,12 +248,6 @@ void showSegment(segment* S)
   Stack functions
 */
 
-typedef struct {
-  size_t size;
-  unsigned* data;
-  size_t top;
-} stack;
-
 void initStack(const segment* seg, size_t off, stack* S)
 {
   S->size = seg->size - off;
@@ -135,13 +292,10 @@ unsigned pop(stack* S)
   }
 }
 
+/* Overflow runs into the guard after the stack segment */
 void push(stack* S, unsigned d)
 {
-  if (S->top >= S->size) {
-    runtimeError("Stack overflow");
-  } else {
-    S->data[S->top++] = d;
-  }
+  S->data[S->top++] = d;
 }
 
 void move(stack* S, unsigned slots)
@@ -174,57 +328,6 @@ void showStack(FILE* out, const char* name, stack* S)
   Code
 */
 
-/*
-  Instruction types
-*/
-typedef enum {
-  PUSH, PTRTO, PUSHv, PUSHc, PUSHi, PUSHf, 
-  COPY, MOVE,
-  POPX, POP, POPc, POPi, POPf,
-
-  CALL, RET,
-
-  INCc, INCi, INCf,
-  DECc, DECi, DECf,
-  NEGc, NEGi, NEGf,
-  FLIP, CONVif, CONVfi,
-
-  PLUSc, PLUSi, PLUSf,
-  MINUSc, MINUSi, MINUSf,
-  STARc, STARi, STARf,
-  SLASHc, SLASHi, SLASHf,
-  MODc, MODi,
-  AND, OR,
-
-  GOTO, 
-  IFZc, IFZi, IFZf,
-  IFNZc, IFNZi, IFNZf,
-  IFEQc, IFEQi, IFEQf,
-  IFNEc, IFNEi, IFNEf,
-  IFLTc, IFLTi, IFLTf,
-  IFLEc, IFLEi, IFLEf,
-  IFGTc, IFGTi, IFGTf,
-  IFGEc, IFGEi, IFGEf,
-  NONE,
-  ERROR
-} opcode;
-
-/*
-  Address types
-*/
-typedef enum {
-  CONST='C', GLOBAL='G', LOCAL='L', LABEL=':', FNUM='f', VALUE='v', UNUSED=' ', MOVEDIST='m'
-} address_type;
-
-/*
-  Complete instructions
-*/
-typedef struct {
-  opcode op;
-  address_type atype;
-  unsigned addr;
-} instruction;
-
 void showInstruction(FILE* out, instruction I)
 {
   switch (I.op) {
@@ -303,53 +406,28 @@ void showInstruction(FILE* out, instruction I)
     case IFGEi:   fprintf(out, ">=i %u", I.addr); return;
     case IFGEf:   fprintf(out, ">=f %u", I.addr); return;
 
+    case PLUSiLL: fprintf(out, "+i L%u L%u", I.addr, I.addr2); return;
+    case PLUSiLV: fprintf(out, "+i L%u %u", I.addr, I.addr2); return;
+    case MINUSiLL:fprintf(out, "-i L%u L%u", I.addr, I.addr2); return;
+    case MINUSiLV:fprintf(out, "-i L%u %u", I.addr, I.addr2); return;
+    case IFEQiLL: fprintf(out, "==i L%u L%u %u", I.addr2, I.addr3, I.addr); return;
+    case IFNEiLL: fprintf(out, "!=i L%u L%u %u", I.addr2, I.addr3, I.addr); return;
+    case IFLTiLL: fprintf(out, "<i L%u L%u %u", I.addr2, I.addr3, I.addr); return;
+    case IFLEiLL: fprintf(out, "<=i L%u L%u %u", I.addr2, I.addr3, I.addr); return;
+    case IFGTiLL: fprintf(out, ">i L%u L%u %u", I.addr2, I.addr3, I.addr); return;
+    case IFGEiLL: fprintf(out, ">=i L%u L%u %u", I.addr2, I.addr3, I.addr); return;
+    case IFEQiLV: fprintf(out, "==i L%u %u %u", I.addr2, I.addr3, I.addr); return;
+    case IFNEiLV: fprintf(out, "!=i L%u %u %u", I.addr2, I.addr3, I.addr); return;
+    case IFLTiLV: fprintf(out, "<i L%u %u %u", I.addr2, I.addr3, I.addr); return;
+    case IFLEiLV: fprintf(out, "<=i L%u %u %u", I.addr2, I.addr3, I.addr); return;
+    case IFGTiLV: fprintf(out, ">i L%u %u %u", I.addr2, I.addr3, I.addr); return;
+    case IFGEiLV: fprintf(out, ">=i L%u %u %u", I.addr2, I.addr3, I.addr); return;
+
     case NONE:    fprintf(out, "no-op"); return;
     case ERROR:   fprintf(out, "error"); return;
   }
 }
 
-/*
-  Function data
-*/
-
-typedef struct {
-  char* name;
-  unsigned parameter_slots;
-  unsigned return_slots;
-  unsigned local_slots;
-  instruction* code;
-  unsigned code_length;
-} function;
-
-void zeroFunc(function *F)
-{
-  assert(F);
-  F->name = 0;
-  F->parameter_slots = 0;
-  F->return_slots = 0;
-  F->local_slots = 0;
-  F->code = 0;
-  F->code_length = 0;
-}
-
-const unsigned BUILTIN_FUNCTIONS = 2;
-
-void initBuiltins(function* F)
-{
-  assert(F);
-  /*
-    Builtin 0: int getchar()
-  */
-  F[0].name = strdup("getchar");
-  F[0].return_slots = 1;
-  /*
-    Builtin 1: int putchar(int)
-  */
-  F[1].name = strdup("putchar");
-  F[1].parameter_slots = 1;
-  F[1].return_slots = 1;
-}
-
 /*
   probably also:
 
@@ -371,6 +449,16 @@ void showFunction(FILE* out, unsigned fnum, function* F)
   }
   fprintf(out, "    instructions:\n");
   unsigned i;
+  if (F->packed) {
+    unsigned* offset = packedOffsets(F);
+    for (i=0; i<F->code_length; i++) {
+      fprintf(out, "\t%4u ", sourceInstruction(F, i));
+      showPacked(out, F, offset[i]);
+      fprintf(out, "\n");
+    }
+    free(offset);
+    return;
+  }
   for (i=0; i<F->code_length; i++) {
     fprintf(out, "\t%4u ", i);
     showInstruction(out, F->code[i]);
@@ -379,711 +467,115 @@ void showFunction(FILE* out, unsigned fnum, function* F)
 }
 
 /*
-
-  Input file parsing
-
+  Code execution
 */
 
-int lineno;
-
-void compileError(const char* s)
-{
-  fprintf(stderr, "Error line %d: %s\n", lineno, s);
-  exit(1);
-}
-
-void compileError2(const char* s, const char* s2)
-{
-  fprintf(stderr, "Error line %d: %s%s\n", lineno, s, s2);
-  exit(1);
-}
-
-void compileError3(const char* s, const char* s2, const char* s3)
-{
-  fprintf(stderr, "Error line %d: %s%s%s\n", lineno, s, s2, s3);
-  exit(1);
-}
-
-void compileError3u(const char* s, unsigned s2, const char* s3)
-{
-  fprintf(stderr, "Error line %d: %s%u%s\n", lineno, s, s2, s3);
-  exit(1);
-}
-
-void compileError4(const char* s, const char* s2, const char* s3, const char* s4)
-{
-  fprintf(stderr, "Error line %d: %s%s%s%s\n", lineno, s, s2, s3, s4);
-  exit(1);
-}
-
-void skipWS(FILE* in)
-{
-  char in_comment = 0;
-  for (;;) {
-    int c = fgetc(in);
-    if ('\n' == c) {
-      lineno++;
-      in_comment = 0;
-      continue;
-    }
-    if (in_comment) continue;
-    if (' ' == c) continue;
-    if ('\t' == c) continue;
-    if ('\r' == c) continue;
-    if (';' == c) {
-      in_comment = 1;
-      continue;
-    }
-    /* Actual character or EOF, put it back */
-    ungetc(c, in);
-    return;
-  }
-}
-
-void matchKeyword(FILE* in, const char* keyword)
-{
-  skipWS(in);
-  while (*keyword) {
-    int c = fgetc(in); 
-    if (c == *keyword) {
-      keyword++;
-      continue;
-    }
-    compileError2("expected ", keyword);
-  }
-}
-
-unsigned readHex(FILE* in)
-{
-  skipWS(in);
-  unsigned out;
-  int ok = fscanf(in, "%x", &out);
-  if (ok != 1) {
-    compileError("expected hex value");
-  }
-  return out;
-}
-
-unsigned readUnsigned(FILE* in, const char* what)
+static unsigned errorInstruction(const vm_context* C)
 {
-  skipWS(in);
-  unsigned out;
-  int ok = fscanf(in, "%u", &out);
-  if (ok != 1) {
-    compileError2("expected ", what);
-  }
-  return out;
+  unsigned pc = C->instruction;
+  if (C->packed_pc) pc = packedIndex(C->executing, pc);
+  return sourceInstruction(C->executing, pc);
 }
 
-unsigned readLabel(FILE* in)
+/*
+  For faultError, which can't use stdio
+*/
+static char* appendText(char* p, char* end, const char* s)
 {
-  skipWS(in);
-  unsigned out;
-  int ok = fscanf(in, "I%u:", &out);
-  if (ok != 1) {
-    compileError("expected label");
-  }
-  return out; 
+  while (*s && p < end) *p++ = *s++;
+  return p;
 }
 
-void readAddress(FILE* in, instruction *I)
+static char* appendNumber(char* p, char* end, unsigned u)
 {
-  assert(I);
-  skipWS(in);
-  int c = fgetc(in);
-  switch (c) {
-    case CONST:
-    case GLOBAL:
-    case LOCAL:
-        I->atype = c;
-        I->addr = readUnsigned(in, "address");
-        return;
-
-    default:
-        compileError("expected address type C, G, or L");
-  }
+  char digits[10];
+  unsigned n = 0;
+  do {
+    digits[n++] = '0' + u % 10;
+    u /= 10;
+  } while (u);
+  while (n && p < end) *p++ = digits[--n];
+  return p;
 }
 
 /*
-  Return true if we fit into the buffer
+  runtimeError for a guard fault or a division, called in the SIGSEGV
+  or SIGFPE handler: only async-signal-safe calls, see vmRecovered.
+  Leaving the handler with siglongjmp is fine here, since both only
+  ever happen in engine code, never in the middle of a library call.
 */
-char readToken(FILE* in, char* buffer, int bufsize)
+static void faultError(const char* what)
 {
-  skipWS(in);
-  int i;
-  for (i=0; i<bufsize; i++) {
-    int c = fgetc(in);
-    if ( (EOF==c) || (' '==c) || ('\n'==c) || ('\t'==c) || ('\r'==c) || (';'==c)) {
-      ungetc(c, in);
-      buffer[i] = 0;
-      return 1;
-    }
-    buffer[i] = c;
+  vm_context* C = vmCurrent;
+  char* p = C->fault;
+  char* end = C->fault + VM_FAULT - 1;
+  p = appendText(p, end, "Runtime error");
+  if (C->executing) {
+    p = appendText(p, end, " in function ");
+    p = appendText(p, end, C->executing->name);
+    p = appendText(p, end, " instruction ");
+    p = appendNumber(p, end, errorInstruction(C));
   }
-  return 0;
-}
-
-char* readIdent(FILE* in)
-{
-  skipWS(in);
-  const int bufsize = 256;  // max identifier length
-  char buffer[bufsize];
-  int i;
-  for (i=0; i<bufsize; i++) {
-    int c = fgetc(in);
-    if ( ('_' == c) || (c>='a' && c<='z') || (c>='A' && c<='Z') )
-    {
-      buffer[i] = c;
-      continue;
+  p = appendText(p, end, ":\n");
+  p = appendText(p, end, what);
+  p = appendText(p, end, "\n");
+  *p = 0;
+
+  if (0==C->recover) {
+    ioFlush();
+    const char* q = C->fault;
+    while (q < p) {
+      ssize_t w = write(2, q, p - q);
+      if (w <= 0) break;
+      q += w;
     }
-    ungetc(c, in);
-    buffer[i] = 0;
-    return strdup(buffer);
-  }
-  compileError("identifier too long");
-  return 0; // keep compilers happy
-}
-
-opcode string2opcode(const char* buffer)
-{
-  /*
-    Abandon hope all ye who enter here.
-  */
-
-  if (0==buffer) return ERROR;
-  switch (buffer[0]) {
-    case 0: return NONE;  // empty string
-
-    case 'c': 
-        // call, convif, convfi, copy
-        switch (buffer[1]) {
-          case 'a': return strcmp("ll", buffer+2) ? ERROR : CALL;
-          case 'o':
-              switch (buffer[2]) {
-                case 'p': return strcmp("y", buffer+3) ? ERROR : COPY;
-                case 'n':
-                    if ('v' != buffer[3]) return ERROR;
-                    switch (buffer[4]) {
-                      case 'f': return strcmp("i", buffer+5) ? ERROR : CONVfi;
-                      case 'i': return strcmp("f", buffer+5) ? ERROR : CONVif;
-                      default : return ERROR;
-                    }
-                default : return ERROR;
-              }
-          default : return ERROR;
-        }
-        return ERROR;
-
-    case 'f':
-        // flip
-        return strcmp("lip", buffer+1) ? ERROR : FLIP;
-
-    case 'g':
-        // goto
-        return strcmp("oto", buffer+1) ? ERROR : GOTO;
-
-    case 'm':
-        // move
-        return strcmp("ove", buffer+1) ? ERROR : MOVE;
-
-    case 'n':
-        // neg<type>
-        if ( ('e'==buffer[1]) && ('g'==buffer[2]) ) {
-          switch (buffer[3]) {
-            case 'c': return NEGc;
-            case 'i': return NEGi;
-            case 'f': return NEGf;
-            default : return ERROR;
-          }
-        }
-        return ERROR;
-
-    case 'p':
-        // pop, popx, popc[], popi[], popf[]
-        if (('o' == buffer[1]) && ('p'==buffer[2])) {
-          // one of the pops
-          switch (buffer[3]) {
-              case 0:   return POP;
-              case 'c': return strcmp("[]", buffer+4) ? ERROR : POPc;
-              case 'i': return strcmp("[]", buffer+4) ? ERROR : POPi;
-              case 'f': return strcmp("[]", buffer+4) ? ERROR : POPf;
-              case 'x': return buffer[4] ? ERROR : POPX;
-              default : return ERROR;
-          }
-          // sanity check
-          return ERROR;
-        }
-        // ptrto
-        if ('t' == buffer[1]) return strcmp("rto", buffer+2) ? ERROR : PTRTO;
-        // push, pushc, pushi, pushf
-        if (('u' == buffer[1]) && ('s'==buffer[2]) && ('h'==buffer[3])) {
-          // one of the pushes
-          switch (buffer[4]) {
-              case 0:   return PUSH;
-              case 'v': return buffer[5] ? ERROR : PUSHv;
-              case 'c': return strcmp("[]", buffer+5) ? ERROR : PUSHc;
-              case 'i': return strcmp("[]", buffer+5) ? ERROR : PUSHi;
-              case 'f': return strcmp("[]", buffer+5) ? ERROR : PUSHf;
-              default : return ERROR;
-          }
-        }
-        return ERROR;
-
-    case 'r':
-        // ret
-        return strcmp("et", buffer+1) ? ERROR : RET;
-
-    case '+':
-        // +t or ++t
-        switch (buffer[1]) {
-          case 'c': return PLUSc;
-          case 'i': return PLUSi;
-          case 'f': return PLUSf;
-          case '+':
-              switch (buffer[2]) {
-                case 'c': return INCc;
-                case 'i': return INCi;
-                case 'f': return INCf;
-                default : return ERROR;
-              }
-          default : return ERROR;
-        }
-        // sanity check
-        return ERROR;
-
-    case '-':
-        // -t or --t
-        switch (buffer[1]) {
-          case 'c': return MINUSc;
-          case 'i': return MINUSi;
-          case 'f': return MINUSf;
-          case '-':
-              switch (buffer[2]) {
-                case 'c': return DECc;
-                case 'i': return DECi;
-                case 'f': return DECf;
-                default : return ERROR;
-              }
-          default : return ERROR;
-        }
-        // sanity check
-        return ERROR;
-
-    case '*':
-        // *t
-        switch (buffer[1]) {
-          case 'c': return STARc;
-          case 'i': return STARi;
-          case 'f': return STARf;
-          default : return ERROR;
-        }
-        // sanity check
-        return ERROR;
-
-    case '/':
-        // /t
-        switch (buffer[1]) {
-          case 'c': return SLASHc;
-          case 'i': return SLASHi;
-          case 'f': return SLASHf;
-          default : return ERROR;
-        }
-        // sanity check
-        return ERROR;
-
-    case '%':
-        // %t
-        switch (buffer[1]) {
-          case 'c': return MODc;
-          case 'i': return MODi;
-          default : return ERROR;
-        }
-        // sanity check
-        return ERROR;
-
-    case '&':
-        return (0==buffer[1]) ? AND : ERROR;
-
-    case '|':
-        return (0==buffer[1]) ? OR  : ERROR;
-
-    case '=':
-        // ==0t or ==t
-        if (buffer[1] != '=') return ERROR;
-        switch (buffer[2]) {
-          case 'c': return IFEQc;
-          case 'i': return IFEQi;
-          case 'f': return IFEQf;
-          case '0':
-              switch (buffer[3]) {
-                case 'c': return IFZc;
-                case 'i': return IFZi;
-                case 'f': return IFZf;
-                default : return ERROR;
-              }
-          default : return ERROR;
-        }
-        // sanity check
-        return ERROR;
-
-    case '!':
-        // !=0t or !=t
-        if (buffer[1] != '=') return ERROR;
-        switch (buffer[2]) {
-          case 'c': return IFNEc;
-          case 'i': return IFNEi;
-          case 'f': return IFNEf;
-          case '0':
-              switch (buffer[3]) {
-                case 'c': return IFNZc;
-                case 'i': return IFNZi;
-                case 'f': return IFNZf;
-                default : return ERROR;
-              }
-          default : return ERROR;
-        }
-        // sanity check
-        return ERROR;
-
-    case '<':
-        // <t or <=t
-        switch (buffer[1]) {
-          case 'c': return IFLTc;
-          case 'i': return IFLTi;
-          case 'f': return IFLTf;
-          case '=':
-              switch (buffer[2]) {
-                case 'c': return IFLEc;
-                case 'i': return IFLEi;
-                case 'f': return IFLEf;
-                default : return ERROR;
-              }
-          default : return ERROR;
-        }
-        // sanity check
-        return ERROR;
-
-    case '>':
-        // >t or >=t
-        switch (buffer[1]) {
-          case 'c': return IFGTc;
-          case 'i': return IFGTi;
-          case 'f': return IFGTf;
-          case '=':
-              switch (buffer[2]) {
-                case 'c': return IFGEc;
-                case 'i': return IFGEi;
-                case 'f': return IFGEf;
-                default : return ERROR;
-              }
-          default : return ERROR;
-        }
-        // sanity check
-        return ERROR;
-
-    default:
-        return ERROR;
-  }
-  // sanity check
-  return ERROR;
-}
-
-
-unsigned readConstants(FILE* in, segment* Mem)
-{
-  matchKeyword(in, ".CONSTANTS");
-  unsigned slots = readUnsigned(in, "#constants");
-  unsigned i;
-  for (i=0; i<slots; i++) {
-    Mem->data[i] = readHex(in);
+    _exit(2);
   }
-  return slots;
-}
-
-unsigned readGlobals(FILE* in)
-{
-  matchKeyword(in, ".GLOBALS");
-  return readUnsigned(in, "#globals");
-}
-
-unsigned readFunctions(FILE* in)
-{
-  matchKeyword(in, ".FUNCTIONS");
-  return readUnsigned(in, "#functions");
-}
-
-instruction finishReading(FILE* in, function* f, unsigned nc, unsigned ng, opcode op)
-{
-  assert(f);
-
-  instruction I;
-  I.op = op;
-
-  switch (op) {
-    /*
-      Cases that require an address
-    */
-    case PUSH:
-    case PTRTO:
-        readAddress(in, &I);
-        switch (I.atype) {
-          case CONST:   if (I.addr >= nc) compileError("constant index too large");
-                        break;
-          case GLOBAL:  if (I.addr >= ng) compileError("global index too large");
-                        break;
-          case LOCAL:   if (I.addr >= f->parameter_slots + f->local_slots) {
-                          compileError("local index too large");
-                        }
-                        break;
-          default:
-                        /* Should have caught this error already */
-                        fprintf(stderr, "Internal error 1\n");
-                        exit(1);
-        }; /* switch */
-        break;
-
-    case POP:
-        readAddress(in, &I);
-        switch (I.atype) {
-          case CONST:   compileError("target of pop cannot be a constant");
-                        break;
-          case GLOBAL:  if (I.addr >= ng) compileError("global index too large");
-                        break;
-          case LOCAL:   if (I.addr >= f->parameter_slots + f->local_slots) {
-                          compileError("local index too large");
-                        }
-                        break;
-          default:
-                        /* Should have caught this error already */
-                        fprintf(stderr, "Internal error 2\n");
-                        exit(1);
-        }; /* switch */
-        break;
-
-    /*
-      Cases that require an unsigned integer
-    */
-    case CALL:
-        I.atype = FNUM;
-        I.addr = readUnsigned(in, "function number");
-        break;
-
-    case MOVE:
-        I.atype = MOVEDIST;
-        I.addr = readUnsigned(in, "move distance");
-        break;
-
-    /*
-      Cases that require a label
-    */
-    case GOTO:
-    case IFZc:
-    case IFZi:
-    case IFZf:
-    case IFNZc:
-    case IFNZi:
-    case IFNZf:
-    case IFEQc:
-    case IFEQi:
-    case IFEQf:
-    case IFNEc:
-    case IFNEi:
-    case IFNEf:
-    case IFLTc:
-    case IFLTi:
-    case IFLTf:
-    case IFLEc:
-    case IFLEi:
-    case IFLEf:
-    case IFGTc:
-    case IFGTi:
-    case IFGTf:
-    case IFGEc:
-    case IFGEi:
-    case IFGEf:
-        I.atype = LABEL;
-        I.addr = readLabel(in);
-        break;
-
-    /*
-      Cases that require a hex value
-    */
-    case PUSHv:
-        I.atype = VALUE;
-        I.addr = readHex(in);
-        break;
-
-    /*
-      Default cases: no operand
-    */
-    default:
-        I.atype = UNUSED;
-        I.addr = 0;
+  while (C->nheld) {
+    C->nheld--;
+    C->orphans[C->norphans++] = *C->held[C->nheld];
+    *C->held[C->nheld] = 0;
   }
-  return I;
+  siglongjmp(*C->recover, 2);
 }
 
-unsigned readFuncNum(FILE* in)
-{
-  matchKeyword(in, ".FUNC");
-  return readUnsigned(in, "function number");
-}
-
-void readFunc(FILE* in, function* F, unsigned nc, unsigned ng)
-{
-  assert(F);
-
-  const int maxlabel = 5000;
-  const char* maxlabelstring = "5000";
-  unsigned labelmap[maxlabel];
-  unsigned i;
-  for (i=0; i<maxlabel; i++) {
-    labelmap[i] = 0;
-  }
-
-  F->name = readIdent(in);
-#ifdef DEBUG_PARSER
-  printf("Parsing function %s\n", F->name);
-#endif
-  matchKeyword(in, ".params");
-  F->parameter_slots = readUnsigned(in, "#slots");
-  matchKeyword(in, ".return");
-  F->return_slots = readUnsigned(in, "#slots");
-  matchKeyword(in, ".locals");
-  F->local_slots = readUnsigned(in, "#slots");
-#ifdef DEBUG_PARSER
-  printf("#param_slots %u #return_slots %u #locals %u\n",
-    F->parameter_slots, F->return_slots, F->local_slots
-  );
-#endif
-
-  unsigned codemax = 1024;
-  instruction* CODE = malloc(codemax * sizeof(instruction));
-
-  for (F->code_length=0; ; F->code_length++) {
-    char token[10];   // in case of really, really long instruction numbers
-    
-    if (!readToken(in, token, 10)) {
-      token[9] = 0;
-      compileError3("token '", token, "' is too long\n(expecting instruction, label, or .end)");
-      exit(1);
-    }
-    if (0==strcmp(".end", token)) break;
-
-    if ('I'==token[0]) {
-      /* This is a label. */
-      long lnum = atol(token+1);
-      if (lnum<0 || lnum >= maxlabel) {
-        compileError4("label ", token, " exceeds maximum allowed: ", maxlabelstring);
-      }
-      if (labelmap[lnum]) {
-        compileError3("label ", token, " already used in this function");
-        exit(1);
-      }
-      labelmap[lnum] = 1+F->code_length--; /* +1 because 0 reserved for "not assigned" */
-#ifdef DEBUG_LABELS
-      printf("Label %s mapped to instruction %u\n", token, labelmap[lnum]);
-#endif
-      continue;
-    }
-
-    opcode OP = string2opcode(token);
-    if (ERROR == OP) {
-      compileError2("unknown instruction ", token);
-    }
-
-    if (F->code_length >= codemax) {
-      // enlarge
-      codemax *= 2;
-      CODE = realloc(CODE, codemax * sizeof(instruction));
-    }
-
-    CODE[F->code_length] = finishReading(in, F, nc, ng, OP);
-
-#ifdef DEBUG_PARSER
-    printf("Instruction %u: ", F->code_length);
-    showInstruction(stdout, CODE[F->code_length]);
-    printf("\n");
-#endif
-  }
-
-  // saw .end
-  matchKeyword(in, "FUNC");
-
-  /*
-    Go through the code, replace labels with instruction numbers
-  */
-  for (i=0; i<F->code_length; i++) {
-    if (LABEL==CODE[i].atype) {
-      unsigned instrno = labelmap[CODE[i].addr];
-      if (0==instrno) {
-        compileError3u("label I", CODE[i].addr, " not found in this function");
-      }
-      instrno--;
-      if (instrno >= F->code_length) {
-        compileError3u("label I", CODE[i].addr, " past end of function");
-      }
-      CODE[i].addr = instrno;
-    }
-  }
-
-  /*
-    Shrink CODE array, store in F
-  */
-  F->code = realloc(CODE, F->code_length * sizeof(instruction));
-
-#ifdef DEBUG_PARSER
-  printf("Done parsing function %s\n", F->name);
-#endif
-}
-
-/*
-  Code execution
-*/
-
-const function* Fexecuting;
-unsigned Finstruction;
-
 void runtimeError(const char* e)
 {
-  fprintf(stderr, "Runtime error");
-  if (Fexecuting) {
-    fprintf(stderr, " in function %s instruction %u", 
-      Fexecuting->name, Finstruction);
+  const vm_context* C = vmCurrent;
+  FILE* out = vmErrors();
+  fprintf(out, "Runtime error");
+  if (C->executing) {
+    fprintf(out, " in function %s instruction %u", 
+      C->executing->name, errorInstruction(C));
   }
-  fprintf(stderr, ":\n%s\n", e);
-  exit(2);
+  fprintf(out, ":\n%s\n", e);
+  vmExit(2);
 }
 
 void runtimeError3(const char* e, unsigned e2, const char* e3)
 {
-  fprintf(stderr, "Runtime error");
-  if (Fexecuting) {
-    fprintf(stderr, " in function %s instruction %u", 
-      Fexecuting->name, Finstruction);
+  const vm_context* C = vmCurrent;
+  FILE* out = vmErrors();
+  fprintf(out, "Runtime error");
+  if (C->executing) {
+    fprintf(out, " in function %s instruction %u", 
+      C->executing->name, errorInstruction(C));
   }
-  fprintf(stderr, ":\n%s%u %s\n", e, e2, e3);
-  exit(2);
+  fprintf(out, ":\n%s%u %s\n", e, e2, e3);
+  vmExit(2);
 }
 
-typedef struct {
-  segment constants;
-  segment globals;
-  function* F;
-  unsigned nf;
-} program;
-
 void callBuiltin(unsigned fnum, segment* mylocals, stack* mystack)
 {
   int c;
   switch (fnum) {
     case 0:   /* int getchar() */
-      push(mystack, i2u(getchar()));    
+      push(mystack, i2u(ioGetchar(&vmCurrent->io)));
       return;
 
     case 1:   /* int putchar(int c) */
       c = u2i(mylocals->data[0]);
-      fputc(c, stdout);
+      ioPutchar(&vmCurrent->io, c);
       push(mystack, i2u(c));
       return;
 
@@ -1092,12 +584,16 @@ void callBuiltin(unsigned fnum, segment* mylocals, stack* mystack)
   }
 }
 
-void callFunction(program* P, unsigned fnum, segment* locals, stack* compstack)
+/*
+  Start the outermost call: check and pop the parameters from the
+  caller's stack into the bottom of locals.  Builtins run right here,
+  and 0 is returned; otherwise the callee, ready to run from
+  instruction 0, with its operand stack in locals right after its
+  local variables (see runFunction).
+*/
+static inline function* enterFunction(program* P, unsigned fnum, segment* locals, stack* compstack,
+  segment* mylocals, stack* mystack)
 {
-  assert(P);
-  assert(locals);
-  assert(compstack);
-
   if (fnum >= P->nf) {
     runtimeError3("target function number ", fnum, " is too large");
   }
@@ -1135,538 +631,863 @@ void callFunction(program* P, unsigned fnum, segment* locals, stack* compstack)
   fprintf(stderr, "\n");
 #endif
 
-  /*
-    Make safe segments for our execution and for function calls below us
-  */
-  stack mystack;
-  segment sublocals;
+  *mylocals = *locals;
+  if (fnum >= BUILTIN_FUNCTIONS) {
+    if (F->source) loadFunction(P, F);
+    if (0==F->packed) packFunction(F);
+    initStack(locals, F->parameter_slots + F->local_slots, mystack);
+    if (F->verified && mystack->size < F->max_depth) {
+      vmCurrent->executing = F;
+      vmCurrent->instruction = 0;
+      runtimeError("Stack overflow");
+    }
+    return F;
+  }
+
+  makeSubStack(mystack, compstack);  // prevent underflow
+
+  callBuiltin(fnum, mylocals, mystack);
+  if (F->return_slots) {
+    push(compstack, pop(mystack));
+  }
+  return 0;
+}
+
+/*
+  The loop is built four times: as callFunction, with profiling set
+  as callProfiled, with sampling set as callSampled, and with fueled
+  set as callFueled.  They are constants in each, so the extra code
+  disappears from callFunction.
+*/
+#ifdef __GNUC__
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+/* Operand i of the instruction being run */
+#define ARG(i)  packedOperand(arg, i)
+
+static ALWAYS_INLINE void runFunction(program* P, unsigned fnum, segment* locals, stack* compstack,
+  const int profiling, const int sampling, const int fueled)
+{
+  assert(P);
+  assert(locals);
+  assert(compstack);
 
-  makeSubStack(&mystack, compstack);  // prevent underflow
-  makeSubSegment(locals, F->parameter_slots + F->local_slots, locals->size, &sublocals);
+  segment mylocals;
+  stack mystack;
+  function* F = enterFunction(P, fnum, locals, compstack, &mylocals, &mystack);
+  if (0==F) return;
 
   /*
-    Execute code
+    Execute code.  A call pushes the caller onto frames and switches
+    to the callee in this same loop, so IR recursion doesn't use the
+    C stack; ret pops it again.
+
+    Frames are contiguous in locals: each is the function's parameters,
+    then its local variables, then its operand stack.  A call starts
+    the callee's frame at the arguments on top of the caller's operand
+    stack, so they become its parameters where they are, and ret leaves
+    the result in the first of those slots.  Everything in a frame is
+    addressed from mylocals.data, and Lend bounds them all.
   */
+  unsigned* const Lend = locals->data + locals->size;
+  vm_context* const C = vmCurrent;
+  call_frame* frames = 0;
+  unsigned nframes = 0;
+  unsigned maxframes = 0;
+  vmHold((void**) &frames);
+  int packed_pc = C->packed_pc;
+  C->packed_pc = 1;
+  const unsigned char* code = F->packed;
+  unsigned pc = 0;
+  for (;;) {
+    /*
+      pc is a byte offset into the packed code, which ends in
+      PACKED_END, so it can't run past the end of the function.  It
+      is moved past the opcode here, and past the operands by the
+      cases that have them.
+    */
+    if (PACKED_HIT == code[pc]) {
+      fusionHits[code[pc+1]]++;
+      pc += 2;
+    }
+    C->executing = F;
+    C->instruction = pc;
+    if (fueled) {
+      /* out of fuel; the scheduler refills it before resuming */
+      if (0==C->fuel) vmYield();
+      C->fuel--;
+    }
 
-  if (fnum < BUILTIN_FUNCTIONS) {
-    callBuiltin(fnum, locals, &mystack);
-  } else {
-    unsigned pc = 0;
-    for (;;) {
-      Fexecuting = F;
-      Finstruction = pc;
-
-      /*
-        Check that pc is in bounds
-      */
-      if (pc >= F->code_length) {
-        runtimeError("ran past end of function; missing ret?");
-      }
-      instruction I = F->code[pc];
-      pc++;   
+    unsigned op = code[pc];
+    const unsigned char* arg = code + pc + 1;
+    if (profiling) {
+      profileOps[packedOpcode[op]]++;
+      F->profile[pc]++;
+      profileTotal++;
+    }
 #ifdef SHOW_EXECUTION
-      fprintf(stderr, "Executing ");
-      showInstruction(stderr, I);
-      fputc('\n', stderr);
+    fprintf(stderr, "Executing ");
+    showPacked(stderr, F, pc);
+    fputc('\n', stderr);
 #endif
+    pc++;
 #ifdef SHOW_STACK
-      showStack(stderr, "stack (before): ", &mystack);
+    showStack(stderr, "stack (before): ", &mystack);
 #endif
 
+    /*
+      Execute instruction
+    */
+    unsigned leftu, rightu;
+    int lefti, righti;
+    float leftf, rightf;
+    if (RET == op) {
+      if (profiling) profileLeave();
       /*
-        Execute instruction
+        Save return value
       */
-      unsigned leftu, rightu;
-      int lefti, righti;
-      float leftf, rightf;
-      if (RET == I.op) break;
-      switch (I.op) {
-        case PUSH:    /* PUSH address */
-                      switch (I.atype) {
-                        case CONST: 
-                                    assert(I.addr < P->constants.size);
-                                    push(&mystack, P->constants.data[I.addr]);
-                                    break;
-                        case GLOBAL:
-                                    assert(I.addr < P->globals.size);
-                                    push(&mystack, P->globals.data[I.addr]);
-                                    break;
-                        case LOCAL:
-                                    assert(I.addr < F->parameter_slots + F->local_slots);
-                                    push(&mystack, locals->data[I.addr]);
-                                    break;
-                        default:
-                                    runtimeError("Internal error 4");
-                      };
-                      break;
-        case PTRTO:   /* PUSH ptr to addr */
-                      switch (I.atype) {
-                        case CONST:
-                                    assert(I.addr < P->constants.size);
-                                    push(&mystack, addr2ptr(&P->constants, I.addr));
-                                    break;    
-                        case GLOBAL:
-                                    assert(I.addr < P->globals.size);
-                                    push(&mystack, addr2ptr(&P->globals, I.addr));
-                                    break;    
-                        case LOCAL:
-                                    assert(I.addr < F->parameter_slots + F->local_slots);
-                                    push(&mystack, addr2ptr(locals, I.addr));
-                                    break;    
-                        default:
-                                    runtimeError("Internal error 5");
-                      };
-                      break;
-        case PUSHv:
-                      assert(VALUE==I.atype);
-                      push(&mystack, I.addr);
-                      break;
-        case PUSHc:
-                      leftu = pop(&mystack);
-                      righti = u2i(pop(&mystack));
-                      push(&mystack, i2u(((char*)(locals->mem_base + leftu))[righti]));
-                      break;
-        case PUSHi:   
-                      leftu = pop(&mystack);
-                      righti = u2i(pop(&mystack));
-                      push(&mystack, i2u(((int*)(locals->mem_base + leftu))[righti]));
-                      break;
-        case PUSHf:   
-                      leftu = pop(&mystack);
-                      righti = u2i(pop(&mystack));
-                      push(&mystack, f2u(((float*)(locals->mem_base + leftu))[righti]));
-                      break;
-        case COPY:    
-                      push(&mystack, top(&mystack));
-                      break;
-        case MOVE:
-                      move(&mystack, I.addr);
-                      break;
-        case POPX:    /* Pop and discard */
-                      pop(&mystack);
-                      break;
-        case POP:
-                      if (GLOBAL == I.atype) {
-                        // store in global
-                        assert(I.addr < P->globals.size);
-                        P->globals.data[I.addr] = pop(&mystack);
-                      } else {
-                        // store in local
-                        assert(I.addr < F->parameter_slots + F->local_slots);
-                        locals->data[I.addr] = pop(&mystack);
-                      }
-                      break;
-        case POPc:    
-                      righti = u2i(pop(&mystack));
-                      leftu = pop(&mystack);
-                      lefti = u2i(pop(&mystack));
-                      ((char*)(locals->mem_base + leftu))[lefti] = righti;
-                      break;
-        case POPi:    
-                      righti = u2i(pop(&mystack));
-                      leftu = pop(&mystack);
-                      lefti = u2i(pop(&mystack));
-                      ((int*)(locals->mem_base + leftu))[lefti] = righti;
-                      break;
-        case POPf:    
-                      rightf = u2f(pop(&mystack));
-                      leftu = pop(&mystack);
-                      lefti = u2i(pop(&mystack));
-                      ((float*)(locals->mem_base + leftu))[lefti] = rightf;
-                      break;
-
-        case CALL:    /* CALL fnum */
-                      assert(FNUM == I.atype);
-                      callFunction(P, I.addr, &sublocals, &mystack);
-                      break;
-
-        case RET:     /* Can't happen */
-                      runtimeError("Internal error 6");
-                      break;  // sanity
-        case INCc:
-        case INCi: 
-                      (*((int*)topptr(&mystack)))++;
-                      break;
-        case INCf: 
-                      (*((float*)topptr(&mystack)))++;
-                      break;
-        case DECc: 
-        case DECi: 
-                      (*((int*)topptr(&mystack)))--;
-                      break;
-        case DECf: 
-                      (*((float*)topptr(&mystack)))--;
-                      break;
-        case NEGc: 
-        case NEGi: 
-                      (*((int*)topptr(&mystack))) *= -1;
-                      break;
-        case NEGf: 
-                      (*((float*)topptr(&mystack))) *= -1.0;
-                      break;
-        case FLIP: 
-                      push(&mystack, ~pop(&mystack));
-                      break;
-        case CONVif:
-                      lefti = u2i(pop(&mystack));
-                      push(&mystack, f2u(lefti));
-                      break;
-        case CONVfi:  
-                      leftf = u2f(pop(&mystack));
-                      push(&mystack, i2u((int)leftf));
-                      break;
-        case PLUSc:
-        case PLUSi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      push(&mystack, i2u(lefti + righti));
-                      break;
-        case PLUSf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      push(&mystack, f2u(leftf + rightf));
-                      break;
-        case MINUSc:
-        case MINUSi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      push(&mystack, i2u(lefti - righti));
-                      break;
-        case MINUSf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      push(&mystack, f2u(leftf - rightf));
-                      break;
-        case STARc:
-        case STARi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      push(&mystack, i2u(lefti * righti));
-                      break;
-        case STARf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      push(&mystack, f2u(leftf * rightf));
-                      break;
-        case SLASHc:
-        case SLASHi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      push(&mystack, i2u(lefti / righti));
-                      break;
-        case SLASHf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      push(&mystack, f2u(leftf / rightf));
-                      break;
-        case MODc:
-        case MODi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      push(&mystack, i2u(lefti % righti));
-                      break;
-        case AND: 
-                      rightu = pop(&mystack);
-                      leftu = pop(&mystack);
-                      push(&mystack, leftu & rightu);
-                      break;
-        case OR:
-                      rightu = pop(&mystack);
-                      leftu = pop(&mystack);
-                      push(&mystack, leftu | rightu);
-                      break;
-        case GOTO:
-                      assert(LABEL == I.atype);
-                      assert(I.addr < F->code_length);
-                      pc = I.addr;
-                      break;
-        case IFZc:
-        case IFZi:  
-                      lefti = u2i(pop(&mystack));
-                      if (0==lefti) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFZf:
-                      leftf = u2f(pop(&mystack));
-                      if (0==leftf) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFNZc:
-        case IFNZi:
-                      lefti = u2i(pop(&mystack));
-                      if (0!=lefti) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFNZf:
-                      leftf = u2f(pop(&mystack));
-                      if (0!=leftf) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFEQc:
-        case IFEQi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      if (lefti == righti) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFEQf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      if (leftf == rightf) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFNEc:
-        case IFNEi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      if (lefti != righti) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFNEf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      if (leftf != rightf) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFLTc:
-        case IFLTi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      if (lefti < righti) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFLTf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      if (leftf < rightf) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFLEc:
-        case IFLEi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      if (lefti <= righti) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFLEf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      if (leftf <= rightf) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFGTc:
-        case IFGTi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      if (lefti > righti) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
-                      }
-                      break;
-        case IFGTf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      if (leftf > rightf) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
+      leftu = 0;
+      if (F->return_slots) {
+        assert(1==F->return_slots);
+        leftu = pop(&mystack);
+      }
+#ifdef SHOW_EXECUTION
+      fprintf(stderr, "Exiting %s\n", F->name);
+#endif
+      if (0==nframes) {
+        if (F->return_slots) push(compstack, leftu);
+        break;
+      }
+      if (sampling) sampleBegin();
+      nframes--;
+      unsigned rs = F->return_slots;
+      F = frames[nframes].F;
+      code = F->packed;
+      pc = frames[nframes].pc;
+      if (sampling) {
+        C->executing = F;
+        C->instruction = pc;
+        sampleDepth = nframes;
+        sampleEnd();
+      }
+      /* the arguments were on the caller's stack up to our frame */
+      unsigned* args = mylocals.data;
+      mylocals.data = frames[nframes].locals;
+      mylocals.size = Lend - mylocals.data;
+      mystack.data = frames[nframes].stack;
+      mystack.size = Lend - mystack.data;
+      mystack.top = args - mystack.data;
+      if (rs) push(&mystack, leftu);
+      continue;
+    }
+    switch (op) {
+      case PUSH:    /* PUSH address */
+                    pc += 4;
+                    assert(ARG(0) < P->constants.size);
+                    push(&mystack, P->constants.data[ARG(0)]);
+                    break;
+      case PUSHG:
+                    pc += 4;
+                    assert(ARG(0) < P->globals.size);
+                    push(&mystack, P->globals.data[ARG(0)]);
+                    break;
+      case PUSHL:
+                    pc += 4;
+                    assert(ARG(0) < F->parameter_slots + F->local_slots);
+                    push(&mystack, mylocals.data[ARG(0)]);
+                    break;
+      case PTRTO:   /* PUSH ptr to addr */
+                    pc += 4;
+                    assert(ARG(0) < P->constants.size);
+                    push(&mystack, addr2ptr(&P->constants, ARG(0)));
+                    break;
+      case PTRTOG:
+                    pc += 4;
+                    assert(ARG(0) < P->globals.size);
+                    push(&mystack, addr2ptr(&P->globals, ARG(0)));
+                    break;
+      case PTRTOL:
+                    pc += 4;
+                    assert(ARG(0) < F->parameter_slots + F->local_slots);
+                    push(&mystack, addr2ptr(&mylocals, ARG(0)));
+                    break;
+      case PUSHv:
+                    pc += 4;
+                    push(&mystack, ARG(0));
+                    break;
+      case PUSHc:
+                    leftu = pop(&mystack);
+                    righti = u2i(pop(&mystack));
+                    push(&mystack, i2u(((char*)(mylocals.mem_base + leftu))[righti]));
+                    break;
+      case PUSHi:   
+                    leftu = pop(&mystack);
+                    righti = u2i(pop(&mystack));
+                    push(&mystack, i2u(((int*)(mylocals.mem_base + leftu))[righti]));
+                    break;
+      case PUSHf:   
+                    leftu = pop(&mystack);
+                    righti = u2i(pop(&mystack));
+                    push(&mystack, f2u(((float*)(mylocals.mem_base + leftu))[righti]));
+                    break;
+      case COPY:    
+                    push(&mystack, top(&mystack));
+                    break;
+      case MOVE:
+                    pc += 4;
+                    move(&mystack, ARG(0));
+                    break;
+      case POPX:    /* Pop and discard */
+                    pop(&mystack);
+                    break;
+      case POP:     /* store in global */
+                    pc += 4;
+                    assert(ARG(0) < P->globals.size);
+                    P->globals.data[ARG(0)] = pop(&mystack);
+                    break;
+      case POPL:    /* store in local */
+                    pc += 4;
+                    assert(ARG(0) < F->parameter_slots + F->local_slots);
+                    mylocals.data[ARG(0)] = pop(&mystack);
+                    break;
+      case POPc:    
+                    righti = u2i(pop(&mystack));
+                    leftu = pop(&mystack);
+                    lefti = u2i(pop(&mystack));
+                    ((char*)(mylocals.mem_base + leftu))[lefti] = righti;
+                    break;
+      case POPi:    
+                    righti = u2i(pop(&mystack));
+                    leftu = pop(&mystack);
+                    lefti = u2i(pop(&mystack));
+                    ((int*)(mylocals.mem_base + leftu))[lefti] = righti;
+                    break;
+      case POPf:    
+                    rightf = u2f(pop(&mystack));
+                    leftu = pop(&mystack);
+                    lefti = u2i(pop(&mystack));
+                    ((float*)(mylocals.mem_base + leftu))[lefti] = rightf;
+                    break;
+
+      case CALL:    /* CALL fnum */
+                    pc += 4;
+                    if (profiling) profileEnter(F, ARG(0));
+                    if (ARG(0) < BUILTIN_FUNCTIONS) {
+                      /* no frame; just check the argument is there */
+                      if (mystack.top < P->F[ARG(0)].parameter_slots) {
+                        runtimeError3("not enough parameters on computation stack\n    in call to function #",
+                          ARG(0), P->F[ARG(0)].name);
                       }
+                      if (sampling) sampleBuiltin = ARG(0)+1;
+                      mystack.top = callBuiltinFast(&C->io, ARG(0), mystack.data + mystack.top) - mystack.data;
+                      if (sampling) sampleBuiltin = 0;
                       break;
-        case IFGEc:
-        case IFGEi:
-                      righti = u2i(pop(&mystack));
-                      lefti = u2i(pop(&mystack));
-                      if (lefti >= righti) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
+                    }
+                    if (nframes >= maxframes) {
+                      if (sampling) sampleBegin();
+                      maxframes = maxframes ? 2*maxframes : 64;
+                      frames = realloc(frames, maxframes * sizeof(call_frame));
+                      if (0==frames) runtimeError("out of memory for call frames");
+                      if (sampling) {
+                        sampleFrames = frames;
+                        sampleEnd();
                       }
-                      break;
-        case IFGEf:
-                      rightf = u2f(pop(&mystack));
-                      leftf = u2f(pop(&mystack));
-                      if (leftf >= rightf) {
-                        assert(I.addr < F->code_length);
-                        pc = I.addr;
+                    }
+                    if (ARG(0) >= P->nf) {
+                      runtimeError3("target function number ", ARG(0), " is too large");
+                    }
+                    {
+                      function* G = P->F + ARG(0);
+                      if (mystack.top < G->parameter_slots) {
+                        runtimeError3("not enough parameters on computation stack\n    in call to function #",
+                          ARG(0), G->name);
                       }
-                      break;
-
-        default:      /* NONE or ERROR; do nothing */
-                      ;
-      } /* switch */
-    } /* for(;;) */ 
-  } /* If not builtin */
-
-  /*
-    Save return value
-  */
-  if (F->return_slots) {
-    assert(1==F->return_slots);
-    push(compstack, pop(&mystack));
-  }
-
+                      if (G->source) loadFunction(P, G);
+                      if (0==G->packed) packFunction(G);
+                      frames[nframes].F = F;
+                      frames[nframes].pc = pc;
+                      frames[nframes].locals = mylocals.data;
+                      frames[nframes].stack = mystack.data;
+                      nframes++;
+                      F = G;
+                    }
 #ifdef SHOW_EXECUTION
-  fprintf(stderr, "Exiting %s\n", F->name);
+                    fprintf(stderr, "Calling %s\n", F->name);
 #endif
+                    /* the arguments become the callee's parameters in place */
+                    mylocals.data = mystack.data + mystack.top - F->parameter_slots;
+                    mylocals.size = Lend - mylocals.data;
+                    if (mylocals.size < F->parameter_slots + F->local_slots) {
+                      runtimeError3("local variable stack overflow\n    in call to function #", ARG(0), F->name);
+                    }
+                    mystack.data = mylocals.data + F->parameter_slots + F->local_slots;
+                    mystack.size = Lend - mystack.data;
+                    mystack.top = 0;
+                    if (F->verified && mystack.size < F->max_depth) {
+                      C->executing = F;
+                      C->instruction = 0;
+                      runtimeError("Stack overflow");
+                    }
+                    code = F->packed;
+                    pc = 0;
+                    if (sampling) {
+                      /* until here, samples count against the call */
+                      sampleBegin();
+                      C->executing = F;
+                      C->instruction = 0;
+                      sampleDepth = nframes;
+                      sampleEnd();
+                    }
+                    break;
+
+      case RET:     /* Can't happen */
+                    runtimeError("Internal error 6");
+                    break;  // sanity
+      case INCc:
+      case INCi: 
+                    (*((int*)topptr(&mystack)))++;
+                    break;
+      case INCf: 
+                    (*((float*)topptr(&mystack)))++;
+                    break;
+      case DECc: 
+      case DECi: 
+                    (*((int*)topptr(&mystack)))--;
+                    break;
+      case DECf: 
+                    (*((float*)topptr(&mystack)))--;
+                    break;
+      case NEGc: 
+      case NEGi: 
+                    (*((int*)topptr(&mystack))) *= -1;
+                    break;
+      case NEGf: 
+                    (*((float*)topptr(&mystack))) *= -1.0;
+                    break;
+      case FLIP: 
+                    push(&mystack, ~pop(&mystack));
+                    break;
+      case CONVif:
+                    lefti = u2i(pop(&mystack));
+                    push(&mystack, f2u(lefti));
+                    break;
+      case CONVfi:  
+                    leftf = u2f(pop(&mystack));
+                    push(&mystack, i2u((int)leftf));
+                    break;
+      case PLUSc:
+      case PLUSi:
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    push(&mystack, i2u(lefti + righti));
+                    break;
+      case PLUSf:
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    push(&mystack, f2u(leftf + rightf));
+                    break;
+      case MINUSc:
+      case MINUSi:
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    push(&mystack, i2u(lefti - righti));
+                    break;
+      case MINUSf:
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    push(&mystack, f2u(leftf - rightf));
+                    break;
+      case STARc:
+      case STARi:
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    push(&mystack, i2u(lefti * righti));
+                    break;
+      case STARf:
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    push(&mystack, f2u(leftf * rightf));
+                    break;
+      case SLASHc:
+      case SLASHi:
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    push(&mystack, i2u(lefti / righti));
+                    break;
+      case SLASHf:
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    push(&mystack, f2u(leftf / rightf));
+                    break;
+      case MODc:
+      case MODi:
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    push(&mystack, i2u(lefti % righti));
+                    break;
+      case AND: 
+                    rightu = pop(&mystack);
+                    leftu = pop(&mystack);
+                    push(&mystack, leftu & rightu);
+                    break;
+      case OR:
+                    rightu = pop(&mystack);
+                    leftu = pop(&mystack);
+                    push(&mystack, leftu | rightu);
+                    break;
+      case GOTO:
+                    pc += 4;
+                    assert(ARG(0) < F->packed_length);
+                    pc = ARG(0);
+                    break;
+      case IFZc:
+      case IFZi:  
+                    pc += 4;
+                    lefti = u2i(pop(&mystack));
+                    if (0==lefti) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFZf:
+                    pc += 4;
+                    leftf = u2f(pop(&mystack));
+                    if (0==leftf) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFNZc:
+      case IFNZi:
+                    pc += 4;
+                    lefti = u2i(pop(&mystack));
+                    if (0!=lefti) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFNZf:
+                    pc += 4;
+                    leftf = u2f(pop(&mystack));
+                    if (0!=leftf) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFEQc:
+      case IFEQi:
+                    pc += 4;
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    if (lefti == righti) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFEQf:
+                    pc += 4;
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    if (leftf == rightf) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFNEc:
+      case IFNEi:
+                    pc += 4;
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    if (lefti != righti) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFNEf:
+                    pc += 4;
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    if (leftf != rightf) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFLTc:
+      case IFLTi:
+                    pc += 4;
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    if (lefti < righti) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFLTf:
+                    pc += 4;
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    if (leftf < rightf) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFLEc:
+      case IFLEi:
+                    pc += 4;
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    if (lefti <= righti) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFLEf:
+                    pc += 4;
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    if (leftf <= rightf) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFGTc:
+      case IFGTi:
+                    pc += 4;
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    if (lefti > righti) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFGTf:
+                    pc += 4;
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    if (leftf > rightf) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFGEc:
+      case IFGEi:
+                    pc += 4;
+                    righti = u2i(pop(&mystack));
+                    lefti = u2i(pop(&mystack));
+                    if (lefti >= righti) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+      case IFGEf:
+                    pc += 4;
+                    rightf = u2f(pop(&mystack));
+                    leftf = u2f(pop(&mystack));
+                    if (leftf >= rightf) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+
+      /*
+        Fused opcodes
+      */
+      case PLUSiLL:
+                    pc += 8;
+                    lefti = u2i(mylocals.data[ARG(0)]);
+                    righti = u2i(mylocals.data[ARG(1)]);
+                    push(&mystack, i2u(lefti) + i2u(righti));
+                    break;
+      case PLUSiLV:
+                    pc += 8;
+                    lefti = u2i(mylocals.data[ARG(0)]);
+                    push(&mystack, i2u(lefti) + ARG(1));
+                    break;
+      case MINUSiLL:
+                    pc += 8;
+                    lefti = u2i(mylocals.data[ARG(0)]);
+                    righti = u2i(mylocals.data[ARG(1)]);
+                    push(&mystack, i2u(lefti) - i2u(righti));
+                    break;
+      case MINUSiLV:
+                    pc += 8;
+                    lefti = u2i(mylocals.data[ARG(0)]);
+                    push(&mystack, i2u(lefti) - ARG(1));
+                    break;
+      case IFEQiLL:
+      case IFNEiLL:
+      case IFLTiLL:
+      case IFLEiLL:
+      case IFGTiLL:
+      case IFGEiLL:
+      case IFEQiLV:
+      case IFNEiLV:
+      case IFLTiLV:
+      case IFLEiLV:
+      case IFGTiLV:
+      case IFGEiLV:
+                    pc += 12;
+                    lefti = u2i(mylocals.data[ARG(1)]);
+                    righti = (op >= IFEQiLV) ? u2i(ARG(2)) : u2i(mylocals.data[ARG(2)]);
+                    switch (op) {
+                      case IFEQiLL:
+                      case IFEQiLV: leftu = (lefti == righti);  break;
+                      case IFNEiLL:
+                      case IFNEiLV: leftu = (lefti != righti);  break;
+                      case IFLTiLL:
+                      case IFLTiLV: leftu = (lefti < righti);   break;
+                      case IFLEiLL:
+                      case IFLEiLV: leftu = (lefti <= righti);  break;
+                      case IFGTiLL:
+                      case IFGTiLV: leftu = (lefti > righti);   break;
+                      default:      leftu = (lefti >= righti);
+                    }
+                    if (leftu) {
+                      assert(ARG(0) < F->packed_length);
+                      pc = ARG(0);
+                    }
+                    break;
+
+      case PACKED_END:
+                    runtimeError("ran past end of function; missing ret?");
+                    break;
+
+      default:      /* NONE or ERROR; do nothing */
+                    ;
+    } /* switch */
+  } /* for(;;) */
+  C->packed_pc = packed_pc;
+  vmRelease();
+  free(frames);
 }
 
-/*
-  Main
-*/
+void callFunction(program* P, unsigned fnum, segment* locals, stack* compstack)
+{
+  runFunction(P, fnum, locals, compstack, 0, 0, 0);
+}
 
-const char* usage = 
-"  Read intermediate code; if no file specified, reads standard input.\n\
-  The lowest numbered function named main is called.\n\n\
-  Input format is ComS 440/540 intermediate representation, which\n\
-  is a free-form text file.  Any text between ; and end of line is\n\
-  ignored.  Format is the following:\n\
-    .CONSTANTS (number of slots)\n\
-    (slot 1 as 32-bit unsigned hex)\n\
-    (slot 2 as 32-bit unsigned hex)\n\
-    ...\n\
-    .GLOBALS (number of slots)\n\
-    .FUNCTIONS (number of functions)\n\
-    .FUNC number name\n\
-      .params (number of slots)\n\
-      .return (number of slots (0 or 1))\n\
-      .locals (number of slots)\n\
-      0 instruction-0\n\
-      1 instruction-1\n\
-      ...\n\
-    .end FUNC\n\
-    .FUNC\n\
-      ...\n\
-    .end FUNC\n\n\
-  Legal instructions: see project spec document.\n\n\
-  Built-in functions:\n\
-    Function 0: int getchar()\n\
-    Function 1: int putchar(int c)\n\
-  So, don't overwrite those.\n\n";
-
-int main(int argc, const char** argv)
+void callProfiled(program* P, unsigned fnum, segment* locals, stack* compstack)
 {
-  if (argc > 2) {
-    fprintf(stderr, "Usage: %s [file]\n\n", argv[0]);
-    fputs(usage, stderr);
-    return 1;
-  }
-  FILE* in;
-  if (argv[1]) {
-    in = fopen(argv[1], "r");
-    if (0==in) {
-      fprintf(stderr, "Error, couldn't open file '%s'\n", argv[1]);
-      return 1;
-    }
-  } else {
-    in = stdin;
-  }
-  lineno = 1;
+  profileEnter(0, fnum);
+  runFunction(P, fnum, locals, compstack, 1, 0, 0);
+}
 
-/* 
-  Initialize "memory"
-*/
+void callSampled(program* P, unsigned fnum, segment* locals, stack* compstack)
+{
+  runFunction(P, fnum, locals, compstack, 0, 1, 0);
+  sampleBegin();
+  sampleDepth = 0;
+}
 
-  program P;
-  segment main_memory, locals;
-  initSegment(&main_memory, 65536);
-  segment compstack_memory;
-  initSegment(&compstack_memory, 65536);
-  stack compstack;
-  initStack(&compstack_memory, 0, &compstack);
-  Fexecuting = 0;
-  Finstruction = 0;
+void callFueled(program* P, unsigned fnum, segment* locals, stack* compstack)
+{
+  runFunction(P, fnum, locals, compstack, 0, 0, 1);
+}
 
 /*
-  Parse constants, globals
+  Library interface.  Each call makes C the thread's current context
+  and catches vmExit with recover, so errors come back as a status;
+  the caller's context and recover point are put back on the way out.
 */
-  unsigned nc = readConstants(in, &main_memory);
-  unsigned ng = readGlobals(in);
-  makeSubSegment(&main_memory, 0, nc, &P.constants);    /* Constant segment */
-  makeSubSegment(&main_memory, nc, nc+ng, &P.globals);  /* Globals segment */
-  makeSubSegment(&main_memory, nc+ng, main_memory.size, &locals);   /* Rest - locals */
-  
+
+static const char* pastLocals = "memory access past the end of local variable space";
+
 /*
-  Parse functions
+  Let runs use only the first slots of C's memory; the rest becomes
+  guard until it is given back with slots = the whole size.  All of
+  the memory is registered as guard with vmContextInit, since only
+  the protected part can fault.
 */
-  P.nf = readFunctions(in);
-  P.nf += BUILTIN_FUNCTIONS;  // reserved functions
-  P.F = malloc(P.nf * sizeof(function));
-  unsigned f;
-  for (f=0; f<P.nf; f++) {
-    zeroFunc(P.F+f);
+static void limitMemory(vm_context* C, size_t slots)
+{
+  size_t bytes;
+  char* base = segmentMapping(&C->memory, &bytes);
+  size_t page = sysconf(_SC_PAGESIZE);
+  unsigned long lo = (unsigned long) (C->memory.data + slots);
+  unsigned long hi = (unsigned long) base + bytes;
+  lo = (lo + page - 1) / page * page;
+  if (slots == C->memory.size) {
+    mprotect(base, bytes, PROT_READ | PROT_WRITE);
+  } else if (lo < hi) {
+    mprotect((void*) lo, hi - lo, PROT_NONE);
   }
-  initBuiltins(P.F);
+}
 
-#ifdef DEBUG_PARSER
-  printf("Reading %u functions\n", P.nf);
-#endif
-  for (f=BUILTIN_FUNCTIONS; f<P.nf; f++) {
-    unsigned fnum = readFuncNum(in);
-    if (fnum >= P.nf) {
-      fprintf(stderr, "Error line %d: function number %u too large (max %u)\n",
-        lineno, fnum, P.nf);
-      exit(1);
-    }
-    if (P.F[fnum].name) {
-      fprintf(stderr, "Error line %d: function number %u in use by %s\n",
-        lineno, fnum, P.F[fnum].name);
-      exit(1);
-    }
-    readFunc(in, P.F+fnum, nc, ng);
+int vmContextInit(vm_context* C, size_t globalSlots, size_t localSlots, size_t stackSlots)
+{
+  assert(C);
+  vm_context* caller = vmCurrent;
+  vmCurrent = C;
+  sigjmp_buf recover;
+  sigjmp_buf* outer = C->recover;
+  C->recover = &recover;
+  int status = sigsetjmp(recover, 1);
+  if (0==status) {
+    initSegment(&C->memory, globalSlots + localSlots, pastLocals);
+    initSegment(&C->stack_memory, stackSlots, "Stack overflow");
+    C->local_slots = localSlots;
+    size_t bytes;
+    char* base = segmentMapping(&C->memory, &bytes);
+    guardRegion(base, bytes, pastLocals);
   }
+  if (status) vmRecovered(C);
+  C->recover = outer;
+  vmCurrent = caller;
+  return status;
+}
 
-
-#ifdef SHOW_PROGRAM
-  printf("Done reading input.\n");
-  printf("Constants:\n");
-  showSegment(&P.constants);
-  printf("Functions:\n");
-  for (f=0; f<P.nf; f++) {
-    showFunction(stdout, f, P.F+f);
+void vmContextFree(vm_context* C)
+{
+  assert(C);
+  if (C->memory.mem_base) {
+    size_t bytes;
+    unguardRegion(segmentMapping(&C->memory, &bytes));
+    freeSegment(&C->memory);
   }
-#endif
+  if (C->stack_memory.mem_base) freeSegment(&C->stack_memory);
+  free(C->io.in_buffer);
+  free(C->io.out_buffer);
+  C->io.in_buffer = C->io.out_buffer = 0;
+}
 
-  unsigned entry = 0;
-  for (f=P.nf-1; f; f--) {
-    if (0==P.F[f].name) continue;
-    if (0==strcmp("main", P.F[f].name)) entry = f;
-  }
+int vmLoad(vm_context* C, const char* path, vm_engine engine, int verify, vm_program* V)
+{
+  assert(C);
+  assert(path);
+  assert(V);
+  vm_context* caller = vmCurrent;
+  vmCurrent = C;
+  sigjmp_buf recover;
+  sigjmp_buf* outer = C->recover;
+  C->recover = &recover;
+  C->executing = 0;
+  int status = sigsetjmp(recover, 1);
+  if (0==status) {
+    program* P = &V->P;
+    segment loaded;
+    makeSubSegment(&C->memory, 0, C->memory.size - C->local_slots, &loaded);
+    if (!loadIrb(path, P, &loaded)) {
+      FILE* in = fopen(path, "r");
+      if (0==in) {
+        fprintf(vmErrors(), "Error, couldn't open file '%s'\n", path);
+        vmExit(1);
+      }
+      readProgram(in, P, &loaded);
+      fclose(in);
+    }
 
-  if (!entry) {
-    fprintf(stderr, "Error, no function named main to execute\n");
-    return 2;
-  }
-#ifdef SHOW_PROGRAM
-  else {
-    printf("Entry point is function #%u\n", entry);
-  }
-#endif
+    /* Runs get their own copy of the constants and globals */
+    unsigned nc = P->constants.size;
+    unsigned ng = P->globals.size;
+    V->image = malloc((nc+ng+1) * sizeof(unsigned));
+    if (0==V->image) {
+      fprintf(vmErrors(), "Error - couldn't allocate program image\n");
+      vmExit(2);
+    }
+    memcpy(V->image, loaded.data, (nc+ng) * sizeof(unsigned));
+    P->constants.mem_base = P->constants.data = V->image;
+    P->globals.mem_base = V->image;
+    P->globals.data = V->image + nc;
+
+    unsigned f;
+    if (fusionEnabled) {
+      for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+        if (P->F[f].name) fuseFunction(P->F+f);
+      }
+    }
+    if (verify) {
+      for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+        if (P->F[f].name) verifyFunction(P, P->F+f);
+      }
+    }
 
-  callFunction(&P, entry, &locals, &compstack);
-  printf("Function main returned: %d\n", u2i(top(&compstack)));
+    for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+      if (P->F[f].name && !P->F[f].rejected) packFunction(P->F+f);
+    }
 
-  return 0;
+    V->entry = 0;
+    for (f=P->nf-1; f; f--) {
+      if (0==P->F[f].name) continue;
+      if (0==strcmp("main", P->F[f].name)) V->entry = f;
+    }
+    if (!V->entry) {
+      fprintf(vmErrors(), "Error, no function named main to execute\n");
+      vmExit(2);
+    }
+
+    if (ENGINE_THREADED == engine && !threadedAvailable) engine = ENGINE_SWITCH;
+    assert(ENGINE_JIT != engine);
+    V->engine = engine;
+    for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+      if (0==P->F[f].name || P->F[f].rejected) continue;
+      if (ENGINE_THREADED == engine) threadFunction(P, P->F+f);
+      if (ENGINE_REGISTER == engine) registerFunction(P, P->F+f);
+    }
+  }
+  clearSegment(&C->memory);
+  if (status) vmRecovered(C);
+  C->recover = outer;
+  vmCurrent = caller;
+  return status;
 }
 
+int vmRun(vm_context* C, const vm_program* V, int in, int out, int* result)
+{
+  assert(C);
+  assert(V);
+  assert(result);
+  vm_context* caller = vmCurrent;
+  vmCurrent = C;
+  sigjmp_buf recover;
+  sigjmp_buf* outer = C->recover;
+  C->recover = &recover;
+  C->executing = 0;
+  C->instruction = 0;
+  C->packed_pc = 0;
+  C->nheld = 0;
+  int status = sigsetjmp(recover, 1);
+  if (0==status) {
+    /*
+      The program as this run sees it: its functions are shared, its
+      constants and globals are copied into C's memory.  Past
+      local_slots of locals the rest of it faults, as on the command
+      line.
+    */
+    program P = V->P;
+    unsigned nc = P.constants.size;
+    unsigned ng = P.globals.size;
+    segment run;
+    makeSubSegment(&C->memory, 0, nc + ng + C->local_slots, &run);
+    limitMemory(C, run.size);
+    memcpy(run.data, V->image, (nc+ng) * sizeof(unsigned));
+    makeSubSegment(&run, 0, nc, &P.constants);
+    makeSubSegment(&run, nc, nc+ng, &P.globals);
+    segment locals;
+    makeSubSegment(&run, nc+ng, run.size, &locals);
+    stack compstack;
+    initStack(&C->stack_memory, 0, &compstack);
+
+    ioOpen(&C->io, in, out, in < 0);
+    if (C->green) {
+      callFueled(&P, V->entry, &locals, &compstack);
+    } else if (ENGINE_THREADED == V->engine) {
+      callThreaded(&P, V->entry, &locals, &compstack);
+    } else if (ENGINE_REGISTER == V->engine) {
+      callRegister(&P, V->entry, &locals, &compstack);
+    } else {
+      callFunction(&P, V->entry, &locals, &compstack);
+    }
+    *result = u2i(top(&compstack));
+  }
+  ioClose(&C->io);
+  limitMemory(C, C->memory.size);
+  clearSegment(&C->memory);
+  clearSegment(&C->stack_memory);
+  if (status) vmRecovered(C);
+  C->recover = outer;
+  vmCurrent = caller;
+  return status;
+}
@@ -0,0 +1,589 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Ahead of time translator: ir2c FILE [OUTFILE] writes a C program
+  that does what vm FILE would, for programs that run for long enough
+  that interpreting them is the wrong tool.
+
+  The program goes through vmLoad like any other, verified and not
+  fused, and each function becomes a C function with the same
+  parameters.  Labels become gotos.  Where every instruction is
+  reached with the same operand stack depth, stack slot n is the C
+  variable sn, so gcc can keep the whole stack in registers; other
+  functions (an expression statement in a loop leaves a value behind
+  every time round) push and pop through sp, on a stack of their own.
+  Locals are C variables too, unless the function takes the address
+  of one, in which case they are a frame in memory as in the VM.
+  Constants, globals and frames share one memory laid out as the
+  VM's, so pointers are the same slot numbers.  getchar and putchar
+  are stdio's.
+
+  Runtime errors are left to the hardware: running off memory faults,
+  and dividing by zero traps, but without the VM's messages.  Running
+  past the end of a function is reported as the VM does, and so is a
+  call to a function the verifier rejected.  Only
+  frames in memory count against LOCAL_SLOTS, so recursion that runs
+  out of locals in the VM may well finish here.
+*/
+
+/*
+  Operand stack depth of every reachable instruction, or -1.
+  Returns 1 if each is reached with only one depth.
+*/
+static int isBranch(opcode op)
+{
+  return op >= IFZc && op <= IFGEf;
+}
+
+static int stackDepths(const program* P, const function* F, int* depth, char* target)
+{
+  unsigned* work = malloc((F->code_length+1) * sizeof(unsigned));
+  if (0==work) {
+    fprintf(stderr, "Error - couldn't allocate work list\n");
+    exit(2);
+  }
+  unsigned n = 0, pc;
+  int fixed = 1;
+  for (pc=0; pc<F->code_length; pc++) {
+    depth[pc] = -1;
+    target[pc] = 0;
+  }
+  if (F->code_length) {
+    depth[0] = 0;
+    work[n++] = 0;
+  }
+  while (n) {
+    pc = work[--n];
+    instruction I = F->code[pc];
+    unsigned need;
+    int delta;
+    stackEffect(P, I, &need, &delta);
+    int next = depth[pc] + delta;
+    unsigned succ[2];
+    unsigned nsucc = 0;
+    if (GOTO == I.op || isBranch(I.op)) {
+      succ[nsucc++] = I.addr;
+      target[I.addr] = 1;
+    }
+    if (GOTO != I.op && RET != I.op) succ[nsucc++] = pc+1;
+    unsigned i;
+    for (i=0; i<nsucc; i++) {
+      if (succ[i] >= F->code_length) continue;   /* the end; see emitFunction */
+      if (depth[succ[i]] < 0) {
+        depth[succ[i]] = next;
+        work[n++] = succ[i];
+      } else if (depth[succ[i]] != next) {
+        fixed = 0;
+      }
+    }
+  }
+  free(work);
+  return fixed;
+}
+
+/*
+  Code for one function
+*/
+typedef struct {
+  FILE* out;
+  const program* P;
+  const function* F;
+  int dynamic;      /* operand stack through sp */
+  int framed;       /* locals in memory, through L */
+  int depth;        /* before this instruction, unless dynamic */
+  int bias;         /* sp already moved by this much */
+} emitter;
+
+/* Names come from a small ring, so a few can be used in one fprintf */
+static const char* name(const char* format, int n)
+{
+  static char ring[8][32];
+  static unsigned next;
+  char* s = ring[next++ % 8];
+  snprintf(s, sizeof(ring[0]), format, n);
+  return s;
+}
+
+/* Operand stack slot off from the top: -1 is the top, 0 just past it */
+static const char* S(emitter* E, int off)
+{
+  if (E->dynamic) return name("sp[%d]", off - E->bias);
+  return name("s%d", E->depth + off);
+}
+
+static const char* local(emitter* E, unsigned a)
+{
+  return name(E->framed ? "L[%d]" : "l%d", a);
+}
+
+/* Where PUSH reads and POP writes */
+static const char* variable(emitter* E, instruction I)
+{
+  unsigned nc = E->P->constants.size;
+  switch (I.atype) {
+    case CONST:   return name("M[%d]", I.addr);
+    case GLOBAL:  return name("M[%d]", nc + I.addr);
+    default:      return local(E, I.addr);
+  }
+}
+
+static void binary(emitter* E, const char* op)
+{
+  fprintf(E->out, "  %s = %s %s %s;\n", S(E, -2), S(E, -2), op, S(E, -1));
+}
+
+static void binaryInt(emitter* E, const char* op)
+{
+  fprintf(E->out, "  %s = (unsigned) ((int) %s %s (int) %s);\n",
+    S(E, -2), S(E, -2), op, S(E, -1));
+}
+
+static void binaryFloat(emitter* E, const char* op)
+{
+  fprintf(E->out, "  %s = U(F(%s) %s F(%s));\n", S(E, -2), S(E, -2), op, S(E, -1));
+}
+
+/* A conditional jump: pop its operands first, so sp is right at the label */
+static void branch(emitter* E, instruction I, unsigned need, const char* format)
+{
+  if (E->dynamic) {
+    fprintf(E->out, "  sp -= %u;\n", need);
+    E->bias = -(int) need;
+  }
+  fprintf(E->out, "  if (");
+  if (1==need) {
+    fprintf(E->out, format, S(E, -1));
+  } else {
+    fprintf(E->out, format, S(E, -2), S(E, -1));
+  }
+  fprintf(E->out, ") goto I%u;\n", I.addr);
+}
+
+static void emitCall(emitter* E, instruction I)
+{
+  const function* G = E->P->F + I.addr;
+  unsigned p = G->parameter_slots;
+  if (0==I.addr) {
+    fprintf(E->out, "  %s = (unsigned) getchar_unlocked();\n", S(E, 0));
+    return;
+  }
+  if (1==I.addr) {
+    fprintf(E->out, "  vmPutchar(%s);\n", S(E, -1));
+    return;
+  }
+  fprintf(E->out, "  ");
+  if (G->return_slots) fprintf(E->out, "%s = ", S(E, -(int) p));
+  fprintf(E->out, "fn%u(fp, sp", I.addr);
+  unsigned i;
+  for (i=p; i; i--) fprintf(E->out, ", %s", S(E, -(int) i));
+  fprintf(E->out, ");\n");
+}
+
+static void emitInstruction(emitter* E, instruction I)
+{
+  const char* cond = 0;
+  switch (I.op) {
+    case PUSH:
+        fprintf(E->out, "  %s = %s;\n", S(E, 0), variable(E, I));
+        return;
+    case PTRTO:
+        if (LOCAL == I.atype) {
+          fprintf(E->out, "  %s = (unsigned) (L - M) + %uu;\n", S(E, 0), I.addr);
+        } else {
+          fprintf(E->out, "  %s = %uu;\n", S(E, 0),
+            (unsigned) (I.addr + (GLOBAL == I.atype ? E->P->constants.size : 0)));
+        }
+        return;
+    case PUSHv:
+        fprintf(E->out, "  %s = 0x%xu;\n", S(E, 0), I.addr);
+        return;
+    case PUSHc:
+        fprintf(E->out, "  %s = (unsigned) (int) ((char*) (M + %s))[(int) %s];\n",
+          S(E, -2), S(E, -1), S(E, -2));
+        return;
+    case PUSHi:
+    case PUSHf:
+        fprintf(E->out, "  %s = (M + %s)[(int) %s];\n", S(E, -2), S(E, -1), S(E, -2));
+        return;
+    case COPY:
+        fprintf(E->out, "  %s = %s;\n", S(E, 0), S(E, -1));
+        return;
+    case MOVE:
+        if (0==I.addr) return;
+        {
+          fprintf(E->out, "  { unsigned t = %s;", S(E, -1));
+          int k;
+          for (k=1; k<=(int) I.addr; k++) {
+            fprintf(E->out, " %s = %s;", S(E, -k), S(E, -k-1));
+          }
+          fprintf(E->out, " %s = t; }\n", S(E, -(int) I.addr - 1));
+        }
+        return;
+    case POPX:
+        return;
+    case POP:
+        fprintf(E->out, "  %s = %s;\n", variable(E, I), S(E, -1));
+        return;
+    case POPc:
+        fprintf(E->out, "  ((char*) (M + %s))[(int) %s] = (char) %s;\n",
+          S(E, -2), S(E, -3), S(E, -1));
+        return;
+    case POPi:
+    case POPf:
+        fprintf(E->out, "  (M + %s)[(int) %s] = %s;\n", S(E, -2), S(E, -3), S(E, -1));
+        return;
+    case CALL:
+        emitCall(E, I);
+        return;
+    case RET:
+        if (E->F->return_slots) {
+          fprintf(E->out, "  return %s;\n", S(E, -1));
+        } else {
+          fprintf(E->out, "  return 0;\n");
+        }
+        return;
+
+    case INCc: case INCi:   fprintf(E->out, "  %s += 1;\n", S(E, -1));   return;
+    case DECc: case DECi:   fprintf(E->out, "  %s -= 1;\n", S(E, -1));   return;
+    case NEGc: case NEGi:   fprintf(E->out, "  %s = 0u - %s;\n", S(E, -1), S(E, -1));  return;
+    case FLIP:              fprintf(E->out, "  %s = ~%s;\n", S(E, -1), S(E, -1));     return;
+    case INCf:    fprintf(E->out, "  %s = U(F(%s) + 1);\n", S(E, -1), S(E, -1));       return;
+    case DECf:    fprintf(E->out, "  %s = U(F(%s) - 1);\n", S(E, -1), S(E, -1));       return;
+    case NEGf:    fprintf(E->out, "  %s = U(F(%s) * -1.0);\n", S(E, -1), S(E, -1));    return;
+    case CONVif:  fprintf(E->out, "  %s = U((float) (int) %s);\n", S(E, -1), S(E, -1));        return;
+    case CONVfi:  fprintf(E->out, "  %s = (unsigned) (int) F(%s);\n", S(E, -1), S(E, -1));  return;
+
+    case PLUSc: case PLUSi:     binary(E, "+");     return;
+    case MINUSc: case MINUSi:   binary(E, "-");     return;
+    case STARc: case STARi:     binary(E, "*");     return;
+    case AND:                   binary(E, "&");     return;
+    case OR:                    binary(E, "|");     return;
+    case SLASHc: case SLASHi:   binaryInt(E, "/");  return;
+    case MODc: case MODi:       binaryInt(E, "%");  return;
+    case PLUSf:                 binaryFloat(E, "+");  return;
+    case MINUSf:                binaryFloat(E, "-");  return;
+    case STARf:                 binaryFloat(E, "*");  return;
+    case SLASHf:                binaryFloat(E, "/");  return;
+
+    case GOTO:
+        fprintf(E->out, "  goto I%u;\n", I.addr);
+        return;
+    case IFZc: case IFZi:     branch(E, I, 1, "0 == %s");      return;
+    case IFNZc: case IFNZi:   branch(E, I, 1, "0 != %s");      return;
+    case IFZf:                branch(E, I, 1, "0 == F(%s)");   return;
+    case IFNZf:               branch(E, I, 1, "0 != F(%s)");   return;
+
+    case IFEQc: case IFEQi:   cond = "==";  break;
+    case IFNEc: case IFNEi:   cond = "!=";  break;
+    case IFLTc: case IFLTi:   cond = "<";   break;
+    case IFLEc: case IFLEi:   cond = "<=";  break;
+    case IFGTc: case IFGTi:   cond = ">";   break;
+    case IFGEc: case IFGEi:   cond = ">=";  break;
+    case IFEQf:   branch(E, I, 2, "F(%s) == F(%s)");  return;
+    case IFNEf:   branch(E, I, 2, "F(%s) != F(%s)");  return;
+    case IFLTf:   branch(E, I, 2, "F(%s) < F(%s)");   return;
+    case IFLEf:   branch(E, I, 2, "F(%s) <= F(%s)");  return;
+    case IFGTf:   branch(E, I, 2, "F(%s) > F(%s)");   return;
+    case IFGEf:   branch(E, I, 2, "F(%s) >= F(%s)");  return;
+
+    default:
+        /* fused opcodes; the program was loaded without fusion */
+        fprintf(stderr, "Internal error: can't translate ");
+        showInstruction(stderr, I);
+        fprintf(stderr, "\n");
+        exit(2);
+  }
+  /* integer compares */
+  char format[32];
+  snprintf(format, sizeof(format), "(int) %%s %s (int) %%s", cond);
+  branch(E, I, 2, format);
+}
+
+static void emitSignature(FILE* out, unsigned fnum, const function* F)
+{
+  fprintf(out, "static unsigned fn%u(unsigned* fp, unsigned* sp", fnum);
+  unsigned i;
+  for (i=0; i<F->parameter_slots; i++) fprintf(out, ", unsigned a%u", i);
+  fprintf(out, ")");
+}
+
+/* A rejected function only reports its verify error, as a C string */
+static void emitRejected(FILE* out, unsigned fnum, const function* F)
+{
+  fprintf(out, "\n/* %s */\n", F->name);
+  emitSignature(out, fnum, F);
+  fprintf(out, "\n{\n  verifyError(\"");
+  const char* s;
+  for (s=F->rejected; *s; s++) {
+    if ('\n' == *s) {
+      fprintf(out, "\\n");
+    } else {
+      if ('"' == *s || '\\' == *s) fputc('\\', out);
+      fputc(*s, out);
+    }
+  }
+  fprintf(out, "\");\n}\n");
+}
+
+static void emitFunction(FILE* out, const program* P, unsigned fnum)
+{
+  const function* F = P->F + fnum;
+  if (F->rejected) {
+    emitRejected(out, fnum, F);
+    return;
+  }
+  int* depth = malloc((F->code_length+1) * sizeof(int));
+  char* target = malloc(F->code_length+1);
+  char* used = calloc(F->parameter_slots + F->local_slots + 1, 1);
+  if (0==depth || 0==target || 0==used) {
+    fprintf(stderr, "Error - couldn't allocate function tables\n");
+    exit(2);
+  }
+  emitter E;
+  E.out = out;
+  E.P = P;
+  E.F = F;
+  E.dynamic = !stackDepths(P, F, depth, target);
+  E.framed = 0;
+  E.bias = 0;
+
+  unsigned pc, i;
+  int maxDepth = 0;
+  int pastEnd = 0==F->code_length;
+  for (pc=0; pc<F->code_length; pc++) {
+    if (depth[pc] < 0) continue;
+    instruction I = F->code[pc];
+    if (pc+1 == F->code_length && GOTO != I.op && RET != I.op) pastEnd = 1;
+    if (PTRTO == I.op && LOCAL == I.atype) E.framed = 1;
+    if (LOCAL == I.atype && (PUSH == I.op || POP == I.op)) used[I.addr] = 1;
+    unsigned need;
+    int delta;
+    stackEffect(P, I, &need, &delta);
+    if (depth[pc] + delta > maxDepth) maxDepth = depth[pc] + delta;
+  }
+
+  fprintf(out, "\n/* %s */\n", F->name);
+  emitSignature(out, fnum, F);
+  fprintf(out, "\n{\n");
+  unsigned slots = F->parameter_slots + F->local_slots;
+  if (E.framed) {
+    fprintf(out, "  unsigned* L = fp;\n");
+    fprintf(out, "  fp += %u;\n", slots);
+    fprintf(out, "  if (fp > framesEnd) localOverflow(\"%s\");\n", F->name);
+    for (i=0; i<F->parameter_slots; i++) fprintf(out, "  L[%u] = a%u;\n", i, i);
+  } else {
+    for (i=0; i<slots; i++) {
+      if (!used[i]) continue;
+      if (i < F->parameter_slots) {
+        fprintf(out, "  unsigned l%u = a%u;\n", i, i);
+      } else {
+        fprintf(out, "  unsigned l%u = 0;\n", i);
+      }
+    }
+  }
+  if (!E.dynamic && maxDepth) {
+    fprintf(out, "  unsigned s0");
+    for (i=1; i<(unsigned) maxDepth; i++) fprintf(out, ", s%u", i);
+    fprintf(out, ";\n");
+  }
+
+  for (pc=0; pc<F->code_length; pc++) {
+    if (depth[pc] < 0) continue;
+    if (target[pc]) fprintf(out, " I%u:\n", pc);
+    instruction I = F->code[pc];
+    E.depth = depth[pc];
+    E.bias = 0;
+    emitInstruction(&E, I);
+    if (E.dynamic && !isBranch(I.op)) {
+      unsigned need;
+      int delta;
+      stackEffect(P, I, &need, &delta);
+      if (delta) fprintf(out, "  sp += %d;\n", delta);
+    }
+  }
+  if (pastEnd) fprintf(out, "  ranPastEnd(\"%s\", %u);\n", F->name, F->code_length);
+  fprintf(out, "}\n");
+  free(depth);
+  free(target);
+  free(used);
+}
+
+/*
+  The rest of the program
+*/
+static const char* prelude =
+  "#include <stdio.h>\n"
+  "#include <stdlib.h>\n"
+  "#include <string.h>\n"
+  "#include <pthread.h>\n"
+  "#include <sys/mman.h>\n"
+  "\n"
+  "/* Sizes in slots as the vm's defaults; compile with -D to change them */\n"
+  "#ifndef LOCAL_SLOTS\n"
+  "#define LOCAL_SLOTS (1u << 24)\n"
+  "#endif\n"
+  "#ifndef STACK_SLOTS\n"
+  "#define STACK_SLOTS (1u << 22)\n"
+  "#endif\n"
+  "/* for the C stack, which holds the calls */\n"
+  "#ifndef C_STACK\n"
+  "#define C_STACK (1ul << 30)\n"
+  "#endif\n"
+  "#define GUARD (64u << 10)\n"
+  "\n"
+  "/* Constants, globals, then frames of locals */\n"
+  "static unsigned* M;\n"
+  "static unsigned* framesEnd;\n"
+  "\n"
+  "static inline float F(unsigned x) { float y; memcpy(&y, &x, sizeof(y)); return y; }\n"
+  "static inline unsigned U(float x) { unsigned y; memcpy(&y, &x, sizeof(y)); return y; }\n"
+  "\n"
+  "static inline void vmPutchar(unsigned c)\n"
+  "{\n"
+  "  if (-1 == (int) c) {\n"
+  "    fflush(stdout);\n"
+  "  } else {\n"
+  "    putchar_unlocked(c);\n"
+  "  }\n"
+  "}\n"
+  "\n"
+  "static inline void localOverflow(const char* function)\n"
+  "{\n"
+  "  fflush(stdout);\n"
+  "  fprintf(stderr, \"Runtime error in function %s:\\nlocal variable stack overflow\\n\", function);\n"
+  "  exit(2);\n"
+  "}\n"
+  "\n"
+  "static void __attribute__((noreturn)) verifyError(const char* message)\n"
+  "{\n"
+  "  fflush(stdout);\n"
+  "  fputs(message, stderr);\n"
+  "  exit(1);\n"
+  "}\n"
+  "\n"
+  "static void __attribute__((noreturn)) ranPastEnd(const char* function, unsigned pc)\n"
+  "{\n"
+  "  fflush(stdout);\n"
+  "  fprintf(stderr, \"Runtime error in function %s instruction %u:\\nran past end of function; missing ret?\\n\", function, pc);\n"
+  "  exit(2);\n"
+  "}\n"
+  "\n"
+  "/* Memory of the given bytes, followed by a guard */\n"
+  "static void* reserve(size_t bytes)\n"
+  "{\n"
+  "  char* p = mmap(0, bytes + GUARD, PROT_READ | PROT_WRITE,\n"
+  "    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);\n"
+  "  if (MAP_FAILED == p) {\n"
+  "    fprintf(stderr, \"Error - couldn't reserve memory\\n\");\n"
+  "    exit(2);\n"
+  "  }\n"
+  "  mprotect(p + bytes, GUARD, PROT_NONE);\n"
+  "  return p;\n"
+  "}\n";
+
+static void emitMain(FILE* out, const vm_program* V)
+{
+  const program* P = &V->P;
+  unsigned nc = P->constants.size;
+  unsigned ng = P->globals.size;
+  unsigned i;
+  fprintf(out, "\n#define IMAGE_SLOTS %uu\n", nc+ng);
+  fprintf(out, "\n/* %u constants, then %u globals */\n", nc, ng);
+  fprintf(out, "static const unsigned image[IMAGE_SLOTS + 1] = {");
+  for (i=0; i<nc+ng; i++) {
+    fprintf(out, "%s0x%x,", (i % 8) ? " " : "\n  ", V->image[i]);
+  }
+  fprintf(out, "\n};\n");
+
+  fprintf(out,
+    "\n"
+    "static unsigned result;\n"
+    "\n"
+    "static void* run(void* stack)\n"
+    "{\n"
+    "  result = fn%u(M + IMAGE_SLOTS, stack);\n"
+    "  return 0;\n"
+    "}\n"
+    "\n"
+    "int main()\n"
+    "{\n"
+    "  M = reserve((IMAGE_SLOTS + LOCAL_SLOTS) * sizeof(unsigned));\n"
+    "  memcpy(M, image, IMAGE_SLOTS * sizeof(unsigned));\n"
+    "  framesEnd = M + IMAGE_SLOTS + LOCAL_SLOTS;\n"
+    "  unsigned* stack = reserve(STACK_SLOTS * sizeof(unsigned));\n"
+    "\n"
+    "  /* calls nest on the C stack, so give it room */\n"
+    "  pthread_attr_t attr;\n"
+    "  pthread_attr_init(&attr);\n"
+    "  pthread_attr_setstack(&attr, reserve(C_STACK), C_STACK);\n"
+    "  pthread_t thread;\n"
+    "  if (pthread_create(&thread, &attr, run, stack)) {\n"
+    "    fprintf(stderr, \"Error - couldn't start the program\\n\");\n"
+    "    return 2;\n"
+    "  }\n"
+    "  pthread_join(thread, 0);\n"
+    "  printf(\"Function main returned: %%d\\n\", (int) result);\n"
+    "  return 0;\n"
+    "}\n", V->entry);
+}
+
+static void translate(FILE* out, const char* path, const vm_program* V)
+{
+  const program* P = &V->P;
+  fprintf(out, "/* Translated from %s by ir2c */\n\n", path);
+  fputs(prelude, out);
+  unsigned f;
+  fprintf(out, "\n");
+  for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+    if (0==P->F[f].name) continue;
+    emitSignature(out, f, P->F+f);
+    fprintf(out, " __attribute__((unused));\n");
+  }
+  for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+    if (P->F[f].name) emitFunction(out, P, f);
+  }
+  emitMain(out, V);
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2 || argc > 3 || '-' == argv[1][0]) {
+    fprintf(stderr, "Usage: %s file [outfile]\n\n"
+      "  Translates the stack vm program in file, text or binary, to C, written\n"
+      "  to outfile or standard output.  Compiled, it prints what vm file would.\n",
+      argv[0]);
+    return 1;
+  }
+  vm_context C;
+  memset(&C, 0, sizeof(C));
+  if (vmContextInit(&C, 1 << 20, 1, 1)) return 2;
+  fusionEnabled = 0;
+  vm_program V;
+  int status = vmLoad(&C, argv[1], ENGINE_SWITCH, 1, &V);
+  if (status) return status;
+  const function* entry = V.P.F + V.entry;
+  if (entry->parameter_slots || 1 != entry->return_slots) {
+    fprintf(stderr, "Error, main must take no parameters and return a value\n");
+    return 1;
+  }
+
+  FILE* out = stdout;
+  if (3==argc) {
+    out = fopen(argv[2], "w");
+    if (0==out) {
+      fprintf(stderr, "Error, couldn't open file '%s'\n", argv[2]);
+      return 1;
+    }
+  }
+  translate(out, argv[1], &V);
+  if (fclose(out)) {
+    fprintf(stderr, "Error writing '%s'\n", 3==argc ? argv[2] : "standard output");
+    return 1;
+  }
+  return 0;
+}
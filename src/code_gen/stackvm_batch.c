@@ -0,0 +1,452 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Batch runner for --batch.
+
+  The job file lists one run per line:
+
+      IRFILE [INFILE [OUTFILE]]
+
+  Blank lines and text after ; are ignored.  A job with no INFILE runs
+  with no input, and one with no OUTFILE writes to stdout, where the
+  output of jobs running at the same time can interleave.  Paths can't
+  contain blanks.
+
+  A fixed set of threads, each with its own context, takes jobs in
+  order from a shared counter.  Every distinct IRFILE is loaded once,
+  by whichever thread first needs it, under that program's lock; after
+  that the program is only read, so runs of it share it.  Errors are
+  written to a memory stream per thread and kept with the job, and
+  once everything has run there is one line per job on stdout, in
+  job file order, and a line of totals.  The exit status is 0 if every
+  job ran and 1 otherwise.
+
+  With --schedule, thread t instead takes jobs t, t+threads, ..., loads
+  what they need, starts them all as green threads, and hands them to
+  vmSchedule.  Inputs are opened nonblocking, so a job reading a pipe
+  that has nothing in it waits without holding up the rest, and each
+  job's line also gets its statistics.
+*/
+
+typedef struct {
+  char* path;
+  pthread_mutex_t lock;
+  int loaded;
+  int status;
+  char* errors;
+  vm_program V;
+} batch_program;
+
+typedef struct {
+  batch_program* program;
+  char* in;             /* 0 for no input */
+  char* out;            /* 0 for stdout */
+  int status;
+  int result;
+  char* errors;
+  /* from the scheduler, with --schedule */
+  unsigned long instructions;
+  unsigned long slices;
+  unsigned long waits;
+  double cpu, started, finished, max_wait;
+} batch_job;
+
+typedef struct {
+  batch_job* jobs;
+  unsigned njobs;
+  unsigned next;
+  unsigned threads;
+  unsigned long quantum;      /* 0 unless scheduled */
+  vm_engine engine;
+  int verify;
+  size_t globalSlots;
+  size_t localSlots;
+  size_t stackSlots;
+} batch;
+
+/*
+  Job file
+*/
+
+static char* nextField(char** line)
+{
+  char* p = *line;
+  while (' ' == *p || '\t' == *p) p++;
+  if (0==*p || '\n' == *p || '\r' == *p) return 0;
+  char* start = p;
+  while (*p && ' ' != *p && '\t' != *p && '\n' != *p && '\r' != *p) p++;
+  if (*p) *p++ = 0;
+  *line = p;
+  return strdup(start);
+}
+
+/*
+  Programs by path, in an open addressed table of slots entries (a
+  power of 2), only used while the job file is read
+*/
+static unsigned programSlot(batch_program** table, unsigned slots, const char* path)
+{
+  unsigned hash = 2166136261u;
+  const char* s;
+  for (s=path; *s; s++) hash = (hash ^ (unsigned char) *s) * 16777619u;
+  unsigned i = hash & (slots-1);
+  while (table[i] && strcmp(table[i]->path, path)) i = (i+1) & (slots-1);
+  return i;
+}
+
+static batch_program** growPrograms(batch_program** old, unsigned oldSlots, unsigned slots)
+{
+  batch_program** table = calloc(slots, sizeof(batch_program*));
+  if (0==table) return 0;
+  unsigned i;
+  for (i=0; i<oldSlots; i++) {
+    if (old[i]) table[programSlot(table, slots, old[i]->path)] = old[i];
+  }
+  free(old);
+  return table;
+}
+
+static void noMemory()
+{
+  fprintf(stderr, "Error - couldn't allocate job table\n");
+  exit(2);
+}
+
+static int readJobs(const char* jobfile, batch* B, unsigned* nprograms)
+{
+  FILE* f = fopen(jobfile, "r");
+  if (0==f) {
+    fprintf(stderr, "Error, couldn't open file '%s'\n", jobfile);
+    return 0;
+  }
+  unsigned maxjobs = 0;
+  unsigned slots = 0;
+  batch_program** table = 0;
+  char* line = 0;
+  size_t size = 0;
+  unsigned lineno = 0;
+  B->jobs = 0;
+  B->njobs = 0;
+  *nprograms = 0;
+  while (getline(&line, &size, f) > 0) {
+    lineno++;
+    char* comment = strchr(line, ';');
+    if (comment) *comment = 0;
+    char* rest = line;
+    char* ir = nextField(&rest);
+    if (0==ir) continue;
+    char* in = nextField(&rest);
+    char* out = in ? nextField(&rest) : 0;
+    if (out && nextField(&rest)) {
+      fprintf(stderr, "Error in %s line %u: expected IRFILE [INFILE [OUTFILE]]\n",
+        jobfile, lineno);
+      return 0;
+    }
+
+    if (B->njobs == maxjobs) {
+      maxjobs = maxjobs ? 2*maxjobs : 256;
+      B->jobs = realloc(B->jobs, maxjobs * sizeof(batch_job));
+      if (0==B->jobs) noMemory();
+    }
+    /* keep the table at most half full */
+    if (2 * (*nprograms + 1) > slots) {
+      table = growPrograms(table, slots, slots ? 2*slots : 256);
+      slots = slots ? 2*slots : 256;
+      if (0==table) noMemory();
+    }
+    unsigned i = programSlot(table, slots, ir);
+    if (0==table[i]) {
+      table[i] = calloc(1, sizeof(batch_program));
+      if (0==table[i]) noMemory();
+      table[i]->path = ir;
+      pthread_mutex_init(&table[i]->lock, 0);
+      (*nprograms)++;
+    } else {
+      free(ir);
+    }
+
+    batch_job* J = B->jobs + B->njobs;
+    memset(J, 0, sizeof(*J));
+    J->program = table[i];
+    J->in = in;
+    J->out = out;
+    B->njobs++;
+  }
+  free(line);
+  free(table);
+  fclose(f);
+  return 1;
+}
+
+/*
+  Running
+*/
+
+/* What was written to C's errors since the last call, or 0 */
+static char* takeErrors(vm_context* C, char** text, size_t* length)
+{
+  char* taken = 0;
+  if (C->errors) {
+    fclose(C->errors);
+    if (*length) {
+      taken = *text;
+    } else {
+      free(*text);
+    }
+  }
+  C->errors = open_memstream(text, length);
+  if (0==C->errors) {
+    fprintf(stderr, "Error - couldn't open an error stream\n");
+    exit(2);
+  }
+  return taken;
+}
+
+/* Load J's program if nobody has; 0 if it loaded */
+static int loadProgram(vm_context* C, batch* B, batch_job* J, char** text, size_t* length)
+{
+  batch_program* BP = J->program;
+  pthread_mutex_lock(&BP->lock);
+  if (!BP->loaded) {
+    BP->status = vmLoad(C, BP->path, B->engine, B->verify, &BP->V);
+    BP->errors = takeErrors(C, text, length);
+    BP->loaded = 1;
+  }
+  pthread_mutex_unlock(&BP->lock);
+  J->status = BP->status;
+  return BP->status;
+}
+
+/*
+  Open J's files; 0 if both opened, otherwise neither is left open.
+  The input is opened blocking even when it is to be read nonblocking,
+  so a FIFO waits for its writer here rather than reading as empty.
+*/
+static int openFiles(vm_context* C, batch_job* J, int nonblocking, int* in, int* out)
+{
+  *in = -1;
+  if (J->in) {
+    *in = open(J->in, O_RDONLY);
+    if (*in < 0) {
+      fprintf(C->errors, "Error, couldn't open file '%s'\n", J->in);
+      return 1;
+    }
+    if (nonblocking) fcntl(*in, F_SETFL, fcntl(*in, F_GETFL) | O_NONBLOCK);
+  }
+  *out = J->out ? open(J->out, O_WRONLY | O_CREAT | O_TRUNC, 0666) : 1;
+  if (*out < 0) {
+    fprintf(C->errors, "Error, couldn't open file '%s'\n", J->out);
+    if (*in >= 0) close(*in);
+    return 1;
+  }
+  return 0;
+}
+
+static void runJob(vm_context* C, batch* B, batch_job* J, char** text, size_t* length)
+{
+  if (loadProgram(C, B, J, text, length)) return;
+  int in, out;
+  if (openFiles(C, J, 0, &in, &out)) {
+    J->status = 1;
+  } else {
+    J->status = vmRun(C, &J->program->V, in, out, &J->result);
+    if (J->out) close(out);
+    if (in >= 0) close(in);
+  }
+  J->errors = takeErrors(C, text, length);
+}
+
+/*
+  Thread t's share of the jobs, as green threads.  Each gets its own
+  error stream, taken once the scheduler is done with it.
+*/
+static void runScheduled(vm_context* C, batch* B, unsigned t, char** text, size_t* length)
+{
+  unsigned n = (B->njobs - t + B->threads - 1) / B->threads;
+  vm_green** greens = calloc(n, sizeof(vm_green*));
+  batch_job** jobs = calloc(n, sizeof(batch_job*));
+  char** gtext = calloc(n, sizeof(char*));
+  size_t* glength = calloc(n, sizeof(size_t));
+  if (0==greens || 0==jobs || 0==gtext || 0==glength) noMemory();
+
+  unsigned i, started = 0;
+  for (i=0; i<n; i++) {
+    batch_job* J = B->jobs + t + i*B->threads;
+    if (loadProgram(C, B, J, text, length)) continue;
+    int in, out;
+    if (openFiles(C, J, 1, &in, &out)) {
+      J->status = 1;
+      J->errors = takeErrors(C, text, length);
+      continue;
+    }
+    vm_green* G = malloc(sizeof(vm_green));
+    if (0==G) noMemory();
+    if (vmGreenInit(G, B->globalSlots, B->localSlots, B->stackSlots)) exit(2);
+    G->C.errors = open_memstream(gtext + started, glength + started);
+    if (0==G->C.errors) {
+      fprintf(stderr, "Error - couldn't open an error stream\n");
+      exit(2);
+    }
+    vmGreenStart(G, &J->program->V, in, out);
+    greens[started] = G;
+    jobs[started] = J;
+    started++;
+  }
+
+  vmSchedule(greens, started, B->quantum);
+
+  for (i=0; i<started; i++) {
+    vm_green* G = greens[i];
+    batch_job* J = jobs[i];
+    J->status = G->status;
+    J->result = G->result;
+    J->instructions = G->instructions;
+    J->slices = G->slices;
+    J->waits = G->waits;
+    J->cpu = G->cpu;
+    J->started = G->started;
+    J->finished = G->finished;
+    J->max_wait = G->max_wait;
+    fclose(G->C.errors);
+    G->C.errors = 0;
+    if (glength[i]) {
+      J->errors = gtext[i];
+    } else {
+      free(gtext[i]);
+    }
+    if (J->out) close(G->out);
+    if (G->in >= 0) close(G->in);
+    vmGreenFree(G);
+    free(G);
+  }
+  free(greens);
+  free(jobs);
+  free(gtext);
+  free(glength);
+}
+
+typedef struct {
+  batch* B;
+  unsigned index;
+} batch_worker;
+
+static void* worker(void* arg)
+{
+  batch* B = ((batch_worker*) arg)->B;
+  unsigned t = ((batch_worker*) arg)->index;
+  vm_context C;
+  memset(&C, 0, sizeof(C));
+  if (vmContextInit(&C, B->globalSlots, B->localSlots, B->stackSlots)) exit(2);
+  char* text = 0;
+  size_t length = 0;
+  takeErrors(&C, &text, &length);
+
+  if (B->quantum) {
+    runScheduled(&C, B, t, &text, &length);
+  } else for (;;) {
+    unsigned j = __atomic_fetch_add(&B->next, 1, __ATOMIC_RELAXED);
+    if (j >= B->njobs) break;
+    runJob(&C, B, B->jobs + j, &text, &length);
+  }
+
+  fclose(C.errors);
+  free(text);
+  vmContextFree(&C);
+  return 0;
+}
+
+/*
+  Report
+*/
+
+/* An error message on one line, each line break and indent a blank */
+static void showErrors(FILE* out, const char* e)
+{
+  int blank = 0;
+  for (; e && *e; e++) {
+    if ('\n' == *e || (blank && ' ' == *e)) {
+      blank = 1;
+      continue;
+    }
+    if (blank) fputc(' ', out);
+    blank = 0;
+    fputc(*e, out);
+  }
+}
+
+int runBatch(const char* jobfile, unsigned threads, vm_engine engine, int verify,
+  size_t globalSlots, size_t localSlots, size_t stackSlots, unsigned long quantum)
+{
+  assert(jobfile);
+  batch B;
+  unsigned nprograms;
+  if (!readJobs(jobfile, &B, &nprograms)) return 1;
+  B.next = 0;
+  B.quantum = quantum;
+  B.engine = engine;
+  B.verify = verify;
+  B.globalSlots = globalSlots;
+  B.localSlots = localSlots;
+  B.stackSlots = stackSlots;
+  if (threads > B.njobs) threads = B.njobs;
+  if (0==threads) threads = 1;
+  B.threads = threads;
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  pthread_t* tids = malloc(threads * sizeof(pthread_t));
+  batch_worker* workers = malloc(threads * sizeof(batch_worker));
+  if (0==tids || 0==workers) noMemory();
+  unsigned t;
+  for (t=0; t<threads; t++) {
+    workers[t].B = &B;
+    workers[t].index = t;
+    if (pthread_create(tids+t, 0, worker, workers+t)) {
+      fprintf(stderr, "Error - couldn't start thread %u\n", t);
+      exit(2);
+    }
+  }
+  for (t=0; t<threads; t++) {
+    pthread_join(tids[t], 0);
+  }
+  free(tids);
+  free(workers);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+  unsigned j, failed = 0;
+  for (j=0; j<B.njobs; j++) {
+    const batch_job* J = B.jobs + j;
+    printf("%s", J->program->path);
+    if (J->in) printf(" < %s", J->in);
+    if (J->out) printf(" > %s", J->out);
+    printf(": ");
+    if (J->status) {
+      failed++;
+      showErrors(stdout, J->errors ? J->errors : J->program->errors);
+      printf("\n");
+    } else {
+      printf("main returned %d", J->result);
+      if (quantum) {
+        printf(" (%lu instructions in %lu slices, %lu waits; %.3f ms CPU;"
+          " started at %.3f ms, longest wait %.3f ms, done at %.3f ms)",
+          J->instructions, J->slices, J->waits, 1e3 * J->cpu,
+          1e3 * J->started, 1e3 * J->max_wait, 1e3 * J->finished);
+      }
+      printf("\n");
+    }
+  }
+  printf("%u jobs of %u programs on %u threads: %u ran, %u failed, in %.3f seconds (%.1f jobs/s)\n",
+    B.njobs, nprograms, threads, B.njobs - failed, failed, seconds,
+    seconds > 0 ? B.njobs / seconds : 0.0);
+  return failed ? 1 : 0;
+}
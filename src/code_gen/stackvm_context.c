@@ -0,0 +1,42 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include "../../includes/stackvm.h"
+
+/*
+  VM contexts.  The loaders link this too, so their errors go through
+  the same vmExit whether they run under the VM or the compiler.
+*/
+
+static vm_context processContext;
+
+__thread vm_context* vmCurrent = &processContext;
+
+void vmExit(int status)
+{
+  vm_context* C = vmCurrent;
+  if (0==C->recover) exit(status);
+
+  while (C->nheld) {
+    C->nheld--;
+    free(*C->held[C->nheld]);
+    *C->held[C->nheld] = 0;
+  }
+  if (C->errors) fflush(C->errors);
+  siglongjmp(*C->recover, status ? status : 2);
+}
+
+void vmRecovered(vm_context* C)
+{
+  if (C->fault[0]) {
+    FILE* out = C->errors ? C->errors : stderr;
+    fputs(C->fault, out);
+    fflush(out);
+    C->fault[0] = 0;
+  }
+  while (C->norphans) {
+    C->norphans--;
+    free(C->orphans[C->norphans]);
+  }
+}
@@ -0,0 +1,212 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Superinstruction fusion.
+
+  The code generator emits a handful of fixed sequences over and over:
+  every assignment ends in copy; pop X; popx, expressions on locals
+  are push Lx; push Ly; +i, increments are pushv 0x1; +i and loop
+  tests are a push or two followed by a compare-and-branch.  fuseFunction
+  rewrites each of those windows into a single instruction, in place,
+  after readFunc has turned labels into instruction numbers.
+
+  A window is only fused when none of its instructions but the first is
+  a jump target, so every target survives and can be remapped to its
+  new position.  When fusionStats is set, fusionSites counts the
+  rewrites per pattern and each fused instruction is tagged with its
+  pattern so the engines can count how often it actually runs.
+  Otherwise the counters are left alone, so functions of different
+  programs can be fused at the same time.
+
+  source_pc gives the instruction number each instruction had before
+  fusion, so messages and reports can use the numbers in the source.
+*/
+
+int fusionEnabled = 1;
+int fusionStats = 0;
+unsigned long fusionSites[FUSE_PATTERNS];
+unsigned long fusionHits[FUSE_PATTERNS];
+
+static const struct {
+  const char* name;
+  unsigned length;
+} patterns[FUSE_PATTERNS] = {
+  [FUSE_STORE]      = { "copy; pop X; popx",        3 },
+  [FUSE_INCDEC]     = { "pushv 0x1; +i/-i",         2 },
+  [FUSE_ARITH_LL]   = { "push Lx; push Ly; +i/-i",  3 },
+  [FUSE_ARITH_LV]   = { "push Lx; pushv k; +i/-i",  3 },
+  [FUSE_BRANCH_LL]  = { "push Lx; push Ly; if",     3 },
+  [FUSE_BRANCH_LV]  = { "push Lx; pushv k; if",     3 },
+};
+
+static int isLocalPush(instruction I)
+{
+  return (PUSH == I.op) && (LOCAL == I.atype);
+}
+
+static opcode arithFused(opcode op, int lv)
+{
+  switch (op) {
+    case PLUSc:
+    case PLUSi:   return lv ? PLUSiLV : PLUSiLL;
+    case MINUSc:
+    case MINUSi:  return lv ? MINUSiLV : MINUSiLL;
+    default:      return NONE;
+  }
+}
+
+static opcode branchFused(opcode op, int lv)
+{
+  switch (op) {
+    case IFEQc:
+    case IFEQi:   return lv ? IFEQiLV : IFEQiLL;
+    case IFNEc:
+    case IFNEi:   return lv ? IFNEiLV : IFNEiLL;
+    case IFLTc:
+    case IFLTi:   return lv ? IFLTiLV : IFLTiLL;
+    case IFLEc:
+    case IFLEi:   return lv ? IFLEiLV : IFLEiLL;
+    case IFGTc:
+    case IFGTi:   return lv ? IFGTiLV : IFGTiLL;
+    case IFGEc:
+    case IFGEi:   return lv ? IFGEiLV : IFGEiLL;
+    default:      return NONE;
+  }
+}
+
+/*
+  Try to match a pattern at code[i].  Returns the pattern, or
+  FUSE_PATTERNS if nothing matches; on a match *R is the replacement.
+  window is how many instructions starting at i may be consumed.
+*/
+static fusion_pattern match(const instruction* code, unsigned window, instruction* R)
+{
+  opcode op;
+
+  if (window >= 3) {
+    if ( (COPY == code[0].op) && (POP == code[1].op) && (POPX == code[2].op) ) {
+      *R = code[1];
+      return FUSE_STORE;
+    }
+    if (isLocalPush(code[0]) && (isLocalPush(code[1]) || PUSHv == code[1].op)) {
+      int lv = (PUSHv == code[1].op);
+      op = arithFused(code[2].op, lv);
+      if (NONE != op) {
+        R->op = op;
+        R->atype = LOCAL;
+        R->addr = code[0].addr;
+        R->addr2 = code[1].addr;
+        R->addr3 = 0;
+        return lv ? FUSE_ARITH_LV : FUSE_ARITH_LL;
+      }
+      op = branchFused(code[2].op, lv);
+      if (NONE != op) {
+        R->op = op;
+        R->atype = LABEL;
+        R->addr = code[2].addr;
+        R->addr2 = code[0].addr;
+        R->addr3 = code[1].addr;
+        return lv ? FUSE_BRANCH_LV : FUSE_BRANCH_LL;
+      }
+    }
+  }
+
+  if (window >= 2) {
+    if ( (PUSHv == code[0].op) && (1 == code[0].addr) ) {
+      switch (code[1].op) {
+        case PLUSc:
+        case PLUSi:   op = INCi;  break;
+        case MINUSc:
+        case MINUSi:  op = DECi;  break;
+        default:      op = NONE;
+      }
+      if (NONE != op) {
+        R->op = op;
+        R->atype = UNUSED;
+        R->addr = R->addr2 = R->addr3 = 0;
+        return FUSE_INCDEC;
+      }
+    }
+  }
+
+  return FUSE_PATTERNS;
+}
+
+void fuseFunction(function* F)
+{
+  assert(F);
+  unsigned n = F->code_length;
+  instruction* code = F->code;
+  if (0==n) return;
+
+  /*
+    Mark jump targets; a fused window may only start at one.
+  */
+  char* target = calloc(n+1, 1);
+  unsigned* map = malloc((n+1) * sizeof(unsigned));
+  unsigned* source = malloc((n+1) * sizeof(unsigned));
+  unsigned char* tags = fusionStats ? calloc(n, 1) : 0;
+  if (0==target || 0==map || 0==source || (fusionStats && 0==tags)) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory for fusion of %s\n", F->name);
+    vmExit(2);
+  }
+  unsigned i, j;
+  for (i=0; i<n; i++) {
+    if (LABEL == code[i].atype) target[code[i].addr] = 1;
+  }
+
+  /*
+    Rewrite in place; the output never overtakes the input.
+  */
+  unsigned out = 0;
+  for (i=0; i<n; ) {
+    unsigned window = 1;
+    while (i+window < n && window < 3 && !target[i+window]) window++;
+
+    instruction R = code[i];
+    fusion_pattern p = match(code+i, window, &R);
+    unsigned length = (p < FUSE_PATTERNS) ? patterns[p].length : 1;
+
+    for (j=0; j<length; j++) map[i+j] = out;
+    if (p < FUSE_PATTERNS) {
+      if (tags) {
+        tags[out] = p+1;
+        fusionSites[p]++;
+      }
+    }
+    source[out] = i;
+    code[out++] = R;
+    i += length;
+  }
+  map[n] = out;
+  source[out] = n;
+
+  for (i=0; i<out; i++) {
+    if (LABEL == code[i].atype) code[i].addr = map[code[i].addr];
+  }
+
+  if (out == n) {
+    free(source);
+    source = 0;
+  }
+  F->code_length = out;
+  F->fused = tags;
+  F->source_pc = source;
+  free(map);
+  free(target);
+}
+
+void showFusionStats(FILE* out)
+{
+  unsigned p;
+  fprintf(out, "Fusion statistics:\n");
+  fprintf(out, "  %-26s %10s %14s %14s\n", "pattern", "sites", "executed", "dispatches saved");
+  for (p=0; p<FUSE_PATTERNS; p++) {
+    fprintf(out, "  %-26s %10lu %14lu %14lu\n", patterns[p].name,
+      fusionSites[p], fusionHits[p], fusionHits[p] * (patterns[p].length-1));
+  }
+}
@@ -0,0 +1,189 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Green threads and their scheduler.
+
+  Each green thread is a ucontext with its own native stack, on which
+  vmRun runs the program in the thread's own context.  vmRun sees
+  green set in the context and runs callFueled, which yields back to
+  whoever resumed it every time the fuel runs out; ioRefill yields
+  the same way when its input would block.  Everything vmRun needs is
+  on that stack or in the context, so a green thread can be left at
+  any yield and resumed later, as long as it is resumed on the OS
+  thread that started it (vmCurrent is per thread).
+*/
+
+#define GREEN_STACK   (256u << 10)
+
+static double now(clockid_t clock)
+{
+  struct timespec t;
+  clock_gettime(clock, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int vmGreenInit(vm_green* G, size_t globalSlots, size_t localSlots, size_t stackSlots)
+{
+  assert(G);
+  memset(G, 0, sizeof(*G));
+  int status = vmContextInit(&G->C, globalSlots, localSlots, stackSlots);
+  if (status) return status;
+
+  /* a page below the stack faults on overflow */
+  size_t page = sysconf(_SC_PAGESIZE);
+  G->stack_bytes = page + GREEN_STACK;
+  G->stack = mmap(0, G->stack_bytes, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+  if (MAP_FAILED == G->stack) {
+    G->stack = 0;
+    fprintf(stderr, "Error - couldn't allocate a green thread stack\n");
+    vmContextFree(&G->C);
+    return 2;
+  }
+  mprotect(G->stack, page, PROT_NONE);
+  G->C.green = G;
+  return 0;
+}
+
+void vmGreenFree(vm_green* G)
+{
+  assert(G);
+  vmContextFree(&G->C);
+  if (G->stack) munmap(G->stack, G->stack_bytes);
+  G->stack = 0;
+}
+
+static void greenMain()
+{
+  vm_green* G = vmCurrent->green;
+  G->status = vmRun(&G->C, G->V, G->in, G->out, &G->result);
+  G->done = 1;
+  /* and back to resumer, through uc_link */
+}
+
+void vmGreenStart(vm_green* G, const vm_program* V, int in, int out)
+{
+  assert(G);
+  assert(G->stack);
+  assert(V);
+  G->V = V;
+  G->in = in;
+  G->out = out;
+  G->waiting = 0;
+  G->done = 0;
+  G->status = 0;
+  G->result = 0;
+  G->instructions = G->slices = G->waits = 0;
+  G->cpu = G->started = G->finished = G->max_wait = G->ready_since = 0;
+
+  size_t page = sysconf(_SC_PAGESIZE);
+  getcontext(&G->context);
+  G->context.uc_stack.ss_sp = G->stack + page;
+  G->context.uc_stack.ss_size = G->stack_bytes - page;
+  G->context.uc_link = &G->resumer;
+  makecontext(&G->context, greenMain, 0);
+}
+
+int vmGreenResume(vm_green* G, unsigned long fuel)
+{
+  assert(G);
+  if (G->done) return 0;
+  vm_context* caller = vmCurrent;
+  vmCurrent = &G->C;
+  G->C.fuel = fuel;
+  G->waiting = 0;
+  swapcontext(&G->resumer, &G->context);
+  vmCurrent = caller;
+  G->instructions += fuel - G->C.fuel;
+  G->slices++;
+  return !G->done;
+}
+
+void vmYield()
+{
+  vm_green* G = vmCurrent->green;
+  assert(G);
+  swapcontext(&G->context, &G->resumer);
+}
+
+/*
+  Scheduler.  The ready queue is a ring of all n threads; those
+  waiting for input sit in a poll set instead, and go back to the
+  tail of the queue once their input is readable or closed.  The
+  poll doesn't block while anything else is ready.
+*/
+void vmSchedule(vm_green** G, unsigned n, unsigned long quantum)
+{
+  assert(G);
+  assert(quantum);
+  vm_green** ready = malloc((n+1) * sizeof(vm_green*));
+  vm_green** waiting = malloc((n+1) * sizeof(vm_green*));
+  struct pollfd* fds = malloc((n+1) * sizeof(struct pollfd));
+  if (0==ready || 0==waiting || 0==fds) {
+    fprintf(stderr, "Error - couldn't allocate run queue\n");
+    exit(2);
+  }
+  unsigned head = 0, nready = 0, nwaiting = 0;
+  unsigned i;
+  for (i=0; i<n; i++) {
+    if (G[i]->done) continue;
+    G[i]->ready_since = 0;
+    ready[nready++] = G[i];
+  }
+
+  double start = now(CLOCK_MONOTONIC);
+  while (nready || nwaiting) {
+    if (nwaiting) {
+      poll(fds, nwaiting, nready ? 0 : -1);
+      double t = now(CLOCK_MONOTONIC) - start;
+      for (i=0; i<nwaiting; ) {
+        if (0==fds[i].revents) {
+          i++;
+          continue;
+        }
+        waiting[i]->ready_since = t;
+        ready[(head + nready++) % n] = waiting[i];
+        nwaiting--;
+        waiting[i] = waiting[nwaiting];
+        fds[i] = fds[nwaiting];
+      }
+    }
+    if (0==nready) continue;
+
+    vm_green* g = ready[head];
+    head = (head+1) % n;
+    nready--;
+    double t = now(CLOCK_MONOTONIC) - start;
+    if (t - g->ready_since > g->max_wait) g->max_wait = t - g->ready_since;
+    if (0==g->slices) g->started = t;
+    double cpu = now(CLOCK_THREAD_CPUTIME_ID);
+    int more = vmGreenResume(g, quantum);
+    g->cpu += now(CLOCK_THREAD_CPUTIME_ID) - cpu;
+    t = now(CLOCK_MONOTONIC) - start;
+    if (!more) {
+      g->finished = t;
+    } else if (g->waiting) {
+      g->waits++;
+      waiting[nwaiting] = g;
+      fds[nwaiting].fd = g->in;
+      fds[nwaiting].events = POLLIN;
+      fds[nwaiting].revents = 0;
+      nwaiting++;
+    } else {
+      g->ready_since = t;
+      ready[(head + nready++) % n] = g;
+    }
+  }
+  free(ready);
+  free(waiting);
+  free(fds);
+}
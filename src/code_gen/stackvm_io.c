@@ -0,0 +1,132 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../../includes/stackvm.h"
+
+/*
+  I/O for the getchar and putchar builtins.
+
+  Input comes from a view of the input descriptor: the rest of the
+  file, mapped, when it is a regular file, and otherwise a buffer
+  refilled with read().  Output collects in a buffer that is written
+  out when it fills, when the program calls putchar(-1), and when the
+  run ends.  When output is a terminal it is written a line at a time
+  instead, and when input is one, output is written before waiting
+  for more of it, so prompts still show up.  Nothing here goes through
+  stdio, which main keeps using for its own messages after ioFlush.
+
+  All of the state is in a vm_io, so runs in different contexts each
+  have their own.  A green thread reading a nonblocking input that is
+  empty yields until the scheduler sees it readable.
+*/
+
+#define IO_BUFFER   (1u << 16)
+
+void ioOpen(vm_io* io, int in, int out, int noInput)
+{
+  if (0==io->in_buffer) io->in_buffer = malloc(IO_BUFFER);
+  if (0==io->out_buffer) io->out_buffer = malloc(IO_BUFFER);
+  if (0==io->in_buffer || 0==io->out_buffer) {
+    fprintf(vmErrors(), "Error - couldn't allocate I/O buffers\n");
+    vmExit(2);
+  }
+  io->in_fd = in;
+  io->out_fd = out;
+  io->in = io->in_end = io->in_buffer;
+  io->out = io->out_buffer;
+  io->out_end = io->out_buffer + IO_BUFFER;
+  io->mapped = 0;
+  io->mapped_length = 0;
+  io->in_terminal = isatty(in);
+  io->out_terminal = isatty(out);
+  /* every putchar takes the slow path, which looks for newlines */
+  if (io->out_terminal) io->out_end = io->out_buffer;
+  io->in_done = noInput;
+  if (noInput) return;
+
+  struct stat st;
+  off_t pos = lseek(in, 0, SEEK_CUR);
+  if (0==fstat(in, &st) && S_ISREG(st.st_mode) && pos >= 0 && pos < st.st_size) {
+    unsigned char* base = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, in, 0);
+    if (MAP_FAILED != base) {
+      madvise(base, st.st_size, MADV_SEQUENTIAL);
+      io->mapped = base;
+      io->mapped_length = st.st_size;
+      io->in = base + pos;
+      io->in_end = base + st.st_size;
+      io->in_done = 1;
+    }
+  }
+}
+
+void ioClose(vm_io* io)
+{
+  vm_io* current = &vmCurrent->io;
+  if (io == current) ioFlush();
+  if (io->mapped) munmap(io->mapped, io->mapped_length);
+  io->mapped = 0;
+  io->in = io->in_end = 0;
+  io->out = io->out_end = 0;
+}
+
+static void writeAll(int fd, const unsigned char* p, size_t n)
+{
+  while (n) {
+    ssize_t w = write(fd, p, n);
+    if (w < 0) {
+      if (EINTR == errno) continue;
+      return;   /* as fputc would, drop it */
+    }
+    p += w;
+    n -= w;
+  }
+}
+
+void ioFlush()
+{
+  vm_io* io = &vmCurrent->io;
+  if (0==io->out) return;
+  writeAll(io->out_fd, io->out_buffer, io->out - io->out_buffer);
+  io->out = io->out_buffer;
+}
+
+int ioRefill()
+{
+  vm_io* io = &vmCurrent->io;
+  if (io->in_done) return -1;
+  if (io->in_terminal) ioFlush();
+  for (;;) {
+    ssize_t n = read(io->in_fd, io->in_buffer, IO_BUFFER);
+    if (n > 0) {
+      io->in = io->in_buffer;
+      io->in_end = io->in_buffer + n;
+      return *io->in++;
+    }
+    if (n < 0 && EINTR == errno) continue;
+    if (n < 0 && EAGAIN == errno && vmCurrent->green) {
+      /* a nonblocking input with nothing yet; let something else run */
+      vmCurrent->green->waiting = 1;
+      vmYield();
+      io = &vmCurrent->io;
+      continue;
+    }
+    io->in_done = 1;
+    return -1;
+  }
+}
+
+void ioOverflow(int c)
+{
+  vm_io* io = &vmCurrent->io;
+  if (-1 == c) {
+    ioFlush();
+    return;
+  }
+  if (io->out == io->out_buffer + IO_BUFFER) ioFlush();
+  *io->out++ = c;
+  if (io->out_terminal && '\n' == c) ioFlush();
+}
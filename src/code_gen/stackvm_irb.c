@@ -0,0 +1,265 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../../includes/stackvm.h"
+#include "../../includes/irb.h"
+
+/*
+  Binary program files.
+
+  writeIrb lays the file out as described in stackvm.h, with every
+  instruction array aligned for direct use.  loadIrb maps the file
+  copy-on-write and points each function's code and name straight
+  into the mapping, so loading costs a pass over the instructions to
+  check them instead of a parse.  Fusion later rewrites the mapped
+  code in place, which only copies the pages it touches.
+
+  The checks are the ones the text loader makes while parsing, so a
+  damaged file can't get further than a bad text file would.
+*/
+
+#define IRB_ALIGN 8
+
+static unsigned long alignUp(unsigned long off)
+{
+  return (off + IRB_ALIGN - 1) / IRB_ALIGN * IRB_ALIGN;
+}
+
+void writeIrb(FILE* out, const program* P)
+{
+  assert(out);
+  assert(P);
+
+  irb_header H;
+  memcpy(H.magic, IRB_MAGIC, 4);
+  H.version = IRB_VERSION;
+  H.byte_order = IRB_BYTE_ORDER;
+  H.instruction_size = sizeof(instruction);
+  H.constants = P->constants.size;
+  H.globals = P->globals.size;
+  H.functions = 0;
+  H.reserved = 0;
+
+  unsigned f;
+  for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+    if (P->F[f].name) H.functions++;
+  }
+
+  /*
+    Offsets: names follow the table, code follows the names
+  */
+  unsigned long names = sizeof(H) + H.constants * sizeof(unsigned)
+                      + H.functions * sizeof(irb_function);
+  unsigned long code = names;
+  for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+    if (P->F[f].name) code += strlen(P->F[f].name) + 1;
+  }
+  code = alignUp(code);
+
+  fwrite(&H, sizeof(H), 1, out);
+  fwrite(P->constants.data, sizeof(unsigned), H.constants, out);
+
+  for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+    const function* F = P->F+f;
+    if (0==F->name) continue;
+    irb_function E;
+    E.fnum = f;
+    E.parameter_slots = F->parameter_slots;
+    E.return_slots = F->return_slots;
+    E.local_slots = F->local_slots;
+    E.code_length = F->code_length;
+    E.name = names;
+    E.code = code;
+    fwrite(&E, sizeof(E), 1, out);
+    names += strlen(F->name) + 1;
+    code = alignUp(code + F->code_length * sizeof(instruction));
+  }
+
+  for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+    if (P->F[f].name) fwrite(P->F[f].name, 1, strlen(P->F[f].name) + 1, out);
+  }
+
+  static const char zeroes[IRB_ALIGN];
+  unsigned long at = names;
+  fwrite(zeroes, 1, alignUp(at) - at, out);
+  at = alignUp(at);
+  for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+    const function* F = P->F+f;
+    if (0==F->name) continue;
+    fwrite(F->code, sizeof(instruction), F->code_length, out);
+    at += F->code_length * sizeof(instruction);
+    fwrite(zeroes, 1, alignUp(at) - at, out);
+    at = alignUp(at);
+  }
+}
+
+static void badIrb(const char* path, const char* what, unsigned u)
+{
+  fprintf(vmErrors(), "Error in %s: ", path);
+  fprintf(vmErrors(), what, u);
+  fprintf(vmErrors(), "\n");
+  vmExit(1);
+}
+
+/*
+  Returns 0 if I is something the text loader could have produced
+  for F, otherwise what's wrong with it.
+*/
+static const char* checkInstruction(const function* F, instruction I,
+  unsigned nc, unsigned ng)
+{
+  if ((unsigned) I.op >= PLUSiLL) return "invalid opcode in function %s";
+
+  switch (I.op) {
+    case PUSH:
+    case PTRTO:
+    case POP:
+        switch (I.atype) {
+          case CONST:   if (POP == I.op) return "pop into a constant in function %s";
+                        if (I.addr >= nc) return "constant index too large in function %s";
+                        return 0;
+          case GLOBAL:  if (I.addr >= ng) return "global index too large in function %s";
+                        return 0;
+          case LOCAL:   if (I.addr >= F->parameter_slots + F->local_slots) {
+                          return "local index too large in function %s";
+                        }
+                        return 0;
+          default:      return "bad address type in function %s";
+        }
+
+    case CALL:
+        return (FNUM == I.atype) ? 0 : "bad call in function %s";
+
+    case MOVE:
+        return (MOVEDIST == I.atype) ? 0 : "bad move in function %s";
+
+    case PUSHv:
+        return (VALUE == I.atype) ? 0 : "bad pushv in function %s";
+
+    default:
+        if (I.op >= GOTO) {
+          if (LABEL != I.atype) return "bad branch in function %s";
+          if (I.addr >= F->code_length) return "label past end of function %s";
+          return 0;
+        }
+        return (UNUSED == I.atype) ? 0 : "bad operand in function %s";
+  }
+}
+
+int loadIrb(const char* path, program* P, segment* memory)
+{
+  assert(path);
+  assert(P);
+  assert(memory);
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) return 0;
+  struct stat st;
+  if (fstat(fd, &st) || st.st_size < sizeof(irb_header)) {
+    close(fd);
+    return 0;
+  }
+  char magic[4];
+  if (4 != pread(fd, magic, 4, 0) || memcmp(magic, IRB_MAGIC, 4)) {
+    close(fd);
+    return 0;
+  }
+  unsigned long size = st.st_size;
+  unsigned char* base = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (MAP_FAILED == base) badIrb(path, "couldn't map file", 0);
+
+  irb_header H;
+  memcpy(&H, base, sizeof(H));
+  if (H.byte_order != IRB_BYTE_ORDER) badIrb(path, "written with another byte order", 0);
+  if (H.version != IRB_VERSION) badIrb(path, "unsupported version %u", H.version);
+  if (H.instruction_size != sizeof(instruction)) {
+    badIrb(path, "written by a build with %u byte instructions", H.instruction_size);
+  }
+  if (H.constants > memory->size || H.globals > memory->size - H.constants) {
+    badIrb(path, "constants and globals don't fit in memory", 0);
+  }
+  unsigned long table = sizeof(H) + (unsigned long) H.constants * sizeof(unsigned);
+  if (table + (unsigned long) H.functions * sizeof(irb_function) > size) {
+    badIrb(path, "truncated", 0);
+  }
+
+  /*
+    Constants and globals
+  */
+  memcpy(memory->data, base + sizeof(H), H.constants * sizeof(unsigned));
+  P->constants.mem_base = memory->mem_base;
+  P->constants.data = memory->data;
+  P->constants.size = H.constants;
+  P->globals.mem_base = memory->mem_base;
+  P->globals.data = memory->data + H.constants;
+  P->globals.size = H.globals;
+
+  /*
+    Functions, used in place
+  */
+  P->nf = H.functions + BUILTIN_FUNCTIONS;
+  P->verify = 0;
+  P->F = malloc(P->nf * sizeof(function));
+  if (0==P->F) badIrb(path, "couldn't allocate %u functions", P->nf);
+  unsigned f, i;
+  for (f=0; f<P->nf; f++) {
+    zeroFunc(P->F+f);
+  }
+  initBuiltins(P->F);
+
+  for (f=0; f<H.functions; f++) {
+    irb_function E;
+    memcpy(&E, base + table + f*sizeof(irb_function), sizeof(E));
+    if (E.fnum < BUILTIN_FUNCTIONS || E.fnum >= P->nf) {
+      badIrb(path, "bad function number %u", E.fnum);
+    }
+    function* F = P->F + E.fnum;
+    if (F->name) badIrb(path, "function number %u used twice", E.fnum);
+    if (E.name >= size || 0==memchr(base + E.name, 0, size - E.name)) {
+      badIrb(path, "bad name for function %u", E.fnum);
+    }
+    if (E.code % IRB_ALIGN || E.code > size
+        || E.code_length > (size - E.code) / sizeof(instruction)) {
+      badIrb(path, "bad code for function %u", E.fnum);
+    }
+    F->name = (char*) base + E.name;
+    F->parameter_slots = E.parameter_slots;
+    F->return_slots = E.return_slots;
+    F->local_slots = E.local_slots;
+    F->code_length = E.code_length;
+    F->code = (instruction*) (base + E.code);
+
+    for (i=0; i<F->code_length; i++) {
+      const char* what = checkInstruction(F, F->code[i], H.constants, H.globals);
+      if (what) {
+        fprintf(vmErrors(), "Error in %s: ", path);
+        fprintf(vmErrors(), what, F->name);
+        fprintf(vmErrors(), ", instruction %u\n", i);
+        vmExit(1);
+      }
+    }
+  }
+  return 1;
+}
+
+void irToIrb(FILE* in, FILE* out)
+{
+  program P;
+  segment memory;
+  memory.size = 65536;
+  memory.mem_base = memory.data = malloc(memory.size * sizeof(unsigned));
+  if (0==memory.data) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory segment\n");
+    vmExit(2);
+  }
+  readProgram(in, &P, &memory);
+  writeIrb(out, &P);
+  free(memory.data);
+}
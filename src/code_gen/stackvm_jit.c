@@ -0,0 +1,555 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Template JIT for x86-64.
+
+  Once a function has been called jitThreshold times, jitCompile
+  translates its instructions one at a time into fixed machine code
+  templates.  Only functions the verifier passed with a bounded depth
+  are compiled, so the generated code has no stack checks, and only
+  if every instruction has a template (floating point and move don't);
+  everything else keeps running in the threaded interpreter.
+
+  Generated code keeps the operand stack in VM memory, exactly where
+  the interpreter would, except that the top of the stack lives in
+  eax.  The memory part always holds one slot more than it would
+  otherwise (the value eax had when the first push happened), so a
+  pop can reload eax without checking for an empty stack.  Register
+  use inside compiled code:
+
+      eax   top of stack          rbx   locals of this call
+      ecx   scratch               r12   operand stack pointer
+      edx   scratch               r13   VM memory base
+                                  r15   stack base of this call
+
+  A compiled function is  unsigned* f(unsigned* locals, unsigned* sp)
+  with its parameters already copied to locals; it returns the stack
+  pointer with the return value, if any, pushed at the base.  Calls
+  from compiled code go through jitCall, which runs the callee
+  compiled when possible, and through callThreaded otherwise;
+  getchar and putchar run right there.  Compiled code runs on a stack
+  of its own, so deep IR recursion isn't limited by the C stack.
+*/
+
+int jitEnabled = 0;
+unsigned jitThreshold = 1;
+
+#if defined(__x86_64__) && defined(__GNUC__) && defined(__unix__)
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+const int jitAvailable = 1;
+
+/* Native stack for compiled code */
+#define JIT_STACK_SIZE  (64u << 20)
+
+typedef unsigned* (*trampoline)(jit_code f, unsigned* locals, unsigned* sp, void* stacktop);
+
+static program* jitProgram;
+static unsigned* jitMem;
+static unsigned* jitLocalsEnd;
+static unsigned* jitStackEnd;
+static unsigned char* jitStackTop;
+static trampoline enterJit;
+static int onJitStack;
+
+/*
+  Code buffer
+*/
+typedef struct {
+  unsigned char* buf;
+  unsigned len;
+  unsigned size;
+} emitter;
+
+static void emitBytes(emitter* E, const char* bytes, unsigned n)
+{
+  if (E->len + n > E->size) {
+    E->size = 2*E->size + n;
+    E->buf = realloc(E->buf, E->size);
+    if (0==E->buf) {
+      fprintf(stderr, "Error - couldn't allocate JIT buffer\n");
+      exit(2);
+    }
+  }
+  memcpy(E->buf + E->len, bytes, n);
+  E->len += n;
+}
+
+#define EMIT(E, S)  emitBytes(E, S, sizeof(S)-1)
+
+static void emit32(emitter* E, unsigned u)
+{
+  char b[4];
+  memcpy(b, &u, 4);
+  emitBytes(E, b, 4);
+}
+
+static void emit64(emitter* E, const void* p)
+{
+  char b[8];
+  memcpy(b, &p, 8);
+  emitBytes(E, b, 8);
+}
+
+/* mov [r12], eax; add r12, 4 */
+static void spill(emitter* E)
+{
+  EMIT(E, "\x41\x89\x04\x24" "\x49\x83\xC4\x04");
+}
+
+/* sub r12, n; mov eax, [r12] */
+static void reload(emitter* E, unsigned char n)
+{
+  EMIT(E, "\x49\x83\xEC");
+  emitBytes(E, (const char*) &n, 1);
+  EMIT(E, "\x41\x8B\x04\x24");
+}
+
+/* Second byte of the jcc rel32 opcode */
+static int condition(opcode op)
+{
+  switch (op) {
+    case IFZc:  case IFZi:
+    case IFEQc: case IFEQi: case IFEQiLL: case IFEQiLV:   return 0x84;
+    case IFNZc: case IFNZi:
+    case IFNEc: case IFNEi: case IFNEiLL: case IFNEiLV:   return 0x85;
+    case IFLTc: case IFLTi: case IFLTiLL: case IFLTiLV:   return 0x8C;
+    case IFLEc: case IFLEi: case IFLEiLL: case IFLEiLV:   return 0x8E;
+    case IFGTc: case IFGTi: case IFGTiLL: case IFGTiLV:   return 0x8F;
+    case IFGEc: case IFGEi: case IFGEiLL: case IFGEiLV:   return 0x8D;
+    default:                                              return 0;
+  }
+}
+
+/*
+  Emit the template for I; returns 0 if there is none.  Jumps are
+  emitted with the target instruction number as displacement, and
+  their positions recorded in fixups.
+*/
+static int emitInstruction(emitter* E, const program* P, const function* F,
+  unsigned pc, instruction I, unsigned* fixups, unsigned* nfixups)
+{
+  unsigned nl = F->parameter_slots + F->local_slots;
+  char jcc[2] = { 0x0F, 0 };
+
+  switch (I.op) {
+    case PUSH:
+        spill(E);
+        if (LOCAL == I.atype) {
+          EMIT(E, "\x8B\x83");                /* mov eax, [rbx+d] */
+          emit32(E, 4*I.addr);
+        } else {
+          const segment* S = (CONST == I.atype) ? &P->constants : &P->globals;
+          EMIT(E, "\x41\x8B\x85");            /* mov eax, [r13+d] */
+          emit32(E, 4*addr2ptr(S, I.addr));
+        }
+        return 1;
+
+    case PTRTO:
+        spill(E);
+        if (LOCAL == I.atype) {
+          EMIT(E, "\x48\x89\xD8"              /* mov rax, rbx */
+                  "\x4C\x29\xE8"              /* sub rax, r13 */
+                  "\x48\xC1\xE8\x02"          /* shr rax, 2 */
+                  "\x05");                    /* add eax, x */
+          emit32(E, I.addr);
+        } else {
+          const segment* S = (CONST == I.atype) ? &P->constants : &P->globals;
+          EMIT(E, "\xB8");                    /* mov eax, ptr */
+          emit32(E, addr2ptr(S, I.addr));
+        }
+        return 1;
+
+    case PUSHv:
+        spill(E);
+        EMIT(E, "\xB8");                      /* mov eax, k */
+        emit32(E, I.addr);
+        return 1;
+
+    case PUSHc:
+    case PUSHi:
+    case PUSHf:
+        EMIT(E, "\x41\x8B\x4C\x24\xFC"        /* mov ecx, [r12-4]  index */
+                "\x48\x63\xC9"                /* movsxd rcx, ecx */
+                "\x49\x83\xEC\x04"            /* sub r12, 4 */
+                "\x49\x8D\x54\x85\x00");      /* lea rdx, [r13+rax*4] */
+        if (PUSHc == I.op) {
+          EMIT(E, "\x0F\xBE\x04\x0A");        /* movsx eax, byte [rdx+rcx] */
+        } else {
+          EMIT(E, "\x8B\x04\x8A");            /* mov eax, [rdx+rcx*4] */
+        }
+        return 1;
+
+    case COPY:
+        spill(E);
+        return 1;
+
+    case POPX:
+        reload(E, 4);
+        return 1;
+
+    case POP:
+        if (GLOBAL == I.atype) {
+          EMIT(E, "\x41\x89\x85");            /* mov [r13+d], eax */
+          emit32(E, 4*addr2ptr(&P->globals, I.addr));
+        } else {
+          EMIT(E, "\x89\x83");                /* mov [rbx+d], eax */
+          emit32(E, 4*I.addr);
+        }
+        reload(E, 4);
+        return 1;
+
+    case POPc:
+    case POPi:
+    case POPf:
+        EMIT(E, "\x41\x8B\x54\x24\xFC"        /* mov edx, [r12-4]  pointer */
+                "\x49\x63\x4C\x24\xF8"        /* movsxd rcx, [r12-8]  index */
+                "\x49\x8D\x54\x95\x00");      /* lea rdx, [r13+rdx*4] */
+        if (POPc == I.op) {
+          EMIT(E, "\x88\x04\x0A");            /* mov [rdx+rcx], al */
+        } else {
+          EMIT(E, "\x89\x04\x8A");            /* mov [rdx+rcx*4], eax */
+        }
+        reload(E, 12);
+        return 1;
+
+    case CALL:
+        spill(E);
+        EMIT(E, "\xBF");                      /* mov edi, fnum */
+        emit32(E, I.addr);
+        EMIT(E, "\x48\x8D\xB3");              /* lea rsi, [rbx+4*nl] */
+        emit32(E, 4*nl);
+        EMIT(E, "\x4C\x89\xE2"                /* mov rdx, r12 */
+                "\xB9");                      /* mov ecx, pc */
+        emit32(E, pc);
+        EMIT(E, "\x48\xB8");                  /* mov rax, jitCall */
+        emit64(E, (const void*) jitCall);
+        EMIT(E, "\xFF\xD0"                    /* call rax */
+                "\x49\x89\xC4");              /* mov r12, rax */
+        reload(E, 4);
+        return 1;
+
+    case RET:
+        if (F->return_slots) {
+          EMIT(E, "\x41\x89\x07"              /* mov [r15], eax */
+                  "\x49\x8D\x47\x04");        /* lea rax, [r15+4] */
+        } else {
+          EMIT(E, "\x4C\x89\xF8");            /* mov rax, r15 */
+        }
+        EMIT(E, "\x41\x5F\x41\x5E\x41\x5D\x41\x5C\x5B\xC3");
+        return 1;
+
+    case INCc:
+    case INCi:    EMIT(E, "\x83\xC0\x01");  return 1;   /* add eax, 1 */
+    case DECc:
+    case DECi:    EMIT(E, "\x83\xE8\x01");  return 1;   /* sub eax, 1 */
+    case NEGc:
+    case NEGi:    EMIT(E, "\xF7\xD8");      return 1;   /* neg eax */
+    case FLIP:    EMIT(E, "\xF7\xD0");      return 1;   /* not eax */
+
+    /* left operand at [r12-4], right in eax */
+    case PLUSc:
+    case PLUSi:
+        EMIT(E, "\x49\x83\xEC\x04" "\x41\x03\x04\x24");       /* add eax, [r12] */
+        return 1;
+    case STARc:
+    case STARi:
+        EMIT(E, "\x49\x83\xEC\x04" "\x41\x0F\xAF\x04\x24");   /* imul eax, [r12] */
+        return 1;
+    case AND:
+        EMIT(E, "\x49\x83\xEC\x04" "\x41\x23\x04\x24");       /* and eax, [r12] */
+        return 1;
+    case OR:
+        EMIT(E, "\x49\x83\xEC\x04" "\x41\x0B\x04\x24");       /* or eax, [r12] */
+        return 1;
+    case MINUSc:
+    case MINUSi:
+        EMIT(E, "\x89\xC1");                  /* mov ecx, eax */
+        reload(E, 4);
+        EMIT(E, "\x29\xC8");                  /* sub eax, ecx */
+        return 1;
+    case SLASHc:
+    case SLASHi:
+    case MODc:
+    case MODi:
+        EMIT(E, "\x89\xC1");                  /* mov ecx, eax */
+        reload(E, 4);
+        EMIT(E, "\x99\xF7\xF9");              /* cdq; idiv ecx */
+        if (MODc == I.op || MODi == I.op) {
+          EMIT(E, "\x89\xD0");                /* mov eax, edx */
+        }
+        return 1;
+
+    case PLUSiLL:
+    case MINUSiLL:
+        spill(E);
+        EMIT(E, "\x8B\x83");                  /* mov eax, [rbx+x] */
+        emit32(E, 4*I.addr);
+        if (PLUSiLL == I.op) {
+          EMIT(E, "\x03\x83");                /* add eax, [rbx+y] */
+        } else {
+          EMIT(E, "\x2B\x83");                /* sub eax, [rbx+y] */
+        }
+        emit32(E, 4*I.addr2);
+        return 1;
+    case PLUSiLV:
+    case MINUSiLV:
+        spill(E);
+        EMIT(E, "\x8B\x83");                  /* mov eax, [rbx+x] */
+        emit32(E, 4*I.addr);
+        if (PLUSiLV == I.op) {
+          EMIT(E, "\x05");                    /* add eax, k */
+        } else {
+          EMIT(E, "\x2D");                    /* sub eax, k */
+        }
+        emit32(E, I.addr2);
+        return 1;
+
+    case GOTO:
+        EMIT(E, "\xE9");
+        fixups[(*nfixups)++] = E->len;
+        emit32(E, I.addr);
+        return 1;
+
+    case IFZc:
+    case IFZi:
+    case IFNZc:
+    case IFNZi:
+        EMIT(E, "\x89\xC1");                  /* mov ecx, eax */
+        reload(E, 4);
+        EMIT(E, "\x85\xC9");                  /* test ecx, ecx */
+        break;
+
+    case IFEQc: case IFEQi:
+    case IFNEc: case IFNEi:
+    case IFLTc: case IFLTi:
+    case IFLEc: case IFLEi:
+    case IFGTc: case IFGTi:
+    case IFGEc: case IFGEi:
+        EMIT(E, "\x89\xC1"                    /* mov ecx, eax */
+                "\x41\x8B\x54\x24\xFC");      /* mov edx, [r12-4] */
+        reload(E, 8);
+        EMIT(E, "\x39\xCA");                  /* cmp edx, ecx */
+        break;
+
+    case IFEQiLL: case IFNEiLL: case IFLTiLL:
+    case IFLEiLL: case IFGTiLL: case IFGEiLL:
+        EMIT(E, "\x8B\x8B");                  /* mov ecx, [rbx+x] */
+        emit32(E, 4*I.addr2);
+        EMIT(E, "\x3B\x8B");                  /* cmp ecx, [rbx+y] */
+        emit32(E, 4*I.addr3);
+        break;
+
+    case IFEQiLV: case IFNEiLV: case IFLTiLV:
+    case IFLEiLV: case IFGTiLV: case IFGEiLV:
+        EMIT(E, "\x81\xBB");                  /* cmp dword [rbx+x], k */
+        emit32(E, 4*I.addr2);
+        emit32(E, I.addr3);
+        break;
+
+    case NONE:
+        return 1;
+
+    default:
+        return 0;
+  }
+
+  /* conditional branches end here */
+  jcc[1] = condition(I.op);
+  emitBytes(E, jcc, 2);
+  fixups[(*nfixups)++] = E->len;
+  emit32(E, I.addr);
+  return 1;
+}
+
+static void* executable(const unsigned char* code, unsigned len)
+{
+  long page = sysconf(_SC_PAGESIZE);
+  size_t size = (len + page - 1) / page * page;
+  void* mem = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (MAP_FAILED == mem) return 0;
+  memcpy(mem, code, len);
+  if (mprotect(mem, size, PROT_READ | PROT_EXEC)) {
+    munmap(mem, size);
+    return 0;
+  }
+  return mem;
+}
+
+/* Where compiled code that runs past its last instruction ends up */
+static void ranPastEnd()
+{
+  vm_context* C = vmCurrent;
+  C->instruction = C->executing->code_length;
+  runtimeError("ran past end of function; missing ret?");
+}
+
+void jitCompile(program* P, function* F)
+{
+  assert(P);
+  assert(F);
+  F->jit_failed = 1;
+  if (!F->verified || 0==F->code_length) return;
+
+  emitter E = { 0, 0, 0 };
+  unsigned* offset = malloc((F->code_length+1) * sizeof(unsigned));
+  unsigned* fixups = malloc(F->code_length * sizeof(unsigned));
+  if (0==offset || 0==fixups) {
+    fprintf(stderr, "Error - couldn't allocate memory to compile %s\n", F->name);
+    exit(2);
+  }
+  unsigned pc, nfixups = 0;
+
+  EMIT(&E, "\x53\x41\x54\x41\x55\x41\x56\x41\x57"   /* push rbx, r12-r15 */
+           "\x48\x89\xFB"                           /* mov rbx, rdi */
+           "\x49\x89\xF4"                           /* mov r12, rsi */
+           "\x49\x89\xF7"                           /* mov r15, rsi */
+           "\x49\xBD");                             /* mov r13, mem */
+  emit64(&E, jitMem);
+
+  for (pc=0; pc<F->code_length; pc++) {
+    offset[pc] = E.len;
+    if (!emitInstruction(&E, P, F, pc, F->code[pc], fixups, &nfixups)) break;
+  }
+  EMIT(&E, "\x48\xB8");                      /* mov rax, ranPastEnd */
+  emit64(&E, (const void*) ranPastEnd);
+  EMIT(&E, "\xFF\xD0");                      /* call rax */
+
+  if (pc == F->code_length) {
+    unsigned i;
+    for (i=0; i<nfixups; i++) {
+      unsigned target;
+      memcpy(&target, E.buf + fixups[i], 4);
+      unsigned rel = offset[target] - (fixups[i] + 4);
+      memcpy(E.buf + fixups[i], &rel, 4);
+    }
+    F->jit = (jit_code) executable(E.buf, E.len);
+    if (F->jit) F->jit_failed = 0;
+  }
+
+  free(fixups);
+  free(offset);
+  free(E.buf);
+}
+
+int jitReady(program* P, function* F)
+{
+  if (F->jit) return 1;
+  if (F->jit_failed || ++F->calls < jitThreshold) return 0;
+  jitCompile(P, F);
+  return 0 != F->jit;
+}
+
+void jitInit(program* P, segment* locals, stack* compstack)
+{
+  jitProgram = P;
+  jitMem = locals->mem_base;
+  jitLocalsEnd = locals->data + locals->size;
+  jitStackEnd = compstack->data + compstack->size;
+
+  /*
+    Switches to the JIT stack:
+      push rbx; mov rbx, rsp; mov rsp, rcx; mov rax, rdi
+      mov rdi, rsi; mov rsi, rdx; call rax; mov rsp, rbx; pop rbx; ret
+  */
+  static const unsigned char code[] =
+    "\x53\x48\x89\xE3\x48\x89\xCC\x48\x89\xF8"
+    "\x48\x89\xF7\x48\x89\xD6\xFF\xD0\x48\x89\xDC\x5B\xC3";
+  enterJit = (trampoline) executable(code, sizeof(code)-1);
+
+  unsigned char* stack = mmap(0, JIT_STACK_SIZE, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (0==enterJit || MAP_FAILED == stack) {
+    fprintf(stderr, "Warning: couldn't set up the JIT, interpreting everything\n");
+    jitEnabled = 0;
+    return;
+  }
+  /* lowest page is a guard */
+  mprotect(stack, sysconf(_SC_PAGESIZE), PROT_NONE);
+  guardRegion(stack, sysconf(_SC_PAGESIZE), "call stack overflow in compiled code");
+  jitStackTop = stack + JIT_STACK_SIZE;
+}
+
+unsigned* jitCall(unsigned fnum, unsigned* locals, unsigned* sp, unsigned pc)
+{
+  program* P = jitProgram;
+  vm_context* const C = vmCurrent;
+  const function* caller = C->executing;
+
+  /* compiled code is verified, so the argument is there */
+  if (fnum < BUILTIN_FUNCTIONS) return callBuiltinFast(&C->io, fnum, sp);
+
+  if (fnum >= P->nf) {
+    C->instruction = pc;
+    runtimeError3("target function number ", fnum, " is too large");
+  }
+  function* G = P->F + fnum;
+
+  if (jitReady(P, G)) {
+    if (jitLocalsEnd - locals < G->parameter_slots + G->local_slots) {
+      C->instruction = pc;
+      runtimeError3("local variable stack overflow\n    in call to function #", fnum, G->name);
+    }
+    unsigned i;
+    sp -= G->parameter_slots;
+    for (i=0; i<G->parameter_slots; i++) {
+      locals[i] = sp[i];
+    }
+    C->executing = G;
+    if (jitStackEnd - sp < G->max_depth) {
+      C->instruction = 0;
+      runtimeError("Stack overflow");
+    }
+    if (onJitStack) {
+      sp = G->jit(locals, sp);
+    } else {
+      onJitStack = 1;
+      sp = enterJit(G->jit, locals, sp, jitStackTop);
+      onJitStack = 0;
+    }
+  } else {
+    segment sublocals = { jitMem, locals, jitLocalsEnd - locals };
+    stack s;
+    s.data = sp - G->parameter_slots;
+    s.size = jitStackEnd - s.data;
+    s.top = G->parameter_slots;
+    C->instruction = pc;
+    callThreaded(P, fnum, &sublocals, &s);
+    sp = s.data + s.top;
+  }
+
+  C->executing = caller;
+  return sp;
+}
+
+#else /* not x86-64 */
+
+const int jitAvailable = 0;
+
+void jitCompile(program* P, function* F)
+{
+  F->jit_failed = 1;
+}
+
+int jitReady(program* P, function* F)
+{
+  return 0;
+}
+
+void jitInit(program* P, segment* locals, stack* compstack)
+{
+}
+
+unsigned* jitCall(unsigned fnum, unsigned* locals, unsigned* sp, unsigned pc)
+{
+  runtimeError("JIT not available");
+  return sp;
+}
+
+#endif
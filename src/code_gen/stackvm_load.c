@@ -0,0 +1,855 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Text program loader.  Kept apart from the engines so the compiler
+  can link it to turn its output into the binary format.
+
+  The input is scanned once, straight out of a mapped (or fully read)
+  buffer: no stdio per character, opcodes found through a perfect
+  hash, and label tables that grow with the function, so neither the
+  size of a function nor its label numbers are limited.
+*/
+
+/*
+  Function data
+*/
+
+void zeroFunc(function *F)
+{
+  assert(F);
+  F->name = 0;
+  F->parameter_slots = 0;
+  F->return_slots = 0;
+  F->local_slots = 0;
+  F->code = 0;
+  F->code_length = 0;
+  F->fused = 0;
+  F->source_pc = 0;
+  F->packed = 0;
+  F->packed_length = 0;
+  F->source = 0;
+  F->source_line = 0;
+  F->threaded = 0;
+  F->registered = 0;
+  F->verified = 0;
+  F->max_depth = 0;
+  F->rejected = 0;
+  F->jit = 0;
+  F->calls = 0;
+  F->jit_failed = 0;
+  F->profile = 0;
+}
+
+const unsigned BUILTIN_FUNCTIONS = 2;
+
+void initBuiltins(function* F)
+{
+  assert(F);
+  /*
+    Builtin 0: int getchar()
+  */
+  F[0].name = strdup("getchar");
+  F[0].return_slots = 1;
+  /*
+    Builtin 1: int putchar(int)
+  */
+  F[1].name = strdup("putchar");
+  F[1].parameter_slots = 1;
+  F[1].return_slots = 1;
+}
+
+/*
+
+  Input file parsing
+
+*/
+
+/*
+  Parser state is per thread, so programs can be read concurrently.
+  Errors go through vmExit, which may return control to a caller
+  instead of exiting; what was read so far is then leaked.
+*/
+__thread int lineno;
+
+void compileError(const char* s)
+{
+  fprintf(vmErrors(), "Error line %d: %s\n", lineno, s);
+  vmExit(1);
+}
+
+void compileError2(const char* s, const char* s2)
+{
+  fprintf(vmErrors(), "Error line %d: %s%s\n", lineno, s, s2);
+  vmExit(1);
+}
+
+void compileError3(const char* s, const char* s2, const char* s3)
+{
+  fprintf(vmErrors(), "Error line %d: %s%s%s\n", lineno, s, s2, s3);
+  vmExit(1);
+}
+
+void compileError3u(const char* s, unsigned s2, const char* s3)
+{
+  fprintf(vmErrors(), "Error line %d: %s%u%s\n", lineno, s, s2, s3);
+  vmExit(1);
+}
+
+void compileError4(const char* s, const char* s2, const char* s3, const char* s4)
+{
+  fprintf(vmErrors(), "Error line %d: %s%s%s%s\n", lineno, s, s2, s3, s4);
+  vmExit(1);
+}
+
+/*
+  The whole input is read into one buffer, mapped when it is a
+  regular file, that ends in a 0 byte.  Everything below scans it
+  with the cursor at; a 0 byte anywhere reads as end of input.
+*/
+
+static __thread const char* at;
+
+typedef struct {
+  char* base;
+  size_t mapped;    /* length of the mapping, 0 if base was malloc'd */
+} source;
+
+static void openSource(FILE* in, source* S)
+{
+  int fd = fileno(in);
+  struct stat st;
+  if (0==fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size > 0
+      && 0==lseek(fd, 0, SEEK_CUR))
+  {
+    /*
+      Map the file over an anonymous region one page longer, so there
+      is always a 0 byte after the last one.
+    */
+    size_t len = st.st_size + sysconf(_SC_PAGESIZE);
+    char* base = mmap(0, len, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED != base) {
+      if (MAP_FAILED != mmap(base, st.st_size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0)) {
+        madvise(base, st.st_size, MADV_SEQUENTIAL);
+        S->base = base;
+        S->mapped = len;
+        at = base;
+        return;
+      }
+      munmap(base, len);
+    }
+  }
+
+  /* Pipes and such: read it all */
+  size_t size = 1 << 16;
+  size_t len = 0;
+  char* buf = malloc(size);
+  for (;;) {
+    if (0==buf) {
+      fprintf(vmErrors(), "Error - couldn't allocate input buffer\n");
+      vmExit(2);
+    }
+    size_t n = fread(buf+len, 1, size-len-1, in);
+    if (0==n) break;
+    len += n;
+    if (len+1 == size) {
+      size *= 2;
+      buf = realloc(buf, size);
+    }
+  }
+  buf[len] = 0;
+  S->base = buf;
+  S->mapped = 0;
+  at = buf;
+}
+
+static void closeSource(source* S)
+{
+  if (S->mapped) {
+    munmap(S->base, S->mapped);
+  } else {
+    free(S->base);
+  }
+  at = 0;
+}
+
+static void skipWS()
+{
+  for (;;) {
+    switch (*at) {
+      case '\n':
+          lineno++;
+          /* fall through */
+      case ' ':
+      case '\t':
+      case '\r':
+          at++;
+          continue;
+      case ';':
+          while (*at && '\n' != *at) at++;
+          continue;
+      default:
+          /* Actual character or end of input */
+          return;
+    }
+  }
+}
+
+static int isDelimiter(char c)
+{
+  return (0==c) || (' '==c) || ('\n'==c) || ('\t'==c) || ('\r'==c) || (';'==c);
+}
+
+static void matchKeyword(const char* keyword)
+{
+  skipWS();
+  while (*keyword) {
+    if (*at != *keyword) {
+      compileError2("expected ", keyword);
+    }
+    at++;
+    keyword++;
+  }
+}
+
+static unsigned readHex()
+{
+  skipWS();
+  if ('0'==at[0] && ('x'==at[1] || 'X'==at[1]) && isxdigit((unsigned char) at[2])) {
+    at += 2;
+  }
+  if (!isxdigit((unsigned char) *at)) {
+    compileError("expected hex value");
+  }
+  unsigned out = 0;
+  for (;;) {
+    char c = *at;
+    if (c >= '0' && c <= '9')       out = 16*out + (c - '0');
+    else if (c >= 'a' && c <= 'f')  out = 16*out + (c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')  out = 16*out + (c - 'A' + 10);
+    else                            return out;
+    at++;
+  }
+}
+
+static unsigned readDigits(const char* what)
+{
+  if (*at < '0' || *at > '9') {
+    compileError2("expected ", what);
+  }
+  unsigned long out = 0;
+  while (*at >= '0' && *at <= '9') {
+    out = 10*out + (*at - '0');
+    if (out > UINT_MAX) {
+      compileError3("", what, " too large");
+    }
+    at++;
+  }
+  return out;
+}
+
+static unsigned readUnsigned(const char* what)
+{
+  skipWS();
+  return readDigits(what);
+}
+
+static unsigned readLabel()
+{
+  skipWS();
+  if ('I' != *at) {
+    compileError("expected label");
+  }
+  at++;
+  unsigned out = readDigits("label");
+  if (':' == *at) at++;
+  return out;
+}
+
+static void readAddress(instruction *I)
+{
+  assert(I);
+  skipWS();
+  switch (*at) {
+    case CONST:
+    case GLOBAL:
+    case LOCAL:
+        I->atype = *at++;
+        I->addr = readUnsigned("address");
+        return;
+
+    default:
+        compileError("expected address type C, G, or L");
+  }
+}
+
+/*
+  Opcode lookup.  The hash is built up while the token is scanned;
+  with these constants it is perfect on the 68 mnemonics (initOpcodes
+  checks), so a lookup is one slot and one compare.
+*/
+#define OPCODE_SLOTS  256
+
+static inline unsigned hashStep(unsigned h, char c)
+{
+  return h * 3882u + (unsigned char) c;
+}
+
+static inline unsigned opcodeSlot(unsigned h)
+{
+  return (h * 2654435761u) >> 24;
+}
+
+static const struct {
+  const char* name;
+  opcode op;
+} mnemonics[] = {
+  { "push", PUSH },     { "ptrto", PTRTO },   { "pushv", PUSHv },
+  { "pushc[]", PUSHc }, { "pushi[]", PUSHi }, { "pushf[]", PUSHf },
+  { "copy", COPY },     { "move", MOVE },
+  { "popx", POPX },     { "pop", POP },
+  { "popc[]", POPc },   { "popi[]", POPi },   { "popf[]", POPf },
+  { "call", CALL },     { "ret", RET },
+  { "++c", INCc },      { "++i", INCi },      { "++f", INCf },
+  { "--c", DECc },      { "--i", DECi },      { "--f", DECf },
+  { "negc", NEGc },     { "negi", NEGi },     { "negf", NEGf },
+  { "flip", FLIP },     { "convif", CONVif }, { "convfi", CONVfi },
+  { "+c", PLUSc },      { "+i", PLUSi },      { "+f", PLUSf },
+  { "-c", MINUSc },     { "-i", MINUSi },     { "-f", MINUSf },
+  { "*c", STARc },      { "*i", STARi },      { "*f", STARf },
+  { "/c", SLASHc },     { "/i", SLASHi },     { "/f", SLASHf },
+  { "%c", MODc },       { "%i", MODi },
+  { "&", AND },         { "|", OR },
+  { "goto", GOTO },
+  { "==0c", IFZc },     { "==0i", IFZi },     { "==0f", IFZf },
+  { "!=0c", IFNZc },    { "!=0i", IFNZi },    { "!=0f", IFNZf },
+  { "==c", IFEQc },     { "==i", IFEQi },     { "==f", IFEQf },
+  { "!=c", IFNEc },     { "!=i", IFNEi },     { "!=f", IFNEf },
+  { "<c", IFLTc },      { "<i", IFLTi },      { "<f", IFLTf },
+  { "<=c", IFLEc },     { "<=i", IFLEi },     { "<=f", IFLEf },
+  { ">c", IFGTc },      { ">i", IFGTi },      { ">f", IFGTf },
+  { ">=c", IFGEc },     { ">=i", IFGEi },     { ">=f", IFGEf },
+};
+
+static struct {
+  const char* name;
+  unsigned len;
+  opcode op;
+} opcodeTable[OPCODE_SLOTS];
+
+/* Filled in before main, so threads only ever read it */
+static void __attribute__((constructor)) initOpcodes()
+{
+  unsigned i;
+  for (i=0; i<sizeof(mnemonics)/sizeof(mnemonics[0]); i++) {
+    const char* s;
+    unsigned h = 0;
+    for (s=mnemonics[i].name; *s; s++) h = hashStep(h, *s);
+    unsigned slot = opcodeSlot(h);
+    if (opcodeTable[slot].name && opcodeTable[slot].op != mnemonics[i].op) {
+      fprintf(vmErrors(), "Internal error: opcode hash collision on %s\n", mnemonics[i].name);
+      vmExit(2);
+    }
+    opcodeTable[slot].name = mnemonics[i].name;
+    opcodeTable[slot].len = s - mnemonics[i].name;
+    opcodeTable[slot].op = mnemonics[i].op;
+  }
+}
+
+static opcode lookupOpcode(const char* token, unsigned len, unsigned h)
+{
+  unsigned slot = opcodeSlot(h);
+  if (opcodeTable[slot].len != len) return ERROR;
+  if (memcmp(opcodeTable[slot].name, token, len)) return ERROR;
+  return opcodeTable[slot].op;
+}
+
+/*
+  Scan a token, leaving its start in *token and its hash in *h.
+  Returns the length, 0 at end of input.
+*/
+static unsigned readToken(const char** token, unsigned* h)
+{
+  skipWS();
+  const char* start = at;
+  unsigned hash = 0;
+  while (!isDelimiter(*at)) {
+    hash = hashStep(hash, *at);
+    at++;
+  }
+  *token = start;
+  *h = hash;
+  return at - start;
+}
+
+/* Copy of a token, for error messages */
+static char* tokenString(const char* token, unsigned len)
+{
+  return strndup(token, len);
+}
+
+static char* readIdent()
+{
+  skipWS();
+  const char* start = at;
+  while (('_' == *at) || (*at>='a' && *at<='z') || (*at>='A' && *at<='Z')
+         || (at > start && *at>='0' && *at<='9'))
+  {
+    at++;
+  }
+  if (at == start) {
+    compileError("expected function name");
+  }
+  return strndup(start, at - start);
+}
+
+/*
+  Labels of the current function, in an open addressed table that
+  grows as needed.  Entries from earlier functions are told apart by
+  their generation, so starting a function doesn't clear anything.
+*/
+typedef struct {
+  unsigned label;
+  unsigned pc;
+  unsigned gen;
+} label_entry;
+
+static __thread label_entry* labels;
+static __thread unsigned labelSlots;
+static __thread unsigned labelCount;
+static __thread unsigned labelGen;
+
+static label_entry* findLabel(unsigned label)
+{
+  unsigned i = (label * 2654435761u) & (labelSlots-1);
+  while (labels[i].gen == labelGen && labels[i].label != label) {
+    i = (i+1) & (labelSlots-1);
+  }
+  return labels+i;
+}
+
+static void growLabels()
+{
+  label_entry* old = labels;
+  unsigned oldSlots = labelSlots;
+  labelSlots = oldSlots ? 2*oldSlots : 1024;
+  labels = calloc(labelSlots, sizeof(label_entry));
+  if (0==labels) {
+    fprintf(vmErrors(), "Error - couldn't allocate label table\n");
+    vmExit(2);
+  }
+  unsigned i;
+  for (i=0; i<oldSlots; i++) {
+    if (old[i].gen != labelGen) continue;
+    *findLabel(old[i].label) = old[i];
+  }
+  free(old);
+}
+
+static void newLabels()
+{
+  labelGen++;
+  labelCount = 0;
+  if (0==labelSlots) growLabels();
+}
+
+static void defineLabel(const char* token, unsigned len, unsigned pc)
+{
+  const char* end = token + len;
+  at = token+1;
+  unsigned label = readDigits("label number");
+  if (at < end && ':' == *at) at++;
+  if (at != end) {
+    compileError2("bad label ", tokenString(token, len));
+  }
+
+  if (2*(labelCount+1) > labelSlots) growLabels();
+  label_entry* L = findLabel(label);
+  if (L->gen == labelGen) {
+    compileError3("label ", tokenString(token, len), " already used in this function");
+  }
+  L->label = label;
+  L->pc = pc;
+  L->gen = labelGen;
+  labelCount++;
+#ifdef DEBUG_LABELS
+  printf("Label I%u mapped to instruction %u\n", label, pc);
+#endif
+}
+
+static unsigned readConstants(segment* Mem)
+{
+  matchKeyword(".CONSTANTS");
+  unsigned slots = readUnsigned("#constants");
+  if (slots > Mem->size) {
+    compileError3u("", slots, " constants don't fit in memory");
+  }
+  unsigned i;
+  for (i=0; i<slots; i++) {
+    Mem->data[i] = readHex();
+  }
+  return slots;
+}
+
+static unsigned readGlobals()
+{
+  matchKeyword(".GLOBALS");
+  return readUnsigned("#globals");
+}
+
+static unsigned readFunctions()
+{
+  matchKeyword(".FUNCTIONS");
+  return readUnsigned("#functions");
+}
+
+static instruction finishReading(function* f, unsigned nc, unsigned ng, opcode op)
+{
+  assert(f);
+
+  instruction I;
+  I.op = op;
+  I.addr2 = 0;
+  I.addr3 = 0;
+
+  switch (op) {
+    /*
+      Cases that require an address
+    */
+    case PUSH:
+    case PTRTO:
+        readAddress(&I);
+        switch (I.atype) {
+          case CONST:   if (I.addr >= nc) compileError("constant index too large");
+                        break;
+          case GLOBAL:  if (I.addr >= ng) compileError("global index too large");
+                        break;
+          case LOCAL:   if (I.addr >= f->parameter_slots + f->local_slots) {
+                          compileError("local index too large");
+                        }
+                        break;
+          default:
+                        /* Should have caught this error already */
+                        fprintf(vmErrors(), "Internal error 1\n");
+                        vmExit(1);
+        }; /* switch */
+        break;
+
+    case POP:
+        readAddress(&I);
+        switch (I.atype) {
+          case CONST:   compileError("target of pop cannot be a constant");
+                        break;
+          case GLOBAL:  if (I.addr >= ng) compileError("global index too large");
+                        break;
+          case LOCAL:   if (I.addr >= f->parameter_slots + f->local_slots) {
+                          compileError("local index too large");
+                        }
+                        break;
+          default:
+                        /* Should have caught this error already */
+                        fprintf(vmErrors(), "Internal error 2\n");
+                        vmExit(1);
+        }; /* switch */
+        break;
+
+    /*
+      Cases that require an unsigned integer
+    */
+    case CALL:
+        I.atype = FNUM;
+        I.addr = readUnsigned("function number");
+        break;
+
+    case MOVE:
+        I.atype = MOVEDIST;
+        I.addr = readUnsigned("move distance");
+        break;
+
+    /*
+      Cases that require a label
+    */
+    case GOTO:
+    case IFZc:
+    case IFZi:
+    case IFZf:
+    case IFNZc:
+    case IFNZi:
+    case IFNZf:
+    case IFEQc:
+    case IFEQi:
+    case IFEQf:
+    case IFNEc:
+    case IFNEi:
+    case IFNEf:
+    case IFLTc:
+    case IFLTi:
+    case IFLTf:
+    case IFLEc:
+    case IFLEi:
+    case IFLEf:
+    case IFGTc:
+    case IFGTi:
+    case IFGTf:
+    case IFGEc:
+    case IFGEi:
+    case IFGEf:
+        I.atype = LABEL;
+        I.addr = readLabel();
+        break;
+
+    /*
+      Cases that require a hex value
+    */
+    case PUSHv:
+        I.atype = VALUE;
+        I.addr = readHex();
+        break;
+
+    /*
+      Default cases: no operand
+    */
+    default:
+        I.atype = UNUSED;
+        I.addr = 0;
+  }
+  return I;
+}
+
+static unsigned readFuncNum()
+{
+  matchKeyword(".FUNC");
+  return readUnsigned("function number");
+}
+
+/*
+  Instructions of the function being read; reused from one function
+  to the next, so it only grows until the largest one fits.
+*/
+static __thread instruction* scratch;
+static __thread unsigned scratchSize;
+
+static void readHeader(function* F)
+{
+  assert(F);
+
+  F->name = readIdent();
+#ifdef DEBUG_PARSER
+  printf("Parsing function %s\n", F->name);
+#endif
+  matchKeyword(".params");
+  F->parameter_slots = readUnsigned("#slots");
+  matchKeyword(".return");
+  F->return_slots = readUnsigned("#slots");
+  matchKeyword(".locals");
+  F->local_slots = readUnsigned("#slots");
+#ifdef DEBUG_PARSER
+  printf("#param_slots %u #return_slots %u #locals %u\n",
+    F->parameter_slots, F->return_slots, F->local_slots
+  );
+#endif
+}
+
+static void readBody(function* F, unsigned nc, unsigned ng)
+{
+  assert(F);
+
+  newLabels();
+  unsigned n = 0;
+  for (;;) {
+    const char* token;
+    unsigned h;
+    unsigned len = readToken(&token, &h);
+
+    if (0==len) {
+      compileError("unexpected end of input\n(expecting instruction, label, or .end)");
+    }
+    if (4==len && 0==memcmp(".end", token, 4)) break;
+
+    if ('I'==token[0]) {
+      /* This is a label. */
+      defineLabel(token, len, n);
+      continue;
+    }
+
+    opcode OP = lookupOpcode(token, len, h);
+    if (ERROR == OP) {
+      compileError2("unknown instruction ", tokenString(token, len));
+    }
+
+    if (n >= scratchSize) {
+      // enlarge
+      scratchSize = scratchSize ? 2*scratchSize : 1024;
+      scratch = realloc(scratch, scratchSize * sizeof(instruction));
+      if (0==scratch) {
+        fprintf(vmErrors(), "Error - couldn't allocate memory for function %s\n", F->name);
+        vmExit(2);
+      }
+    }
+
+    scratch[n] = finishReading(F, nc, ng, OP);
+
+#ifdef DEBUG_PARSER
+    printf("Instruction %u: ", n);
+    showInstruction(stdout, scratch[n]);
+    printf("\n");
+#endif
+    n++;
+  }
+
+  // saw .end
+  matchKeyword("FUNC");
+
+  /*
+    Go through the code, replace labels with instruction numbers
+  */
+  unsigned i;
+  for (i=0; i<n; i++) {
+    if (LABEL==scratch[i].atype) {
+      label_entry* L = findLabel(scratch[i].addr);
+      if (L->gen != labelGen) {
+        compileError3u("label I", scratch[i].addr, " not found in this function");
+      }
+      if (L->pc >= n) {
+        compileError3u("label I", scratch[i].addr, " past end of function");
+      }
+      scratch[i].addr = L->pc;
+    }
+  }
+
+  /*
+    Store an exact size copy in F
+  */
+  F->code_length = n;
+  F->code = malloc(n * sizeof(instruction));
+  if (n && 0==F->code) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory for function %s\n", F->name);
+    vmExit(2);
+  }
+  memcpy(F->code, scratch, n * sizeof(instruction));
+
+#ifdef DEBUG_PARSER
+  printf("Done parsing function %s\n", F->name);
+#endif
+}
+
+/*
+  Skip to the end of a function's code, noting where it starts
+*/
+static void skipBody(function* F)
+{
+  assert(F);
+  F->source = at;
+  F->source_line = lineno;
+  for (;;) {
+    skipWS();
+    if (0==*at) {
+      compileError("unexpected end of input\n(expecting instruction, label, or .end)");
+    }
+    if ('.'==at[0] && 'e'==at[1] && 'n'==at[2] && 'd'==at[3] && isDelimiter(at[4])) break;
+    while (!isDelimiter(*at)) at++;
+  }
+  at += 4;
+  matchKeyword("FUNC");
+}
+
+void loadFunction(program* P, function* F)
+{
+  assert(P);
+  assert(F);
+  assert(F->source);
+  at = F->source;
+  lineno = F->source_line;
+  readBody(F, P->constants.size, P->globals.size);
+  F->source = 0;
+  at = 0;
+  if (fusionEnabled) fuseFunction(F);
+  if (P->verify) verifyFunction(P, F);
+  packFunction(F);
+}
+
+static void readAll(FILE* in, program* P, segment* memory, int lazy)
+{
+  assert(P);
+  assert(memory);
+  lineno = 1;
+  source S;
+  openSource(in, &S);
+
+/*
+  Parse constants, globals
+*/
+  unsigned nc = readConstants(memory);
+  unsigned ng = readGlobals();
+  if (ng > memory->size - nc) {
+    compileError3u("", ng, " globals don't fit in memory");
+  }
+  P->constants.mem_base = memory->mem_base;
+  P->constants.data = memory->data;
+  P->constants.size = nc;
+  P->globals.mem_base = memory->mem_base;
+  P->globals.data = memory->data + nc;
+  P->globals.size = ng;
+
+/*
+  Parse functions
+*/
+  P->nf = readFunctions();
+  P->nf += BUILTIN_FUNCTIONS;  // reserved functions
+  P->F = malloc(P->nf * sizeof(function));
+  unsigned f;
+  for (f=0; f<P->nf; f++) {
+    zeroFunc(P->F+f);
+  }
+  initBuiltins(P->F);
+
+#ifdef DEBUG_PARSER
+  printf("Reading %u functions\n", P->nf);
+#endif
+  for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+    unsigned fnum = readFuncNum();
+    if (fnum >= P->nf) {
+      fprintf(vmErrors(), "Error line %d: function number %u too large (max %u)\n",
+        lineno, fnum, P->nf);
+      vmExit(1);
+    }
+    if (P->F[fnum].name) {
+      fprintf(vmErrors(), "Error line %d: function number %u in use by %s\n",
+        lineno, fnum, P->F[fnum].name);
+      vmExit(1);
+    }
+    readHeader(P->F+fnum);
+    if (lazy) {
+      skipBody(P->F+fnum);
+    } else {
+      readBody(P->F+fnum, nc, ng);
+    }
+  }
+  P->verify = 0;
+  if (lazy) {
+    /* function code is read from it later */
+    at = 0;
+    return;
+  }
+  closeSource(&S);
+}
+
+void readProgram(FILE* in, program* P, segment* memory)
+{
+  readAll(in, P, memory, 0);
+}
+
+void readProgramLazy(FILE* in, program* P, segment* memory, int verify)
+{
+  readAll(in, P, memory, 1);
+  P->verify = verify;
+}
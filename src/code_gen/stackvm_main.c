@@ -0,0 +1,463 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "../../includes/stackvm.h"
+
+//#define SHOW_PROGRAM
+
+/*
+  Main
+*/
+
+const char* usage = 
+"  Read intermediate code; if no file specified, reads standard input.\n\
+  The lowest numbered function named main is called.\n\n\
+  Input format is ComS 440/540 intermediate representation, which\n\
+  is a free-form text file.  Any text between ; and end of line is\n\
+  ignored.  Format is the following:\n\
+    .CONSTANTS (number of slots)\n\
+    (slot 1 as 32-bit unsigned hex)\n\
+    (slot 2 as 32-bit unsigned hex)\n\
+    ...\n\
+    .GLOBALS (number of slots)\n\
+    .FUNCTIONS (number of functions)\n\
+    .FUNC number name\n\
+      .params (number of slots)\n\
+      .return (number of slots (0 or 1))\n\
+      .locals (number of slots)\n\
+      0 instruction-0\n\
+      1 instruction-1\n\
+      ...\n\
+    .end FUNC\n\
+    .FUNC\n\
+      ...\n\
+    .end FUNC\n\n\
+  Legal instructions: see project spec document.\n\n\
+  Built-in functions:\n\
+    Function 0: int getchar()\n\
+    Function 1: int putchar(int c)\n\
+  So, don't overwrite those.  Output is buffered until exit, or until\n\
+  the end of a line when it is a terminal; putchar(-1) writes nothing\n\
+  and flushes it.\n\n\
+  Options:\n\
+    --engine=switch     run with the reference switch interpreter (default)\n\
+    --engine=threaded   run with the direct-threaded interpreter\n\
+    --engine=register   translate to register code where possible and run that\n\
+    --engine=jit        threaded, compiling hot functions to native code\n\
+    --jit-threshold=N   calls before a function is compiled (default 1)\n\
+    --no-fusion         don't fuse common sequences into superinstructions\n\
+    --no-verify         skip the load-time verifier; everything runs checked\n\
+    --eager             read, fuse and verify every function before main\n\
+                        runs; otherwise, with the switch and threaded\n\
+                        engines, each is read on its first call\n\
+    --fusion-stats      report fusion sites and executions on exit\n\
+    --emit-irb=FILE     write the program to FILE in binary form and exit\n\
+    --profile[=FILE]    count opcodes, instructions and calls with the switch\n\
+                        interpreter; report to stderr and as JSON to FILE\n\
+                        (default profile.json)\n\
+    --sample[=FILE]     sample the call stack with SIGPROF while the switch\n\
+                        interpreter runs; write folded stacks, as used by\n\
+                        flame graph tools, to FILE (default profile.folded)\n\
+    --sample-rate=HZ    samples per second of CPU time (default 997)\n\
+    --globals=N         room for constants and globals (default 1M)\n\
+    --locals=N          room for local variables (default 16M)\n\
+    --stack=N           room for the computation stack (default 4M)\n\
+    --huge-pages        ask for transparent huge pages for all of those\n\
+    --batch=FILE        run the jobs listed in FILE, one per line, as\n\
+                          IRFILE [INFILE [OUTFILE]]\n\
+                        each reading INFILE (default none) and writing\n\
+                        OUTFILE (default stdout);\n\
+                        each IRFILE is loaded once, and the jobs are run\n\
+                        in parallel, with a line about each on stdout\n\
+    --threads=N         threads for --batch (default one per processor)\n\
+    --schedule[=N]      with --batch, start all of each thread's jobs at\n\
+                        once as green threads, and switch between them\n\
+                        every N instructions (default 10K) or when one\n\
+                        waits for input; runs the switch engine, and\n\
+                        adds instructions, CPU time and latency per job\n\
+    --serve=SOCKET      load file once, then listen on the Unix socket\n\
+                        SOCKET and run it in a forked copy for each\n\
+                        connection; the client sends a line of '-' and\n\
+                        then its input, or a path to read input from, or\n\
+                        an empty line for none, and gets back the output\n\
+                        and result as above\n\n\
+  Sizes are in 4-byte slots, with an optional K, M or G suffix.  They\n\
+  may also be set with STACKVM_GLOBALS, STACKVM_LOCALS, STACKVM_STACK\n\
+  and STACKVM_HUGE_PAGES=1; options win.  Memory is only reserved up\n\
+  front, and filled in as it is touched; with --batch, each thread has\n\
+  that much.  Constants, globals and locals are addressed with 32-bit\n\
+  slot numbers, so together they are limited to 4G slots.\n\n\
+  The input may also be a binary program from --emit-irb or the\n\
+  compiler's -b option; it is mapped instead of parsed.\n\n";
+
+/*
+  Sizes for --globals, --locals and --stack: a number of slots, with an
+  optional K, M or G suffix.  Returns 0 if s isn't one.
+*/
+static int parseSlots(const char* s, size_t* slots)
+{
+  char* end;
+  if (*s < '0' || *s > '9') return 0;
+  unsigned long long n = strtoull(s, &end, 10);
+  switch (*end) {
+    case 'G':   n <<= 10;
+    case 'M':   n <<= 10;
+    case 'K':   n <<= 10;
+                end++;
+  }
+  if (*end || 0==n || n > (1ull << 40)) return 0;
+  *slots = n;
+  return 1;
+}
+
+static void sizeFromEnv(const char* name, size_t* slots)
+{
+  const char* value = getenv(name);
+  if (value && !parseSlots(value, slots)) {
+    fprintf(stderr, "Warning: ignoring %s=%s; not a number of slots\n", name, value);
+  }
+}
+
+int main(int argc, const char** argv)
+{
+  vm_engine engine = ENGINE_SWITCH;
+  int verify = 1;
+  int eager = 0;
+  const char* infile = 0;
+  const char* irbfile = 0;
+  const char* profile = 0;
+  const char* sample = 0;
+  unsigned sampleRate = 997;
+  const char* batch = 0;
+  unsigned threads = 0;
+  size_t quantum = 0;
+  const char* serve = 0;
+  size_t globalSlots = 1 << 20;
+  size_t localSlots = 1 << 24;
+  size_t stackSlots = 1 << 22;
+  sizeFromEnv("STACKVM_GLOBALS", &globalSlots);
+  sizeFromEnv("STACKVM_LOCALS", &localSlots);
+  sizeFromEnv("STACKVM_STACK", &stackSlots);
+  if (getenv("STACKVM_HUGE_PAGES")) hugePages = strcmp("0", getenv("STACKVM_HUGE_PAGES"));
+  int a;
+  for (a=1; a<argc; a++) {
+    if (0==strcmp("--engine=switch", argv[a])) {
+      engine = ENGINE_SWITCH;
+      continue;
+    }
+    if (0==strcmp("--engine=threaded", argv[a])) {
+      engine = ENGINE_THREADED;
+      continue;
+    }
+    if (0==strcmp("--engine=register", argv[a])) {
+      engine = ENGINE_REGISTER;
+      continue;
+    }
+    if (0==strcmp("--engine=jit", argv[a])) {
+      engine = ENGINE_JIT;
+      continue;
+    }
+    if (0==strncmp("--jit-threshold=", argv[a], 16)) {
+      jitThreshold = atoi(argv[a]+16);
+      continue;
+    }
+    if (0==strncmp("--emit-irb=", argv[a], 11)) {
+      irbfile = argv[a]+11;
+      continue;
+    }
+    if (0==strcmp("--profile", argv[a])) {
+      profile = "profile.json";
+      continue;
+    }
+    if (0==strncmp("--profile=", argv[a], 10)) {
+      profile = argv[a]+10;
+      continue;
+    }
+    if (0==strcmp("--sample", argv[a])) {
+      sample = "profile.folded";
+      continue;
+    }
+    if (0==strncmp("--sample=", argv[a], 9)) {
+      sample = argv[a]+9;
+      continue;
+    }
+    if (0==strncmp("--sample-rate=", argv[a], 14)) {
+      sampleRate = atoi(argv[a]+14);
+      continue;
+    }
+    if (0==strncmp("--globals=", argv[a], 10) && parseSlots(argv[a]+10, &globalSlots)) {
+      continue;
+    }
+    if (0==strncmp("--locals=", argv[a], 9) && parseSlots(argv[a]+9, &localSlots)) {
+      continue;
+    }
+    if (0==strncmp("--stack=", argv[a], 8) && parseSlots(argv[a]+8, &stackSlots)) {
+      continue;
+    }
+    if (0==strcmp("--huge-pages", argv[a])) {
+      hugePages = 1;
+      continue;
+    }
+    if (0==strcmp("--no-fusion", argv[a])) {
+      fusionEnabled = 0;
+      continue;
+    }
+    if (0==strcmp("--no-verify", argv[a])) {
+      verify = 0;
+      continue;
+    }
+    if (0==strcmp("--eager", argv[a])) {
+      eager = 1;
+      continue;
+    }
+    if (0==strcmp("--fusion-stats", argv[a])) {
+      fusionStats = 1;
+      continue;
+    }
+    if (0==strncmp("--batch=", argv[a], 8)) {
+      batch = argv[a]+8;
+      continue;
+    }
+    if (0==strncmp("--threads=", argv[a], 10) && atoi(argv[a]+10) > 0) {
+      threads = atoi(argv[a]+10);
+      continue;
+    }
+    if (0==strcmp("--schedule", argv[a])) {
+      quantum = 10000;
+      continue;
+    }
+    if (0==strncmp("--schedule=", argv[a], 11) && parseSlots(argv[a]+11, &quantum) && quantum) {
+      continue;
+    }
+    if (0==strncmp("--serve=", argv[a], 8) && argv[a][8]) {
+      serve = argv[a]+8;
+      continue;
+    }
+    if ('-' == argv[a][0] || infile) {
+      fprintf(stderr, "Usage: %s [options] [file]\n\n", argv[0]);
+      fputs(usage, stderr);
+      return 1;
+    }
+    infile = argv[a];
+  }
+  if (globalSlots + localSlots > (1ull << 32)) {
+    fprintf(stderr, "Error, globals and locals together can't pass 4G slots\n");
+    return 1;
+  }
+  if (profile && sample) {
+    fprintf(stderr, "Error, --profile and --sample can't be used together\n");
+    return 1;
+  }
+  if (sample && 0==sampleRate) {
+    fprintf(stderr, "Error, --sample-rate must be at least 1\n");
+    return 1;
+  }
+  if ((profile || sample) && ENGINE_SWITCH != engine) {
+    fprintf(stderr, "Warning: %s runs the switch engine\n", profile ? "--profile" : "--sample");
+    engine = ENGINE_SWITCH;
+  }
+  if (quantum && !batch) {
+    fprintf(stderr, "Error, --schedule is only for --batch\n");
+    return 1;
+  }
+  if (quantum && ENGINE_SWITCH != engine) {
+    fprintf(stderr, "Warning: --schedule runs the switch engine\n");
+    engine = ENGINE_SWITCH;
+  }
+  if (batch) {
+    if (infile || irbfile || profile || sample || fusionStats || ENGINE_JIT == engine) {
+      fprintf(stderr, "Error, --batch takes no file, and can't be used with --emit-irb,\n"
+        "--profile, --sample, --fusion-stats or --engine=jit\n");
+      return 1;
+    }
+    if (0==threads) threads = sysconf(_SC_NPROCESSORS_ONLN);
+    return runBatch(batch, threads, engine, verify, globalSlots, localSlots, stackSlots,
+      quantum);
+  }
+  if (serve) {
+    if (0==infile || irbfile || profile || sample || fusionStats || ENGINE_JIT == engine) {
+      fprintf(stderr, "Error, --serve needs a file, and can't be used with --emit-irb,\n"
+        "--profile, --sample, --fusion-stats or --engine=jit\n");
+      return 1;
+    }
+    return runServer(serve, infile, engine, verify, globalSlots, localSlots, stackSlots);
+  }
+  if (ENGINE_JIT == engine && !jitAvailable) {
+    fprintf(stderr, "Warning: JIT not available in this build, using threaded\n");
+    engine = ENGINE_THREADED;
+  }
+  if (ENGINE_JIT == engine && !threadedAvailable) {
+    fprintf(stderr, "Warning: threaded engine not available in this build, using switch\n");
+    engine = ENGINE_SWITCH;
+  }
+  if (ENGINE_THREADED == engine && !threadedAvailable) {
+    fprintf(stderr, "Warning: threaded engine not available in this build, using switch\n");
+    engine = ENGINE_SWITCH;
+  }
+
+/* 
+  Initialize "memory"
+*/
+
+  program P;
+  segment main_memory, loaded, locals;
+  const char* pastLocals = "memory access past the end of local variable space";
+  initSegment(&main_memory, globalSlots + localSlots, pastLocals);
+  makeSubSegment(&main_memory, 0, globalSlots, &loaded);  /* constants and globals */
+  segment compstack_memory;
+  initSegment(&compstack_memory, stackSlots, "Stack overflow");
+  stack compstack;
+  initStack(&compstack_memory, 0, &compstack);
+
+/*
+  Load the program: binary files are mapped, anything else is parsed
+*/
+  if (0==infile || !loadIrb(infile, &P, &loaded)) {
+    FILE* in;
+    if (infile) {
+      in = fopen(infile, "r");
+      if (0==in) {
+        fprintf(stderr, "Error, couldn't open file '%s'\n", infile);
+        return 1;
+      }
+    } else {
+      in = stdin;
+    }
+    /*
+      Functions are read on their first call, unless something
+      needs them all
+    */
+    int lazy = !eager && !irbfile && !profile && !sample && !fusionStats
+      && (ENGINE_SWITCH == engine || ENGINE_THREADED == engine);
+    if (lazy) {
+      readProgramLazy(in, &P, &loaded, verify);
+    } else {
+      readProgram(in, &P, &loaded);
+    }
+    if (in != stdin) fclose(in);
+  }
+  unsigned nc = P.constants.size;
+  unsigned ng = P.globals.size;
+  shrinkSegment(&main_memory, nc+ng+localSlots, pastLocals);
+  makeSubSegment(&main_memory, nc+ng, main_memory.size, &locals);   /* Rest - locals */
+  unsigned f;
+
+  if (irbfile) {
+    FILE* out = fopen(irbfile, "wb");
+    if (0==out) {
+      fprintf(stderr, "Error, couldn't open file '%s'\n", irbfile);
+      return 1;
+    }
+    writeIrb(out, &P);
+    if (fclose(out)) {
+      fprintf(stderr, "Error writing '%s'\n", irbfile);
+      return 1;
+    }
+    return 0;
+  }
+
+/*
+  Collapse common sequences into superinstructions
+*/
+  if (fusionEnabled) {
+    for (f=BUILTIN_FUNCTIONS; f<P.nf; f++) {
+      if (P.F[f].name && !P.F[f].source) fuseFunction(P.F+f);
+    }
+  }
+
+/*
+  Verify functions; calls need every function read first
+*/
+  if (verify) {
+    for (f=BUILTIN_FUNCTIONS; f<P.nf; f++) {
+      if (P.F[f].name && !P.F[f].source) verifyFunction(&P, P.F+f);
+    }
+  }
+
+/*
+  Pack the final code for callFunction
+*/
+  for (f=BUILTIN_FUNCTIONS; f<P.nf; f++) {
+    if (P.F[f].name && !P.F[f].source && !P.F[f].rejected) packFunction(P.F+f);
+  }
+
+#ifdef SHOW_PROGRAM
+  printf("Done reading input.\n");
+  printf("Constants:\n");
+  showSegment(&P.constants);
+  printf("Functions:\n");
+  for (f=0; f<P.nf; f++) {
+    showFunction(stdout, f, P.F+f);
+  }
+#endif
+
+  unsigned entry = 0;
+  for (f=P.nf-1; f; f--) {
+    if (0==P.F[f].name) continue;
+    if (0==strcmp("main", P.F[f].name)) entry = f;
+  }
+
+  if (!entry) {
+    fprintf(stderr, "Error, no function named main to execute\n");
+    return 2;
+  }
+#ifdef SHOW_PROGRAM
+  else {
+    printf("Entry point is function #%u\n", entry);
+  }
+#endif
+
+  ioOpen(&vmCurrent->io, 0, 1, 0==infile);
+  atexit(ioFlush);
+  if (ENGINE_THREADED == engine) {
+    for (f=BUILTIN_FUNCTIONS; f<P.nf; f++) {
+      if (!P.F[f].source && !P.F[f].rejected) threadFunction(&P, P.F+f);
+    }
+    callThreaded(&P, entry, &locals, &compstack);
+  } else if (ENGINE_JIT == engine) {
+    for (f=BUILTIN_FUNCTIONS; f<P.nf; f++) {
+      if (!P.F[f].rejected) threadFunction(&P, P.F+f);
+    }
+    jitEnabled = 1;
+    jitInit(&P, &locals, &compstack);
+    if (jitEnabled && jitReady(&P, P.F+entry)) {
+      unsigned* sp = jitCall(entry, locals.data, compstack.data + compstack.top, 0);
+      compstack.top = sp - compstack.data;
+    } else {
+      callThreaded(&P, entry, &locals, &compstack);
+    }
+  } else if (ENGINE_REGISTER == engine) {
+    for (f=BUILTIN_FUNCTIONS; f<P.nf; f++) {
+      registerFunction(&P, P.F+f);
+    }
+    callRegister(&P, entry, &locals, &compstack);
+  } else if (profile) {
+    profileStart(&P);
+    callProfiled(&P, entry, &locals, &compstack);
+  } else if (sample) {
+    sampleStart(&P, sampleRate);
+    callSampled(&P, entry, &locals, &compstack);
+    sampleStop();
+  } else {
+    callFunction(&P, entry, &locals, &compstack);
+  }
+  ioFlush();
+  printf("Function main returned: %d\n", u2i(top(&compstack)));
+  if (profile) {
+    fflush(stdout);
+    profileReport(&P, stderr, profile);
+  }
+  if (sample) {
+    fflush(stdout);
+    sampleReport(&P, stderr, sample);
+  }
+  if (fusionStats) {
+    fflush(stdout);
+    showFusionStats(stderr);
+  }
+
+  return 0;
+}
+
@@ -0,0 +1,219 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Packed code.
+
+  An instruction array spends 20 bytes on every instruction, four
+  words of which most opcodes never read.  packFunction copies the
+  final code (after fusion) into a byte stream that holds only what
+  each instruction uses, so the switch loop walks a few bytes per
+  instruction instead.  The instruction array stays, for the other
+  engines and the tools.
+*/
+
+const unsigned char packedOperands[PACKED_OPCODES] = {
+  [PUSH] = 1, [PUSHG] = 1, [PUSHL] = 1,
+  [PTRTO] = 1, [PTRTOG] = 1, [PTRTOL] = 1,
+  [PUSHv] = 1, [MOVE] = 1,
+  [POP] = 1, [POPL] = 1,
+  [CALL] = 1,
+  [GOTO] = 1,
+  [IFZc] = 1, [IFZi] = 1, [IFZf] = 1,
+  [IFNZc] = 1, [IFNZi] = 1, [IFNZf] = 1,
+  [IFEQc] = 1, [IFEQi] = 1, [IFEQf] = 1,
+  [IFNEc] = 1, [IFNEi] = 1, [IFNEf] = 1,
+  [IFLTc] = 1, [IFLTi] = 1, [IFLTf] = 1,
+  [IFLEc] = 1, [IFLEi] = 1, [IFLEf] = 1,
+  [IFGTc] = 1, [IFGTi] = 1, [IFGTf] = 1,
+  [IFGEc] = 1, [IFGEi] = 1, [IFGEf] = 1,
+  [PLUSiLL] = 2, [PLUSiLV] = 2, [MINUSiLL] = 2, [MINUSiLV] = 2,
+  [IFEQiLL] = 3, [IFNEiLL] = 3, [IFLTiLL] = 3,
+  [IFLEiLL] = 3, [IFGTiLL] = 3, [IFGEiLL] = 3,
+  [IFEQiLV] = 3, [IFNEiLV] = 3, [IFLTiLV] = 3,
+  [IFLEiLV] = 3, [IFGTiLV] = 3, [IFGEiLV] = 3,
+};
+
+/* The opcode each packed opcode came from; profiles count these */
+#define SAME(op)  [op] = op
+const unsigned char packedOpcode[PACKED_OPCODES] = {
+  SAME(PUSH), SAME(PTRTO), SAME(PUSHv), SAME(PUSHc), SAME(PUSHi), SAME(PUSHf),
+  SAME(COPY), SAME(MOVE),
+  SAME(POPX), SAME(POP), SAME(POPc), SAME(POPi), SAME(POPf),
+  SAME(CALL), SAME(RET),
+  SAME(INCc), SAME(INCi), SAME(INCf),
+  SAME(DECc), SAME(DECi), SAME(DECf),
+  SAME(NEGc), SAME(NEGi), SAME(NEGf),
+  SAME(FLIP), SAME(CONVif), SAME(CONVfi),
+  SAME(PLUSc), SAME(PLUSi), SAME(PLUSf),
+  SAME(MINUSc), SAME(MINUSi), SAME(MINUSf),
+  SAME(STARc), SAME(STARi), SAME(STARf),
+  SAME(SLASHc), SAME(SLASHi), SAME(SLASHf),
+  SAME(MODc), SAME(MODi),
+  SAME(AND), SAME(OR),
+  SAME(GOTO),
+  SAME(IFZc), SAME(IFZi), SAME(IFZf),
+  SAME(IFNZc), SAME(IFNZi), SAME(IFNZf),
+  SAME(IFEQc), SAME(IFEQi), SAME(IFEQf),
+  SAME(IFNEc), SAME(IFNEi), SAME(IFNEf),
+  SAME(IFLTc), SAME(IFLTi), SAME(IFLTf),
+  SAME(IFLEc), SAME(IFLEi), SAME(IFLEf),
+  SAME(IFGTc), SAME(IFGTi), SAME(IFGTf),
+  SAME(IFGEc), SAME(IFGEi), SAME(IFGEf),
+  SAME(PLUSiLL), SAME(PLUSiLV), SAME(MINUSiLL), SAME(MINUSiLV),
+  SAME(IFEQiLL), SAME(IFNEiLL), SAME(IFLTiLL),
+  SAME(IFLEiLL), SAME(IFGTiLL), SAME(IFGEiLL),
+  SAME(IFEQiLV), SAME(IFNEiLV), SAME(IFLTiLV),
+  SAME(IFLEiLV), SAME(IFGTiLV), SAME(IFGEiLV),
+  SAME(NONE), SAME(ERROR),
+  [PUSHG] = PUSH, [PUSHL] = PUSH,
+  [PTRTOG] = PTRTO, [PTRTOL] = PTRTO,
+  [POPL] = POP,
+  [PACKED_HIT] = NONE, [PACKED_END] = ERROR,
+};
+#undef SAME
+
+static unsigned char packedOp(instruction I)
+{
+  switch (I.op) {
+    case PUSH:    if (GLOBAL == I.atype) return PUSHG;
+                  if (LOCAL == I.atype) return PUSHL;
+                  return PUSH;
+    case PTRTO:   if (GLOBAL == I.atype) return PTRTOG;
+                  if (LOCAL == I.atype) return PTRTOL;
+                  return PTRTO;
+    case POP:     if (LOCAL == I.atype) return POPL;
+                  return POP;
+    default:      return I.op;
+  }
+}
+
+/* Bytes an instruction takes, counting its hit prefix */
+static unsigned packedSize(const function* F, unsigned i)
+{
+  return 1 + 4*packedOperands[packedOp(F->code[i])]
+    + ((F->fused && F->fused[i]) ? 2 : 0);
+}
+
+static void putOperand(unsigned char* p, unsigned u)
+{
+  memcpy(p, &u, sizeof(u));
+}
+
+void packFunction(function* F)
+{
+  assert(F);
+  if (F->rejected) rejectedCall(F);
+  unsigned n = F->code_length;
+  unsigned* offset = malloc((n+1) * sizeof(unsigned));
+  if (0==offset) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory to pack %s\n", F->name);
+    vmExit(2);
+  }
+  unsigned i;
+  offset[0] = 0;
+  for (i=0; i<n; i++) offset[i+1] = offset[i] + packedSize(F, i);
+
+  unsigned char* code = malloc(offset[n] + 1);
+  if (0==code) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory to pack %s\n", F->name);
+    vmExit(2);
+  }
+  unsigned char* p = code;
+  for (i=0; i<n; i++) {
+    instruction I = F->code[i];
+    if (F->fused && F->fused[i]) {
+      *p++ = PACKED_HIT;
+      *p++ = F->fused[i]-1;
+    }
+    unsigned char op = packedOp(I);
+    *p++ = op;
+    unsigned addr = (LABEL == I.atype) ? offset[I.addr] : I.addr;
+    switch (packedOperands[op]) {
+      case 3:   putOperand(p+8, I.addr3);   /* fall through */
+      case 2:   putOperand(p+4, I.addr2);   /* fall through */
+      case 1:   putOperand(p, addr);
+    }
+    p += 4*packedOperands[op];
+  }
+  *p = PACKED_END;
+
+  free(F->packed);
+  F->packed = code;
+  F->packed_length = offset[n] + 1;
+  free(offset);
+}
+
+/* Skips a hit prefix */
+static unsigned instructionAt(const function* F, unsigned off)
+{
+  if (off < F->packed_length && PACKED_HIT == F->packed[off]) off += 2;
+  return off;
+}
+
+unsigned packedIndex(const function* F, unsigned offset)
+{
+  assert(F);
+  unsigned off, i;
+  for (i=off=0; off < F->packed_length; i++) {
+    off = instructionAt(F, off);
+    if (off >= offset || PACKED_END == F->packed[off]) return i;
+    off += 1 + 4*packedOperands[F->packed[off]];
+  }
+  return i;
+}
+
+unsigned* packedOffsets(const function* F)
+{
+  assert(F);
+  unsigned* offset = malloc((F->code_length+1) * sizeof(unsigned));
+  if (0==offset) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory for offsets of %s\n", F->name);
+    vmExit(2);
+  }
+  unsigned off = 0, i;
+  for (i=0; i<F->code_length; i++) {
+    off = instructionAt(F, off);
+    offset[i] = off;
+    off += 1 + 4*packedOperands[F->packed[off]];
+  }
+  offset[i] = off;
+  return offset;
+}
+
+void showPacked(FILE* out, const function* F, unsigned offset)
+{
+  assert(F);
+  offset = instructionAt(F, offset);
+  const unsigned char* p = F->packed + offset;
+  instruction I;
+  I.op = packedOpcode[*p];
+  I.addr = packedOperands[*p] > 0 ? packedOperand(p+1, 0) : 0;
+  I.addr2 = packedOperands[*p] > 1 ? packedOperand(p+1, 1) : 0;
+  I.addr3 = packedOperands[*p] > 2 ? packedOperand(p+1, 2) : 0;
+  switch (*p) {
+    case PUSH:
+    case PTRTO:   I.atype = CONST;    break;
+    case PUSHG:
+    case PTRTOG:
+    case POP:     I.atype = GLOBAL;   break;
+    case PUSHL:
+    case PTRTOL:
+    case POPL:    I.atype = LOCAL;    break;
+    case CALL:    I.atype = FNUM;     break;
+    default:      I.atype = UNUSED;
+  }
+  if (PACKED_END == *p) {
+    fprintf(out, "end");
+    return;
+  }
+  /* targets back to instruction numbers */
+  if (GOTO == *p || (*p >= IFZc && *p <= IFGEf) || (*p >= IFEQiLL && *p <= IFGEiLV)) {
+    I.addr = sourceInstruction(F, packedIndex(F, I.addr));
+  }
+  showInstruction(out, I);
+}
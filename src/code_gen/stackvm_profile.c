@@ -0,0 +1,371 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Execution profiler for --profile.
+
+  The profiled build of the switch loop counts every instruction
+  itself, and calls profileEnter for every call and profileLeave for
+  every ret; everything else happens here.  Per-instruction counts live in
+  each function's profile array, indexed like its code, so exclusive
+  totals are just their sums.  Inclusive totals come from a shadow
+  call stack that remembers the instruction count at entry; a
+  function's inclusive total only grows when its outermost activation
+  returns, so recursion isn't counted twice.
+*/
+
+unsigned long profileOps[ERROR+1];
+unsigned long profileTotal;
+
+static const program* profiled;
+static unsigned long* calls;
+static unsigned long* inclusive;
+static unsigned* active;
+
+typedef struct {
+  unsigned fnum;
+  unsigned long start;
+} shadow_frame;
+
+static shadow_frame* shadow;
+static unsigned nshadow;
+static unsigned maxshadow;
+
+/*
+  Call graph edges, open addressing on (caller, callee).  The entry
+  call has no caller and isn't recorded.
+*/
+typedef struct {
+  unsigned caller;
+  unsigned callee;
+  unsigned long count;
+} call_edge;
+
+static call_edge* edges;
+static unsigned edgeSlots;
+static unsigned nedges;
+
+static const char* opnames[ERROR+1] = {
+  [PUSH] = "push",      [PTRTO] = "ptrto",    [PUSHv] = "pushv",
+  [PUSHc] = "pushc[]",  [PUSHi] = "pushi[]",  [PUSHf] = "pushf[]",
+  [COPY] = "copy",      [MOVE] = "move",
+  [POPX] = "popx",      [POP] = "pop",
+  [POPc] = "popc[]",    [POPi] = "popi[]",    [POPf] = "popf[]",
+  [CALL] = "call",      [RET] = "ret",
+  [INCc] = "++c",       [INCi] = "++i",       [INCf] = "++f",
+  [DECc] = "--c",       [DECi] = "--i",       [DECf] = "--f",
+  [NEGc] = "negc",      [NEGi] = "negi",      [NEGf] = "negf",
+  [FLIP] = "flip",      [CONVif] = "convif",  [CONVfi] = "convfi",
+  [PLUSc] = "+c",       [PLUSi] = "+i",       [PLUSf] = "+f",
+  [MINUSc] = "-c",      [MINUSi] = "-i",      [MINUSf] = "-f",
+  [STARc] = "*c",       [STARi] = "*i",       [STARf] = "*f",
+  [SLASHc] = "/c",      [SLASHi] = "/i",      [SLASHf] = "/f",
+  [MODc] = "%c",        [MODi] = "%i",
+  [AND] = "&",          [OR] = "|",
+  [GOTO] = "goto",
+  [IFZc] = "==0c",      [IFZi] = "==0i",      [IFZf] = "==0f",
+  [IFNZc] = "!=0c",     [IFNZi] = "!=0i",     [IFNZf] = "!=0f",
+  [IFEQc] = "==c",      [IFEQi] = "==i",      [IFEQf] = "==f",
+  [IFNEc] = "!=c",      [IFNEi] = "!=i",      [IFNEf] = "!=f",
+  [IFLTc] = "<c",       [IFLTi] = "<i",       [IFLTf] = "<f",
+  [IFLEc] = "<=c",      [IFLEi] = "<=i",      [IFLEf] = "<=f",
+  [IFGTc] = ">c",       [IFGTi] = ">i",       [IFGTf] = ">f",
+  [IFGEc] = ">=c",      [IFGEi] = ">=i",      [IFGEf] = ">=f",
+  [PLUSiLL] = "+iLL",   [PLUSiLV] = "+iLV",
+  [MINUSiLL] = "-iLL",  [MINUSiLV] = "-iLV",
+  [IFEQiLL] = "==iLL",  [IFNEiLL] = "!=iLL",  [IFLTiLL] = "<iLL",
+  [IFLEiLL] = "<=iLL",  [IFGTiLL] = ">iLL",   [IFGEiLL] = ">=iLL",
+  [IFEQiLV] = "==iLV",  [IFNEiLV] = "!=iLV",  [IFLTiLV] = "<iLV",
+  [IFLEiLV] = "<=iLV",  [IFGTiLV] = ">iLV",   [IFGEiLV] = ">=iLV",
+  [NONE] = "no-op",     [ERROR] = "error",
+};
+
+static void* profileAlloc(size_t n, size_t size)
+{
+  void* p = calloc(n ? n : 1, size);
+  if (0==p) {
+    fprintf(stderr, "Error - couldn't allocate profile data\n");
+    exit(2);
+  }
+  return p;
+}
+
+void profileStart(program* P)
+{
+  assert(P);
+  profiled = P;
+  calls = profileAlloc(P->nf, sizeof(unsigned long));
+  inclusive = profileAlloc(P->nf, sizeof(unsigned long));
+  active = profileAlloc(P->nf, sizeof(unsigned));
+  unsigned f;
+  for (f=0; f<P->nf; f++) {
+    /* counted per offset into the packed code */
+    P->F[f].profile = profileAlloc(P->F[f].packed_length, sizeof(unsigned long));
+  }
+}
+
+static call_edge* findEdge(unsigned caller, unsigned callee)
+{
+  unsigned i = ((caller * 2654435761u) ^ callee) & (edgeSlots-1);
+  while (edges[i].count && (edges[i].caller != caller || edges[i].callee != callee)) {
+    i = (i+1) & (edgeSlots-1);
+  }
+  return edges+i;
+}
+
+static void countEdge(unsigned caller, unsigned callee)
+{
+  if (2*(nedges+1) > edgeSlots) {
+    call_edge* old = edges;
+    unsigned oldSlots = edgeSlots;
+    edgeSlots = oldSlots ? 2*oldSlots : 256;
+    edges = profileAlloc(edgeSlots, sizeof(call_edge));
+    unsigned i;
+    for (i=0; i<oldSlots; i++) {
+      if (old[i].count) *findEdge(old[i].caller, old[i].callee) = old[i];
+    }
+    free(old);
+  }
+  call_edge* E = findEdge(caller, callee);
+  if (0==E->count) {
+    E->caller = caller;
+    E->callee = callee;
+    nedges++;
+  }
+  E->count++;
+}
+
+void profileEnter(const function* caller, unsigned fnum)
+{
+  if (fnum >= profiled->nf) return;   /* about to fail anyway */
+  calls[fnum]++;
+  if (caller) countEdge(caller - profiled->F, fnum);
+  if (fnum < BUILTIN_FUNCTIONS) return;
+
+  if (nshadow >= maxshadow) {
+    maxshadow = maxshadow ? 2*maxshadow : 64;
+    shadow = realloc(shadow, maxshadow * sizeof(shadow_frame));
+    if (0==shadow) runtimeError("out of memory for profile");
+  }
+  shadow[nshadow].fnum = fnum;
+  shadow[nshadow].start = profileTotal;
+  nshadow++;
+  active[fnum]++;
+}
+
+void profileLeave()
+{
+  assert(nshadow);
+  nshadow--;
+  unsigned f = shadow[nshadow].fnum;
+  if (0 == --active[f]) inclusive[f] += profileTotal - shadow[nshadow].start;
+}
+
+/*
+  Report
+*/
+
+static unsigned long exclusive(const function* F)
+{
+  unsigned long sum = 0;
+  unsigned pc;
+  for (pc=0; pc<F->packed_length; pc++) sum += F->profile[pc];
+  return sum;
+}
+
+static double percent(unsigned long n)
+{
+  return profileTotal ? 100.0 * n / profileTotal : 0.0;
+}
+
+/* qsort helpers; sort keys are filled in just before sorting */
+static unsigned long* sortKey;
+
+static int byKey(const void* a, const void* b)
+{
+  unsigned long ka = sortKey[*(const unsigned*) a];
+  unsigned long kb = sortKey[*(const unsigned*) b];
+  if (ka != kb) return (ka < kb) ? 1 : -1;
+  return (*(const unsigned*) a < *(const unsigned*) b) ? -1 : 1;
+}
+
+static int byCount(const void* a, const void* b)
+{
+  const call_edge* ea = a;
+  const call_edge* eb = b;
+  if (ea->count != eb->count) return (ea->count < eb->count) ? 1 : -1;
+  if (ea->caller != eb->caller) return (ea->caller < eb->caller) ? -1 : 1;
+  return (ea->callee < eb->callee) ? -1 : 1;
+}
+
+typedef struct {
+  unsigned fnum;
+  unsigned pc;
+  unsigned offset;      /* of pc in the packed code */
+  unsigned long count;
+} hot_pc;
+
+#define HOT_PCS 20
+
+static void textReport(FILE* out, const program* P, call_edge* sorted)
+{
+  unsigned i, f, n;
+  unsigned* order = profileAlloc(P->nf > ERROR+1 ? P->nf : ERROR+1, sizeof(unsigned));
+
+  fprintf(out, "\nProfile: %lu instructions executed\n", profileTotal);
+
+  fprintf(out, "\nOpcodes:\n    %14s  %6s  %s\n", "count", "%", "opcode");
+  for (n=i=0; i<=ERROR; i++) {
+    if (profileOps[i]) order[n++] = i;
+  }
+  sortKey = profileOps;
+  qsort(order, n, sizeof(unsigned), byKey);
+  for (i=0; i<n; i++) {
+    fprintf(out, "    %14lu  %6.2f  %s\n", profileOps[order[i]],
+      percent(profileOps[order[i]]), opnames[order[i]]);
+  }
+
+  unsigned long* excl = profileAlloc(P->nf, sizeof(unsigned long));
+  for (n=f=0; f<P->nf; f++) {
+    if (0==calls[f]) continue;
+    excl[f] = exclusive(P->F+f);
+    order[n++] = f;
+  }
+  sortKey = excl;
+  qsort(order, n, sizeof(unsigned), byKey);
+  fprintf(out, "\nFunctions:\n    %10s  %14s  %6s  %14s  %6s  %s\n",
+    "calls", "exclusive", "%", "inclusive", "%", "function");
+  for (i=0; i<n; i++) {
+    f = order[i];
+    fprintf(out, "    %10lu  %14lu  %6.2f  %14lu  %6.2f  %s\n", calls[f],
+      excl[f], percent(excl[f]), inclusive[f], percent(inclusive[f]), P->F[f].name);
+  }
+
+  fprintf(out, "\nCall graph:\n    %10s  %s\n", "calls", "caller -> callee");
+  for (i=0; i<nedges; i++) {
+    fprintf(out, "    %10lu  %s -> %s\n", sorted[i].count,
+      P->F[sorted[i].caller].name, P->F[sorted[i].callee].name);
+  }
+
+  /*
+    Hottest instructions overall
+  */
+  hot_pc hot[HOT_PCS+1];
+  unsigned nhot = 0;
+  for (f=BUILTIN_FUNCTIONS; f<P->nf; f++) {
+    if (0==P->F[f].packed) continue;
+    unsigned* offset = packedOffsets(P->F+f);
+    unsigned pc;
+    for (pc=0; pc<P->F[f].code_length; pc++) {
+      unsigned long c = P->F[f].profile[offset[pc]];
+      if (0==c) continue;
+      if (nhot == HOT_PCS && c <= hot[HOT_PCS-1].count) continue;
+      /* insertion into the sorted list */
+      unsigned j = (nhot < HOT_PCS) ? nhot++ : HOT_PCS-1;
+      while (j && hot[j-1].count < c) {
+        hot[j] = hot[j-1];
+        j--;
+      }
+      hot[j].fnum = f;
+      hot[j].pc = sourceInstruction(P->F+f, pc);
+      hot[j].offset = offset[pc];
+      hot[j].count = c;
+    }
+    free(offset);
+  }
+  fprintf(out, "\nHottest instructions:\n    %14s  %6s  %s\n", "count", "%", "function:pc  instruction");
+  for (i=0; i<nhot; i++) {
+    fprintf(out, "    %14lu  %6.2f  %s:%u  ", hot[i].count, percent(hot[i].count),
+      P->F[hot[i].fnum].name, hot[i].pc);
+    showPacked(out, P->F + hot[i].fnum, hot[i].offset);
+    fputc('\n', out);
+  }
+
+  free(excl);
+  free(order);
+}
+
+static void jsonString(FILE* out, const char* s)
+{
+  fputc('"', out);
+  for (; *s; s++) {
+    if ('"' == *s || '\\' == *s) fputc('\\', out);
+    if ((unsigned char) *s < ' ') {
+      fprintf(out, "\\u%04x", *s);
+    } else {
+      fputc(*s, out);
+    }
+  }
+  fputc('"', out);
+}
+
+static void jsonReport(FILE* out, const program* P, call_edge* sorted)
+{
+  unsigned i, f, pc;
+  int first;
+
+  fprintf(out, "{\n  \"instructions\": %lu,\n  \"fused\": %s,\n  \"opcodes\": {",
+    profileTotal, fusionEnabled ? "true" : "false");
+  for (first=1, i=0; i<=ERROR; i++) {
+    if (0==profileOps[i]) continue;
+    fprintf(out, "%s\n    ", first ? "" : ",");
+    jsonString(out, opnames[i]);
+    fprintf(out, ": %lu", profileOps[i]);
+    first = 0;
+  }
+  fprintf(out, "\n  },\n  \"functions\": [");
+  for (first=1, f=0; f<P->nf; f++) {
+    if (0==P->F[f].name) continue;
+    fprintf(out, "%s\n    {\"id\": %u, \"name\": ", first ? "" : ",", f);
+    jsonString(out, P->F[f].name);
+    fprintf(out, ", \"calls\": %lu, \"exclusive\": %lu, \"inclusive\": %lu, \"pcs\": [",
+      calls[f], exclusive(P->F+f), inclusive[f]);
+    /* by source instruction; each one in a fused window ran as often as it */
+    const function* F = P->F+f;
+    unsigned* offset = F->packed ? packedOffsets(F) : 0;
+    for (pc=0; pc<F->code_length; pc++) {
+      unsigned s;
+      for (s=sourceInstruction(F, pc); s<sourceInstruction(F, pc+1); s++) {
+        fprintf(out, "%s%lu", s ? ", " : "", F->profile[offset[pc]]);
+      }
+    }
+    free(offset);
+    fprintf(out, "]}");
+    first = 0;
+  }
+  fprintf(out, "\n  ],\n  \"calls\": [");
+  for (i=0; i<nedges; i++) {
+    fprintf(out, "%s\n    {\"caller\": %u, \"callee\": %u, \"count\": %lu}",
+      i ? "," : "", sorted[i].caller, sorted[i].callee, sorted[i].count);
+  }
+  fprintf(out, "\n  ]\n}\n");
+}
+
+void profileReport(const program* P, FILE* text, const char* jsonpath)
+{
+  assert(P);
+
+  call_edge* sorted = profileAlloc(nedges, sizeof(call_edge));
+  unsigned i, n = 0;
+  for (i=0; i<edgeSlots; i++) {
+    if (edges[i].count) sorted[n++] = edges[i];
+  }
+  qsort(sorted, nedges, sizeof(call_edge), byCount);
+
+  if (text) textReport(text, P, sorted);
+
+  if (jsonpath) {
+    FILE* out = fopen(jsonpath, "w");
+    if (0==out) {
+      fprintf(stderr, "Error, couldn't open file '%s'\n", jsonpath);
+    } else {
+      jsonReport(out, P, sorted);
+      fclose(out);
+    }
+  }
+  free(sorted);
+}
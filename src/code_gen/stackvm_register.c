@@ -0,0 +1,845 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Register-based execution tier.
+
+  registerFunction translates a function's stack code into three-address
+  code once all functions are loaded.  Stack slot k at a given point of
+  the function becomes register k, and the register file is laid out in
+  the frame right after the parameters and locals, so a frame is
+
+      params | locals | registers
+
+  and a register is addressed exactly like a local.  Within a basic
+  block the translator keeps a model of the stack: pushes of locals and
+  immediates generate no code, and the instruction that consumes them
+  reads the local or the immediate directly.  So
+
+      push L3; pushv 0x1; +i; pop L3
+
+  becomes the single instruction L3 = L3 + 1 (plus a move).  Everything
+  is forced into its register at the end of each block, before calls,
+  before stores through pointers and before a local is overwritten while
+  a pending push of it is still on the model stack.
+
+  The translation needs the stack depth at every instruction, so it
+  first computes depths over the control flow graph.  Functions where
+  the depth at a join depends on the path (the code generator leaves
+  values behind in loops), that can underflow, or that call an unknown
+  function are not translated and keep running on callFunction, which
+  also remains the reference for differential testing.
+*/
+
+typedef enum {
+  R_MOV, R_MOVI, R_LOADM, R_STOREM, R_PTRL,
+  R_LOADc, R_LOADi, R_LOADf, R_STOREc, R_STOREi, R_STOREf,
+  R_MOVE, R_CALL, R_RET, R_RET0,
+  R_INCf, R_DECf, R_NEGf, R_FLIP, R_CONVif, R_CONVfi,
+
+  /* binary: a = b op c; the RI forms take c as an immediate */
+  R_ADD, R_ADDRI, R_SUB, R_SUBRI, R_MUL, R_MULRI,
+  R_DIV, R_DIVRI, R_MOD, R_MODRI,
+  R_AND, R_ANDRI, R_OR, R_ORRI,
+  R_ADDf, R_SUBf, R_MULf, R_DIVf,
+
+  /* branches: target in a */
+  R_GOTO,
+  R_IFZi, R_IFZf, R_IFNZi, R_IFNZf,
+  R_IFEQ, R_IFEQRI, R_IFNE, R_IFNERI, R_IFLT, R_IFLTRI,
+  R_IFLE, R_IFLERI, R_IFGT, R_IFGTRI, R_IFGE, R_IFGERI,
+  R_IFEQf, R_IFNEf, R_IFLTf, R_IFLEf, R_IFGTf, R_IFGEf,
+
+  R_FALLOFF
+} register_op;
+
+typedef struct {
+  register_op op;
+  unsigned a;
+  unsigned b;
+  unsigned c;
+} register_instr;
+
+struct register_code {
+  register_instr* code;
+  unsigned length;
+  /* parameters + locals + registers */
+  unsigned frame_slots;
+};
+
+static int fallsThrough(opcode op)
+{
+  return (GOTO != op) && (RET != op);
+}
+
+/*
+  Depth at each instruction, -1 if unreachable; depth[code_length] is
+  set if control can run off the end.  Returns 0 if the depths are
+  not static.
+*/
+static int computeDepths(const program* P, const function* F, int* depth, unsigned* maxdepth)
+{
+  unsigned n = F->code_length;
+  unsigned* work = malloc((n+1) * sizeof(unsigned));
+  if (0==work) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory for translation of %s\n", F->name);
+    vmExit(2);
+  }
+  unsigned i, nwork = 0;
+  for (i=0; i<=n; i++) depth[i] = -1;
+  *maxdepth = 0;
+
+  int ok = 1;
+  depth[0] = 0;
+  work[nwork++] = 0;
+  while (ok && nwork) {
+    unsigned pc = work[--nwork];
+    if (pc >= n) continue;
+    instruction I = F->code[pc];
+    unsigned need;
+    int delta;
+    if (!stackEffect(P, I, &need, &delta)) {
+      ok = 0;
+      break;
+    }
+    int d = depth[pc];
+    if (RET == I.op && F->return_slots) need = 1;
+    if (d < (int) need) {
+      ok = 0;
+      break;
+    }
+    int after = d + delta;
+    if (after > (int) *maxdepth) *maxdepth = after;
+
+    unsigned succ[2];
+    unsigned ns = 0;
+    if (fallsThrough(I.op)) succ[ns++] = pc+1;
+    if (LABEL == I.atype) succ[ns++] = I.addr;
+    for (i=0; i<ns; i++) {
+      if (depth[succ[i]] < 0) {
+        depth[succ[i]] = after;
+        work[nwork++] = succ[i];
+      } else if (depth[succ[i]] != after) {
+        ok = 0;
+      }
+    }
+  }
+  free(work);
+  return ok;
+}
+
+/*
+  Translator state.  model[k] describes stack slot k: either a frame
+  slot holding the value or an immediate.  Slot k is "in place" when
+  it is frame slot nl+k.
+*/
+typedef struct {
+  int imm;
+  unsigned v;
+} operand;
+
+typedef struct {
+  register_instr* code;
+  unsigned length;
+  unsigned size;
+  operand* model;
+  unsigned nl;
+} translator;
+
+static void emit(translator* T, register_op op, unsigned a, unsigned b, unsigned c)
+{
+  if (T->length >= T->size) {
+    T->size = T->size ? 2*T->size : 64;
+    T->code = realloc(T->code, T->size * sizeof(register_instr));
+    if (0==T->code) {
+      fprintf(vmErrors(), "Error - couldn't allocate register code\n");
+      vmExit(2);
+    }
+  }
+  register_instr* R = T->code + T->length++;
+  R->op = op;
+  R->a = a;
+  R->b = b;
+  R->c = c;
+}
+
+static void setInPlace(translator* T, unsigned k)
+{
+  T->model[k].imm = 0;
+  T->model[k].v = T->nl + k;
+}
+
+static void materialize(translator* T, unsigned k)
+{
+  operand o = T->model[k];
+  if (o.imm) {
+    emit(T, R_MOVI, T->nl + k, o.v, 0);
+  } else if (o.v != T->nl + k) {
+    emit(T, R_MOV, T->nl + k, o.v, 0);
+  }
+  setInPlace(T, k);
+}
+
+static void flush(translator* T, unsigned depth)
+{
+  unsigned k;
+  for (k=0; k<depth; k++) materialize(T, k);
+}
+
+/*
+  Local x is about to be written: pending reads of it must happen first
+*/
+static void protect(translator* T, unsigned depth, unsigned x)
+{
+  unsigned k;
+  for (k=0; k<depth; k++) {
+    if (!T->model[k].imm && x == T->model[k].v) materialize(T, k);
+  }
+}
+
+static register_op binaryOp(opcode op)
+{
+  switch (op) {
+    case PLUSc:   case PLUSi:   case PLUSiLL: case PLUSiLV:
+                                  return R_ADD;
+    case MINUSc:  case MINUSi:  case MINUSiLL: case MINUSiLV:
+                                  return R_SUB;
+    case STARc:   case STARi:   return R_MUL;
+    case SLASHc:  case SLASHi:  return R_DIV;
+    case MODc:    case MODi:    return R_MOD;
+    case AND:                   return R_AND;
+    case OR:                    return R_OR;
+    case PLUSf:                 return R_ADDf;
+    case MINUSf:                return R_SUBf;
+    case STARf:                 return R_MULf;
+    case SLASHf:                return R_DIVf;
+    default:                    assert(0);  return R_FALLOFF;
+  }
+}
+
+static register_op compareOp(opcode op)
+{
+  switch (op) {
+    case IFEQc: case IFEQi: case IFEQiLL: case IFEQiLV:   return R_IFEQ;
+    case IFNEc: case IFNEi: case IFNEiLL: case IFNEiLV:   return R_IFNE;
+    case IFLTc: case IFLTi: case IFLTiLL: case IFLTiLV:   return R_IFLT;
+    case IFLEc: case IFLEi: case IFLEiLL: case IFLEiLV:   return R_IFLE;
+    case IFGTc: case IFGTi: case IFGTiLL: case IFGTiLV:   return R_IFGT;
+    case IFGEc: case IFGEi: case IFGEiLL: case IFGEiLV:   return R_IFGE;
+    case IFEQf:   return R_IFEQf;
+    case IFNEf:   return R_IFNEf;
+    case IFLTf:   return R_IFLTf;
+    case IFLEf:   return R_IFLEf;
+    case IFGTf:   return R_IFGTf;
+    case IFGEf:   return R_IFGEf;
+    default:      assert(0);  return R_FALLOFF;
+  }
+}
+
+/* The comparison with its operands swapped */
+static register_op mirror(register_op op)
+{
+  switch (op) {
+    case R_IFLT:  return R_IFGT;
+    case R_IFLE:  return R_IFGE;
+    case R_IFGT:  return R_IFLT;
+    case R_IFGE:  return R_IFLE;
+    default:      return op;
+  }
+}
+
+static int commutes(register_op op)
+{
+  return (R_ADD == op) || (R_MUL == op) || (R_AND == op) || (R_OR == op);
+}
+
+static int isFloatOp(register_op op)
+{
+  return (op >= R_ADDf && op <= R_DIVf) || (op >= R_IFEQf && op <= R_IFGEf);
+}
+
+/*
+  dst = left op right (or branch to target on left op right).
+  The integer forms have an RI variant right after them in register_op.
+*/
+static void emitBinary(translator* T, register_op op, unsigned dst,
+  operand left, operand right, unsigned leftk)
+{
+  if (left.imm && !right.imm && !isFloatOp(op)) {
+    if (commutes(op) || op >= R_IFEQ) {
+      operand t = left;
+      left = right;
+      right = t;
+      op = mirror(op);
+    }
+  }
+  if (left.imm) {
+    /* Only leftk's own register can hold it; right doesn't live there */
+    emit(T, R_MOVI, T->nl + leftk, left.v, 0);
+    left.imm = 0;
+    left.v = T->nl + leftk;
+  }
+  if (right.imm && isFloatOp(op)) {
+    emit(T, R_MOVI, T->nl + leftk + 1, right.v, 0);
+    right.imm = 0;
+    right.v = T->nl + leftk + 1;
+  }
+  if (right.imm) {
+    emit(T, op+1, dst, left.v, right.v);
+  } else {
+    emit(T, op, dst, left.v, right.v);
+  }
+}
+
+/*
+  The value about to be stored in x was just computed into register
+  slot r by the last instruction of this block: compute it into x
+  instead.
+*/
+static int retarget(translator* T, unsigned block, unsigned r, unsigned x)
+{
+  if (T->length <= block) return 0;
+  register_instr* last = T->code + T->length - 1;
+  if (last->a != r) return 0;
+  switch (last->op) {
+    case R_MOV: case R_MOVI: case R_LOADM: case R_PTRL:
+    case R_INCf: case R_DECf: case R_NEGf:
+    case R_FLIP: case R_CONVif: case R_CONVfi:
+        break;
+    default:
+        if (last->op < R_ADD || last->op > R_DIVf) return 0;
+  }
+  last->a = x;
+  return 1;
+}
+
+static void translateFunction(const program* P, function* F, const int* depth, unsigned maxdepth)
+{
+  translator T;
+  T.code = 0;
+  T.length = T.size = 0;
+  T.nl = F->parameter_slots + F->local_slots;
+  T.model = malloc((maxdepth+1) * sizeof(operand));
+
+  unsigned n = F->code_length;
+  unsigned* map = malloc((n+1) * sizeof(unsigned));
+  char* target = calloc(n+1, 1);
+  if (0==T.model || 0==map || 0==target) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory for translation of %s\n", F->name);
+    vmExit(2);
+  }
+  unsigned pc, k;
+  for (pc=0; pc<n; pc++) {
+    if (LABEL == F->code[pc].atype) target[F->code[pc].addr] = 1;
+  }
+
+  unsigned d = 0;
+  unsigned block = 0;   /* first instruction of the current block */
+  int live = 0;         /* does control fall into pc from pc-1? */
+  operand L, R;
+  for (pc=0; pc<=n; pc++) {
+    if (depth[pc] < 0) {
+      live = 0;
+      map[pc] = T.length;
+      continue;
+    }
+    if (live && target[pc]) {
+      flush(&T, d);
+    }
+    if (!live) {
+      d = depth[pc];
+      for (k=0; k<d; k++) setInPlace(&T, k);
+    }
+    if (!live || target[pc]) block = T.length;
+    assert(d == (unsigned) depth[pc]);
+    map[pc] = T.length;
+    if (pc == n) {
+      emit(&T, R_FALLOFF, 0, 0, 0);
+      break;
+    }
+
+    instruction I = F->code[pc];
+    live = fallsThrough(I.op);
+    unsigned nl = T.nl;
+    switch (I.op) {
+      case PUSH:
+          if (LOCAL == I.atype) {
+            T.model[d].imm = 0;
+            T.model[d].v = I.addr;
+          } else {
+            const segment* S = (CONST == I.atype) ? &P->constants : &P->globals;
+            emit(&T, R_LOADM, nl+d, addr2ptr(S, I.addr), 0);
+            setInPlace(&T, d);
+          }
+          d++;
+          break;
+
+      case PTRTO:
+          if (LOCAL == I.atype) {
+            emit(&T, R_PTRL, nl+d, I.addr, 0);
+            setInPlace(&T, d);
+          } else {
+            const segment* S = (CONST == I.atype) ? &P->constants : &P->globals;
+            T.model[d].imm = 1;
+            T.model[d].v = addr2ptr(S, I.addr);
+          }
+          d++;
+          break;
+
+      case PUSHv:
+          T.model[d].imm = 1;
+          T.model[d].v = I.addr;
+          d++;
+          break;
+
+      case PUSHc:
+      case PUSHi:
+      case PUSHf:
+          materialize(&T, d-2);
+          materialize(&T, d-1);
+          emit(&T, R_LOADc + (I.op - PUSHc), nl+d-2, 0, 0);
+          d--;
+          break;
+
+      case COPY:
+          T.model[d] = T.model[d-1];
+          d++;
+          break;
+
+      case MOVE:
+          if (I.addr) {
+            flush(&T, d);
+            emit(&T, R_MOVE, nl+d-1, I.addr, 0);
+          }
+          break;
+
+      case POPX:
+          d--;
+          break;
+
+      case POP:
+          d--;
+          if (GLOBAL == I.atype) {
+            materialize(&T, d);
+            emit(&T, R_STOREM, addr2ptr(&P->globals, I.addr), nl+d, 0);
+          } else {
+            protect(&T, d, I.addr);
+            R = T.model[d];
+            if (retarget(&T, block, nl+d, I.addr)) {
+              /* computed straight into the local */
+            } else if (R.imm) {
+              emit(&T, R_MOVI, I.addr, R.v, 0);
+            } else if (R.v != I.addr) {
+              emit(&T, R_MOV, I.addr, R.v, 0);
+            }
+          }
+          break;
+
+      case POPc:
+      case POPi:
+      case POPf:
+          flush(&T, d);
+          d -= 3;
+          emit(&T, R_STOREc + (I.op - POPc), nl+d, 0, 0);
+          break;
+
+      case CALL:
+          flush(&T, d);
+          d -= P->F[I.addr].parameter_slots;
+          emit(&T, R_CALL, I.addr, nl+d, pc);
+          for (k=0; k<P->F[I.addr].return_slots; k++) setInPlace(&T, d++);
+          break;
+
+      case RET:
+          if (F->return_slots) {
+            R = T.model[d-1];
+            if (R.imm) materialize(&T, d-1);
+            emit(&T, R_RET, T.model[d-1].v, 0, 0);
+          } else {
+            emit(&T, R_RET0, 0, 0, 0);
+          }
+          break;
+
+      case INCc:
+      case INCi:
+      case DECc:
+      case DECi:
+      case NEGc:
+      case NEGi:
+          R.imm = 1;
+          R.v = (NEGc == I.op || NEGi == I.op) ? i2u(-1) : 1;
+          emitBinary(&T, (INCc == I.op || INCi == I.op) ? R_ADD
+                         : (DECc == I.op || DECi == I.op) ? R_SUB : R_MUL,
+                     nl+d-1, T.model[d-1], R, d-1);
+          setInPlace(&T, d-1);
+          break;
+
+      case INCf:
+      case DECf:
+      case NEGf:
+      case FLIP:
+      case CONVif:
+      case CONVfi:
+          if (T.model[d-1].imm) materialize(&T, d-1);
+          emit(&T, (INCf == I.op) ? R_INCf : (DECf == I.op) ? R_DECf
+                 : (NEGf == I.op) ? R_NEGf : (FLIP == I.op) ? R_FLIP
+                 : (CONVif == I.op) ? R_CONVif : R_CONVfi,
+               nl+d-1, T.model[d-1].v, 0);
+          setInPlace(&T, d-1);
+          break;
+
+      case PLUSc: case PLUSi: case PLUSf:
+      case MINUSc: case MINUSi: case MINUSf:
+      case STARc: case STARi: case STARf:
+      case SLASHc: case SLASHi: case SLASHf:
+      case MODc: case MODi:
+      case AND: case OR:
+          emitBinary(&T, binaryOp(I.op), nl+d-2, T.model[d-2], T.model[d-1], d-2);
+          d--;
+          setInPlace(&T, d-1);
+          break;
+
+      case PLUSiLL:
+      case MINUSiLL:
+      case PLUSiLV:
+      case MINUSiLV:
+          L.imm = 0;
+          L.v = I.addr;
+          R.imm = (PLUSiLV == I.op || MINUSiLV == I.op);
+          R.v = I.addr2;
+          emitBinary(&T, binaryOp(I.op), nl+d, L, R, d);
+          setInPlace(&T, d);
+          d++;
+          break;
+
+      case GOTO:
+          flush(&T, d);
+          emit(&T, R_GOTO, I.addr, 0, 0);
+          break;
+
+      case IFZc: case IFZi: case IFZf:
+      case IFNZc: case IFNZi: case IFNZf:
+          d--;
+          flush(&T, d);
+          if (T.model[d].imm) materialize(&T, d);
+          emit(&T, (IFZf == I.op) ? R_IFZf : (IFNZf == I.op) ? R_IFNZf
+                 : (IFNZc == I.op || IFNZi == I.op) ? R_IFNZi : R_IFZi,
+               I.addr, T.model[d].v, 0);
+          break;
+
+      case IFEQc: case IFEQi: case IFEQf:
+      case IFNEc: case IFNEi: case IFNEf:
+      case IFLTc: case IFLTi: case IFLTf:
+      case IFLEc: case IFLEi: case IFLEf:
+      case IFGTc: case IFGTi: case IFGTf:
+      case IFGEc: case IFGEi: case IFGEf:
+          d -= 2;
+          flush(&T, d);
+          emitBinary(&T, compareOp(I.op), I.addr, T.model[d], T.model[d+1], d);
+          break;
+
+      case IFEQiLL: case IFNEiLL: case IFLTiLL:
+      case IFLEiLL: case IFGTiLL: case IFGEiLL:
+      case IFEQiLV: case IFNEiLV: case IFLTiLV:
+      case IFLEiLV: case IFGTiLV: case IFGEiLV:
+          flush(&T, d);
+          L.imm = 0;
+          L.v = I.addr2;
+          R.imm = (I.op >= IFEQiLV);
+          R.v = I.addr3;
+          emitBinary(&T, compareOp(I.op), I.addr, L, R, d);
+          break;
+
+      default:      /* NONE or ERROR; do nothing */
+          ;
+    }
+  }
+
+  /*
+    Jump operands are still instruction numbers
+  */
+  for (k=0; k<T.length; k++) {
+    register_instr* RI = T.code + k;
+    if (RI->op >= R_GOTO && RI->op < R_FALLOFF) RI->a = map[RI->a];
+  }
+
+  free(F->registered);
+  F->registered = malloc(sizeof(struct register_code));
+  if (0==F->registered) {
+    fprintf(vmErrors(), "Error - couldn't allocate register code\n");
+    vmExit(2);
+  }
+  F->registered->code = T.code;
+  F->registered->length = T.length;
+  F->registered->frame_slots = T.nl + maxdepth + 1;
+
+  free(target);
+  free(map);
+  free(T.model);
+}
+
+int registerFunction(program* P, function* F)
+{
+  assert(P);
+  assert(F);
+  /* callFunction reports a rejected function */
+  if (0==F->code_length || F->rejected) return 0;
+
+  int* depth = malloc((F->code_length+1) * sizeof(int));
+  if (0==depth) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory for translation of %s\n", F->name);
+    vmExit(2);
+  }
+  unsigned maxdepth;
+  int ok = computeDepths(P, F, depth, &maxdepth);
+  if (ok) translateFunction(P, F, depth, maxdepth);
+  free(depth);
+  return ok;
+}
+
+/*
+  Calls to functions that weren't translated go through the stack
+  interpreter, with the arguments pushed on the (otherwise unused)
+  computation stack.  Calls between translated functions stay in
+  runRegister.
+*/
+static void stackCall(program* P, unsigned fnum, unsigned* R, unsigned base,
+  segment* sub, stack* mystack)
+{
+  function* G = P->F + fnum;
+  stack s;
+  makeSubStack(&s, mystack);
+  unsigned i;
+  for (i=0; i<G->parameter_slots; i++) {
+    push(&s, R[base+i]);
+  }
+  callFunction(P, fnum, sub, &s);
+  if (G->return_slots) R[base] = pop(&s);
+}
+
+static unsigned runRegister(program* P, const function* F, segment* frame, stack* mystack);
+
+void callRegister(program* P, unsigned fnum, segment* locals, stack* compstack)
+{
+  assert(P);
+  assert(locals);
+  assert(compstack);
+
+  if (fnum >= P->nf) {
+    runtimeError3("target function number ", fnum, " is too large");
+  }
+  function* F = P->F + fnum;
+  if (0==F->registered) {
+    callFunction(P, fnum, locals, compstack);
+    return;
+  }
+
+  if (locals->size < F->registered->frame_slots) {
+    runtimeError3("local variable stack overflow\n    in call to function #", fnum, F->name);
+  }
+  if (compstack->top < F->parameter_slots) {
+    runtimeError3("not enough parameters on computation stack\n    in call to function #", fnum, F->name);
+  }
+
+  unsigned i;
+  compstack->top -= F->parameter_slots;
+  for (i=0; i<F->parameter_slots; i++) {
+    locals->data[i] = compstack->data[compstack->top + i];
+  }
+
+  stack mystack;
+  makeSubStack(&mystack, compstack);
+  unsigned v = runRegister(P, F, locals, &mystack);
+  if (F->return_slots) {
+    assert(1==F->return_slots);
+    push(compstack, v);
+  }
+}
+
+#define BINARY_U(OP)      R[I->a] = R[I->b] OP R[I->c]; break
+#define BINARY_URI(OP)    R[I->a] = R[I->b] OP I->c; break
+#define BINARY_I(OP)      R[I->a] = i2u(u2i(R[I->b]) OP u2i(R[I->c])); break
+#define BINARY_IRI(OP)    R[I->a] = i2u(u2i(R[I->b]) OP u2i(I->c)); break
+#define BINARY_F(OP)      R[I->a] = f2u(u2f(R[I->b]) OP u2f(R[I->c])); break
+
+#define BRANCH_I(CMP)     if (u2i(R[I->b]) CMP u2i(R[I->c])) I = code + I->a - 1; break
+#define BRANCH_IRI(CMP)   if (u2i(R[I->b]) CMP u2i(I->c)) I = code + I->a - 1; break
+#define BRANCH_F(CMP)     if (u2f(R[I->b]) CMP u2f(R[I->c])) I = code + I->a - 1; break
+
+/*
+  A suspended caller; its R_CALL instruction says where the result goes
+*/
+struct register_frame {
+  const register_instr* I;
+  const function* F;
+  unsigned* R;
+};
+
+static unsigned runRegister(program* P, const function* F, segment* frame, stack* mystack)
+{
+  vm_context* const C = vmCurrent;
+  const register_instr* code = F->registered->code;
+  unsigned frame_slots = F->registered->frame_slots;
+  unsigned* R = frame->data;
+  unsigned* const Rend = frame->data + frame->size;
+  unsigned* const M = frame->mem_base;
+  const register_instr* I;
+  unsigned u, i;
+  int lefti;
+  float leftf;
+  const function* G;
+  unsigned* GR;
+
+  struct register_frame* frames = 0;
+  unsigned nframes = 0;
+  unsigned maxframes = 0;
+  vmHold((void**) &frames);
+
+  C->executing = F;
+  for (I = code; ; I++) {
+    switch (I->op) {
+      case R_MOV:     R[I->a] = R[I->b];            break;
+      case R_MOVI:    R[I->a] = I->b;               break;
+      case R_LOADM:   R[I->a] = M[I->b];            break;
+      case R_STOREM:  M[I->a] = R[I->b];            break;
+      case R_PTRL:    R[I->a] = (R - M) + I->b;     break;
+
+      /* index in a, pointer in a+1, value (stores) in a+2 */
+      case R_LOADc:   R[I->a] = i2u(((char*)(M + R[I->a+1]))[u2i(R[I->a])]);  break;
+      case R_LOADi:   R[I->a] = i2u(((int*)(M + R[I->a+1]))[u2i(R[I->a])]);   break;
+      case R_LOADf:   R[I->a] = f2u(((float*)(M + R[I->a+1]))[u2i(R[I->a])]); break;
+      case R_STOREc:  ((char*)(M + R[I->a+1]))[u2i(R[I->a])] = u2i(R[I->a+2]);  break;
+      case R_STOREi:  ((int*)(M + R[I->a+1]))[u2i(R[I->a])] = u2i(R[I->a+2]);   break;
+      case R_STOREf:  ((float*)(M + R[I->a+1]))[u2i(R[I->a])] = u2f(R[I->a+2]); break;
+
+      case R_MOVE:
+          u = R[I->a];
+          for (i=0; i<I->b; i++) {
+            R[I->a - i] = R[I->a - i - 1];
+          }
+          R[I->a - I->b] = u;
+          break;
+
+      case R_CALL:
+          G = P->F + I->a;
+          GR = R + frame_slots;
+          if (I->a < BUILTIN_FUNCTIONS) {
+            /* arguments are in place, and putchar's result is its argument */
+            if (0==I->a) {
+              R[I->b] = i2u(ioGetchar(&C->io));
+            } else {
+              ioPutchar(&C->io, u2i(R[I->b]));
+            }
+            break;
+          }
+          if (0==G->registered) {
+            segment sub = { M, GR, Rend - GR };
+            C->instruction = I->c;
+            stackCall(P, I->a, R, I->b, &sub, mystack);
+            C->executing = F;
+            break;
+          }
+          if (Rend - GR < G->registered->frame_slots) {
+            C->instruction = I->c;
+            runtimeError3("local variable stack overflow\n    in call to function #", I->a, G->name);
+          }
+          for (i=0; i<G->parameter_slots; i++) {
+            GR[i] = R[I->b + i];
+          }
+          if (nframes >= maxframes) {
+            maxframes = maxframes ? 2*maxframes : 64;
+            frames = realloc(frames, maxframes * sizeof(struct register_frame));
+            if (0==frames) runtimeError("out of memory for call frames");
+          }
+          frames[nframes].I = I;
+          frames[nframes].F = F;
+          frames[nframes].R = R;
+          nframes++;
+          F = G;
+          R = GR;
+          code = F->registered->code;
+          frame_slots = F->registered->frame_slots;
+          C->executing = F;
+          I = code - 1;
+          break;
+
+      case R_RET:
+      case R_RET0:
+          u = (R_RET == I->op) ? R[I->a] : 0;
+          if (0==nframes) {
+            vmRelease();
+            free(frames);
+            return u;
+          }
+          i = F->return_slots;
+          nframes--;
+          I = frames[nframes].I;
+          F = frames[nframes].F;
+          R = frames[nframes].R;
+          code = F->registered->code;
+          frame_slots = F->registered->frame_slots;
+          C->executing = F;
+          if (i) R[I->b] = u;
+          break;
+
+      case R_INCf:    leftf = u2f(R[I->b]);  leftf++;  R[I->a] = f2u(leftf);  break;
+      case R_DECf:    leftf = u2f(R[I->b]);  leftf--;  R[I->a] = f2u(leftf);  break;
+      case R_NEGf:    leftf = u2f(R[I->b]);  leftf *= -1.0;  R[I->a] = f2u(leftf);  break;
+      case R_FLIP:    R[I->a] = ~R[I->b];           break;
+      case R_CONVif:  lefti = u2i(R[I->b]);  R[I->a] = f2u(lefti);  break;
+      case R_CONVfi:  R[I->a] = i2u((int)u2f(R[I->b]));  break;
+
+      /* + - * on two's complement ints are the same bits as unsigned */
+      case R_ADD:     BINARY_U(+);
+      case R_ADDRI:   BINARY_URI(+);
+      case R_SUB:     BINARY_U(-);
+      case R_SUBRI:   BINARY_URI(-);
+      case R_MUL:     BINARY_U(*);
+      case R_MULRI:   BINARY_URI(*);
+      case R_DIV:     BINARY_I(/);
+      case R_DIVRI:   BINARY_IRI(/);
+      case R_MOD:     BINARY_I(%);
+      case R_MODRI:   BINARY_IRI(%);
+      case R_AND:     BINARY_U(&);
+      case R_ANDRI:   BINARY_URI(&);
+      case R_OR:      BINARY_U(|);
+      case R_ORRI:    BINARY_URI(|);
+      case R_ADDf:    BINARY_F(+);
+      case R_SUBf:    BINARY_F(-);
+      case R_MULf:    BINARY_F(*);
+      case R_DIVf:    BINARY_F(/);
+
+      case R_GOTO:    I = code + I->a - 1;          break;
+      case R_IFZi:    if (0==u2i(R[I->b])) I = code + I->a - 1;  break;
+      case R_IFZf:    if (0==u2f(R[I->b])) I = code + I->a - 1;  break;
+      case R_IFNZi:   if (0!=u2i(R[I->b])) I = code + I->a - 1;  break;
+      case R_IFNZf:   if (0!=u2f(R[I->b])) I = code + I->a - 1;  break;
+      case R_IFEQ:    BRANCH_I(==);
+      case R_IFEQRI:  BRANCH_IRI(==);
+      case R_IFNE:    BRANCH_I(!=);
+      case R_IFNERI:  BRANCH_IRI(!=);
+      case R_IFLT:    BRANCH_I(<);
+      case R_IFLTRI:  BRANCH_IRI(<);
+      case R_IFLE:    BRANCH_I(<=);
+      case R_IFLERI:  BRANCH_IRI(<=);
+      case R_IFGT:    BRANCH_I(>);
+      case R_IFGTRI:  BRANCH_IRI(>);
+      case R_IFGE:    BRANCH_I(>=);
+      case R_IFGERI:  BRANCH_IRI(>=);
+      case R_IFEQf:   BRANCH_F(==);
+      case R_IFNEf:   BRANCH_F(!=);
+      case R_IFLTf:   BRANCH_F(<);
+      case R_IFLEf:   BRANCH_F(<=);
+      case R_IFGTf:   BRANCH_F(>);
+      case R_IFGEf:   BRANCH_F(>=);
+
+      case R_FALLOFF:
+          C->instruction = F->code_length;
+          runtimeError("ran past end of function; missing ret?");
+          return 0;
+    }
+  }
+}
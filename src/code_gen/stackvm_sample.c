@@ -0,0 +1,234 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Sampling profiler for --sample.
+
+  An ITIMER_PROF timer raises SIGPROF every 1/hz seconds of CPU time.
+  The handler reads the call stack callSampled publishes, adds the
+  running function and pc from the context it interrupted, and
+  counts the stack in a table of distinct stacks.  The handler can't
+  allocate, so the table and the pool its stacks live in are set up
+  by sampleStart; samples that don't fit are counted as dropped.  A
+  sample that lands while callSampled is switching frames is left
+  pending, and taken by sampleCatchUp a few instructions later, once
+  the new frame is in place.
+
+  Only the innermost SAMPLE_DEPTH functions of a deeper stack are
+  kept, under a (truncated) root.  The report writes one line per
+  stack, outermost function first, with the pc as an extra innermost
+  frame:
+
+      main;fib;fib;fib:4 1234
+
+  which is what flamegraph.pl and its relatives read.
+*/
+
+call_frame* volatile sampleFrames;
+volatile unsigned sampleDepth;
+volatile unsigned sampleBuiltin;
+volatile int sampleBusy;
+volatile unsigned samplePending;
+
+#define SAMPLE_DEPTH    2048
+#define SAMPLE_SLOTS    (1u << 16)
+#define SAMPLE_POOL     (1u << 22)
+
+/*
+  A distinct stack.  Its key is stored in the pool as
+    truncated, builtin + 1 or 0, pc, outermost fnum, ..., innermost fnum
+*/
+typedef struct {
+  unsigned long count;
+  unsigned hash;
+  unsigned start;
+  unsigned length;
+} sampled_stack;
+
+static const program* sampled;
+static unsigned sampleHz;
+static sampled_stack* stacks;
+static unsigned nstacks;
+static unsigned* pool;
+static unsigned poolUsed;
+static unsigned key[SAMPLE_DEPTH + 3];
+
+static volatile unsigned long samples;
+static volatile unsigned long dropped;
+
+static void recordSample()
+{
+  const vm_context* C = vmCurrent;
+  if (0==C->executing) {
+    dropped++;
+    return;
+  }
+
+  unsigned depth = sampleDepth;
+  unsigned first = 0;
+  if (depth >= SAMPLE_DEPTH) first = depth - SAMPLE_DEPTH + 1;
+  unsigned length = 3;
+  key[0] = first > 0;
+  key[1] = sampleBuiltin;
+  key[2] = C->instruction;
+  unsigned i;
+  for (i=first; i<depth; i++) {
+    key[length++] = sampleFrames[i].F - sampled->F;
+  }
+  key[length++] = C->executing - sampled->F;
+
+  unsigned hash = 2166136261u;
+  for (i=0; i<length; i++) {
+    hash = (hash ^ key[i]) * 16777619u;
+  }
+
+  unsigned slot = hash & (SAMPLE_SLOTS-1);
+  while (stacks[slot].count) {
+    sampled_stack* S = stacks+slot;
+    if (S->hash == hash && S->length == length
+        && 0==memcmp(pool + S->start, key, length * sizeof(unsigned))) {
+      S->count++;
+      samples++;
+      return;
+    }
+    slot = (slot+1) & (SAMPLE_SLOTS-1);
+  }
+
+  /* Keep the table at most 3/4 full so probes stay short */
+  if (4*(nstacks+1) > 3*SAMPLE_SLOTS || poolUsed + length > SAMPLE_POOL) {
+    dropped++;
+    return;
+  }
+  memcpy(pool + poolUsed, key, length * sizeof(unsigned));
+  stacks[slot].hash = hash;
+  stacks[slot].start = poolUsed;
+  stacks[slot].length = length;
+  stacks[slot].count = 1;
+  poolUsed += length;
+  nstacks++;
+  samples++;
+}
+
+static void takeSample(int sig)
+{
+  if (sampleBusy) {
+    samplePending++;
+  } else {
+    recordSample();
+  }
+}
+
+void sampleCatchUp()
+{
+  sigset_t prof, old;
+  sigemptyset(&prof);
+  sigaddset(&prof, SIGPROF);
+  sigprocmask(SIG_BLOCK, &prof, &old);
+  for (; samplePending; samplePending--) {
+    recordSample();
+  }
+  sigprocmask(SIG_SETMASK, &old, 0);
+}
+
+void sampleStart(const program* P, unsigned hz)
+{
+  assert(P);
+  assert(hz);
+  sampled = P;
+  sampleHz = hz;
+  stacks = calloc(SAMPLE_SLOTS, sizeof(sampled_stack));
+  pool = malloc(SAMPLE_POOL * sizeof(unsigned));
+  if (0==stacks || 0==pool) {
+    fprintf(stderr, "Error - couldn't allocate sample table\n");
+    exit(2);
+  }
+  sampleBusy = 0;
+  samplePending = 0;
+  sampleDepth = 0;
+  sampleBuiltin = 0;
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = takeSample;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = SA_RESTART;
+  if (sigaction(SIGPROF, &sa, 0)) {
+    fprintf(stderr, "Error - couldn't install SIGPROF handler\n");
+    exit(2);
+  }
+
+  struct itimerval it;
+  it.it_interval.tv_sec = 0;
+  it.it_interval.tv_usec = (hz > 1000000) ? 1 : 1000000 / hz;
+  if (it.it_interval.tv_usec >= 1000000) {
+    it.it_interval.tv_sec = it.it_interval.tv_usec / 1000000;
+    it.it_interval.tv_usec %= 1000000;
+  }
+  it.it_value = it.it_interval;
+  if (setitimer(ITIMER_PROF, &it, 0)) {
+    fprintf(stderr, "Error - couldn't start the sampling timer\n");
+    exit(2);
+  }
+}
+
+void sampleStop()
+{
+  struct itimerval it;
+  memset(&it, 0, sizeof(it));
+  setitimer(ITIMER_PROF, &it, 0);
+  signal(SIGPROF, SIG_IGN);
+}
+
+/*
+  Report
+*/
+
+static void writeStack(FILE* out, const sampled_stack* S)
+{
+  const unsigned* k = pool + S->start;
+  unsigned i;
+  if (k[0]) fprintf(out, "(truncated);");
+  for (i=3; i<S->length; i++) {
+    fprintf(out, "%s;", sampled->F[k[i]].name);
+  }
+  /* the switch loop runs packed code, so this is an offset */
+  const function* F = sampled->F + k[S->length-1];
+  fprintf(out, "%s:%u", F->name, sourceInstruction(F, packedIndex(F, k[2])));
+  if (k[1]) fprintf(out, ";%s", sampled->F[k[1]-1].name);
+  fprintf(out, " %lu\n", S->count);
+}
+
+void sampleReport(const program* P, FILE* text, const char* foldedpath)
+{
+  assert(P == sampled);
+  assert(text);
+  assert(foldedpath);
+
+  FILE* out = fopen(foldedpath, "w");
+  if (0==out) {
+    fprintf(stderr, "Error, couldn't open file '%s'\n", foldedpath);
+    exit(1);
+  }
+  unsigned slot;
+  for (slot=0; slot<SAMPLE_SLOTS; slot++) {
+    if (stacks[slot].count) writeStack(out, stacks+slot);
+  }
+  if (fclose(out)) {
+    fprintf(stderr, "Error writing '%s'\n", foldedpath);
+    exit(1);
+  }
+
+  fprintf(text, "\nSampled %lu stacks at %u Hz (%u distinct, %lu dropped); written to %s\n",
+    samples, sampleHz, nstacks, dropped + samplePending, foldedpath);
+
+  free(stacks);
+  free(pool);
+  stacks = 0;
+  pool = 0;
+}
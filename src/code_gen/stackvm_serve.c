@@ -0,0 +1,145 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Server for --serve.
+
+  The program is loaded, fused and verified once, then the server
+  listens on a Unix socket and forks a child for each connection.  The
+  child starts from the loaded program, copy on write, so a run costs
+  a fork instead of a load.  A client sends one line:
+
+      -         the input follows, up to the client's end of the
+                connection (shutdown for writing to end it)
+      PATH      the input is the file PATH, opened by the server
+      (blank)   there is no input
+
+  and gets back what the command line would have printed to stdout and
+  stderr for the run: the program's output, then either
+
+      Function main returned: N
+
+  or an error message, after which the server closes the connection.
+*/
+
+/* The request line, one byte at a time, so none of the input is read */
+static int readRequest(int fd, char* line, size_t size)
+{
+  size_t n = 0;
+  for (;;) {
+    char c;
+    ssize_t r = read(fd, &c, 1);
+    if (r < 0 && EINTR == errno) continue;
+    if (r <= 0) return 0;
+    if ('\n' == c) break;
+    if (n+1 == size) return 0;
+    line[n++] = c;
+  }
+  if (n && '\r' == line[n-1]) n--;
+  line[n] = 0;
+  return 1;
+}
+
+static void serveRun(int conn, const vm_program* V)
+{
+  /* output, errors and the result line all go to the client */
+  dup2(conn, 1);
+  dup2(conn, 2);
+  char line[4096];
+  if (!readRequest(conn, line, sizeof(line))) {
+    fprintf(stderr, "Error, expected a request line of '-', a path, or nothing\n");
+    exit(1);
+  }
+  int in = -1;
+  if (0==strcmp("-", line)) {
+    in = conn;
+  } else if (line[0]) {
+    in = open(line, O_RDONLY);
+    if (in < 0) {
+      fprintf(stderr, "Error, couldn't open file '%s'\n", line);
+      exit(1);
+    }
+  }
+  int result;
+  int status = vmRun(vmCurrent, V, in, conn, &result);
+  if (0==status) printf("Function main returned: %d\n", result);
+  fflush(stdout);
+  exit(status);
+}
+
+int runServer(const char* socketPath, const char* irfile, vm_engine engine, int verify,
+  size_t globalSlots, size_t localSlots, size_t stackSlots)
+{
+  assert(socketPath);
+  assert(irfile);
+  vm_context* C = vmCurrent;
+  if (vmContextInit(C, globalSlots, localSlots, stackSlots)) return 2;
+  vm_program V;
+  int status = vmLoad(C, irfile, engine, verify, &V);
+  if (status) return status;
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "Error, socket path '%s' is too long\n", socketPath);
+    return 1;
+  }
+  strcpy(addr.sun_path, socketPath);
+  /* replace a socket left by an earlier server, but nothing else */
+  struct stat st;
+  if (0==stat(socketPath, &st)) {
+    if (!S_ISSOCK(st.st_mode)) {
+      fprintf(stderr, "Error, '%s' exists and isn't a socket\n", socketPath);
+      return 1;
+    }
+    unlink(socketPath);
+  }
+  int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listener < 0
+    || bind(listener, (struct sockaddr*) &addr, sizeof(addr))
+    || listen(listener, SOMAXCONN))
+  {
+    fprintf(stderr, "Error, couldn't listen on '%s': %s\n", socketPath, strerror(errno));
+    return 1;
+  }
+
+  /* children are never waited for */
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = SIG_DFL;
+  sa.sa_flags = SA_NOCLDWAIT;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGCHLD, &sa, 0);
+
+  fprintf(stderr, "Serving %s on %s\n", irfile, socketPath);
+  for (;;) {
+    int conn = accept(listener, 0, 0);
+    if (conn < 0) {
+      if (EINTR == errno || ECONNABORTED == errno) continue;
+      fprintf(stderr, "Error accepting a connection: %s\n", strerror(errno));
+      return 2;
+    }
+    pid_t child = fork();
+    if (0==child) {
+      close(listener);
+      serveRun(conn, &V);
+    }
+    if (child < 0) {
+      /* the client sees the connection close with no result */
+      fprintf(stderr, "Error - couldn't start a run: %s\n", strerror(errno));
+    }
+    close(conn);
+  }
+}
@@ -0,0 +1,853 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Direct-threaded execution engine.
+
+  At load time threadFunction translates a function's instruction array
+  into a stream of (handler address, operand) pairs.  Address types are
+  resolved during the translation: a push from a constant or global
+  becomes a handler that reads the slot at its offset from the start
+  of memory, a ptrto a constant or global becomes a pushv of the
+  precomputed pointer, and jump operands become pointers into the
+  stream.  Offsets rather than addresses keep the stream independent
+  of where memory is, so runs in different contexts can share it.
+  One extra entry past the end of the code catches a missing ret, so
+  the loop needs no pc bounds check.  Fused instructions carry their
+  local slots and immediates in x and y.  With --fusion-stats a
+  counting entry is placed in front of every fused instruction;
+  without it the stream is exactly one entry per instruction.
+
+  Execution jumps straight from handler to handler with computed gotos.
+  The stack is kept in a local pointer; the only per-instruction checks
+  left are the underflow tests (overflow runs into the guard after the
+  stack segment), and the pc is only written to the context's
+  instruction when an error is reported.  Functions the verifier
+  passed don't even have those: their stream points past the checks,
+  and callThreaded makes sure once that max_depth slots are free.
+
+  Semantics match callFunction exactly; that loop stays the reference.
+*/
+
+#if defined(__GNUC__)
+
+const int threadedAvailable = 1;
+
+struct threaded_instr {
+  const void* handler;
+  union {
+    unsigned u;
+    const struct threaded_instr* target;
+  } arg;
+  unsigned x, y;
+};
+
+/*
+  Handler kinds.  The c and i flavors of an opcode share a handler,
+  as they do in the reference switch.
+*/
+typedef enum {
+  T_PUSHSLOT, T_PUSHL, T_PTRL, T_PUSHV, T_PUSHc, T_PUSHi, T_PUSHf,
+  T_COPY, T_MOVE,
+  T_POPX, T_POPSLOT, T_POPL, T_POPc, T_POPi, T_POPf,
+  T_CALL, T_RET,
+  T_INCi, T_INCf, T_DECi, T_DECf, T_NEGi, T_NEGf,
+  T_FLIP, T_CONVif, T_CONVfi,
+  T_PLUSi, T_PLUSf, T_MINUSi, T_MINUSf, T_STARi, T_STARf,
+  T_SLASHi, T_SLASHf, T_MODi, T_AND, T_OR,
+  T_GOTO,
+  T_IFZi, T_IFZf, T_IFNZi, T_IFNZf,
+  T_IFEQi, T_IFEQf, T_IFNEi, T_IFNEf,
+  T_IFLTi, T_IFLTf, T_IFLEi, T_IFLEf,
+  T_IFGTi, T_IFGTf, T_IFGEi, T_IFGEf,
+  T_PLUSLL, T_PLUSLV, T_MINUSLL, T_MINUSLV,
+  T_IFEQLL, T_IFNELL, T_IFLTLL, T_IFLELL, T_IFGTLL, T_IFGELL,
+  T_IFEQLV, T_IFNELV, T_IFLTLV, T_IFLELV, T_IFGTLV, T_IFGELV,
+  T_HIT, T_NOP, T_END,
+  T_KINDS
+} threaded_kind;
+
+/*
+  Handler addresses, exported by runThreaded when called with no
+  function, before main so threads never race to fill them in.
+  fastHandlers enter each handler past its stack checks.
+*/
+static const void* const* handlers;
+static const void* const* fastHandlers;
+
+static void runThreaded(program* P, function* F, segment* locals, stack* mystack);
+
+static void __attribute__((constructor)) exportHandlers()
+{
+  runThreaded(0, 0, 0, 0);
+}
+
+static const void* handler(threaded_kind k, int checked)
+{
+  return checked ? handlers[k] : fastHandlers[k];
+}
+
+static threaded_kind kindOf(opcode op)
+{
+  switch (op) {
+    case PUSHv:   return T_PUSHV;
+    case PUSHc:   return T_PUSHc;
+    case PUSHi:   return T_PUSHi;
+    case PUSHf:   return T_PUSHf;
+    case COPY:    return T_COPY;
+    case MOVE:    return T_MOVE;
+    case POPX:    return T_POPX;
+    case POPc:    return T_POPc;
+    case POPi:    return T_POPi;
+    case POPf:    return T_POPf;
+    case CALL:    return T_CALL;
+    case RET:     return T_RET;
+    case INCc:
+    case INCi:    return T_INCi;
+    case INCf:    return T_INCf;
+    case DECc:
+    case DECi:    return T_DECi;
+    case DECf:    return T_DECf;
+    case NEGc:
+    case NEGi:    return T_NEGi;
+    case NEGf:    return T_NEGf;
+    case FLIP:    return T_FLIP;
+    case CONVif:  return T_CONVif;
+    case CONVfi:  return T_CONVfi;
+    case PLUSc:
+    case PLUSi:   return T_PLUSi;
+    case PLUSf:   return T_PLUSf;
+    case MINUSc:
+    case MINUSi:  return T_MINUSi;
+    case MINUSf:  return T_MINUSf;
+    case STARc:
+    case STARi:   return T_STARi;
+    case STARf:   return T_STARf;
+    case SLASHc:
+    case SLASHi:  return T_SLASHi;
+    case SLASHf:  return T_SLASHf;
+    case MODc:
+    case MODi:    return T_MODi;
+    case AND:     return T_AND;
+    case OR:      return T_OR;
+    case GOTO:    return T_GOTO;
+    case IFZc:
+    case IFZi:    return T_IFZi;
+    case IFZf:    return T_IFZf;
+    case IFNZc:
+    case IFNZi:   return T_IFNZi;
+    case IFNZf:   return T_IFNZf;
+    case IFEQc:
+    case IFEQi:   return T_IFEQi;
+    case IFEQf:   return T_IFEQf;
+    case IFNEc:
+    case IFNEi:   return T_IFNEi;
+    case IFNEf:   return T_IFNEf;
+    case IFLTc:
+    case IFLTi:   return T_IFLTi;
+    case IFLTf:   return T_IFLTf;
+    case IFLEc:
+    case IFLEi:   return T_IFLEi;
+    case IFLEf:   return T_IFLEf;
+    case IFGTc:
+    case IFGTi:   return T_IFGTi;
+    case IFGTf:   return T_IFGTf;
+    case IFGEc:
+    case IFGEi:   return T_IFGEi;
+    case IFGEf:   return T_IFGEf;
+    case PLUSiLL: return T_PLUSLL;
+    case PLUSiLV: return T_PLUSLV;
+    case MINUSiLL:return T_MINUSLL;
+    case MINUSiLV:return T_MINUSLV;
+    case IFEQiLL: return T_IFEQLL;
+    case IFNEiLL: return T_IFNELL;
+    case IFLTiLL: return T_IFLTLL;
+    case IFLEiLL: return T_IFLELL;
+    case IFGTiLL: return T_IFGTLL;
+    case IFGEiLL: return T_IFGELL;
+    case IFEQiLV: return T_IFEQLV;
+    case IFNEiLV: return T_IFNELV;
+    case IFLTiLV: return T_IFLTLV;
+    case IFLEiLV: return T_IFLELV;
+    case IFGTiLV: return T_IFGTLV;
+    case IFGEiLV: return T_IFGELV;
+    default:      /* NONE or ERROR; do nothing, like the switch */
+                  return T_NOP;
+  }
+}
+
+void threadFunction(program* P, function* F)
+{
+  assert(P);
+  assert(F);
+  if (F->source) loadFunction(P, F);
+  if (F->rejected) rejectedCall(F);
+  int checked = !F->verified;
+
+  /*
+    map[pc] is the stream index of instruction pc
+  */
+  unsigned* map = malloc((F->code_length+1) * sizeof(unsigned));
+  if (0==map) {
+    fprintf(vmErrors(), "Error - couldn't allocate threaded code for %s\n", F->name);
+    vmExit(2);
+  }
+  unsigned i, t = 0;
+  for (i=0; i<F->code_length; i++) {
+    if (F->fused && F->fused[i]) t++;
+    map[i] = t++;
+  }
+  map[F->code_length] = t;
+
+  free(F->threaded);
+  F->threaded = malloc((t+1) * sizeof(struct threaded_instr));
+  if (0==F->threaded) {
+    fprintf(vmErrors(), "Error - couldn't allocate threaded code for %s\n", F->name);
+    vmExit(2);
+  }
+
+  for (i=0; i<F->code_length; i++) {
+    instruction I = F->code[i];
+    struct threaded_instr* T = F->threaded + map[i];
+    if (F->fused && F->fused[i]) {
+      T[-1].handler = handler(T_HIT, checked);
+      T[-1].arg.u = F->fused[i]-1;
+    }
+    T->arg.u = I.addr;
+    T->x = I.addr2;
+    T->y = I.addr3;
+
+    switch (I.op) {
+      case PUSH:
+          switch (I.atype) {
+            case CONST:   T->handler = handler(T_PUSHSLOT, checked);
+                          T->arg.u = addr2ptr(&P->constants, I.addr);
+                          break;
+            case GLOBAL:  T->handler = handler(T_PUSHSLOT, checked);
+                          T->arg.u = addr2ptr(&P->globals, I.addr);
+                          break;
+            default:      T->handler = handler(T_PUSHL, checked);
+          }
+          break;
+
+      case PTRTO:
+          switch (I.atype) {
+            case CONST:   T->handler = handler(T_PUSHV, checked);
+                          T->arg.u = addr2ptr(&P->constants, I.addr);
+                          break;
+            case GLOBAL:  T->handler = handler(T_PUSHV, checked);
+                          T->arg.u = addr2ptr(&P->globals, I.addr);
+                          break;
+            default:      T->handler = handler(T_PTRL, checked);
+          }
+          break;
+
+      case POP:
+          if (GLOBAL == I.atype) {
+            T->handler = handler(T_POPSLOT, checked);
+            T->arg.u = addr2ptr(&P->globals, I.addr);
+          } else {
+            T->handler = handler(T_POPL, checked);
+          }
+          break;
+
+      case PLUSiLL:
+      case PLUSiLV:
+      case MINUSiLL:
+      case MINUSiLV:
+          T->handler = handler(kindOf(I.op), checked);
+          T->x = I.addr;
+          T->y = I.addr2;
+          break;
+
+      default:
+          T->handler = handler(kindOf(I.op), checked);
+          if (LABEL == I.atype) {
+            assert(I.addr < F->code_length);
+            T->arg.target = F->threaded + map[I.addr];
+          }
+    }
+  }
+
+  F->threaded[t].handler = handler(T_END, checked);
+  F->threaded[t].arg.u = 0;
+  free(map);
+}
+
+/*
+  Instruction number of a stream entry, for error messages
+*/
+static unsigned pcOf(const function* F, const struct threaded_instr* ip)
+{
+  unsigned t = ip - F->threaded;
+  if (0==F->fused) return t;
+  unsigned i;
+  for (i=0; i<F->code_length; i++) {
+    if (F->fused[i]) {
+      if (0==t) return i;
+      t--;
+    }
+    if (0==t) return i;
+    t--;
+  }
+  return F->code_length;
+}
+
+void callThreaded(program* P, unsigned fnum, segment* locals, stack* compstack)
+{
+  assert(P);
+  assert(locals);
+  assert(compstack);
+
+  if (fnum >= P->nf) {
+    runtimeError3("target function number ", fnum, " is too large");
+  }
+  function* F = P->F + fnum;
+  /* read now, since the stack check below needs it verified */
+  if (F->source) loadFunction(P, F);
+
+  if (locals->size < F->parameter_slots + F->local_slots) {
+    runtimeError3("local variable stack overflow\n    in call to function #", fnum, F->name);
+  }
+  if (compstack->top < F->parameter_slots) {
+    runtimeError3("not enough parameters on computation stack\n    in call to function #", fnum, F->name);
+  }
+
+  /*
+    Copy parameters from top of compstack to locals
+  */
+  unsigned i;
+  compstack->top -= F->parameter_slots;
+  for (i=0; i<F->parameter_slots; i++) {
+    locals->data[i] = compstack->data[compstack->top + i];
+  }
+
+  stack mystack;
+  makeSubStack(&mystack, compstack);
+
+  /*
+    The only stack check a verified function needs
+  */
+  if (F->verified && mystack.size < F->max_depth) {
+    vmCurrent->executing = F;
+    vmCurrent->instruction = 0;
+    runtimeError("Stack overflow");
+  }
+
+  if (fnum < BUILTIN_FUNCTIONS) {
+    callBuiltin(fnum, locals, &mystack);
+  } else {
+    if (0==F->threaded) threadFunction(P, F);
+    runThreaded(P, F, locals, &mystack);
+  }
+
+  if (F->return_slots) {
+    assert(1==F->return_slots);
+    push(compstack, pop(&mystack));
+  }
+}
+
+/*
+  Handler helpers.  NEED is the underflow check.  A handler that
+  checks has an L_ entry that does the checks and falls into its U_
+  entry; verified functions are threaded through U_.  Pushes check
+  nothing, since overflow runs into the stack's guard region.
+*/
+#define NEXT        goto *(++ip)->handler
+#define JUMP(T)     do { ip = (T); goto *ip->handler; } while (0)
+#define NEED(n)     if (sp - sbase < (n)) goto underflow
+
+#define BINARY_U(OP)                                    \
+          sp--;                                         \
+          sp[-1] = sp[-1] OP sp[0];                     \
+          NEXT
+
+#define BINARY_I(OP)                                    \
+          sp--;                                         \
+          sp[-1] = i2u(u2i(sp[-1]) OP u2i(sp[0]));      \
+          NEXT
+
+#define BINARY_F(OP)                                    \
+          sp--;                                         \
+          sp[-1] = f2u(u2f(sp[-1]) OP u2f(sp[0]));      \
+          NEXT
+
+#define BRANCH1_I(CMP)                                  \
+          sp--;                                         \
+          if (u2i(sp[0]) CMP 0) JUMP(ip->arg.target);   \
+          NEXT
+
+#define BRANCH1_F(CMP)                                  \
+          sp--;                                         \
+          if (u2f(sp[0]) CMP 0) JUMP(ip->arg.target);   \
+          NEXT
+
+#define BRANCH2_I(CMP)                                  \
+          sp -= 2;                                      \
+          if (u2i(sp[0]) CMP u2i(sp[1])) JUMP(ip->arg.target); \
+          NEXT
+
+#define BRANCH2_F(CMP)                                  \
+          sp -= 2;                                      \
+          if (u2f(sp[0]) CMP u2f(sp[1])) JUMP(ip->arg.target); \
+          NEXT
+
+#define BRANCH_LL(CMP)                                  \
+          if (u2i(L[ip->x]) CMP u2i(L[ip->y])) JUMP(ip->arg.target); \
+          NEXT
+
+#define BRANCH_LV(CMP)                                  \
+          if (u2i(L[ip->x]) CMP u2i(ip->y)) JUMP(ip->arg.target); \
+          NEXT
+
+/*
+  A suspended caller.  Its stack pointer is the callee's stack base.
+*/
+struct threaded_frame {
+  const struct threaded_instr* ip;
+  function* F;
+  unsigned* L;
+  unsigned* sbase;
+};
+
+static void runThreaded(program* P, function* F, segment* locals, stack* mystack)
+{
+  static const void* const table[T_KINDS] = {
+    [T_PUSHSLOT] = &&L_PUSHSLOT, [T_PUSHL] = &&L_PUSHL, [T_PTRL] = &&L_PTRL,
+    [T_PUSHV] = &&L_PUSHV, [T_PUSHc] = &&L_PUSHc, [T_PUSHi] = &&L_PUSHi,
+    [T_PUSHf] = &&L_PUSHf,
+    [T_COPY] = &&L_COPY, [T_MOVE] = &&L_MOVE,
+    [T_POPX] = &&L_POPX, [T_POPSLOT] = &&L_POPSLOT, [T_POPL] = &&L_POPL,
+    [T_POPc] = &&L_POPc, [T_POPi] = &&L_POPi, [T_POPf] = &&L_POPf,
+    [T_CALL] = &&L_CALL, [T_RET] = &&L_RET,
+    [T_INCi] = &&L_INCi, [T_INCf] = &&L_INCf,
+    [T_DECi] = &&L_DECi, [T_DECf] = &&L_DECf,
+    [T_NEGi] = &&L_NEGi, [T_NEGf] = &&L_NEGf,
+    [T_FLIP] = &&L_FLIP, [T_CONVif] = &&L_CONVif, [T_CONVfi] = &&L_CONVfi,
+    [T_PLUSi] = &&L_PLUSi, [T_PLUSf] = &&L_PLUSf,
+    [T_MINUSi] = &&L_MINUSi, [T_MINUSf] = &&L_MINUSf,
+    [T_STARi] = &&L_STARi, [T_STARf] = &&L_STARf,
+    [T_SLASHi] = &&L_SLASHi, [T_SLASHf] = &&L_SLASHf,
+    [T_MODi] = &&L_MODi, [T_AND] = &&L_AND, [T_OR] = &&L_OR,
+    [T_GOTO] = &&L_GOTO,
+    [T_IFZi] = &&L_IFZi, [T_IFZf] = &&L_IFZf,
+    [T_IFNZi] = &&L_IFNZi, [T_IFNZf] = &&L_IFNZf,
+    [T_IFEQi] = &&L_IFEQi, [T_IFEQf] = &&L_IFEQf,
+    [T_IFNEi] = &&L_IFNEi, [T_IFNEf] = &&L_IFNEf,
+    [T_IFLTi] = &&L_IFLTi, [T_IFLTf] = &&L_IFLTf,
+    [T_IFLEi] = &&L_IFLEi, [T_IFLEf] = &&L_IFLEf,
+    [T_IFGTi] = &&L_IFGTi, [T_IFGTf] = &&L_IFGTf,
+    [T_IFGEi] = &&L_IFGEi, [T_IFGEf] = &&L_IFGEf,
+    [T_PLUSLL] = &&L_PLUSLL, [T_PLUSLV] = &&L_PLUSLV,
+    [T_MINUSLL] = &&L_MINUSLL, [T_MINUSLV] = &&L_MINUSLV,
+    [T_IFEQLL] = &&L_IFEQLL, [T_IFNELL] = &&L_IFNELL,
+    [T_IFLTLL] = &&L_IFLTLL, [T_IFLELL] = &&L_IFLELL,
+    [T_IFGTLL] = &&L_IFGTLL, [T_IFGELL] = &&L_IFGELL,
+    [T_IFEQLV] = &&L_IFEQLV, [T_IFNELV] = &&L_IFNELV,
+    [T_IFLTLV] = &&L_IFLTLV, [T_IFLELV] = &&L_IFLELV,
+    [T_IFGTLV] = &&L_IFGTLV, [T_IFGELV] = &&L_IFGELV,
+    [T_HIT] = &&L_HIT, [T_NOP] = &&L_NOP, [T_END] = &&L_END
+  };
+  static const void* const fast[T_KINDS] = {
+    [T_PUSHSLOT] = &&U_PUSHSLOT, [T_PUSHL] = &&U_PUSHL, [T_PTRL] = &&U_PTRL,
+    [T_PUSHV] = &&U_PUSHV, [T_PUSHc] = &&U_PUSHc, [T_PUSHi] = &&U_PUSHi,
+    [T_PUSHf] = &&U_PUSHf,
+    [T_COPY] = &&U_COPY, [T_MOVE] = &&L_MOVE,
+    [T_POPX] = &&U_POPX, [T_POPSLOT] = &&U_POPSLOT, [T_POPL] = &&U_POPL,
+    [T_POPc] = &&U_POPc, [T_POPi] = &&U_POPi, [T_POPf] = &&U_POPf,
+    [T_CALL] = &&L_CALL, [T_RET] = &&L_RET,
+    [T_INCi] = &&U_INCi, [T_INCf] = &&U_INCf,
+    [T_DECi] = &&U_DECi, [T_DECf] = &&U_DECf,
+    [T_NEGi] = &&U_NEGi, [T_NEGf] = &&U_NEGf,
+    [T_FLIP] = &&U_FLIP, [T_CONVif] = &&U_CONVif, [T_CONVfi] = &&U_CONVfi,
+    [T_PLUSi] = &&U_PLUSi, [T_PLUSf] = &&U_PLUSf,
+    [T_MINUSi] = &&U_MINUSi, [T_MINUSf] = &&U_MINUSf,
+    [T_STARi] = &&U_STARi, [T_STARf] = &&U_STARf,
+    [T_SLASHi] = &&U_SLASHi, [T_SLASHf] = &&U_SLASHf,
+    [T_MODi] = &&U_MODi, [T_AND] = &&U_AND, [T_OR] = &&U_OR,
+    [T_GOTO] = &&L_GOTO,
+    [T_IFZi] = &&U_IFZi, [T_IFZf] = &&U_IFZf,
+    [T_IFNZi] = &&U_IFNZi, [T_IFNZf] = &&U_IFNZf,
+    [T_IFEQi] = &&U_IFEQi, [T_IFEQf] = &&U_IFEQf,
+    [T_IFNEi] = &&U_IFNEi, [T_IFNEf] = &&U_IFNEf,
+    [T_IFLTi] = &&U_IFLTi, [T_IFLTf] = &&U_IFLTf,
+    [T_IFLEi] = &&U_IFLEi, [T_IFLEf] = &&U_IFLEf,
+    [T_IFGTi] = &&U_IFGTi, [T_IFGTf] = &&U_IFGTf,
+    [T_IFGEi] = &&U_IFGEi, [T_IFGEf] = &&U_IFGEf,
+    [T_PLUSLL] = &&U_PLUSLL, [T_PLUSLV] = &&U_PLUSLV,
+    [T_MINUSLL] = &&U_MINUSLL, [T_MINUSLV] = &&U_MINUSLV,
+    [T_IFEQLL] = &&L_IFEQLL, [T_IFNELL] = &&L_IFNELL,
+    [T_IFLTLL] = &&L_IFLTLL, [T_IFLELL] = &&L_IFLELL,
+    [T_IFGTLL] = &&L_IFGTLL, [T_IFGELL] = &&L_IFGELL,
+    [T_IFEQLV] = &&L_IFEQLV, [T_IFNELV] = &&L_IFNELV,
+    [T_IFLTLV] = &&L_IFLTLV, [T_IFLELV] = &&L_IFLELV,
+    [T_IFGTLV] = &&L_IFGTLV, [T_IFGELV] = &&L_IFGELV,
+    [T_HIT] = &&L_HIT, [T_NOP] = &&L_NOP, [T_END] = &&L_END
+  };
+
+  if (0==F) {
+    handlers = table;
+    fastHandlers = fast;
+    return;
+  }
+
+  vm_context* const C = vmCurrent;
+  unsigned* const mem = locals->mem_base;
+  unsigned* L = locals->data;
+  unsigned* const Lend = locals->data + locals->size;
+  unsigned* sbase = mystack->data;
+  unsigned* const slimit = sbase + mystack->size;
+  unsigned* sp = sbase + mystack->top;
+  const struct threaded_instr* ip = F->threaded;
+  unsigned leftu, n;
+  int lefti, righti;
+  float rightf;
+  function* G;
+  unsigned* GL;
+
+  /*
+    IR calls stay in this loop: the caller is saved in frames and the
+    callee's locals and stack start where the caller's end.
+  */
+  struct threaded_frame* frames = 0;
+  unsigned nframes = 0;
+  unsigned maxframes = 0;
+  vmHold((void**) &frames);
+
+  C->executing = F;
+  goto *ip->handler;
+
+  L_PUSHSLOT:
+  U_PUSHSLOT:
+          *sp++ = mem[ip->arg.u];
+          NEXT;
+  L_PUSHL:
+  U_PUSHL:
+          *sp++ = L[ip->arg.u];
+          NEXT;
+  L_PTRL:
+  U_PTRL:
+          *sp++ = (L - mem) + ip->arg.u;
+          NEXT;
+  L_PUSHV:
+  U_PUSHV:
+          *sp++ = ip->arg.u;
+          NEXT;
+  L_PUSHc:
+          NEED(2);
+  U_PUSHc:
+          leftu = sp[-1];
+          righti = u2i(sp[-2]);
+          sp--;
+          sp[-1] = i2u(((char*)(mem + leftu))[righti]);
+          NEXT;
+  L_PUSHi:
+          NEED(2);
+  U_PUSHi:
+          leftu = sp[-1];
+          righti = u2i(sp[-2]);
+          sp--;
+          sp[-1] = i2u(((int*)(mem + leftu))[righti]);
+          NEXT;
+  L_PUSHf:
+          NEED(2);
+  U_PUSHf:
+          leftu = sp[-1];
+          righti = u2i(sp[-2]);
+          sp--;
+          sp[-1] = f2u(((float*)(mem + leftu))[righti]);
+          NEXT;
+  L_COPY:
+          NEED(1);
+  U_COPY:
+          sp[0] = sp[-1];
+          sp++;
+          NEXT;
+  L_MOVE:
+          n = ip->arg.u;
+          if (n) {
+            NEED(n+1);
+            leftu = sp[-1];
+            unsigned* ptr;
+            for (ptr = sp-1; n; n--, ptr--) *ptr = ptr[-1];
+            *ptr = leftu;
+          }
+          NEXT;
+  L_POPX:
+          NEED(1);
+  U_POPX:
+          sp--;
+          NEXT;
+  L_POPSLOT:
+          NEED(1);
+  U_POPSLOT:
+          mem[ip->arg.u] = *--sp;
+          NEXT;
+  L_POPL:
+          NEED(1);
+  U_POPL:
+          L[ip->arg.u] = *--sp;
+          NEXT;
+  L_POPc:
+          NEED(3);
+  U_POPc:
+          sp -= 3;
+          ((char*)(mem + sp[1]))[u2i(sp[0])] = u2i(sp[2]);
+          NEXT;
+  L_POPi:
+          NEED(3);
+  U_POPi:
+          sp -= 3;
+          ((int*)(mem + sp[1]))[u2i(sp[0])] = u2i(sp[2]);
+          NEXT;
+  L_POPf:
+          NEED(3);
+  U_POPf:
+          sp -= 3;
+          ((float*)(mem + sp[1]))[u2i(sp[0])] = u2f(sp[2]);
+          NEXT;
+
+  L_CALL:
+          n = ip->arg.u;
+          GL = L + F->parameter_slots + F->local_slots;
+          if (n < BUILTIN_FUNCTIONS) {
+            if (sp - sbase < P->F[n].parameter_slots) {
+              C->instruction = pcOf(F, ip);
+              runtimeError3("not enough parameters on computation stack\n    in call to function #", n, P->F[n].name);
+            }
+            sp = callBuiltinFast(&C->io, n, sp);
+            NEXT;
+          }
+          if (n >= P->nf) {
+            C->instruction = pcOf(F, ip);
+            runtimeError3("target function number ", n, " is too large");
+          }
+          G = P->F + n;
+          if (Lend - GL < G->parameter_slots + G->local_slots) {
+            C->instruction = pcOf(F, ip);
+            runtimeError3("local variable stack overflow\n    in call to function #", n, G->name);
+          }
+          if (sp - sbase < G->parameter_slots) {
+            C->instruction = pcOf(F, ip);
+            runtimeError3("not enough parameters on computation stack\n    in call to function #", n, G->name);
+          }
+          if (jitEnabled && jitReady(P, G)) {
+            sp = jitCall(n, GL, sp, pcOf(F, ip));
+            NEXT;
+          }
+          sp -= G->parameter_slots;
+          for (leftu=0; leftu<G->parameter_slots; leftu++) GL[leftu] = sp[leftu];
+
+          if (nframes >= maxframes) {
+            maxframes = maxframes ? 2*maxframes : 64;
+            frames = realloc(frames, maxframes * sizeof(struct threaded_frame));
+            if (0==frames) runtimeError("out of memory for call frames");
+          }
+          frames[nframes].ip = ip;
+          frames[nframes].F = F;
+          frames[nframes].L = L;
+          frames[nframes].sbase = sbase;
+          nframes++;
+
+          F = G;
+          L = GL;
+          sbase = sp;
+          if (0==F->threaded) threadFunction(P, F);
+          C->executing = F;
+          if (F->verified && slimit - sp < F->max_depth) {
+            C->instruction = 0;
+            runtimeError("Stack overflow");
+          }
+          JUMP(F->threaded);
+  L_RET:
+          if (0==nframes) {
+            mystack->top = sp - mystack->data;
+            vmRelease();
+            free(frames);
+            return;
+          }
+          if (F->return_slots) {
+            NEED(1);
+            sbase[0] = sp[-1];
+            sp = sbase + 1;
+          } else {
+            sp = sbase;
+          }
+          nframes--;
+          ip = frames[nframes].ip;
+          F = frames[nframes].F;
+          L = frames[nframes].L;
+          sbase = frames[nframes].sbase;
+          C->executing = F;
+          NEXT;
+
+  L_INCi:
+          NEED(1);
+  U_INCi:
+          sp[-1] = i2u(u2i(sp[-1]) + 1);
+          NEXT;
+  L_INCf:
+          NEED(1);
+  U_INCf:
+          sp[-1] = f2u(u2f(sp[-1]) + 1);
+          NEXT;
+  L_DECi:
+          NEED(1);
+  U_DECi:
+          sp[-1] = i2u(u2i(sp[-1]) - 1);
+          NEXT;
+  L_DECf:
+          NEED(1);
+  U_DECf:
+          sp[-1] = f2u(u2f(sp[-1]) - 1);
+          NEXT;
+  L_NEGi:
+          NEED(1);
+  U_NEGi:
+          sp[-1] = -sp[-1];
+          NEXT;
+  L_NEGf:
+          NEED(1);
+  U_NEGf:
+          rightf = u2f(sp[-1]);
+          rightf *= -1.0;
+          sp[-1] = f2u(rightf);
+          NEXT;
+  L_FLIP:
+          NEED(1);
+  U_FLIP:
+          sp[-1] = ~sp[-1];
+          NEXT;
+  L_CONVif:
+          NEED(1);
+  U_CONVif:
+          lefti = u2i(sp[-1]);
+          sp[-1] = f2u(lefti);
+          NEXT;
+  L_CONVfi:
+          NEED(1);
+  U_CONVfi:
+          sp[-1] = i2u((int)u2f(sp[-1]));
+          NEXT;
+
+  /* + - * on two's complement ints are the same bits as unsigned */
+  L_PLUSi:  NEED(2);
+  U_PLUSi:  BINARY_U(+);
+  L_PLUSf:  NEED(2);
+  U_PLUSf:  BINARY_F(+);
+  L_MINUSi: NEED(2);
+  U_MINUSi: BINARY_U(-);
+  L_MINUSf: NEED(2);
+  U_MINUSf: BINARY_F(-);
+  L_STARi:  NEED(2);
+  U_STARi:  BINARY_U(*);
+  L_STARf:  NEED(2);
+  U_STARf:  BINARY_F(*);
+  L_SLASHi: NEED(2);
+  U_SLASHi: BINARY_I(/);
+  L_SLASHf: NEED(2);
+  U_SLASHf: BINARY_F(/);
+  L_MODi:   NEED(2);
+  U_MODi:   BINARY_I(%);
+  L_AND:    NEED(2);
+  U_AND:    BINARY_U(&);
+  L_OR:     NEED(2);
+  U_OR:     BINARY_U(|);
+
+  L_GOTO:
+          JUMP(ip->arg.target);
+  L_IFZi:   NEED(1);
+  U_IFZi:   BRANCH1_I(==);
+  L_IFZf:   NEED(1);
+  U_IFZf:   BRANCH1_F(==);
+  L_IFNZi:  NEED(1);
+  U_IFNZi:  BRANCH1_I(!=);
+  L_IFNZf:  NEED(1);
+  U_IFNZf:  BRANCH1_F(!=);
+  L_IFEQi:  NEED(2);
+  U_IFEQi:  BRANCH2_I(==);
+  L_IFEQf:  NEED(2);
+  U_IFEQf:  BRANCH2_F(==);
+  L_IFNEi:  NEED(2);
+  U_IFNEi:  BRANCH2_I(!=);
+  L_IFNEf:  NEED(2);
+  U_IFNEf:  BRANCH2_F(!=);
+  L_IFLTi:  NEED(2);
+  U_IFLTi:  BRANCH2_I(<);
+  L_IFLTf:  NEED(2);
+  U_IFLTf:  BRANCH2_F(<);
+  L_IFLEi:  NEED(2);
+  U_IFLEi:  BRANCH2_I(<=);
+  L_IFLEf:  NEED(2);
+  U_IFLEf:  BRANCH2_F(<=);
+  L_IFGTi:  NEED(2);
+  U_IFGTi:  BRANCH2_I(>);
+  L_IFGTf:  NEED(2);
+  U_IFGTf:  BRANCH2_F(>);
+  L_IFGEi:  NEED(2);
+  U_IFGEi:  BRANCH2_I(>=);
+  L_IFGEf:  NEED(2);
+  U_IFGEf:  BRANCH2_F(>=);
+
+  L_PLUSLL:
+  U_PLUSLL:
+          *sp++ = L[ip->x] + L[ip->y];
+          NEXT;
+  L_PLUSLV:
+  U_PLUSLV:
+          *sp++ = L[ip->x] + ip->y;
+          NEXT;
+  L_MINUSLL:
+  U_MINUSLL:
+          *sp++ = L[ip->x] - L[ip->y];
+          NEXT;
+  L_MINUSLV:
+  U_MINUSLV:
+          *sp++ = L[ip->x] - ip->y;
+          NEXT;
+  L_IFEQLL: BRANCH_LL(==);
+  L_IFNELL: BRANCH_LL(!=);
+  L_IFLTLL: BRANCH_LL(<);
+  L_IFLELL: BRANCH_LL(<=);
+  L_IFGTLL: BRANCH_LL(>);
+  L_IFGELL: BRANCH_LL(>=);
+  L_IFEQLV: BRANCH_LV(==);
+  L_IFNELV: BRANCH_LV(!=);
+  L_IFLTLV: BRANCH_LV(<);
+  L_IFLELV: BRANCH_LV(<=);
+  L_IFGTLV: BRANCH_LV(>);
+  L_IFGELV: BRANCH_LV(>=);
+
+  L_HIT:
+          fusionHits[ip->arg.u]++;
+          NEXT;
+  L_NOP:
+          NEXT;
+  L_END:
+          C->instruction = F->code_length;
+          runtimeError("ran past end of function; missing ret?");
+          return;
+
+  underflow:
+          C->instruction = pcOf(F, ip);
+          runtimeError("Stack underflow");
+          return;
+}
+
+#else /* no labels-as-values */
+
+const int threadedAvailable = 0;
+
+void threadFunction(program* P, function* F)
+{
+}
+
+void callThreaded(program* P, unsigned fnum, segment* locals, stack* compstack)
+{
+  callFunction(P, fnum, locals, compstack);
+}
+
+#endif
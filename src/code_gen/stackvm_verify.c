@@ -0,0 +1,301 @@
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include "../../includes/stackvm.h"
+
+/*
+  Static verifier.
+
+  verifyFunction runs once per function after the whole program is
+  read (a call's stack effect depends on the callee).  It walks the
+  instructions reachable from 0, following fall-through and labels,
+  and keeps for every instruction the least and greatest operand stack
+  depth it can be reached with.  From that it proves, for every
+  reachable instruction:
+
+    - the stack holds enough operands,
+    - local, global and constant indexes are in range,
+    - jump targets and called functions exist.
+
+  Anything else rejects the function: the diagnostic naming the
+  instruction is kept in rejected, and rejectedCall reports it and
+  exits when the function is called, not before.  So whether a program
+  runs doesn't depend on whether it was read lazily, which only
+  verifies the functions that are called, or all at once.
+
+  Control may reach the end of the function, as it does in code
+  generated for a function whose last statement isn't a return; the
+  engines report that at run time, when it happens.
+
+  The greatest depth is finite unless a loop leaves values behind on
+  every iteration (the code generator does that for expression
+  statements).  Once a depth exceeds the code length it can only be
+  growing around a loop, and it is widened to unbounded.  Functions
+  with a bounded depth are marked verified: an engine can check for
+  max_depth free slots once per call and drop every per-instruction
+  check.  The rest still pass, but keep running checked.
+*/
+
+#define UNBOUNDED INT_MAX
+
+int stackEffect(const program* P, instruction I, unsigned* need, int* delta)
+{
+  switch (I.op) {
+    case PUSH:
+    case PTRTO:
+    case PUSHv:
+    case PLUSiLL:
+    case PLUSiLV:
+    case MINUSiLL:
+    case MINUSiLV:  *need = 0;  *delta = 1;   return 1;
+
+    case PUSHc:
+    case PUSHi:
+    case PUSHf:     *need = 2;  *delta = -1;  return 1;
+
+    case COPY:      *need = 1;  *delta = 1;   return 1;
+    case MOVE:      *need = I.addr ? I.addr+1 : 0;  *delta = 0;  return 1;
+
+    case POPX:
+    case POP:       *need = 1;  *delta = -1;  return 1;
+
+    case POPc:
+    case POPi:
+    case POPf:      *need = 3;  *delta = -3;  return 1;
+
+    case CALL:
+        if (I.addr >= P->nf || 0==P->F[I.addr].name) return 0;
+        *need = P->F[I.addr].parameter_slots;
+        *delta = (int) P->F[I.addr].return_slots - (int) *need;
+        return 1;
+
+    case INCc: case INCi: case INCf:
+    case DECc: case DECi: case DECf:
+    case NEGc: case NEGi: case NEGf:
+    case FLIP: case CONVif: case CONVfi:
+                    *need = 1;  *delta = 0;   return 1;
+
+    case PLUSc: case PLUSi: case PLUSf:
+    case MINUSc: case MINUSi: case MINUSf:
+    case STARc: case STARi: case STARf:
+    case SLASHc: case SLASHi: case SLASHf:
+    case MODc: case MODi:
+    case AND: case OR:
+                    *need = 2;  *delta = -1;  return 1;
+
+    case IFZc: case IFZi: case IFZf:
+    case IFNZc: case IFNZi: case IFNZf:
+                    *need = 1;  *delta = -1;  return 1;
+
+    case IFEQc: case IFEQi: case IFEQf:
+    case IFNEc: case IFNEi: case IFNEf:
+    case IFLTc: case IFLTi: case IFLTf:
+    case IFLEc: case IFLEi: case IFLEf:
+    case IFGTc: case IFGTi: case IFGTf:
+    case IFGEc: case IFGEi: case IFGEf:
+                    *need = 2;  *delta = -2;  return 1;
+
+    default:        /* RET, GOTO, fused branches, NONE, ERROR */
+                    *need = 0;  *delta = 0;   return 1;
+  }
+}
+
+/* Keeps a verify error for rejectedCall and returns 0, for the caller to give up */
+static int reject(function* F, unsigned pc, const char* what, unsigned u1, unsigned u2)
+{
+  size_t length;
+  FILE* out = open_memstream(&F->rejected, &length);
+  if (0==out) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory to verify %s\n", F->name);
+    vmExit(2);
+  }
+  fprintf(out, "Verify error in function %s instruction %u",
+    F->name, sourceInstruction(F, pc));
+  if (pc < F->code_length) {
+    fprintf(out, " (");
+    showInstruction(out, F->code[pc]);
+    fprintf(out, ")");
+  }
+  fprintf(out, ":\n    ");
+  fprintf(out, what, u1, u2);
+  fprintf(out, "\n");
+  fclose(out);
+  return 0;
+}
+
+void rejectedCall(const function* F)
+{
+  assert(F->rejected);
+  fputs(F->rejected, vmErrors());
+  vmExit(1);
+}
+
+static int checkSlot(const program* P, function* F, unsigned pc,
+  address_type atype, unsigned addr)
+{
+  unsigned nl = F->parameter_slots + F->local_slots;
+  switch (atype) {
+    case CONST:
+        if (addr >= P->constants.size) {
+          return reject(F, pc, "constant C%u out of range (%u constants)", addr, P->constants.size);
+        }
+        return 1;
+    case GLOBAL:
+        if (addr >= P->globals.size) {
+          return reject(F, pc, "global G%u out of range (%u globals)", addr, P->globals.size);
+        }
+        return 1;
+    case LOCAL:
+        if (addr >= nl) {
+          return reject(F, pc, "local L%u out of range (%u parameter and local slots)", addr, nl);
+        }
+        return 1;
+    default:
+        return reject(F, pc, "bad address type", 0, 0);
+  }
+}
+
+static int checkOperands(const program* P, function* F, unsigned pc)
+{
+  instruction I = F->code[pc];
+  switch (I.op) {
+    case PUSH:
+    case PTRTO:
+        if (!checkSlot(P, F, pc, I.atype, I.addr)) return 0;
+        break;
+
+    case POP:
+        if (CONST == I.atype) return reject(F, pc, "pop into a constant", 0, 0);
+        if (!checkSlot(P, F, pc, I.atype, I.addr)) return 0;
+        break;
+
+    case PLUSiLL:
+    case MINUSiLL:
+        if (!checkSlot(P, F, pc, LOCAL, I.addr2)) return 0;
+        /* fall through */
+    case PLUSiLV:
+    case MINUSiLV:
+        if (!checkSlot(P, F, pc, LOCAL, I.addr)) return 0;
+        break;
+
+    case IFEQiLL: case IFNEiLL: case IFLTiLL:
+    case IFLEiLL: case IFGTiLL: case IFGEiLL:
+        if (!checkSlot(P, F, pc, LOCAL, I.addr3)) return 0;
+        /* fall through */
+    case IFEQiLV: case IFNEiLV: case IFLTiLV:
+    case IFLEiLV: case IFGTiLV: case IFGEiLV:
+        if (!checkSlot(P, F, pc, LOCAL, I.addr2)) return 0;
+        break;
+
+    case CALL:
+        if (I.addr >= P->nf || 0==P->F[I.addr].name) {
+          return reject(F, pc, "call to undefined function #%u", I.addr, 0);
+        }
+        break;
+
+    case ERROR:
+        return reject(F, pc, "invalid instruction", 0, 0);
+
+    default:
+        ;
+  }
+  if (LABEL == I.atype && I.addr >= F->code_length) {
+    return reject(F, pc, "jump target %u past end of function (%u instructions)", I.addr, F->code_length);
+  }
+  return 1;
+}
+
+void verifyFunction(const program* P, function* F)
+{
+  assert(P);
+  assert(F);
+  F->verified = 0;
+  F->max_depth = 0;
+  free(F->rejected);
+  F->rejected = 0;
+
+  unsigned n = F->code_length;
+  if (0==n) {
+    F->verified = 1;
+    return;
+  }
+
+  /*
+    lo[pc] and hi[pc] bound the depth on entry to pc; hi < 0 means
+    pc hasn't been reached.
+  */
+  int* lo = malloc(n * sizeof(int));
+  int* hi = malloc(n * sizeof(int));
+  char* queued = calloc(n, 1);
+  unsigned* work = malloc(n * sizeof(unsigned));
+  if (0==lo || 0==hi || 0==queued || 0==work) {
+    fprintf(vmErrors(), "Error - couldn't allocate memory to verify %s\n", F->name);
+    vmExit(2);
+  }
+  unsigned pc, i, nwork = 0;
+  for (pc=0; pc<n; pc++) hi[pc] = -1;
+
+  lo[0] = hi[0] = 0;
+  work[nwork++] = 0;
+  queued[0] = 1;
+  int maxdepth = 0;
+  int ok = 1;
+
+  while (ok && nwork) {
+    pc = work[--nwork];
+    queued[pc] = 0;
+    instruction I = F->code[pc];
+
+    ok = checkOperands(P, F, pc);
+    if (!ok) break;
+
+    unsigned need;
+    int delta;
+    stackEffect(P, I, &need, &delta);
+    if (RET == I.op) need = F->return_slots;
+    if (lo[pc] < (int) need) {
+      ok = reject(F, pc, "stack underflow: needs %u slots, may have %u", need, lo[pc]);
+      break;
+    }
+
+    int alo = lo[pc] + delta;
+    int ahi = (UNBOUNDED == hi[pc]) ? UNBOUNDED : hi[pc] + delta;
+    if (ahi > (int) n && ahi != UNBOUNDED) ahi = UNBOUNDED;
+    if (ahi > maxdepth) maxdepth = ahi;
+
+    unsigned succ[2];
+    unsigned ns = 0;
+    /* falling off the end is left to the engines */
+    if ((GOTO != I.op) && (RET != I.op) && pc+1 < n) succ[ns++] = pc+1;
+    if (LABEL == I.atype) succ[ns++] = I.addr;
+
+    for (i=0; i<ns; i++) {
+      unsigned s = succ[i];
+      int changed = 0;
+      if (hi[s] < 0) {
+        lo[s] = alo;
+        hi[s] = ahi;
+        changed = 1;
+      } else {
+        if (alo < lo[s]) { lo[s] = alo; changed = 1; }
+        if (ahi > hi[s]) { hi[s] = ahi; changed = 1; }
+      }
+      if (changed && !queued[s]) {
+        queued[s] = 1;
+        work[nwork++] = s;
+      }
+    }
+  }
+
+  if (ok && maxdepth != UNBOUNDED) {
+    F->verified = 1;
+    F->max_depth = maxdepth;
+  }
+
+  free(work);
+  free(queued);
+  free(hi);
+  free(lo);
+}
@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../../includes/arena.h"
+
+//the first chunk, each new chunk is twice the last up to the max
+#define FIRST_CHUNK_SIZE    (64 * 1024)
+#define MAX_CHUNK_SIZE      (4 * 1024 * 1024)
+//everything in an ast is at most as aligned as a long or a pointer
+#define ARENA_ALIGN         sizeof(long)
+
+//chunk headers are padded so the data after them stays aligned
+#define CHUNK_HEADER        ((sizeof(arena_chunk_t) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+static arena_chunk_t *new_chunk(arena_t *arena, size_t size)
+{
+    arena_chunk_t *chunk;
+
+    if(arena->chunk_size == 0)
+        arena->chunk_size = FIRST_CHUNK_SIZE;
+    else if(arena->chunk_size < MAX_CHUNK_SIZE)
+        arena->chunk_size *= 2;
+
+    //big requests get a chunk of their own size
+    if(size < arena->chunk_size)
+        size = arena->chunk_size;
+
+    chunk = malloc(CHUNK_HEADER + size);
+    if(chunk == NULL)
+    {
+        fprintf(stderr, "failed to allocate memory for arena chunk\n");
+        exit(-1);
+    }
+
+    chunk->size = size;
+    chunk->used = 0;
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+    return chunk;
+}
+
+void *arena_alloc(arena_t *arena, size_t size)
+{
+    arena_chunk_t *chunk = arena->chunks;
+    void *ptr;
+
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    if(chunk == NULL || chunk->size - chunk->used < size)
+        chunk = new_chunk(arena, size);
+
+    ptr = (char*)chunk + CHUNK_HEADER + chunk->used;
+    chunk->used += size;
+    arena->allocations++;
+    arena->bytes += size;
+    return ptr;
+}
+
+void arena_reset(arena_t *arena)
+{
+    arena_chunk_t *chunk, *next;
+
+    for(chunk = arena->chunks; chunk; chunk = next)
+    {
+        next = chunk->next;
+        free(chunk);
+    }
+
+    arena->chunks = NULL;
+    arena->chunk_size = 0;
+    arena->allocations = 0;
+    arena->bytes = 0;
+}
@@ -1,284 +1,301 @@
 /*
  * Generic map implementation.
+ *
+ * Open addressing in the style of a Swiss table.  The slots come in
+ * groups of 16, and each slot has a control byte that is EMPTY, DELETED
+ * or the low 7 bits of the hash of the key in it.  A lookup checks all
+ * 16 control bytes of a group against the key's 7 bits at once and only
+ * looks at the slots that match, and it stops at the first group that
+ * still has an EMPTY slot.  The full hash is kept in each slot, so
+ * growing never hashes a key again.
  */
 #include "../../includes/hashmap.h"
+#include "../../includes/intern.h"
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
-#define INITIAL_SIZE (256)
-#define MAX_CHAIN_LENGTH (8)
+#define GROUP_SIZE (16)
+#define INITIAL_SIZE (32)
 
-/* We need to keep keys and values */
+/* Control bytes.  A slot in use holds 0 to 127 so its top bit is clear */
+#define CTRL_EMPTY ((signed char)-128)
+#define CTRL_DELETED ((signed char)-2)
+
+/* wyhash's constants */
+#define HASH_P0 (0xa0761d6478bd642full)
+#define HASH_P1 (0xe7037ed1a0b428dbull)
+
+/* We need to keep keys and values, and the hash of the key */
 typedef struct _hashmap_element{
-	char* key;
-	int in_use;
+	const char* key;
 	any_t data;
+	uint64_t hash;
 } hashmap_element;
 
-/* A hashmap has some maximum size and current size,
- * as well as the data to hold. */
+/* A hashmap has a number of slots, a power of two and at least one
+ * group, and the control bytes for them.  growth_left counts the EMPTY
+ * slots that can still be used before the map must grow. */
 typedef struct _hashmap_map{
-	int table_size;
-	int size;
+	size_t table_size;
+	size_t size;
+	size_t growth_left;
+	int interned;
+	signed char *ctrl;
 	hashmap_element *data;
 } hashmap_map;
 
+/* Keep at least 1/8 of the slots EMPTY so every probe ends */
+static size_t hashmap_capacity(size_t table_size){
+	return table_size - table_size / 8;
+}
+
+/*
+ * Make the slots for a map of table_size slots, all EMPTY.  The control
+ * bytes share the allocation, after the slots.
+ */
+static int hashmap_alloc(hashmap_map* m, size_t table_size){
+	hashmap_element* data = (hashmap_element*)
+		malloc(table_size * (sizeof(hashmap_element) + 1));
+	if(!data) return MAP_OMEM;
+
+	m->data = data;
+	m->ctrl = (signed char*) (data + table_size);
+	memset(m->ctrl, CTRL_EMPTY, table_size);
+	m->table_size = table_size;
+	m->growth_left = hashmap_capacity(table_size);
+	return MAP_OK;
+}
+
 /*
  * Return an empty hashmap, or NULL on failure.
  */
 map_t hashmap_new() {
 	hashmap_map* m = (hashmap_map*) malloc(sizeof(hashmap_map));
-	if(!m) goto err;
-
-	m->data = (hashmap_element*) calloc(INITIAL_SIZE, sizeof(hashmap_element));
-	if(!m->data) goto err;
+	if(!m) return NULL;
 
-	m->table_size = INITIAL_SIZE;
+	if(hashmap_alloc(m, INITIAL_SIZE) != MAP_OK){
+		free(m);
+		return NULL;
+	}
 	m->size = 0;
+	m->interned = 0;
 
 	return m;
-	err:
-		if (m)
-			hashmap_free(m);
-		return NULL;
 }
 
-/* The implementation here was originally done by Gary S. Brown.  I have
-   borrowed the tables directly, and made some minor changes to the
-   crc32-function (including changing the interface). //ylo */
-
-  /* ============================================================= */
-  /*  COPYRIGHT (C) 1986 Gary S. Brown.  You may use this program, or       */
-  /*  code or tables extracted from it, as desired without restriction.     */
-  /*                                                                        */
-  /*  First, the polynomial itself and its table of feedback terms.  The    */
-  /*  polynomial is                                                         */
-  /*  X^32+X^26+X^23+X^22+X^16+X^12+X^11+X^10+X^8+X^7+X^5+X^4+X^2+X^1+X^0   */
-  /*                                                                        */
-  /*  Note that we take it "backwards" and put the highest-order term in    */
-  /*  the lowest-order bit.  The X^32 term is "implied"; the LSB is the     */
-  /*  X^31 term, etc.  The X^0 term (usually shown as "+1") results in      */
-  /*  the MSB being 1.                                                      */
-  /*                                                                        */
-  /*  Note that the usual hardware shift register implementation, which     */
-  /*  is what we're using (we're merely optimizing it by doing eight-bit    */
-  /*  chunks at a time) shifts bits into the lowest-order term.  In our     */
-  /*  implementation, that means shifting towards the right.  Why do we     */
-  /*  do it this way?  Because the calculated CRC must be transmitted in    */
-  /*  order from highest-order term to lowest-order term.  UARTs transmit   */
-  /*  characters in order from LSB to MSB.  By storing the CRC this way,    */
-  /*  we hand it to the UART in the order low-byte to high-byte; the UART   */
-  /*  sends each low-bit to hight-bit; and the result is transmission bit   */
-  /*  by bit from highest- to lowest-order term without requiring any bit   */
-  /*  shuffling on our part.  Reception works similarly.                    */
-  /*                                                                        */
-  /*  The feedback terms table consists of 256, 32-bit entries.  Notes:     */
-  /*                                                                        */
-  /*      The table can be generated at runtime if desired; code to do so   */
-  /*      is shown later.  It might not be obvious, but the feedback        */
-  /*      terms simply represent the results of eight shift/xor opera-      */
-  /*      tions for all combinations of data and CRC register values.       */
-  /*                                                                        */
-  /*      The values must be right-shifted by eight bits by the "updcrc"    */
-  /*      logic; the shift must be unsigned (bring in zeroes).  On some     */
-  /*      hardware you could probably optimize the shift in assembler by    */
-  /*      using byte-swap instructions.                                     */
-  /*      polynomial $edb88320                                              */
-  /*                                                                        */
-  /*  --------------------------------------------------------------------  */
-
-static unsigned long crc32_tab[] = {
-      0x00000000L, 0x77073096L, 0xee0e612cL, 0x990951baL, 0x076dc419L,
-      0x706af48fL, 0xe963a535L, 0x9e6495a3L, 0x0edb8832L, 0x79dcb8a4L,
-      0xe0d5e91eL, 0x97d2d988L, 0x09b64c2bL, 0x7eb17cbdL, 0xe7b82d07L,
-      0x90bf1d91L, 0x1db71064L, 0x6ab020f2L, 0xf3b97148L, 0x84be41deL,
-      0x1adad47dL, 0x6ddde4ebL, 0xf4d4b551L, 0x83d385c7L, 0x136c9856L,
-      0x646ba8c0L, 0xfd62f97aL, 0x8a65c9ecL, 0x14015c4fL, 0x63066cd9L,
-      0xfa0f3d63L, 0x8d080df5L, 0x3b6e20c8L, 0x4c69105eL, 0xd56041e4L,
-      0xa2677172L, 0x3c03e4d1L, 0x4b04d447L, 0xd20d85fdL, 0xa50ab56bL,
-      0x35b5a8faL, 0x42b2986cL, 0xdbbbc9d6L, 0xacbcf940L, 0x32d86ce3L,
-      0x45df5c75L, 0xdcd60dcfL, 0xabd13d59L, 0x26d930acL, 0x51de003aL,
-      0xc8d75180L, 0xbfd06116L, 0x21b4f4b5L, 0x56b3c423L, 0xcfba9599L,
-      0xb8bda50fL, 0x2802b89eL, 0x5f058808L, 0xc60cd9b2L, 0xb10be924L,
-      0x2f6f7c87L, 0x58684c11L, 0xc1611dabL, 0xb6662d3dL, 0x76dc4190L,
-      0x01db7106L, 0x98d220bcL, 0xefd5102aL, 0x71b18589L, 0x06b6b51fL,
-      0x9fbfe4a5L, 0xe8b8d433L, 0x7807c9a2L, 0x0f00f934L, 0x9609a88eL,
-      0xe10e9818L, 0x7f6a0dbbL, 0x086d3d2dL, 0x91646c97L, 0xe6635c01L,
-      0x6b6b51f4L, 0x1c6c6162L, 0x856530d8L, 0xf262004eL, 0x6c0695edL,
-      0x1b01a57bL, 0x8208f4c1L, 0xf50fc457L, 0x65b0d9c6L, 0x12b7e950L,
-      0x8bbeb8eaL, 0xfcb9887cL, 0x62dd1ddfL, 0x15da2d49L, 0x8cd37cf3L,
-      0xfbd44c65L, 0x4db26158L, 0x3ab551ceL, 0xa3bc0074L, 0xd4bb30e2L,
-      0x4adfa541L, 0x3dd895d7L, 0xa4d1c46dL, 0xd3d6f4fbL, 0x4369e96aL,
-      0x346ed9fcL, 0xad678846L, 0xda60b8d0L, 0x44042d73L, 0x33031de5L,
-      0xaa0a4c5fL, 0xdd0d7cc9L, 0x5005713cL, 0x270241aaL, 0xbe0b1010L,
-      0xc90c2086L, 0x5768b525L, 0x206f85b3L, 0xb966d409L, 0xce61e49fL,
-      0x5edef90eL, 0x29d9c998L, 0xb0d09822L, 0xc7d7a8b4L, 0x59b33d17L,
-      0x2eb40d81L, 0xb7bd5c3bL, 0xc0ba6cadL, 0xedb88320L, 0x9abfb3b6L,
-      0x03b6e20cL, 0x74b1d29aL, 0xead54739L, 0x9dd277afL, 0x04db2615L,
-      0x73dc1683L, 0xe3630b12L, 0x94643b84L, 0x0d6d6a3eL, 0x7a6a5aa8L,
-      0xe40ecf0bL, 0x9309ff9dL, 0x0a00ae27L, 0x7d079eb1L, 0xf00f9344L,
-      0x8708a3d2L, 0x1e01f268L, 0x6906c2feL, 0xf762575dL, 0x806567cbL,
-      0x196c3671L, 0x6e6b06e7L, 0xfed41b76L, 0x89d32be0L, 0x10da7a5aL,
-      0x67dd4accL, 0xf9b9df6fL, 0x8ebeeff9L, 0x17b7be43L, 0x60b08ed5L,
-      0xd6d6a3e8L, 0xa1d1937eL, 0x38d8c2c4L, 0x4fdff252L, 0xd1bb67f1L,
-      0xa6bc5767L, 0x3fb506ddL, 0x48b2364bL, 0xd80d2bdaL, 0xaf0a1b4cL,
-      0x36034af6L, 0x41047a60L, 0xdf60efc3L, 0xa867df55L, 0x316e8eefL,
-      0x4669be79L, 0xcb61b38cL, 0xbc66831aL, 0x256fd2a0L, 0x5268e236L,
-      0xcc0c7795L, 0xbb0b4703L, 0x220216b9L, 0x5505262fL, 0xc5ba3bbeL,
-      0xb2bd0b28L, 0x2bb45a92L, 0x5cb36a04L, 0xc2d7ffa7L, 0xb5d0cf31L,
-      0x2cd99e8bL, 0x5bdeae1dL, 0x9b64c2b0L, 0xec63f226L, 0x756aa39cL,
-      0x026d930aL, 0x9c0906a9L, 0xeb0e363fL, 0x72076785L, 0x05005713L,
-      0x95bf4a82L, 0xe2b87a14L, 0x7bb12baeL, 0x0cb61b38L, 0x92d28e9bL,
-      0xe5d5be0dL, 0x7cdcefb7L, 0x0bdbdf21L, 0x86d3d2d4L, 0xf1d4e242L,
-      0x68ddb3f8L, 0x1fda836eL, 0x81be16cdL, 0xf6b9265bL, 0x6fb077e1L,
-      0x18b74777L, 0x88085ae6L, 0xff0f6a70L, 0x66063bcaL, 0x11010b5cL,
-      0x8f659effL, 0xf862ae69L, 0x616bffd3L, 0x166ccf45L, 0xa00ae278L,
-      0xd70dd2eeL, 0x4e048354L, 0x3903b3c2L, 0xa7672661L, 0xd06016f7L,
-      0x4969474dL, 0x3e6e77dbL, 0xaed16a4aL, 0xd9d65adcL, 0x40df0b66L,
-      0x37d83bf0L, 0xa9bcae53L, 0xdebb9ec5L, 0x47b2cf7fL, 0x30b5ffe9L,
-      0xbdbdf21cL, 0xcabac28aL, 0x53b39330L, 0x24b4a3a6L, 0xbad03605L,
-      0xcdd70693L, 0x54de5729L, 0x23d967bfL, 0xb3667a2eL, 0xc4614ab8L,
-      0x5d681b02L, 0x2a6f2b94L, 0xb40bbe37L, 0xc30c8ea1L, 0x5a05df1bL,
-      0x2d02ef8dL
-   };
-
-/* Return a 32-bit CRC of the contents of the buffer. */
-
-unsigned long crc32(const unsigned char *s, unsigned int len)
-{
-  unsigned int i;
-  unsigned long crc32val;
-  
-  crc32val = 0;
-  for (i = 0;  i < len;  i ++)
-    {
-      crc32val =
-	crc32_tab[(crc32val ^ s[i]) & 0xff] ^
-	  (crc32val >> 8);
-    }
-  return crc32val;
+/*
+ * Return an empty hashmap whose keys all come from intern, or NULL on
+ * failure.  Keys are hashed with the hash intern saved and compared
+ * by pointer.
+ */
+map_t hashmap_new_interned() {
+	hashmap_map* m = (hashmap_map*) hashmap_new();
+	if(m) m->interned = 1;
+	return m;
+}
+
+/* Keys are the same string */
+static int hashmap_key_equal(hashmap_map* m, const char* a, const char* b){
+	if(m->interned) return a == b;
+	return strcmp(a, b) == 0;
+}
+
+/* The high and low halves of the 128 bit product */
+static uint64_t hashmap_mix(uint64_t a, uint64_t b){
+	__uint128_t r = (__uint128_t) a * b;
+	return (uint64_t) r ^ (uint64_t) (r >> 64);
 }
 
 /*
- * Hashing function for a string
+ * Hashing function for a string, after wyhash.  Reads 8 bytes at a
+ * time, and a short tail as two overlapping words.
  */
-unsigned int hashmap_hash_int(hashmap_map * m, char* keystring){
-
-    unsigned long key = crc32((unsigned char*)(keystring), strlen(keystring));
+static uint64_t hashmap_hash_string(const char* keystring){
+	const unsigned char* p = (const unsigned char*) keystring;
+	size_t length = strlen(keystring), left = length;
+	uint64_t seed = HASH_P0, a, b;
+	uint32_t x, y;
+
+	for(; left > 16; p += 16, left -= 16){
+		memcpy(&a, p, 8);
+		memcpy(&b, p + 8, 8);
+		seed = hashmap_mix(a ^ HASH_P1, b ^ seed);
+	}
 
-	/* Robert Jenkins' 32 bit Mix Function */
-	key += (key << 12);
-	key ^= (key >> 22);
-	key += (key << 4);
-	key ^= (key >> 9);
-	key += (key << 10);
-	key ^= (key >> 2);
-	key += (key << 7);
-	key ^= (key >> 12);
+	if(left > 8){
+		memcpy(&a, p, 8);
+		memcpy(&b, p + left - 8, 8);
+	}
+	else if(left >= 4){
+		memcpy(&x, p, 4);
+		memcpy(&y, p + left - 4, 4);
+		a = x;
+		b = y;
+	}
+	else if(left > 0){
+		a = ((uint64_t) p[0] << 16) | ((uint64_t) p[left / 2] << 8) | p[left - 1];
+		b = 0;
+	}
+	else{
+		a = b = 0;
+	}
 
-	/* Knuth's Multiplicative Method */
-	key = (key >> 3) * 2654435761;
+	return hashmap_mix(HASH_P1 ^ length, hashmap_mix(a ^ HASH_P1, b ^ seed));
+}
 
-	return key % m->table_size;
+/* The hash of a key in this map */
+static uint64_t hashmap_hash(hashmap_map* m, const char* key){
+	if(m->interned)
+		return hashmap_mix(intern_hash(key) ^ HASH_P0, HASH_P1);
+	return hashmap_hash_string(key);
 }
 
 /*
- * Return the integer of the location in data
- * to store the point to the item, or MAP_FULL.
+ * Bit i of the result is set when control byte i of the group at ctrl
+ * is c.  With SSE2 that is one compare for the whole group.
  */
-int hashmap_hash(map_t in, char* key){
-	int curr;
+static unsigned int hashmap_group_match(const signed char* ctrl, signed char c){
+#ifdef __SSE2__
+	__m128i group = _mm_loadu_si128((const __m128i*) ctrl);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(c)));
+#else
+	unsigned int mask = 0;
 	int i;
+	for(i = 0; i < GROUP_SIZE; i++)
+		if(ctrl[i] == c) mask |= 1u << i;
+	return mask;
+#endif
+}
 
-	/* Cast the hashmap */
-	hashmap_map* m = (hashmap_map *) in;
-
-	/* If full, return immediately */
-	if(m->size >= (m->table_size/2)) return MAP_FULL;
-
-	/* Find the best index */
-	curr = hashmap_hash_int(m, key);
+/* Same, for the slots that are EMPTY or DELETED */
+static unsigned int hashmap_group_free(const signed char* ctrl){
+#ifdef __SSE2__
+	return _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) ctrl));
+#else
+	unsigned int mask = 0;
+	int i;
+	for(i = 0; i < GROUP_SIZE; i++)
+		if(ctrl[i] < 0) mask |= 1u << i;
+	return mask;
+#endif
+}
 
-	/* Linear probing */
-	for(i = 0; i< MAX_CHAIN_LENGTH; i++){
-		if(m->data[curr].in_use == 0)
-			return curr;
+/*
+ * Groups are probed starting from the one the hash picks, stepping
+ * 1, 2, 3... groups further each time, which visits every group once
+ * because the number of groups is a power of two.
+ */
+#define FIRST_GROUP(m, hash) ((size_t) ((hash) >> 7) & ((m)->table_size / GROUP_SIZE - 1))
+#define NEXT_GROUP(m, group, step) (((group) + (step)) & ((m)->table_size / GROUP_SIZE - 1))
+#define H2(hash) ((signed char) ((hash) & 0x7f))
 
-		if(m->data[curr].in_use == 1 && (strcmp(m->data[curr].key,key)==0))
-			return curr;
+/*
+ * Return the slot holding key, or -1.
+ */
+static long hashmap_find(hashmap_map* m, const char* key, uint64_t hash){
+	size_t group = FIRST_GROUP(m, hash), step = 0;
+
+	for(;;){
+		const signed char* ctrl = m->ctrl + group * GROUP_SIZE;
+		unsigned int match = hashmap_group_match(ctrl, H2(hash));
+
+		while(match){
+			size_t index = group * GROUP_SIZE + __builtin_ctz(match);
+			if(m->data[index].hash == hash && hashmap_key_equal(m, m->data[index].key, key))
+				return index;
+			match &= match - 1;
+		}
 
-		curr = (curr + 1) % m->table_size;
+		/* The key would have gone in this group's EMPTY slot */
+		if(hashmap_group_match(ctrl, CTRL_EMPTY))
+			return -1;
+		group = NEXT_GROUP(m, group, ++step);
 	}
+}
 
-	return MAP_FULL;
+/*
+ * Return the first EMPTY or DELETED slot on the probe for hash.
+ */
+static size_t hashmap_find_free(hashmap_map* m, uint64_t hash){
+	size_t group = FIRST_GROUP(m, hash), step = 0;
+
+	for(;;){
+		unsigned int match = hashmap_group_free(m->ctrl + group * GROUP_SIZE);
+		if(match)
+			return group * GROUP_SIZE + __builtin_ctz(match);
+		group = NEXT_GROUP(m, group, ++step);
+	}
 }
 
 /*
- * Doubles the size of the hashmap, and rehashes all the elements
+ * Moves every element into new slots, dropping the DELETED ones.  The
+ * table doubles when more than half of it would be in use, otherwise
+ * it keeps its size and only the DELETED slots are won back.
  */
-int hashmap_rehash(map_t in){
-	int i;
-	int old_size;
-	hashmap_element* curr;
-
-	/* Setup the new elements */
-	hashmap_map *m = (hashmap_map *) in;
-	hashmap_element* temp = (hashmap_element *)
-		calloc(2 * m->table_size, sizeof(hashmap_element));
-	if(!temp) return MAP_OMEM;
-
-	/* Update the array */
-	curr = m->data;
-	m->data = temp;
-
-	/* Update the size */
-	old_size = m->table_size;
-	m->table_size = 2 * m->table_size;
-	m->size = 0;
+static int hashmap_rehash(hashmap_map* m){
+	size_t i, old_size = m->table_size, table_size = old_size;
+	signed char* old_ctrl = m->ctrl;
+	hashmap_element* old_data = m->data;
+
+	if(2 * (m->size + 1) > hashmap_capacity(old_size))
+		table_size = 2 * old_size;
+	if(hashmap_alloc(m, table_size) != MAP_OK){
+		m->ctrl = old_ctrl;
+		m->data = old_data;
+		return MAP_OMEM;
+	}
 
-	/* Rehash the elements */
 	for(i = 0; i < old_size; i++){
-        int status;
-
-        if (curr[i].in_use == 0)
-            continue;
-            
-		status = hashmap_put(m, curr[i].key, curr[i].data);
-		if (status != MAP_OK)
-			return status;
-	}
+		size_t index;
 
-	free(curr);
+		if(old_ctrl[i] < 0)
+			continue;
+		index = hashmap_find_free(m, old_data[i].hash);
+		m->ctrl[index] = old_ctrl[i];
+		m->data[index] = old_data[i];
+	}
+	m->growth_left -= m->size;
 
+	free(old_data);
 	return MAP_OK;
 }
 
 /*
- * Add a pointer to the hashmap with some key
+ * Add a pointer to the hashmap with some key, or replace the pointer
+ * the key already has
  */
-int hashmap_put(map_t in, char* key, any_t value){
-	int index;
-	hashmap_map* m;
+int hashmap_put(map_t in, const char* key, any_t value){
+	hashmap_map* m = (hashmap_map *) in;
+	uint64_t hash = hashmap_hash(m, key);
+	long found = hashmap_find(m, key, hash);
+	size_t index;
 
-	/* Cast the hashmap */
-	m = (hashmap_map *) in;
+	if(found >= 0){
+		m->data[found].data = value;
+		return MAP_OK;
+	}
 
-	/* Find a place to put our value */
-	index = hashmap_hash(in, key);
-	while(index == MAP_FULL){
-		if (hashmap_rehash(in) == MAP_OMEM) {
+	/* Reusing a DELETED slot never needs room */
+	index = hashmap_find_free(m, hash);
+	if(m->growth_left == 0 && m->ctrl[index] == CTRL_EMPTY){
+		if(hashmap_rehash(m) != MAP_OK)
 			return MAP_OMEM;
-		}
-		index = hashmap_hash(in, key);
+		index = hashmap_find_free(m, hash);
 	}
 
-	/* Set the data */
-	m->data[index].data = value;
+	if(m->ctrl[index] == CTRL_EMPTY)
+		m->growth_left--;
+	m->ctrl[index] = H2(hash);
 	m->data[index].key = key;
-	m->data[index].in_use = 1;
-	m->size++; 
+	m->data[index].data = value;
+	m->data[index].hash = hash;
+	m->size++;
 
 	return MAP_OK;
 }
@@ -286,34 +303,53 @@ int hashmap_put(map_t in, char* key, any_t value){
 /*
  * Get your pointer out of the hashmap with a key
  */
-int hashmap_get(map_t in, char* key, any_t *arg){
-	int curr;
-	int i;
-	hashmap_map* m;
-
-	/* Cast the hashmap */
-	m = (hashmap_map *) in;
+int hashmap_get(map_t in, const char* key, any_t *arg){
+	hashmap_map* m = (hashmap_map *) in;
+	long found = hashmap_find(m, key, hashmap_hash(m, key));
 
-	/* Find data location */
-	curr = hashmap_hash_int(m, key);
+	if(found < 0){
+		*arg = NULL;
+		return MAP_MISSING;
+	}
 
-	/* Linear probing, if necessary */
-	for(i = 0; i<MAX_CHAIN_LENGTH; i++){
+	*arg = m->data[found].data;
+	return MAP_OK;
+}
 
-        int in_use = m->data[curr].in_use;
-        if (in_use == 1){
-            if (strcmp(m->data[curr].key,key)==0){
-                *arg = (m->data[curr].data);
-                return MAP_OK;
-            }
-		}
+/*
+ * Empties a slot.  A probe only goes past a group with no EMPTY slot,
+ * so when this group has one the slot can be EMPTY again; otherwise
+ * it is marked DELETED so probes keep going through it.
+ */
+static void hashmap_erase(hashmap_map* m, size_t index){
+	const signed char* ctrl = m->ctrl + index / GROUP_SIZE * GROUP_SIZE;
 
-		curr = (curr + 1) % m->table_size;
+	if(hashmap_group_match(ctrl, CTRL_EMPTY)){
+		m->ctrl[index] = CTRL_EMPTY;
+		m->growth_left++;
+	}
+	else{
+		m->ctrl[index] = CTRL_DELETED;
 	}
+	m->size--;
+}
 
-	*arg = NULL;
+/*
+ * Get any element, and remove it if remove is set
+ */
+int hashmap_get_one(map_t in, any_t *arg, int remove){
+	hashmap_map* m = (hashmap_map *) in;
+	size_t i;
+
+	for(i = 0; i < m->table_size; i++)
+		if(m->ctrl[i] >= 0){
+			*arg = m->data[i].data;
+			if(remove)
+				hashmap_erase(m, i);
+			return MAP_OK;
+		}
 
-	/* Not found */
+	*arg = NULL;
 	return MAP_MISSING;
 }
 
@@ -323,20 +359,18 @@ int hashmap_get(map_t in, char* key, any_t *arg){
  * argument and the hashmap element is the second.
  */
 int hashmap_iterate(map_t in, PFany f, any_t item) {
-	int i;
+	size_t i;
 
 	/* Cast the hashmap */
 	hashmap_map* m = (hashmap_map*) in;
 
 	/* On empty hashmap, return immediately */
 	if (hashmap_length(m) <= 0)
-		return MAP_MISSING;	
+		return MAP_MISSING;
 
-	/* Linear probing */
-	for(i = 0; i< m->table_size; i++)
-		if(m->data[i].in_use != 0) {
-			any_t data = (any_t) (m->data[i].data);
-			int status = f(item, data);
+	for(i = 0; i < m->table_size; i++)
+		if(m->ctrl[i] >= 0) {
+			int status = f(item, m->data[i].data);
 			if (status != MAP_OK) {
 				return status;
 			}
@@ -348,38 +382,15 @@ int hashmap_iterate(map_t in, PFany f, any_t item) {
 /*
  * Remove an element with that key from the map
  */
-int hashmap_remove(map_t in, char* key){
-	int i;
-	int curr;
-	hashmap_map* m;
+int hashmap_remove(map_t in, const char* key){
+	hashmap_map* m = (hashmap_map *) in;
+	long found = hashmap_find(m, key, hashmap_hash(m, key));
 
-	/* Cast the hashmap */
-	m = (hashmap_map *) in;
-
-	/* Find key */
-	curr = hashmap_hash_int(m, key);
-
-	/* Linear probing, if necessary */
-	for(i = 0; i<MAX_CHAIN_LENGTH; i++){
-
-        int in_use = m->data[curr].in_use;
-        if (in_use == 1){
-            if (strcmp(m->data[curr].key,key)==0){
-                /* Blank out the fields */
-                m->data[curr].in_use = 0;
-                m->data[curr].data = NULL;
-                m->data[curr].key = NULL;
-
-                /* Reduce the size */
-                m->size--;
-                return MAP_OK;
-            }
-		}
-		curr = (curr + 1) % m->table_size;
-	}
+	if(found < 0)
+		return MAP_MISSING;
 
-	/* Data not found */
-	return MAP_MISSING;
+	hashmap_erase(m, found);
+	return MAP_OK;
 }
 
 /* Deallocate the hashmap */
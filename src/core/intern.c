@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "../../includes/arena.h"
+#include "../../includes/intern.h"
+
+//the table starts with room for this many names and doubles at 3/4 full
+#define INITIAL_SLOTS   1024
+
+/*
+ * an interned name. the pointer handed out is to text, so the hash
+ * and length sit just in front of the characters
+ */
+typedef struct interned
+{
+    unsigned hash;
+    unsigned length;
+    char text[];
+} interned_t;
+
+#define HEADER(name)    ((interned_t*)((name) - offsetof(interned_t, text)))
+
+//the names themselves, they never move
+static arena_t names;
+
+//every name, in the order they were first seen
+static interned_t **by_id;
+static unsigned num_names;
+static unsigned max_names;
+
+/*
+ * open addressing table of the names, linear probing. a slot holds the
+ * hash and one past the id of its name, so probing and growing only
+ * touch the table, never the names
+ */
+typedef struct slot
+{
+    unsigned hash;
+    unsigned id;
+} slot_t;
+
+static slot_t *slots;
+static unsigned num_slots;
+
+//32 bit FNV-1a, then mixed
+static unsigned hash_text(const char *text, size_t length)
+{
+    unsigned hash = 2166136261u;
+    size_t i;
+
+    for(i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)text[i];
+        hash *= 16777619u;
+    }
+    //murmur3's finish, FNV leaves near names in near buckets
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+static void grow_table(void)
+{
+    slot_t *old = slots;
+    unsigned old_slots = num_slots, i, j;
+
+    num_slots = num_slots ? 2 * num_slots : INITIAL_SLOTS;
+    slots = calloc(num_slots, sizeof(slot_t));
+    if(slots == NULL)
+    {
+        fprintf(stderr, "failed to allocate memory for interned names\n");
+        exit(-1);
+    }
+
+    for(i = 0; i < old_slots; i++)
+    {
+        if(old[i].id == 0)
+            continue;
+        for(j = old[i].hash & (num_slots - 1); slots[j].id; j = (j + 1) & (num_slots - 1));
+        slots[j] = old[i];
+    }
+    free(old);
+}
+
+const char *intern_n(const char *text, size_t length)
+{
+    unsigned hash = hash_text(text, length), i;
+    interned_t *name;
+
+    if(4 * (num_names + 1) > 3 * num_slots)
+        grow_table();
+
+    for(i = hash & (num_slots - 1); slots[i].id; i = (i + 1) & (num_slots - 1))
+    {
+        if(slots[i].hash != hash)
+            continue;
+        name = by_id[slots[i].id - 1];
+        if(name->length == length && !memcmp(name->text, text, length))
+            return name->text;
+    }
+
+    if(num_names == max_names)
+    {
+        max_names = max_names ? 2 * max_names : INITIAL_SLOTS;
+        by_id = realloc(by_id, max_names * sizeof(interned_t*));
+        if(by_id == NULL)
+        {
+            fprintf(stderr, "failed to allocate memory for interned names\n");
+            exit(-1);
+        }
+    }
+
+    name = arena_alloc(&names, sizeof(interned_t) + length + 1);
+    name->hash = hash;
+    name->length = length;
+    memcpy(name->text, text, length);
+    name->text[length] = '\0';
+    by_id[num_names++] = name;
+    slots[i].hash = hash;
+    slots[i].id = num_names;
+    return name->text;
+}
+
+const char *intern(const char *text)
+{
+    return intern_n(text, strlen(text));
+}
+
+unsigned intern_hash(const char *name)
+{
+    return HEADER(name)->hash;
+}
+
+void intern_free(void)
+{
+    arena_reset(&names);
+    free(slots);
+    free(by_id);
+    slots = NULL;
+    by_id = NULL;
+    num_slots = 0;
+    num_names = 0;
+    max_names = 0;
+}
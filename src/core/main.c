@@ -5,18 +5,20 @@
 #include "../../includes/lexer.h"
 #include "../../includes/parser.h"
 #include "../../includes/intermediate_generator.h"
+#include "../../includes/intern.h"
 
 //characters needed ofr on the parse args function
 #define LEXER           'l'
 #define PARSER          'p'
 #define TYPE            't'
 #define INTERMEDIATE    'i'
+#define BINARY          'b'
 #define COMPILE         'c'
 #define OPTION_FLAG     '-'
 
 static int parse_args(int argc, char** argv);
 
-static void free_memory(lexer_state_t *lexer, ast_node_t *parse_trees);
+static void free_memory(lexer_state_t *lexer, flat_tree_t *parse_trees);
 
 //source files that need to be 'compiled'
 static char** file_list;
@@ -33,7 +35,7 @@ int main(int argc, char** argv)
 {
     int result;
     lexer_state_t *lexer = NULL;
-    ast_node_t *parse_trees;
+    flat_tree_t *parse_trees = NULL;
 
     //temp to meet assigment 1 specs
     program_options = program_options | INTERMEDIATE_OUTPUT;
@@ -91,7 +93,7 @@ int main(int argc, char** argv)
     return 0;
 }
 
-void free_memory(lexer_state_t *lexer, ast_node_t *parse_trees)
+void free_memory(lexer_state_t *lexer, flat_tree_t *parse_trees)
 {
     int i;
 
@@ -109,12 +111,13 @@ void free_memory(lexer_state_t *lexer, ast_node_t *parse_trees)
     {   
         for(i = 0; i < files; i++)
         {
-            free_tree_memory(parse_trees[i]);
+            free_flat_tree(parse_trees + i);
         }
         free(parse_trees);
     }
     //clean up after file list
     free(file_list);
+    intern_free();
 }
 
 static int parse_args(int argc, char** argv)
@@ -133,6 +136,9 @@ static int parse_args(int argc, char** argv)
             cur = argv[i][1];
             switch(cur)
             {
+                case BINARY:
+                    //same as compile, written as a .irb file
+                    program_options = program_options | BINARY_OUTPUT;
                 case COMPILE:
                     program_options = program_options | COMPILE_OPTION;
                 case INTERMEDIATE:
@@ -160,11 +166,12 @@ static int parse_args(int argc, char** argv)
                     {
                         fprintf(
                             stderr, 
-                            "only one of %c %c %c %c %c can be selected\n", 
+                            "only one of %c %c %c %c %c %c can be selected\n", 
                             LEXER, 
                             PARSER, 
                             TYPE, 
                             INTERMEDIATE, 
+                            BINARY, 
                             COMPILE
                         );
                         return -1;
@@ -177,11 +184,12 @@ static int parse_args(int argc, char** argv)
                     {
                         fprintf(
                             stderr, 
-                            "only one of %c %c %c %c %c can be selected\n", 
+                            "only one of %c %c %c %c %c %c can be selected\n", 
                             LEXER, 
                             PARSER, 
                             TYPE, 
                             INTERMEDIATE, 
+                            BINARY, 
                             COMPILE
                         );
                         return -1;
@@ -226,11 +234,12 @@ static int parse_args(int argc, char** argv)
             {
                 fprintf(
                     stderr, 
-                    "must select a run option first: %c, %c, %c, %c, %c\n",
+                    "must select a run option first: %c, %c, %c, %c, %c, %c\n",
                     LEXER, 
                     PARSER, 
                     TYPE, 
                     INTERMEDIATE, 
+                    BINARY, 
                     COMPILE
                 );
                 return -1;
@@ -244,11 +253,12 @@ static int parse_args(int argc, char** argv)
     {
         fprintf(
             stderr, 
-            "must select a run option first: %c, %c, %c, %c, %c\n",
+            "must select a run option first: %c, %c, %c, %c, %c, %c\n",
             LEXER, 
             PARSER, 
             TYPE, 
             INTERMEDIATE, 
+            BINARY, 
             COMPILE
         );
         return -1;
@@ -8,6 +8,7 @@
 #include "../../includes/types.h"
 #include "../../includes/main.h"
 #include "../../includes/lexer.h"
+#include "../../includes/intern.h"
 
 #define SIZE_OF_FILE_ARRAY      100
 #define FILE_STACK_SIZE         32
@@ -74,6 +75,17 @@ static int fill_state(lexer_state_t *state, char *file);
  */
 static int clean_def_map(void *nothing, void *map);
 
+/**
+ *  frees the value of a lexeme. identifiers and string constants are
+ *  interned and types are constants, so theirs are left alone
+ */
+static void free_lexeme_value(lexeme_t *lexeme);
+
+/**
+ *  returns the constant spelling of the type name in yytext
+ */
+static const char *type_name(void);
+
 lexer_state_t *lexical_analysis(int num_files, char** files)
 {
     lexer_state_t *state;
@@ -112,7 +124,8 @@ lexer_state_t *lexical_analysis(int num_files, char** files)
         }
         state[i].stack_size = FILE_STACK_SIZE;
         state[i].number_of_files = 0;
-        state[i].def_map = hashmap_new();
+        //keyed by interned names
+        state[i].def_map = hashmap_new_interned();
 
         fill_state(state + i, files[i]);
         
@@ -148,8 +161,9 @@ void set_lval(int token)
             else
                 yylval.v.i = STATIC;
             break;
+        //names and string constants are interned so maps can compare them by pointer
         case IDENT:
-            yylval.v.s = strdup(yytext);
+            yylval.v.s = (char*)intern(yytext);
             break;
         case INTCONST:
             yylval.v.i = atoi(yytext);
@@ -162,7 +176,7 @@ void set_lval(int token)
             break;
         case STRCONST:
             size = strlen(yytext);
-            yylval.v.s = strndup(yytext + 1, size-2);
+            yylval.v.s = (char*)intern_n(yytext + 1, size-2);
             break;
         case CHARCONST:
             yylval.v.c = *(yytext + 1);
@@ -231,7 +245,7 @@ static int fill_state(lexer_state_t *state, char *file)
 static int add_definition(lexer_state_t *state)
 {
     int token, i, j, size;
-    char *dup;
+    const char *name;
     lexeme_t *list, *temp;
     def_map_t *map;
 
@@ -243,14 +257,7 @@ static int add_definition(lexer_state_t *state)
             token = yylex();
         return -2;
     }
-    //adding two because i keep getting invalid writes from valgrind when i don't
-    dup = (char*) calloc(1, strlen(yytext)+2);
-    if(!dup)
-    {
-        fprintf(stderr, "failed to allocate memory");
-        return -1;
-    }
-    dup = strcpy(dup, yytext);
+    name = yylval.v.s;
     size = DEFINE_LIST_SIZE;
     list = (lexeme_t*) malloc(sizeof(lexeme_t) * size);
     if(!list)
@@ -297,15 +304,13 @@ static int add_definition(lexer_state_t *state)
         }
         token = yylex();
     }
-    if(hashmap_get(state->def_map, dup, (void**)&map) == MAP_OK)
+    if(hashmap_get(state->def_map, name, (void**)&map) == MAP_OK)
     {
         for(j = 0; j < map->size; j++)
         {
-            if(map->list[j].value)
-                free(map->list[j].value);
+            free_lexeme_value(map->list + j);
         }
         free(map->list);
-        free(dup);
         map->list = list;
         map->size = i;
         return 0;
@@ -315,13 +320,12 @@ static int add_definition(lexer_state_t *state)
     {
         fprintf(stderr, "failed to allocate memory\n");
         free(list);
-        free(dup);
         return -1;
     }
     map->list = list;
-    map->key = dup;
+    map->key = name;
     map->size = i;
-    hashmap_put(state->def_map, dup, map);
+    hashmap_put(state->def_map, name, map);
     return 0;
 }
 
@@ -338,7 +342,8 @@ static int handle_ifdef(lexer_state_t *state, int ndef, char* file)
         return -1;
     }
 
-    hashmap_get(state->def_map, yytext, (void**)&map);
+    map = NULL;
+    hashmap_get(state->def_map, yylval.v.s, (void**)&map);
 
     boolean = ndef && map==NULL;
     while(1)
@@ -356,7 +361,7 @@ static int handle_ifdef(lexer_state_t *state, int ndef, char* file)
                 fprintf(stderr, "expexted identified but got %s, at %d in %s\n", yytext, yyline, file);
                 continue;
             }
-            boolean = hashmap_get(state->def_map, yytext, (void**)&map) == MAP_OK;
+            boolean = hashmap_get(state->def_map, yylval.v.s, (void**)&map) == MAP_OK;
         }
         else if(boolean)
         {
@@ -384,13 +389,7 @@ static int process_token(lexer_state_t *state, lexeme_t *token)
     switch(token->token)
     {
         case STRCONST:
-            dup = (char*) malloc(sizeof(char)*strlen(yytext)+1);
-            if(!dup)
-            {
-                fprintf(stderr, "failed to allocate memory\n");
-            }
-            strcpy(dup, yytext);
-            token->value = dup;
+            token->value = (void*)intern(yytext);
             break;
         case INTCONST:
             token->value = (void*) malloc(sizeof(int));
@@ -486,14 +485,12 @@ static int process_token(lexer_state_t *state, lexeme_t *token)
                 fprintf(stderr, "expected identifier got %s in %s:%d", yytext, state->cur_file, yyline);
                 return -1;
             }
-            if(hashmap_get(state->def_map, yytext, (void**)&map) == MAP_OK)
+            if(hashmap_get(state->def_map, yylval.v.s, (void**)&map) == MAP_OK)
             {
-                hashmap_remove(state->def_map, yytext);
-                free(map->key);
+                hashmap_remove(state->def_map, map->key);
                 for(i = 0; i < map->size; i ++)
                 {
-                    if(map->list[i].value)
-                        free(map->list[i].value);
+                    free_lexeme_value(map->list + i);
                 }
                 free(map->list);
             }
@@ -514,19 +511,18 @@ static int process_token(lexer_state_t *state, lexeme_t *token)
             fprintf(stderr, "#else found with no related #ifdef or #ifndef, %s:%d\n", state->cur_file, yyline);
             return -1;
         case TYPE:
-            token->value = malloc(5);
-            strcpy(token->value, yytext);
+            token->value = (void*)type_name();
             break;
         case NEWLINE:
             return -1;
         case IDENT:
-            if(token->filename != NULL && hashmap_get(state->def_map, yytext, (void**)&map) == MAP_OK)
+            //set_lval interned it when yylex matched it
+            token->value = (void*)yylval.v.s;
+            if(token->filename != NULL && hashmap_get(state->def_map, token->value, (void**)&map) == MAP_OK)
             {
                 resolve_ident(state, map, token->filename);
                 return -1;
             }
-            token->value = malloc(strlen(yytext)+1);
-            strcpy(token->value, yytext);
             break;
     }
     //if filename is null then this is a token for a definition and should not be printed
@@ -572,13 +568,41 @@ static int add_lexeme(lexer_state_t *state, lexeme_t lexeme)
     } 
     else
     {
-        if(lexeme.value)
-            free(lexeme.value);
+        free_lexeme_value(&lexeme);
     }
 
     return 0;
 }
 
+static const char *type_name(void)
+{
+    switch(*yytext)
+    {
+        case 'c':
+            return "char";
+        case 'f':
+            return "float";
+        case 'v':
+            return "void";
+        default:
+            return "int";
+    }
+}
+
+static void free_lexeme_value(lexeme_t *lexeme)
+{
+    switch(lexeme->token)
+    {
+        case IDENT:
+        case TYPE:
+        case STRCONST:
+            break;
+        default:
+            if(lexeme->value)
+                free(lexeme->value);
+    }
+}
+
 static char *add_file(const char* file, lexer_state_t *state)
 {
     char **temp;
@@ -628,8 +652,7 @@ void clean_lexer(lexer_state_t *state)
         next = cur->next;
         while(cur)
         {
-            if(cur->value)
-                free(cur->value);
+            free_lexeme_value(cur);
             next = cur->next;
             free(cur);
             cur = next;
@@ -646,13 +669,10 @@ static int clean_def_map(void *nothing, void *map)
     def_map_t *def_map;
 
     def_map = (def_map_t*) map;
-    
-    free(def_map->key);
 
     for(i = 0; i < def_map->size; i++)
     {
-        if(def_map->list[i].value)
-            free(def_map->list[i].value);
+        free_lexeme_value(def_map->list + i);
     }
 
     free(def_map->list);
@@ -710,8 +730,7 @@ static void resolve_ident(lexer_state_t *state, def_map_t *map, char* filename)
                 }
                 break;
             case STRCONST:
-                cur.value = malloc(strlen((char*)map->list[i].value));
-                strcpy((char*)cur.value, (char*)map->list[i].value);
+                cur.value = map->list[i].value;
                 if(program_options & LEXER_DEBUG_OPTION && filename != NULL) 
                 {
                     tok_to_str(token_name, cur.token);
@@ -732,8 +751,7 @@ static void resolve_ident(lexer_state_t *state, def_map_t *map, char* filename)
                 }
                 break;
             case TYPE:
-                cur.value = malloc(5);
-                strcpy(cur.value, map->list[i].value);
+                cur.value = map->list[i].value;
                 if(program_options & LEXER_DEBUG_OPTION && filename != NULL) 
                 {
                     tok_to_str(token_name, cur.token);
@@ -802,10 +820,9 @@ static void resolve_ident(lexer_state_t *state, def_map_t *map, char* filename)
                     resolve_ident(state, nest, filename);
                     continue;
                 }
+                cur.value = map->list[i].value;
                 if(program_options & LEXER_DEBUG_OPTION && filename != NULL) 
                 {
-                    cur.value = malloc(strlen((char*)map->list[i].value));
-                    strcpy(cur.value, map->list[i].value);
                     tok_to_str(token_name, cur.token);
                     printf("File %s Line %d Token %s Text '%s'\n", filename, cur.line_number, token_name, (char*)cur.value);
                 }
@@ -2,7 +2,6 @@
 {
 
 #include "../../includes/parser.h"
-extern ast_node_t yyast;
 
 }
 
@@ -12,7 +11,6 @@ extern ast_node_t yyast;
 #include "../../includes/parser.h"
 #include "../../includes/types.h"
 
-ast_node_t yyast;
 ast_value_t yyempty_value;
 extern char* parse_file_string;
 %}
@@ -58,9 +56,9 @@ extern char* parse_file_string;
 %%
 
 program: program_statement 
-        { add_ast_children(&yyast, $1, 1); }
+        { add_flat_declaration($1); }
     | program program_statement 
-        { add_ast_children(&yyast, $2, 1); }
+        { add_flat_declaration($2); }
     ;
 
 program_statement: variable
@@ -74,13 +72,13 @@ program_statement: variable
 variables: 
     { $$ = new_ast_node(VARIABLE_LIST, 0, 0, NULL, yyempty_value, 0); }
     | variable_list
-    { $$ = invert_list($1); process_declaration($1, 1); }
+    { $$ = $1; process_declaration($1, 1); }
 
 variable_list: variable
             { $$ = new_ast_node(VARIABLE_LIST, 0, 1, $1, yyempty_value, 0); } 
-        | variable variable_list
-            { $$ = $2;
-              add_ast_children($$, $1, 1);
+        | variable_list variable
+            { $$ = $1;
+              add_ast_children($$, $2, 1);
             }
 
 variable: SCOPE TYPE identifiers ';'
@@ -108,13 +106,13 @@ function_sig: func_type_name '(' params ')'
 params: 
         { $$ = new_ast_node(PARAM_LIST, 0, 0, NULL, yyempty_value, 0); }
     | param_list
-        { $$ = invert_list($1); } 
+        { $$ = $1; } 
 
 param_list: type_name
         { $$ = new_ast_node(PARAM_LIST, 0, 1, $1, yyempty_value, 0); }
-    | type_name ',' param_list %prec COMMA_FAKE
-        { $$ = $3;
-          add_ast_children($$, $1, 1);
+    | param_list ',' type_name %prec COMMA_FAKE
+        { $$ = $1;
+          add_ast_children($$, $3, 1);
         }
     ;
 
@@ -141,14 +139,14 @@ statement_block: '{' statements '}'
 statements:
     { $$ = new_ast_node(STATEMENT_BLOCK, 0, 0, NULL, yyempty_value, 0); }
     | statement_list
-    { $$ = invert_list($1); }
+    { $$ = $1; }
 
 
 statement_list: statement
         { $$ = new_ast_node(STATEMENT_BLOCK, 0, 1, $1, yyempty_value, 0); } 
-    | statement statement_list
-        { $$ = $2;
-          add_ast_children($$, $1, 1);
+    | statement_list statement
+        { $$ = $1;
+          add_ast_children($$, $2, 1);
         }
     ;
 
@@ -180,9 +178,9 @@ statement: ';'
 
 expressions: expression
         { $$ = new_ast_node(EXPRESSION_LIST, 0, 1, $1, yyempty_value, 0); } 
-    | expression ',' expressions %prec ','
-        { $$ = $3;
-          add_ast_children($$, $1, 1);
+    | expressions ',' expression %prec ','
+        { $$ = $1;
+          add_ast_children($$, $3, 1);
         } 
     ;
 
@@ -197,7 +195,7 @@ expression: constant
     | l_value
         { $$ = $1; }
     | IDENT '(' expressions ')'
-        { $$ = new_ast_node(FUNCTION_CALL, find_type($1.s), 1, invert_list($3), $1, 0); 
+        { $$ = new_ast_node(FUNCTION_CALL, find_type($1.s), 1, $3, $1, 0); 
             check_function_params($$);  
         }
     | IDENT '(' ')'
@@ -337,9 +335,11 @@ constant: INTCONST
     ;
 
 identifiers: identifier
-        { $$ = $1; } 
-    | identifier ',' identifiers
-        { add_ast_children($1, $3, 1); $$ = $1; }
+        { $$ = new_ast_node(VARIABLE, 0, 1, $1, yyempty_value, 0); } 
+    | identifiers ',' identifier
+        { $$ = $1;
+          add_ast_children($$, $3, 1);
+        }
     ;
 
 identifier:  IDENT
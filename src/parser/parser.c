@@ -13,27 +13,47 @@
 //have to have this for the yyerror function to print the file
 char* parse_file_string;
 
+arena_t *ast_arena;
+
+/*
+ * node arrays the parser is done with, by the log 2 of how many nodes
+ * they hold. the grammar copies nodes into their parents children, so
+ * reusing the copied from blocks keeps the arena about the size of the tree
+ */
+static ast_node_t *spare_nodes[32];
+
 /*
  * this function takes a main program node and then
  * searches through its children in the ast to print
  * the information required for this assignment
  */
-static void print_parser_output(ast_node_t node);
+static void print_parser_output(const flat_tree_t *tree);
 
-static void free_memory(ast_node_t node, int depth, void *arg);
+/*
+ * the flat tree of the file being parsed and how many nodes its arrays
+ * have room for. it starts as a lone PROGRAM node and each external
+ * declaration is appended as soon as it is reduced
+ */
+static flat_tree_t *unit;
+static unsigned unit_capacity;
+
+static void begin_flat_tree(flat_tree_t *tree);
+
+static void end_flat_tree(void);
 
 void yyerror(const char *error)
 {
     fprintf(stderr, "Syntax error in %s, line %d:\n\t%s\n", parse_file_string, yyline, error);
 }
 
-ast_node_t *parse_input(int num_files, char **files)
+flat_tree_t *parse_input(int num_files, char **files)
 {
     FILE *file;
     int i;
-    ast_node_t *units;
+    flat_tree_t *units;
+    arena_t nodes;
 
-    units = calloc(num_files, sizeof(ast_node_t));
+    units = calloc(num_files, sizeof(flat_tree_t));
 
     i = init_symbol_table();
 
@@ -49,8 +69,6 @@ ast_node_t *parse_input(int num_files, char **files)
         return NULL;
     }
     
-    yyast.token = PROGRAM;
-
     for(i = 0; i < num_files; i++)
     {
         file = fopen(files[i], "r");
@@ -59,22 +77,38 @@ ast_node_t *parse_input(int num_files, char **files)
         if(!file)
         {
             fprintf(stderr, "Error opening file %s:\n %s\n", files[i], strerror(errno));
+            //an empty program stands in for the file
+            begin_flat_tree(units + i);
+            end_flat_tree();
             continue;
         }
 
         yyline = 1;
+
+        memset(&nodes, 0, sizeof(nodes));
+        ast_arena = &nodes;
+        memset(spare_nodes, 0, sizeof(spare_nodes));
+        begin_flat_tree(units + i);
         
         yyrestart(file);
         yyparse();
         fclose(file);
         yypop_buffer_state();
-        units[i] = yyast;
-        yyast.num_children = 0;
-        yyast.children = NULL;
+        if( program_options & PARSER_DEBUG_OPTION )
+        {
+            printf("parse tree of %s: %zu allocations, %zu bytes\n", 
+                files[i], nodes.allocations, nodes.bytes
+            );
+        }
+
+        end_flat_tree();
+        arena_reset(&nodes);
+        ast_arena = NULL;
+
         if( program_options & PARSER_TREE_OPTION )
-            preorder_traversal(units[i], 1, &print_node, NULL);
+            preorder_traversal(units + i, 0, 1, &print_node, NULL);
         if( program_options & PARSER_OUTPUT_OPTION )
-            print_parser_output(units[i]);
+            print_parser_output(units + i);
     }
     
     //don't continue if type errors exist
@@ -82,7 +116,7 @@ ast_node_t *parse_input(int num_files, char **files)
     {
         for(i = 0; i < num_files; i++)
         {
-            free_tree_memory(units[i]);
+            free_flat_tree(units + i);
         }
         free(units);
         return NULL;
@@ -91,6 +125,170 @@ ast_node_t *parse_input(int num_files, char **files)
     return units;
 }
 
+void free_flat_tree(flat_tree_t *tree)
+{
+    free(tree->nodes);
+    free(tree->line_numbers);
+    free(tree->array_sizes);
+    memset(tree, 0, sizeof(flat_tree_t));
+}
+
+//children arrays are allocated with room for the next power of 2
+static int child_capacity(int num_children)
+{
+    int capacity = 1;
+
+    if(num_children == 0)
+        return 0;
+    while(capacity < num_children)
+        capacity *= 2;
+    return capacity;
+}
+
+static int capacity_class(int capacity)
+{
+    int class = 0;
+
+    while((1 << class) < capacity)
+        class++;
+    return class;
+}
+
+//capacity must be a power of 2
+static ast_node_t *alloc_nodes(int capacity)
+{
+    int class = capacity_class(capacity);
+    ast_node_t *nodes = spare_nodes[class];
+
+    if(nodes == NULL)
+        return arena_alloc(ast_arena, capacity * sizeof(ast_node_t));
+
+    spare_nodes[class] = nodes->children;
+    return nodes;
+}
+
+static void release_nodes(ast_node_t *nodes, int capacity)
+{
+    int class = capacity_class(capacity);
+
+    nodes->children = spare_nodes[class];
+    spare_nodes[class] = nodes;
+}
+
+static void grow_flat_tree(unsigned length)
+{
+    if(length <= unit_capacity)
+        return;
+
+    while(unit_capacity < length)
+        unit_capacity = unit_capacity ? 2 * unit_capacity : 1024;
+    unit->nodes = realloc(unit->nodes, unit_capacity * sizeof(flat_node_t));
+    unit->line_numbers = realloc(unit->line_numbers, unit_capacity * sizeof(int));
+    unit->array_sizes = realloc(unit->array_sizes, unit_capacity * sizeof(int));
+    if(!unit->nodes || !unit->line_numbers || !unit->array_sizes)
+    {
+        fprintf(stderr, "failed to allocate memory for flat tree\n");
+        exit(-1);
+    }
+}
+
+static void begin_flat_tree(flat_tree_t *tree)
+{
+    unit = tree;
+    unit_capacity = 0;
+    memset(unit, 0, sizeof(flat_tree_t));
+    grow_flat_tree(1);
+    memset(unit->nodes, 0, sizeof(flat_node_t));
+    unit->nodes[0].token = PROGRAM;
+    unit->nodes[0].size = 1;
+    unit->line_numbers[0] = 0;
+    unit->array_sizes[0] = 0;
+    unit->length = 1;
+}
+
+static void end_flat_tree(void)
+{
+    //give back the room that was never used
+    unit_capacity = unit->length;
+    unit->nodes = realloc(unit->nodes, unit_capacity * sizeof(flat_node_t));
+    unit->line_numbers = realloc(unit->line_numbers, unit_capacity * sizeof(int));
+    unit->array_sizes = realloc(unit->array_sizes, unit_capacity * sizeof(int));
+    unit = NULL;
+}
+
+void add_flat_declaration(ast_node_t *decl)
+{
+    ast_node_t *stack, cur;
+    unsigned top = 0, stack_size = 64, start = unit->length, i, j, child;
+    char tok[20];
+
+    if(program_options & PARSER_DEBUG_OPTION)
+    {
+        tok_to_str(tok, PROGRAM);
+        printf("adding %d children to node of type %s\n", 1, tok);
+    }
+
+    stack = malloc(stack_size * sizeof(ast_node_t));
+    if(stack == NULL)
+    {
+        fprintf(stderr, "failed to allocate memory for flat tree\n");
+        exit(-1);
+    }
+
+    //the stack holds copies so each children array can be given back 
+    //as soon as it is pushed. children go on backwards so the first
+    //comes off next
+    stack[top++] = *decl;
+    release_nodes(decl, 1);
+    while(top)
+    {
+        cur = stack[--top];
+
+        grow_flat_tree(unit->length + 1);
+        i = unit->length++;
+        unit->nodes[i].value = cur.value;
+        unit->nodes[i].type = cur.type;
+        unit->nodes[i].size = 1;
+        unit->nodes[i].num_children = cur.num_children;
+        unit->nodes[i].token = cur.token;
+        unit->line_numbers[i] = cur.line_number;
+        unit->array_sizes[i] = cur.array_size;
+
+        if(cur.num_children == 0)
+            continue;
+        if(top + cur.num_children > stack_size)
+        {
+            while(top + cur.num_children > stack_size)
+                stack_size *= 2;
+            stack = realloc(stack, stack_size * sizeof(ast_node_t));
+            if(stack == NULL)
+            {
+                fprintf(stderr, "failed to allocate memory for flat tree\n");
+                exit(-1);
+            }
+        }
+        for(j = cur.num_children; j > 0; j--)
+        {
+            stack[top++] = cur.children[j-1];
+        }
+        release_nodes(cur.children, child_capacity(cur.num_children));
+    }
+    free(stack);
+
+    //children come after their parent, so going backwards every
+    //child's size is known before its parent's
+    for(i = unit->length; i-- > start; )
+    {
+        for(j = 0, child = i + 1; j < unit->nodes[i].num_children; j++)
+        {
+            unit->nodes[i].size += unit->nodes[child].size;
+            child += unit->nodes[child].size;
+        }
+    }
+    unit->nodes[0].num_children++;
+    unit->nodes[0].size = unit->length;
+}
+
 ast_node_t *new_ast_node(int token, int type, int num_children, ast_node_t *children, ast_value_t value, int array_size)
 {
     char tok[20];
@@ -101,12 +299,7 @@ ast_node_t *new_ast_node(int token, int type, int num_children, ast_node_t *chil
     }
     ast_node_t *new;
 
-    new = malloc(sizeof(ast_node_t));
-    if(new == NULL)
-    {
-        fprintf(stderr, "failed to allocate memory for new ast node\n");
-        return NULL;
-    }
+    new = alloc_nodes(1);
     new->num_children = num_children;
     new->token = token;
     new->value = value;
@@ -115,7 +308,8 @@ ast_node_t *new_ast_node(int token, int type, int num_children, ast_node_t *chil
     new->line_number = yyline;
     if(num_children && !children)
     {
-        new->children = calloc(num_children, sizeof(ast_node_t));
+        new->children = alloc_nodes(child_capacity(num_children));
+        memset(new->children, 0, child_capacity(num_children) * sizeof(ast_node_t));
     }
     else
     {
@@ -126,43 +320,24 @@ ast_node_t *new_ast_node(int token, int type, int num_children, ast_node_t *chil
 
 ast_node_t *new_variable_node(int scope, int type, ast_node_t *identifiers)
 {
-    int kids = 0, i;
-    ast_node_t *cur = identifiers, *ans, *last;
-    ast_value_t value;
+    int i;
 
     if( program_options & PARSER_DEBUG_OPTION )
     {
         printf("creating variable of type %d, scope %d\n", type, scope>>30); 
     }
 
-    while(cur)
-    {
-        kids++;
-        cur = cur->children;
-    }
-
-    value.i = 0; 
-
-    ans = new_ast_node(VARIABLE, type, kids, NULL, value, 0);
-    cur = identifiers;
-    i = 0; 
-
-    while(cur)
+    //the identifiers rule already collected them under a VARIABLE node
+    identifiers->type = type;
+    for(i = 0; i < identifiers->num_children; i++)
     {
-        ans->children[i] = *cur;
-        if(ans->children[i].array_size)
-            ans->children[i].type = type | ARRAY;
+        if(identifiers->children[i].array_size)
+            identifiers->children[i].type = type | ARRAY;
         else
-            ans->children[i].type = type;
-        last = cur;
-        cur = cur->children;
-        ans->children[i].num_children = 0;
-        ans->children[i].children = NULL;
-        free(last);
-        i++;
+            identifiers->children[i].type = type;
     }
-    ans->line_number = yyline; 
-    return ans;
+    identifiers->line_number = yyline; 
+    return identifiers;
 }
 
 ast_node_t *make_function_sig(ast_node_t *type_name, ast_node_t *params, int type)
@@ -170,24 +345,20 @@ ast_node_t *make_function_sig(ast_node_t *type_name, ast_node_t *params, int typ
     int *p, i;
     ast_node_t *func = type_name;
     
-    type_name = realloc(params, sizeof(ast_node_t) * 2);
-
-    if(type_name == NULL)
-    {
-        fprintf(stderr, "failed to allocate memory for function identifier node\n"); 
-        exit(-1);
-    }
+    type_name = alloc_nodes(2);
 
     func->num_children = 2;
     func->children = type_name;
+    type_name[1] = *params;
+    release_nodes(params, 1);
     params = type_name + 1;
-    *params = *type_name;
     type_name->token = IDENT;
     type_name->num_children = 0;
     type_name->children = NULL;
     type_name->value.s = func->value.s;
     type_name->type = CHAR | ARRAY;
     type_name->line_number = yyline;
+    type_name->array_size = 0;
 
     p = malloc(sizeof(int) * (params->num_children + 1));
 
@@ -211,21 +382,6 @@ ast_node_t *make_function_sig(ast_node_t *type_name, ast_node_t *params, int typ
     return func;
 }
 
-ast_node_t *invert_list(ast_node_t *node)
-{
-    int i;
-    ast_node_t temp;
-
-    for(i = 0; i < node->num_children/2; i++)
-    {
-        temp = node->children[i];
-        node->children[i] = node->children[node->num_children-i-1];
-        node->children[node->num_children-i-1] = temp;
-    }
-
-    return node;
-}
-
 void check_function_params(ast_node_t *node)
 {
     int i, length = 1;
@@ -287,7 +443,7 @@ void process_declaration(ast_node_t *node, int local)
 
 void add_ast_children(ast_node_t *parent, ast_node_t *children, int num_children)
 {
-    void *temp;    
+    ast_node_t *temp;
     char tok[20];
 
     if(program_options & PARSER_DEBUG_OPTION)
@@ -296,60 +452,120 @@ void add_ast_children(ast_node_t *parent, ast_node_t *children, int num_children
         printf("adding %d children to node of type %s\n", num_children, tok);
     }
 
-    temp = realloc(parent->children, (num_children + parent->num_children) * sizeof(ast_node_t));
-    if(temp == NULL)
+    //move to a bigger array once the power of 2 is used up
+    if(parent->num_children + num_children > child_capacity(parent->num_children))
     {
-        fprintf(stderr, "failed to allocate memory for new ast children\n");
-        return;
+        temp = alloc_nodes(child_capacity(parent->num_children + num_children));
+        if(parent->num_children)
+        {
+            memcpy(temp, parent->children, sizeof(ast_node_t) * parent->num_children);
+            release_nodes(parent->children, child_capacity(parent->num_children));
+        }
+        parent->children = temp;
     }
 
-    parent->children = temp;
     memcpy(parent->children + parent->num_children, children, sizeof(ast_node_t) * num_children);
     parent->num_children = parent->num_children + num_children;
-    free(children);
+    release_nodes(children, child_capacity(num_children));
 }
 
-void preorder_traversal(ast_node_t node, int depth, void (*func)(ast_node_t, int, void*), void *arg)
+unsigned flat_child(const flat_tree_t *tree, unsigned node, int n)
 {
-    int i; 
+    node++;
+    while(n-- > 0)
+    {
+        node += tree->nodes[node].size;
+    }
+    return node;
+}
+
+unsigned flat_next(const flat_tree_t *tree, unsigned node)
+{
+    return node + tree->nodes[node].size;
+}
+
+//the depth of a node is the number of open subtrees it falls in
+static unsigned *open_subtrees(unsigned *stack, int top, int *capacity)
+{
+    if(top < *capacity)
+        return stack;
 
-    func(node, depth, arg);
-    for(i = 0; i < node.num_children; i++)
+    *capacity = *capacity ? 2 * *capacity : 64;
+    stack = realloc(stack, *capacity * 2 * sizeof(unsigned));
+    if(stack == NULL)
     {
-        preorder_traversal(node.children[i], depth+1, func, arg);
+        fprintf(stderr, "failed to allocate memory to traverse parse tree\n");
+        exit(-1);
     }
+    return stack;
 }
 
-void postorder_traversal(ast_node_t node, int depth, void (*func)(ast_node_t, int, void*), void *arg)
+void preorder_traversal(const flat_tree_t *tree, unsigned node, int depth, flat_visitor_t func, void *arg)
 {
-    int i;
+    unsigned *ends = NULL, end = node + tree->nodes[node].size;
+    int top = 0, capacity = 0;
 
-    for(i = 0; i < node.num_children; i++)
+    for(; node < end; node++)
     {
-        postorder_traversal(node.children[i], depth+1, func, arg);
+        while(top && node >= ends[top-1])
+            top--;
+        func(tree, node, depth + top, arg);
+        if(tree->nodes[node].size > 1)
+        {
+            ends = open_subtrees(ends, top, &capacity);
+            ends[top++] = node + tree->nodes[node].size;
+        }
     }
-    func(node, depth, arg);
+    free(ends);
 }
 
-void print_node(ast_node_t node, int depth, void *arg)
+void postorder_traversal(const flat_tree_t *tree, unsigned node, int depth, flat_visitor_t func, void *arg)
+{
+    unsigned *open = NULL, end = node + tree->nodes[node].size;
+    int top = 0, capacity = 0;
+
+    //a parent is visited once the last node of its subtree has been,
+    //open holds (start, end) pairs
+    for(; node < end; node++)
+    {
+        if(tree->nodes[node].size > 1)
+        {
+            open = open_subtrees(open, top, &capacity);
+            open[2*top] = node;
+            open[2*top+1] = node + tree->nodes[node].size;
+            top++;
+            continue;
+        }
+        func(tree, node, depth + top, arg);
+        while(top && node + 1 >= open[2*top-1])
+        {
+            top--;
+            func(tree, open[2*top], depth + top, arg);
+        }
+    }
+    free(open);
+}
+
+void print_node(const flat_tree_t *tree, unsigned i, int depth, void *arg)
 {
     char tok[20], type[20];
+    const flat_node_t *node = tree->nodes + i;
 
-    tok_to_str(tok, node.token);
+    tok_to_str(tok, node->token);
 
-    switch(node.token)
+    switch(node->token)
     {
         //nodes with int values
         case INTCONST: 
-            printf("%*ctype: %s, value: %d, children %d\n", 2*depth, ' ', tok, node.value.i, node.num_children);
+            printf("%*ctype: %s, value: %d, children %d\n", 2*depth, ' ', tok, node->value.i, node->num_children);
             break;
         //nodes with char values
         case CHARCONST:
-            printf("%*ctype: %s, value: %c, children %d\n", 2*depth, ' ', tok, node.value.c, node.num_children);
+            printf("%*ctype: %s, value: %c, children %d\n", 2*depth, ' ', tok, node->value.c, node->num_children);
             break;
         //ndoes with real values
         case REALCONST:
-            printf("%*ctype: %s, value: %f, children %d\n", 2*depth, ' ', tok, node.value.f, node.num_children);
+            printf("%*ctype: %s, value: %f, children %d\n", 2*depth, ' ', tok, node->value.f, node->num_children);
             break;
         //nodes with string values
         case STRCONST:
@@ -357,51 +573,50 @@ void print_node(ast_node_t node, int depth, void *arg)
         case IDENT:
         case FUNCTION_CALL:
         case LVALUE:
-            type_to_str(type, node.type);
-            if(node.array_size)
+            type_to_str(type, node->type);
+            if(tree->array_sizes[i])
                 printf("%*ctoken: %s, value: %s, type: %s, array size %d, children %d\n", 
-                    2*depth, ' ', tok, node.value.s, type, node.array_size, node.num_children
+                    2*depth, ' ', tok, node->value.s, type, tree->array_sizes[i], node->num_children
                 );
             else
                 printf("%*ctoken: %s, value: %s, type: %s, children %d\n", 
-                    2*depth, ' ', tok, node.value.s, type, node.num_children
+                    2*depth, ' ', tok, node->value.s, type, node->num_children
                 );
             break;
         //special case node with type rep as value
         case TYPE:
         case VARIABLE:
-            type_to_str(type, node.type);
-            printf("%*ctoken: %s, var type: %s, children %d\n", 2*depth, ' ', tok, type, node.num_children);
+            type_to_str(type, node->type);
+            printf("%*ctoken: %s, var type: %s, children %d\n", 2*depth, ' ', tok, type, node->num_children);
             break;
         //sepcial case node with op type as value
         case BINARY_OP:
-            tok_to_str(type, node.value.i);
-            printf("%*ctoken: %s, op: %s, children %d\n", 2*depth, ' ', tok, type, node.num_children);
+            tok_to_str(type, node->value.i);
+            printf("%*ctoken: %s, op: %s, children %d\n", 2*depth, ' ', tok, type, node->num_children);
             break;
         default:
-            type_to_str(type, node.type);
-            printf("%*ctoken: %s, type: %s, children %d\n", 2*depth, ' ', tok, type, node.num_children);
+            type_to_str(type, node->type);
+            printf("%*ctoken: %s, type: %s, children %d\n", 2*depth, ' ', tok, type, node->num_children);
             break;
     }
 }
 
-static void print_parser_output(ast_node_t node)
+static void print_parser_output(const flat_tree_t *tree)
 {
-    int i, j, k, p=0;
-    ast_node_t cur, cur_2;
+    unsigned i, j, k, cur, cur_2, n, m, p=0;
+    const flat_node_t *nodes = tree->nodes;
 
     printf("Global Variables: ");
     //loops through main program children to find global variables
-    for(i = 0; i < node.num_children; i++)
+    for(i = 1; i < tree->length; i = flat_next(tree, i))
     {
-        if(node.children[i].token == VARIABLE)
+        if(nodes[i].token == VARIABLE)
         {
-            cur = node.children[i];
-            for(j = 0; j < cur.num_children; j++)
+            for(j = i+1, n = 0; n < nodes[i].num_children; j = flat_next(tree, j), n++)
             {
                 if(p!=0)
                     printf(", ");
-                printf("%s", cur.children[j].value.s);
+                printf("%s", nodes[j].value.s);
                 p++;
             }
         }
@@ -409,35 +624,33 @@ static void print_parser_output(ast_node_t node)
 
     printf("\n\n");
     //finds all functions in main program then prints the data in their children
-    for(i = 0; i < node.num_children; i++)
+    for(i = 1; i < tree->length; i = flat_next(tree, i))
     {
-        cur = node.children[i];
-        if( cur.token == FUNCTION_PROTO || cur.token == FUNCTION_DEF)
+        if( nodes[i].token == FUNCTION_PROTO || nodes[i].token == FUNCTION_DEF)
         {
-            printf("Function: %s\n", cur.children[0].value.s);
+            printf("Function: %s\n", nodes[i+1].value.s);
             printf("\tParameters: ");
 
-            cur = node.children[i].children[1];
-            for(j = 0; j < cur.num_children-1; j++)
+            cur = flat_child(tree, i, 1);
+            for(j = cur+1, n = 0; n < nodes[cur].num_children; j = flat_next(tree, j), n++)
             {
-                printf("%s, ", cur.children[j].value.s);
+                if(n != 0)
+                    printf(", ");
+                printf("%s", nodes[j].value.s);
             }
-            if(cur.num_children != 0)
-                printf("%s", cur.children[j].value.s);
             
-            if( node.children[i].token == FUNCTION_DEF)
+            if( nodes[i].token == FUNCTION_DEF)
             {
                 printf("\n\tLocal vars: ");
-                cur = node.children[i].children[2];
-                for(j = 0; j < cur.num_children; j++)
+                cur = flat_child(tree, i, 2);
+                for(cur_2 = cur+1, n = 0; n < nodes[cur].num_children; cur_2 = flat_next(tree, cur_2), n++)
                 {
-                    cur_2 = cur.children[j];
-                    for(k = 0; k < cur_2.num_children; k++)
+                    for(k = cur_2+1, m = 0; m < nodes[cur_2].num_children; k = flat_next(tree, k), m++)
                     {
-                        if(k == 0 && j == 0) 
-                            printf("%s", cur_2.children[k].value.s);
+                        if(m == 0 && n == 0) 
+                            printf("%s", nodes[k].value.s);
                         else
-                            printf(", %s", cur_2.children[k].value.s);
+                            printf(", %s", nodes[k].value.s);
                     }
                 }
             }
@@ -445,18 +658,3 @@ static void print_parser_output(ast_node_t node)
         }
     }
 }
-
-static void free_memory(ast_node_t node, int depth, void *arg)
-{
-    if(node.num_children && node.children)
-        free(node.children);
-    
-    if(node.token == TYPE_NAME || node.token == IDENT || node.token == FUNCTION_CALL || node.token == LVALUE)
-        free(node.value.s);
-}
-
-void free_tree_memory(ast_node_t node)
-{
-    postorder_traversal(node, 1, &free_memory, NULL); 
-}
-
@@ -0,0 +1,45 @@
+#!/bin/sh
+#
+# Differential test of ir2c against the vm: every program is run by
+# both, with its own text as input, and the output and exit status
+# must match.  Run from the top directory, after make vm ir2c; give
+# .ir files to test other programs than src/test/*.ir.
+#
+#   sh src/test/aot_diff.sh [file.ir ...]
+#
+VM=${VM:-bin/vm}
+IR2C=${IR2C:-bin/ir2c}
+CC=${CC:-gcc}
+
+if [ $# -eq 0 ]; then
+    set -- src/test/*.ir
+fi
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+failed=0
+for ir in "$@"; do
+    name=$(basename "$ir" .ir)
+    if ! "$IR2C" "$ir" "$work/$name.c" ||
+       ! $CC -O2 -o "$work/$name" "$work/$name.c" -pthread; then
+        echo "FAIL $ir: didn't translate"
+        failed=$((failed+1))
+        continue
+    fi
+    "$VM" "$ir" < "$ir" > "$work/$name.vm" 2>&1
+    vmstatus=$?
+    "$work/$name" < "$ir" > "$work/$name.aot" 2>&1
+    aotstatus=$?
+    if [ $vmstatus -ne $aotstatus ]; then
+        echo "FAIL $ir: vm exits with $vmstatus, translation with $aotstatus"
+        failed=$((failed+1))
+    elif ! cmp -s "$work/$name.vm" "$work/$name.aot"; then
+        echo "FAIL $ir: output differs"
+        diff "$work/$name.vm" "$work/$name.aot" | head -5
+        failed=$((failed+1))
+    else
+        echo "ok   $ir: $(tail -n 1 "$work/$name.aot")"
+    fi
+done
+echo "$# programs, $failed failed"
+[ $failed -eq 0 ]
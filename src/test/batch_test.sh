@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Test of vm --batch with failing jobs among good ones: a division by
+# zero and an INT_MIN % -1 must each fail their own job only, and the
+# rest must run to the end, on one thread or several and with
+# --schedule.  Run from the top directory, after make vm.
+#
+#   sh src/test/batch_test.sh
+#
+VM=${VM:-bin/vm}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+cat > "$work/jobs" <<EOF
+src/test/loop.ir
+src/test/batch/div.ir
+src/test/vm_test.ir src/test/vm_test.ir $work/vm_test.out
+src/test/batch/mod.ir
+src/test/cat.ir src/test/hellor.ir $work/cat.out
+EOF
+cat > "$work/expected" <<EOF
+src/test/loop.ir: main returned -2014260032
+src/test/batch/div.ir: Runtime error in function main instruction 6: division by zero or overflow
+src/test/vm_test.ir < src/test/vm_test.ir > $work/vm_test.out: main returned 17
+src/test/batch/mod.ir: Runtime error in function main instruction 6: division by zero or overflow
+src/test/cat.ir < src/test/hellor.ir > $work/cat.out: main returned 696
+EOF
+
+failed=0
+runs=0
+for options in "--threads=1" "--threads=2" "--threads=2 --schedule" \
+               "--threads=1 --schedule=100"; do
+    runs=$((runs+1))
+    rm -f "$work/vm_test.out" "$work/cat.out"
+    $VM --batch="$work/jobs" $options > "$work/out" 2>&1
+    status=$?
+    sed 's/ ([0-9]* instructions.*//' "$work/out" | head -n 5 > "$work/got"
+    if [ $status -ne 1 ]; then
+        echo "FAIL $options: vm exits with $status, not 1"
+        tail -n 3 "$work/out"
+        failed=$((failed+1))
+    elif ! tail -n 1 "$work/out" | grep -q "3 ran, 2 failed"; then
+        echo "FAIL $options: $(tail -n 1 "$work/out")"
+        failed=$((failed+1))
+    elif ! cmp -s "$work/expected" "$work/got"; then
+        echo "FAIL $options: job results differ"
+        diff "$work/expected" "$work/got" | head -5
+        failed=$((failed+1))
+    elif ! cmp -s src/test/hellor.ir "$work/cat.out"; then
+        echo "FAIL $options: cat.ir output differs"
+        failed=$((failed+1))
+    else
+        echo "ok   $options"
+    fi
+done
+echo "$runs runs, $failed failed"
+[ $failed -eq 0 ]
@@ -0,0 +1,122 @@
+/*
+ * Microbenchmark for src/core/hashmap.c. It only uses the map_t api, so
+ * hashmap_bench.sh can build it against older versions of the map too.
+ * Prints one line per operation with the nanoseconds each call took.
+ *
+ *   hashmap_bench [names]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../includes/hashmap.h"
+#include "../../includes/intern.h"
+
+//names in a function's local map, and how many functions
+#define LOCAL_NAMES     16
+#define LOCAL_ROUNDS    20000
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static void report(const char *map, const char *op, long calls, double start)
+{
+    printf("%-10s %-12s %10.1f\n", map, op, (now() - start) / calls);
+}
+
+/**
+ *  puts every name into one map, then gets each of them, gets names that
+ *  are not there, and removes them all. lookup holds the same strings as
+ *  names, and absent names that were never put
+ */
+static void one_map(const char *label, map_t map, const char **names,
+                    const char **lookup, const char **absent, int n)
+{
+    void *value;
+    double start;
+    int i, found = 0;
+
+    start = now();
+    for(i = 0; i < n; i++)
+        hashmap_put(map, names[i], (void*)names[i]);
+    report(label, "put", n, start);
+
+    start = now();
+    for(i = 0; i < n; i++)
+        found += hashmap_get(map, lookup[i], &value) == MAP_OK;
+    report(label, "get", n, start);
+
+    start = now();
+    for(i = 0; i < n; i++)
+        found += hashmap_get(map, absent[i], &value) == MAP_OK;
+    report(label, "get missing", n, start);
+
+    start = now();
+    for(i = 0; i < n; i++)
+        found += hashmap_remove(map, lookup[i]) == MAP_OK;
+    report(label, "remove", n, start);
+
+    if(found != 2 * n || hashmap_length(map) != 0)
+        fprintf(stderr, "%s: map lost names\n", label);
+    hashmap_free(map);
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 200000;
+    const char **names = malloc(n * sizeof(char*));
+    const char **copies = malloc(n * sizeof(char*));
+    const char **absent = malloc(n * sizeof(char*));
+    const char **absent_copies = malloc(n * sizeof(char*));
+    char buffer[32];
+    void *value;
+    double start;
+    map_t map;
+    int i, j, round;
+
+    if(n < LOCAL_NAMES)
+        n = LOCAL_NAMES;
+    for(i = 0; i < n; i++)
+    {
+        sprintf(buffer, "name_%d", i);
+        names[i] = intern(buffer);
+        copies[i] = strdup(buffer);
+        sprintf(buffer, "other_%d", i);
+        absent[i] = intern(buffer);
+        absent_copies[i] = strdup(buffer);
+    }
+
+    //a symbol table or address map of a large file
+    one_map("interned", hashmap_new_interned(), names, names, absent, n);
+    one_map("strings", hashmap_new(), names, copies, absent_copies, n);
+
+    //a map of locals made and thrown away for every function
+    start = now();
+    for(round = 0; round < LOCAL_ROUNDS; round++)
+    {
+        map = hashmap_new_interned();
+        for(i = 0; i < LOCAL_NAMES; i++)
+            hashmap_put(map, names[i], (void*)names[i]);
+        for(j = 0; j < 4; j++)
+            for(i = 0; i < LOCAL_NAMES; i++)
+                hashmap_get(map, names[i], &value);
+        hashmap_free(map);
+    }
+    report("locals", "function", LOCAL_ROUNDS, start);
+
+    for(i = 0; i < n; i++)
+    {
+        free((char*)copies[i]);
+        free((char*)absent_copies[i]);
+    }
+    free(names);
+    free(copies);
+    free(absent);
+    free(absent_copies);
+    intern_free();
+    return 0;
+}
@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Microbenchmark of the map in src/core/hashmap.c against an older
+# version of it.  Builds hashmap_bench.c twice, once with the map from
+# git revision OLD (by default the last one before the open addressing
+# map) and once with the map in the tree, and prints the nanoseconds
+# per call of each side by side.  The two take turns RUNS times and
+# each line is the fastest of the runs, as a single run is noisy.
+# Run from the top directory.
+#
+#   sh src/test/hashmap_bench.sh [names]
+#
+OLD=${OLD:-24cccb3}
+RUNS=${RUNS:-9}
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+if ! git show "$OLD:src/core/hashmap.c" > "$work/hashmap.c"; then
+    echo "no hashmap.c at $OLD"
+    exit 1
+fi
+# build map out: builds the benchmark with that hashmap.c.  -I src/core lets the
+# old file's includes, relative to src/core, resolve from $work
+build() {
+    $CC $CFLAGS -I src/core -o "$2" src/test/hashmap_bench.c "$1" \
+        src/core/intern.c src/core/arena.c
+}
+build "$work/hashmap.c" "$work/benchold" || exit 1
+build src/core/hashmap.c "$work/benchnew" || exit 1
+
+# best file: the lowest time for each line across the runs in file
+best() {
+    awk '{
+        key = $1; for (i = 2; i < NF; i++) key = key " " $i
+        if (!(key in low)) { order[++n] = key; low[key] = $NF }
+        else if ($NF + 0 < low[key] + 0) low[key] = $NF
+    } END {
+        for (i = 1; i <= n; i++) print order[i], low[order[i]]
+    }' "$1"
+}
+run=0
+while [ $run -lt "$RUNS" ]; do
+    "$work/benchold" "$@" >> "$work/oldruns" || exit 1
+    "$work/benchnew" "$@" >> "$work/newruns" || exit 1
+    run=$((run + 1))
+done
+best "$work/oldruns" > "$work/old"
+best "$work/newruns" > "$work/new"
+printf "%-10s %-12s %10s %10s\n" map operation "old ns" "new ns"
+paste "$work/old" "$work/new" | awk '{
+    n = NF / 2
+    map = $1; op = $2
+    for (i = 3; i < n; i++) op = op " " $i
+    printf "%-10s %-12s %10s %10s\n", map, op, $n, $NF
+}'
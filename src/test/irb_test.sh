@@ -0,0 +1,45 @@
+#!/bin/sh
+#
+# Test of compile -b against compile -c: every program is compiled
+# both ways and run by the vm, with its own text as input, and the
+# output and exit status must match.  Run from the top directory,
+# after make compile vm; give .c files to test other programs than
+# src/test/gen_test.c.
+#
+#   sh src/test/irb_test.sh [file.c ...]
+#
+VM=${VM:-bin/vm}
+COMPILE=${COMPILE:-bin/compile}
+
+if [ $# -eq 0 ]; then
+    set -- src/test/gen_test.c
+fi
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+failed=0
+for c in "$@"; do
+    name=$(basename "$c" .c)
+    if ! "$COMPILE" -c "$c" > "$work/$name.ir" ||
+       ! "$COMPILE" -b "$c" > "$work/$name.irb"; then
+        echo "FAIL $c: didn't compile"
+        failed=$((failed+1))
+        continue
+    fi
+    "$VM" "$work/$name.ir" < "$c" > "$work/$name.text" 2>&1
+    textstatus=$?
+    "$VM" "$work/$name.irb" < "$c" > "$work/$name.binary" 2>&1
+    binarystatus=$?
+    if [ $textstatus -ne $binarystatus ]; then
+        echo "FAIL $c: -c exits with $textstatus, -b with $binarystatus"
+        failed=$((failed+1))
+    elif ! cmp -s "$work/$name.text" "$work/$name.binary"; then
+        echo "FAIL $c: output differs"
+        diff "$work/$name.text" "$work/$name.binary" | head -5
+        failed=$((failed+1))
+    else
+        echo "ok   $c: $(tail -n 1 "$work/$name.binary")"
+    fi
+done
+echo "$# programs, $failed failed"
+[ $failed -eq 0 ]
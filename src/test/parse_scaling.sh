@@ -0,0 +1,66 @@
+#!/bin/sh
+#
+# Scaling benchmark for the parser.  Generates programs that are long
+# in one direction at a time (top level declarations, statements in one
+# body, locals in one body, names in one declaration) and times the
+# compiler on each, doubling the length every step.  When building is
+# linear the time per element stays flat down each column.  Run from
+# the top directory, after make compile.
+#
+#   sh src/test/parse_scaling.sh [length ...]
+#
+COMPILE=${COMPILE:-bin/compile}
+MODE=${MODE:--c}
+
+if [ $# -eq 0 ]; then
+    set -- 12500 25000 50000 100000 200000
+fi
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# shape length: writes a program to stdout
+generate() {
+    awk -v shape="$1" -v n="$2" 'BEGIN {
+        if (shape == "globals") {
+            for (i = 0; i < n; i++) printf "int g%d;\n", i;
+            print "int main() { return 0; }";
+        } else if (shape == "functions") {
+            for (i = 0; i < n; i++) printf "int f%d() { return %d; }\n", i, i % 100;
+            print "int main() { return f0(); }";
+        } else if (shape == "statements") {
+            print "int main() {\n    int x;\n    x = 0;";
+            for (i = 0; i < n; i++) printf "    x = x + %d;\n", i % 100;
+            print "    return x;\n}";
+        } else if (shape == "locals") {
+            print "int main() {";
+            for (i = 0; i < n; i++) printf "    int l%d;\n", i;
+            print "    return 0;\n}";
+        } else if (shape == "names") {
+            printf "int g0";
+            for (i = 1; i < n; i++) printf ", g%d", i;
+            print ";\nint main() { return 0; }";
+        }
+    }'
+}
+
+now() {
+    date +%s%N
+}
+
+printf "%-12s %10s %10s %12s\n" shape length ms "ns/element"
+for shape in globals functions statements locals names; do
+    for n in "$@"; do
+        generate $shape $n > "$work/$shape.c"
+        start=$(now)
+        "$COMPILE" $MODE "$work/$shape.c" > /dev/null 2> "$work/err"
+        status=$?
+        end=$(now)
+        # a syntax error (the parser stack running out) still exits with 0
+        if [ $status -eq 0 ] && [ ! -s "$work/err" ]; then
+            printf "%-12s %10d %10d %12d\n" $shape $n \
+                $(( (end-start)/1000000 )) $(( (end-start)/n ))
+        else
+            printf "%-12s %10d %10s   %s\n" $shape $n failed "$(head -n 1 "$work/err")"
+        fi
+    done
+done
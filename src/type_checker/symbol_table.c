@@ -4,6 +4,7 @@
 #include "../../bin/parser/bison.h"
 #include "../../includes/symbol_table.h"
 #include "../../includes/hashmap.h"
+#include "../../includes/intern.h"
 #include "../../includes/utils.h"
 #include "../../includes/types.h"
 #include "../../includes/main.h"
@@ -48,12 +49,13 @@ int init_symbol_table()
 {
     int i, params[2];
     params[0]  = DEF_TYPE;
-    i = global_scope_add("getchar", INT, BUILT_IN_FUNC, 0, params);
+    //symbols are interned names, the tables compare them by pointer
+    i = global_scope_add((char*)intern("getchar"), INT, BUILT_IN_FUNC, 0, params);
     if(i == 0)
     {
         params[0] = INT;
         params[1] = DEF_TYPE;
-        i = global_scope_add("putchar", INT, BUILT_IN_FUNC, 0, params);
+        i = global_scope_add((char*)intern("putchar"), INT, BUILT_IN_FUNC, 0, params);
     }
     return i;
 }
@@ -71,7 +73,7 @@ int global_scope_add(char* symbol, int type, char* file, int line, int* params)
     symbol_imp_t *sym;
 
     if(global_symbols == NULL)
-        global_symbols = hashmap_new();
+        global_symbols = hashmap_new_interned();
     
     if( hashmap_get(global_symbols, symbol, (void**)&sym) == MAP_OK )
     {
@@ -102,7 +104,7 @@ int local_scope_add(char* symbol, int type, char* file, int line)
     symbol_imp_t *sym;
 
     if(local_symbols == NULL)
-        local_symbols = hashmap_new();
+        local_symbols = hashmap_new_interned();
     if( hashmap_get(local_symbols, symbol, (void**)&sym) == MAP_OK ) 
     {
         print_type_error(file, sym->file, symbol, sym->type, sym->line, line);